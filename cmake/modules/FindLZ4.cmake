@@ -0,0 +1,42 @@
+# Find the LZ4 includes and library.
+# 
+# This module defines
+# LZ4_INCLUDE_DIR, where to locate lz4.h file
+# LZ4_LIBRARIES, the libraries to link against to use lz4
+# LZ4_FOUND.  If false, you cannot build anything that requires lz4.
+# LZ4_LIBRARY, where to find the liblz4 library.
+
+set(LZ4_FOUND 0)
+if(LZ4_LIBRARY AND LZ4_INCLUDE_DIR)
+  set(LZ4_FIND_QUIETLY TRUE)
+endif()
+
+find_path(LZ4_INCLUDE_DIR lz4.h
+  $ENV{LZ4_DIR}/include
+  $ENV{LZ4} $ENV{LZ4}/include
+  /usr/local/include
+  /usr/include
+  /opt/lz4/include
+  DOC "Specify the directory containing lz4.h"
+)
+
+find_library(LZ4_LIBRARY NAMES lz4 PATHS
+  $ENV{LZ4_DIR}/lib
+  $ENV{LZ4} $ENV{LZ4}/lib
+  /usr/local/lib
+  /usr/lib 
+  /opt/lz4/lib
+  DOC "Specify the lz4 library here."
+)
+
+if(LZ4_INCLUDE_DIR AND LZ4_LIBRARY)
+  set(LZ4_FOUND 1 )
+  if(NOT LZ4_FIND_QUIETLY)
+     message(STATUS "Found lz4 includes at ${LZ4_INCLUDE_DIR}")
+     message(STATUS "Found lz4 library at ${LZ4_LIBRARY}")
+  endif()
+endif()
+
+set(LZ4_LIBRARIES ${LZ4_LIBRARY})
+
+mark_as_advanced(LZ4_FOUND LZ4_LIBRARY LZ4_INCLUDE_DIR)
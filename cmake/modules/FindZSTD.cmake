@@ -0,0 +1,42 @@
+# Find the ZSTD includes and library.
+# 
+# This module defines
+# ZSTD_INCLUDE_DIR, where to locate zstd.h file
+# ZSTD_LIBRARIES, the libraries to link against to use zstd
+# ZSTD_FOUND.  If false, you cannot build anything that requires zstd.
+# ZSTD_LIBRARY, where to find the libzstd library.
+
+set(ZSTD_FOUND 0)
+if(ZSTD_LIBRARY AND ZSTD_INCLUDE_DIR)
+  set(ZSTD_FIND_QUIETLY TRUE)
+endif()
+
+find_path(ZSTD_INCLUDE_DIR zstd.h
+  $ENV{ZSTD_DIR}/include
+  $ENV{ZSTD} $ENV{ZSTD}/include
+  /usr/local/include
+  /usr/include
+  /opt/zstd/include
+  DOC "Specify the directory containing zstd.h"
+)
+
+find_library(ZSTD_LIBRARY NAMES zstd PATHS
+  $ENV{ZSTD_DIR}/lib
+  $ENV{ZSTD} $ENV{ZSTD}/lib
+  /usr/local/lib
+  /usr/lib 
+  /opt/zstd/lib
+  DOC "Specify the zstd library here."
+)
+
+if(ZSTD_INCLUDE_DIR AND ZSTD_LIBRARY)
+  set(ZSTD_FOUND 1 )
+  if(NOT ZSTD_FIND_QUIETLY)
+     message(STATUS "Found zstd includes at ${ZSTD_INCLUDE_DIR}")
+     message(STATUS "Found zstd library at ${ZSTD_LIBRARY}")
+  endif()
+endif()
+
+set(ZSTD_LIBRARIES ${ZSTD_LIBRARY})
+
+mark_as_advanced(ZSTD_FOUND ZSTD_LIBRARY ZSTD_INCLUDE_DIR)
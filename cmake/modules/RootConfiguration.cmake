@@ -322,6 +322,8 @@ set(setresuid undef)
 set(hasmathmore ${has${mathmore}})
 set(haspthread ${has${CMAKE_USE_PTHREADS_INIT}})
 set(hasxft ${has${xft}})
+set(haslz4 ${has${lz4}})
+set(haszstd ${has${zstd}})
 set(hascling ${has${cling}})
 set(haslzmacompression ${has${lzma}})
 set(hascocoa ${has${cocoa}})
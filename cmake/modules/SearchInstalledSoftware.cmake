@@ -93,6 +93,34 @@ if(builtin_lzma)
   endif()
 endif()
 
+#---Check for LZ4-------------------------------------------------------------------
+if(lz4)
+  message(STATUS "Looking for LZ4")
+  find_package(LZ4)
+  if(NOT LZ4_FOUND)
+    if(fail-on-missing)
+      message(FATAL_ERROR "LZ4 library not found and it is required (lz4 option enabled)")
+    else()
+      message(STATUS "LZ4 not found. Switching off lz4 option")
+      set(lz4 OFF CACHE BOOL "" FORCE)
+    endif()
+  endif()
+endif()
+
+#---Check for Zstandard-------------------------------------------------------------
+if(zstd)
+  message(STATUS "Looking for Zstandard")
+  find_package(ZSTD)
+  if(NOT ZSTD_FOUND)
+    if(fail-on-missing)
+      message(FATAL_ERROR "Zstandard library not found and it is required (zstd option enabled)")
+    else()
+      message(STATUS "Zstandard not found. Switching off zstd option")
+      set(zstd OFF CACHE BOOL "" FORCE)
+    endif()
+  endif()
+endif()
+
 #---Check for Cocoa/Quartz graphics backend (MacOS X only)
 if(cocoa)
   if(APPLE)
@@ -448,6 +448,93 @@ inline void frombuf(char *&buf, Long_t *x)   { frombuf(buf, (ULong_t *) x); }
 inline void frombuf(char *&buf, Long64_t *x) { frombuf(buf, (ULong64_t *) x); }
 
 
+//______________________________________________________________________________
+// The tobuf() and frombuf() routines below convert n consecutive values at
+// once. When byte swapping is needed they call the out of line
+// R__bswapcpy routines, which use the SIMD instructions supported by the
+// processor (see Bytes.cxx). The values are moved with memcpy, the input
+// or output array may hence be of any type of the same size (e.g. a
+// Float_t array for UInt_t).
+
+#ifndef __CINT__
+void R__bswapcpy16(void *to, const void *from, Int_t n);
+void R__bswapcpy32(void *to, const void *from, Int_t n);
+void R__bswapcpy64(void *to, const void *from, Int_t n);
+#endif
+
+inline void tobuf(char *&buf, const UShort_t *x, Int_t n)
+{
+#ifdef R__BYTESWAP
+   R__bswapcpy16(buf, x, n);
+#else
+   memcpy(buf, x, n*sizeof(UShort_t));
+#endif
+   buf += n*sizeof(UShort_t);
+}
+
+inline void tobuf(char *&buf, const UInt_t *x, Int_t n)
+{
+#ifdef R__BYTESWAP
+   R__bswapcpy32(buf, x, n);
+#else
+   memcpy(buf, x, n*sizeof(UInt_t));
+#endif
+   buf += n*sizeof(UInt_t);
+}
+
+inline void tobuf(char *&buf, const ULong64_t *x, Int_t n)
+{
+#ifdef R__BYTESWAP
+   R__bswapcpy64(buf, x, n);
+#else
+   memcpy(buf, x, n*sizeof(ULong64_t));
+#endif
+   buf += n*sizeof(ULong64_t);
+}
+
+inline void tobuf(char *&buf, const Short_t *x, Int_t n)   { tobuf(buf, (const UShort_t *) x, n); }
+inline void tobuf(char *&buf, const Int_t *x, Int_t n)     { tobuf(buf, (const UInt_t *) x, n); }
+inline void tobuf(char *&buf, const Long64_t *x, Int_t n)  { tobuf(buf, (const ULong64_t *) x, n); }
+inline void tobuf(char *&buf, const Float_t *x, Int_t n)   { tobuf(buf, (const UInt_t *) x, n); }
+inline void tobuf(char *&buf, const Double_t *x, Int_t n)  { tobuf(buf, (const ULong64_t *) x, n); }
+
+inline void frombuf(char *&buf, UShort_t *x, Int_t n)
+{
+#ifdef R__BYTESWAP
+   R__bswapcpy16(x, buf, n);
+#else
+   memcpy(x, buf, n*sizeof(UShort_t));
+#endif
+   buf += n*sizeof(UShort_t);
+}
+
+inline void frombuf(char *&buf, UInt_t *x, Int_t n)
+{
+#ifdef R__BYTESWAP
+   R__bswapcpy32(x, buf, n);
+#else
+   memcpy(x, buf, n*sizeof(UInt_t));
+#endif
+   buf += n*sizeof(UInt_t);
+}
+
+inline void frombuf(char *&buf, ULong64_t *x, Int_t n)
+{
+#ifdef R__BYTESWAP
+   R__bswapcpy64(x, buf, n);
+#else
+   memcpy(x, buf, n*sizeof(ULong64_t));
+#endif
+   buf += n*sizeof(ULong64_t);
+}
+
+inline void frombuf(char *&buf, Short_t *x, Int_t n)   { frombuf(buf, (UShort_t *) x, n); }
+inline void frombuf(char *&buf, Int_t *x, Int_t n)     { frombuf(buf, (UInt_t *) x, n); }
+inline void frombuf(char *&buf, Long64_t *x, Int_t n)  { frombuf(buf, (ULong64_t *) x, n); }
+inline void frombuf(char *&buf, Float_t *x, Int_t n)   { frombuf(buf, (UInt_t *) x, n); }
+inline void frombuf(char *&buf, Double_t *x, Int_t n)  { frombuf(buf, (ULong64_t *) x, n); }
+
+
 //______________________________________________________________________________
 #ifdef R__BYTESWAP
 inline UShort_t host2net(UShort_t x)
@@ -0,0 +1,193 @@
+// @(#)root/base:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2012, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// Bytes                                                                //
+//                                                                      //
+// Out of line byte swapping of arrays, used by the tobuf() and         //
+// frombuf() routines converting n values at once (see Bytes.h).        //
+//                                                                      //
+// On x86_64 the arrays are swapped 16 (SSSE3) or 32 (AVX2) bytes at a  //
+// time with a byte shuffle. The implementation is chosen the first     //
+// time a routine is called, according to the instruction sets          //
+// supported by the processor, so that the library itself does not     //
+// require them. On the other platforms, or if the processor supports   //
+// neither, a plain loop is used.                                       //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#include "Bytes.h"
+
+#if defined(__x86_64__) && !defined(__INTEL_COMPILER) && \
+    (defined(__clang__) || (defined(__GNUC__) && \
+     (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define R__BSWAP_SIMD
+#include <immintrin.h>
+#endif
+
+typedef void (*SwapCopy_t)(void *to, const void *from, Int_t n);
+
+//______________________________________________________________________________
+static void SwapCopy16(void *to, const void *from, Int_t n)
+{
+   // Copy n 16 bits values from from to to, swapping their bytes.
+   // The arrays do not have to be aligned and may be the same.
+
+   const char *src = (const char *)from;
+   char *dst = (char *)to;
+   for (Int_t i = 0; i < n; ++i) {
+      UShort_t v;
+      memcpy(&v, src + i*sizeof(UShort_t), sizeof(UShort_t));
+      v = (UShort_t)(((v & 0x00ffU) << 8) | ((v & 0xff00U) >> 8));
+      memcpy(dst + i*sizeof(UShort_t), &v, sizeof(UShort_t));
+   }
+}
+
+//______________________________________________________________________________
+static void SwapCopy32(void *to, const void *from, Int_t n)
+{
+   // Copy n 32 bits values from from to to, swapping their bytes.
+
+   const char *src = (const char *)from;
+   char *dst = (char *)to;
+   for (Int_t i = 0; i < n; ++i) {
+      UInt_t v;
+      memcpy(&v, src + i*sizeof(UInt_t), sizeof(UInt_t));
+      v = ((v & 0x000000ffU) << 24) | ((v & 0x0000ff00U) <<  8) |
+          ((v & 0x00ff0000U) >>  8) | ((v & 0xff000000U) >> 24);
+      memcpy(dst + i*sizeof(UInt_t), &v, sizeof(UInt_t));
+   }
+}
+
+//______________________________________________________________________________
+static void SwapCopy64(void *to, const void *from, Int_t n)
+{
+   // Copy n 64 bits values from from to to, swapping their bytes.
+
+   const char *src = (const char *)from;
+   char *dst = (char *)to;
+   for (Int_t i = 0; i < n; ++i) {
+      ULong64_t v;
+      memcpy(&v, src + i*sizeof(ULong64_t), sizeof(ULong64_t));
+      v = ((v & 0x00000000000000ffULL) << 56) | ((v & 0x000000000000ff00ULL) << 40) |
+          ((v & 0x0000000000ff0000ULL) << 24) | ((v & 0x00000000ff000000ULL) <<  8) |
+          ((v & 0x000000ff00000000ULL) >>  8) | ((v & 0x0000ff0000000000ULL) >> 24) |
+          ((v & 0x00ff000000000000ULL) >> 40) | ((v & 0xff00000000000000ULL) >> 56);
+      memcpy(dst + i*sizeof(ULong64_t), &v, sizeof(ULong64_t));
+   }
+}
+
+#ifdef R__BSWAP_SIMD
+
+// Shuffle masks reversing the bytes of each 2, 4 and 8 bytes word of
+// a 16 bytes lane.
+static const char kMask16[16] = { 1,0, 3,2, 5,4, 7,6, 9,8, 11,10, 13,12, 15,14 };
+static const char kMask32[16] = { 3,2,1,0, 7,6,5,4, 11,10,9,8, 15,14,13,12 };
+static const char kMask64[16] = { 7,6,5,4,3,2,1,0, 15,14,13,12,11,10,9,8 };
+
+//______________________________________________________________________________
+__attribute__((target("ssse3")))
+static Int_t SwapCopySSSE3(char *dst, const char *src, Int_t nbytes, const char *mask)
+{
+   // Swap the bytes of the 16 bytes blocks of src into dst.
+   // Returns the number of bytes processed, the tail is left to the caller.
+
+   const __m128i m = _mm_loadu_si128((const __m128i *)mask);
+   Int_t i = 0;
+   for (; i + 16 <= nbytes; i += 16) {
+      __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+      _mm_storeu_si128((__m128i *)(dst + i), _mm_shuffle_epi8(v, m));
+   }
+   return i;
+}
+
+//______________________________________________________________________________
+__attribute__((target("avx2")))
+static Int_t SwapCopyAVX2(char *dst, const char *src, Int_t nbytes, const char *mask)
+{
+   // Swap the bytes of the 32 bytes blocks of src into dst.
+   // Returns the number of bytes processed, the tail is left to the caller.
+
+   const __m128i h = _mm_loadu_si128((const __m128i *)mask);
+   const __m256i m = _mm256_broadcastsi128_si256(h);
+   Int_t i = 0;
+   for (; i + 32 <= nbytes; i += 32) {
+      __m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+      _mm256_storeu_si256((__m256i *)(dst + i), _mm256_shuffle_epi8(v, m));
+   }
+   return i;
+}
+
+#define R__SWAPCOPY_SIMD(name, kernel, mask, size, tail)             \
+static void name(void *to, const void *from, Int_t n)                \
+{                                                                    \
+   Int_t done = kernel((char *)to, (const char *)from, n*size, mask);\
+   tail((char *)to + done, (const char *)from + done, n - done/size); \
+}
+
+R__SWAPCOPY_SIMD(SwapCopy16SSSE3, SwapCopySSSE3, kMask16, 2, SwapCopy16)
+R__SWAPCOPY_SIMD(SwapCopy32SSSE3, SwapCopySSSE3, kMask32, 4, SwapCopy32)
+R__SWAPCOPY_SIMD(SwapCopy64SSSE3, SwapCopySSSE3, kMask64, 8, SwapCopy64)
+R__SWAPCOPY_SIMD(SwapCopy16AVX2,  SwapCopyAVX2,  kMask16, 2, SwapCopy16)
+R__SWAPCOPY_SIMD(SwapCopy32AVX2,  SwapCopyAVX2,  kMask32, 4, SwapCopy32)
+R__SWAPCOPY_SIMD(SwapCopy64AVX2,  SwapCopyAVX2,  kMask64, 8, SwapCopy64)
+
+//______________________________________________________________________________
+static SwapCopy_t SelectSwapCopy(SwapCopy_t avx2, SwapCopy_t ssse3, SwapCopy_t generic)
+{
+   // Return the fastest implementation supported by the processor.
+
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx2"))  return avx2;
+   if (__builtin_cpu_supports("ssse3")) return ssse3;
+   return generic;
+}
+
+#endif
+
+//______________________________________________________________________________
+void R__bswapcpy16(void *to, const void *from, Int_t n)
+{
+   // Copy n 16 bits values from from to to, swapping their bytes.
+
+#ifdef R__BSWAP_SIMD
+   static SwapCopy_t swapcopy = SelectSwapCopy(SwapCopy16AVX2, SwapCopy16SSSE3, SwapCopy16);
+   (*swapcopy)(to, from, n);
+#else
+   SwapCopy16(to, from, n);
+#endif
+}
+
+//______________________________________________________________________________
+void R__bswapcpy32(void *to, const void *from, Int_t n)
+{
+   // Copy n 32 bits values from from to to, swapping their bytes.
+
+#ifdef R__BSWAP_SIMD
+   static SwapCopy_t swapcopy = SelectSwapCopy(SwapCopy32AVX2, SwapCopy32SSSE3, SwapCopy32);
+   (*swapcopy)(to, from, n);
+#else
+   SwapCopy32(to, from, n);
+#endif
+}
+
+//______________________________________________________________________________
+void R__bswapcpy64(void *to, const void *from, Int_t n)
+{
+   // Copy n 64 bits values from from to to, swapping their bytes.
+
+#ifdef R__BSWAP_SIMD
+   static SwapCopy_t swapcopy = SelectSwapCopy(SwapCopy64AVX2, SwapCopy64SSSE3, SwapCopy64);
+   (*swapcopy)(to, from, n);
+#else
+   SwapCopy64(to, from, n);
+#endif
+}
@@ -24,10 +24,14 @@ ZIPOLDH      := $(MODDIRI)/Bits.h       \
                 $(MODDIRI)/ZDeflate.h   \
                 $(MODDIRI)/ZIP.h        \
                 $(MODDIRI)/ZTrees.h     \
-                $(MODDIRI)/Compression.h
+                $(MODDIRI)/Compression.h \
+                $(MODDIRI)/ZipLZ4.h     \
+                $(MODDIRI)/ZipZSTD.h
 
 ZIPOLDS      := $(MODDIRS)/ZDeflate.c   \
-                $(MODDIRS)/ZInflate.c
+                $(MODDIRS)/ZInflate.c   \
+                $(MODDIRS)/ZipLZ4.c     \
+                $(MODDIRS)/ZipZSTD.c
 
 ZIPNEWH      := $(MODDIRI)/crc32.h      \
                 $(MODDIRI)/deflate.h    \
@@ -95,3 +99,7 @@ distclean-$(MODNAME): clean-$(MODNAME)
 		@rm -f $(ZIPDEP) $(ZIPDS) $(ZIPDH)
 
 distclean::     distclean-$(MODNAME)
+
+##### extra rules ######
+$(call stripsrc,$(MODDIRS)/ZipLZ4.o): CFLAGS += $(LZ4INCDIR:%=-I%)
+$(call stripsrc,$(MODDIRS)/ZipZSTD.o): CFLAGS += $(ZSTDINCDIR:%=-I%)
@@ -15,8 +15,11 @@
 #include "zlib.h"
 #include "RConfigure.h"
 #include "ZipLZMA.h"
+#include "ZipLZ4.h"
+#include "ZipZSTD.h"
 
 #include <stdio.h>
+#include <string.h>
 
 /*
  *  bits.c by Jean-loup Gailly and Kai Uwe Rommel.
@@ -152,9 +155,15 @@ ulg R__bits_sent;   /* bit length of the compressed data */
    R__ZipMode = 2 : LZMA compression algorithm is used
    R__ZipMode = 0 or 3 : a very old compression algorithm is used
    (the very old algorithm is supported for backward compatibility)
+   R__ZipMode = 4 : LZ4 compression algorithm is used
+   R__ZipMode = 5 : Zstandard compression algorithm is used
    The LZMA algorithm requires the external XZ package be installed when linking
    is done. LZMA typically has significantly higher compression factors, but takes
    more CPU time and memory resources while compressing.
+   The LZ4 and Zstandard algorithms are only available if ROOT was configured
+   with the external liblz4 and libzstd (otherwise ZLIB is used instead). Both
+   decompress much faster than ZLIB; LZ4 compresses less than ZLIB, Zstandard
+   usually compresses better.
 */
 int R__ZipMode = 1;
 
@@ -421,6 +430,8 @@ void R__zipMultipleAlgorithm(int cxlevel, int *srcsize, char *src, int *tgtsize,
      /*                      1 = zlib */
      /*                      2 = lzma */
      /*                      3 = old */
+     /*                      4 = lz4 */
+     /*                      5 = zstd */
 {
   int err;
   int method   = Z_DEFLATED;
@@ -440,6 +451,22 @@ void R__zipMultipleAlgorithm(int cxlevel, int *srcsize, char *src, int *tgtsize,
     return;
   }
 
+#ifdef R__HAS_LZ4
+  // The LZ4 compression algorithm
+  if (compressionAlgorithm == 4) {
+    R__zipLZ4(cxlevel, srcsize, src, tgtsize, tgt, irep);
+    return;
+  }
+#endif
+
+#ifdef R__HAS_ZSTD
+  // The Zstandard compression algorithm
+  if (compressionAlgorithm == 5) {
+    R__zipZSTD(cxlevel, srcsize, src, tgtsize, tgt, irep);
+    return;
+  }
+#endif
+
   // The very old algorithm for backward compatibility
   // 0 for selecting with R__ZipMode in a backward compatible way
   // 3 for selecting in other cases
@@ -492,17 +519,23 @@ void R__zipMultipleAlgorithm(int cxlevel, int *srcsize, char *src, int *tgtsize,
     return;
 
   // 1 is for ZLIB (which is the default), ZLIB is also used for any illegal
-  // algorithm setting
+  // algorithm setting and for the algorithms not available in this build
   } else {
 
+    /* This branch does not use any of the global state above so that
+       several threads can compress at the same time (see TTreeFlushPool). */
     z_stream stream;
+    unsigned zin_size, zout_size;
     *irep = 0;
 
-    error_flag   = 0;
-    if (*tgtsize <= 0) R__error("target buffer too small");
-    if (error_flag != 0) return;
-    if (*srcsize > 0xffffff) R__error("source buffer too big");
-    if (error_flag != 0) return;
+    if (*tgtsize <= 0) {
+       if (verbose) fprintf(stderr,"R__zip: target buffer too small\n");
+       return;
+    }
+    if (*srcsize > 0xffffff) {
+       if (verbose) fprintf(stderr,"R__zip: source buffer too big\n");
+       return;
+    }
 
 
     stream.next_in   = (Bytef*)src;
@@ -538,15 +571,15 @@ void R__zipMultipleAlgorithm(int cxlevel, int *srcsize, char *src, int *tgtsize,
     tgt[1] = 'L';
     tgt[2] = (char) method;
 
-    in_size   = (unsigned) (*srcsize);
-    out_size  = stream.total_out;             /* compressed size */
-    tgt[3] = (char)(out_size & 0xff);
-    tgt[4] = (char)((out_size >> 8) & 0xff);
-    tgt[5] = (char)((out_size >> 16) & 0xff);
+    zin_size   = (unsigned) (*srcsize);
+    zout_size  = stream.total_out;            /* compressed size */
+    tgt[3] = (char)(zout_size & 0xff);
+    tgt[4] = (char)((zout_size >> 8) & 0xff);
+    tgt[5] = (char)((zout_size >> 16) & 0xff);
 
-    tgt[6] = (char)(in_size & 0xff);         /* decompressed size */
-    tgt[7] = (char)((in_size >> 8) & 0xff);
-    tgt[8] = (char)((in_size >> 16) & 0xff);
+    tgt[6] = (char)(zin_size & 0xff);        /* decompressed size */
+    tgt[7] = (char)((zin_size >> 8) & 0xff);
+    tgt[8] = (char)((zin_size >> 16) & 0xff);
 
     *irep = stream.total_out + HDRSIZE;
     return;
@@ -558,6 +591,146 @@ void R__zip(int cxlevel, int *srcsize, char *src, int *tgtsize, char *tgt, int *
   R__zipMultipleAlgorithm(cxlevel, srcsize, src, tgtsize, tgt, irep, 0);
 }
 
+/***********************************************************************
+ *                                                                     *
+ * Compression with a dictionary trained on the first buffers of a     *
+ * TBranch (see TBranch::SetCompressionDictionary). Small buffers do   *
+ * not contain enough data for the compression to learn the repeated   *
+ * patterns, the dictionary provides them from the start.              *
+ *                                                                     *
+ * Only zlib (preset dictionary, signature 'D' 'Z') and Zstandard      *
+ * (signature 'D' 'S') use the dictionary, the other algorithms call   *
+ * R__zipMultipleAlgorithm. The buffers must be decompressed with      *
+ * R__unzipDict and the same dictionary.                               *
+ *                                                                     *
+ ***********************************************************************/
+void R__zipDict(int cxlevel, int *srcsize, char *src, int *tgtsize, char *tgt, int *irep,
+                int compressionAlgorithm, const char *dict, int dictsize)
+{
+  z_stream stream;
+  unsigned zin_size, zout_size;
+  int err;
+
+  if (compressionAlgorithm == 0) {
+    compressionAlgorithm = R__ZipMode;
+  }
+  if (cxlevel <= 0 || !dict || dictsize <= 0 ||
+      (compressionAlgorithm != 1 && compressionAlgorithm != 5)) {
+    R__zipMultipleAlgorithm(cxlevel, srcsize, src, tgtsize, tgt, irep, compressionAlgorithm);
+    return;
+  }
+
+#ifdef R__HAS_ZSTD
+  if (compressionAlgorithm == 5) {
+    R__zipZSTDDict(cxlevel, srcsize, src, tgtsize, tgt, irep, dict, dictsize);
+    return;
+  }
+#else
+  if (compressionAlgorithm == 5) {
+    R__zipMultipleAlgorithm(cxlevel, srcsize, src, tgtsize, tgt, irep, compressionAlgorithm);
+    return;
+  }
+#endif
+
+  *irep = 0;
+
+  if (*tgtsize <= 0) {
+    if (verbose) fprintf(stderr,"R__zipDict: target buffer too small\n");
+    return;
+  }
+  if (*srcsize > 0xffffff) {
+    if (verbose) fprintf(stderr,"R__zipDict: source buffer too big\n");
+    return;
+  }
+
+  stream.next_in   = (Bytef*)src;
+  stream.avail_in  = (uInt)(*srcsize);
+
+  stream.next_out  = (Bytef*)(&tgt[HDRSIZE]);
+  stream.avail_out = (uInt)(*tgtsize);
+
+  stream.zalloc    = (alloc_func)0;
+  stream.zfree     = (free_func)0;
+  stream.opaque    = (voidpf)0;
+
+  if (cxlevel > 9) cxlevel = 9;
+  err = deflateInit(&stream, cxlevel);
+  if (err != Z_OK) {
+    printf("error %d in deflateInit (zlib)\n",err);
+    return;
+  }
+
+  /* zlib only uses the last 32KB of the dictionary */
+  if (dictsize > 32768) {
+    dict     += dictsize - 32768;
+    dictsize  = 32768;
+  }
+  err = deflateSetDictionary(&stream, (const Bytef*)dict, (uInt)dictsize);
+  if (err != Z_OK) {
+    deflateEnd(&stream);
+    printf("error %d in deflateSetDictionary (zlib)\n",err);
+    return;
+  }
+
+  err = deflate(&stream, Z_FINISH);
+  if (err != Z_STREAM_END) {
+    deflateEnd(&stream);
+    return;
+  }
+
+  err = deflateEnd(&stream);
+
+  tgt[0] = 'D';               /* Signature ZLib with a dictionary */
+  tgt[1] = 'Z';
+  tgt[2] = (char) Z_DEFLATED;
+
+  zin_size   = (unsigned) (*srcsize);
+  zout_size  = stream.total_out;            /* compressed size */
+  tgt[3] = (char)(zout_size & 0xff);
+  tgt[4] = (char)((zout_size >> 8) & 0xff);
+  tgt[5] = (char)((zout_size >> 16) & 0xff);
+
+  tgt[6] = (char)(zin_size & 0xff);        /* decompressed size */
+  tgt[7] = (char)((zin_size >> 8) & 0xff);
+  tgt[8] = (char)((zin_size >> 16) & 0xff);
+
+  *irep = stream.total_out + HDRSIZE;
+}
+
+int R__zip_traindict(int compressionAlgorithm, int nsamples, const int *sizes, const char *samples,
+                     int capacity, char *dict)
+{
+  /* Build in dict (at most capacity bytes) a dictionary for compressionAlgorithm
+     from the nsamples buffers concatenated in samples.
+     Returns the size of the dictionary, 0 if the algorithm does not use one. */
+
+  int total = 0;
+  int i;
+
+  if (compressionAlgorithm == 0) {
+    compressionAlgorithm = R__ZipMode;
+  }
+  if (compressionAlgorithm != 1 && compressionAlgorithm != 5) return 0;
+  if (nsamples <= 0 || capacity <= 0) return 0;
+
+  for (i = 0; i < nsamples; ++i) total += sizes[i];
+
+#ifdef R__HAS_ZSTD
+  if (compressionAlgorithm == 5) {
+    int dictsize = R__trainZSTDDict(nsamples, sizes, samples, capacity, dict);
+    if (dictsize > 0) return dictsize;
+    /* Too few samples for the trainer, fall back to a raw content dictionary */
+  }
+#endif
+
+  /* A raw content dictionary: the end of the samples. The strings used most
+     often in the compressed data should be at the end (zlib only keeps 32KB). */
+  if (compressionAlgorithm == 1 && capacity > 32768) capacity = 32768;
+  if (capacity > total) capacity = total;
+  memcpy(dict, samples + total - capacity, capacity);
+  return capacity;
+}
+
 void R__error(char *msg)
 {
   if (verbose) fprintf(stderr,"R__zip: %s\n",msg);
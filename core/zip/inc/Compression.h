@@ -25,6 +25,11 @@ namespace ROOT {
    // in greater compression factors, but takes more CPU time
    // and memory when compressing.  LZMA memory usage is particularly
    // high for compression levels 8 and 9.
+   // The LZ4 and ZSTD (Zstandard) algorithms are available when ROOT
+   // is built with the corresponding external libraries (otherwise
+   // ZLIB is used). Both decompress several times faster than ZLIB,
+   // which makes them a good choice for the branches read often.
+   // LZ4 compresses less than ZLIB, ZSTD usually compresses better.
    //
    // The current algorithms support level 1 to 9. The higher
    // the level the greater the compression and more CPU time
@@ -34,6 +39,8 @@ namespace ROOT {
                                 kZLIB,
                                 kLZMA,
                                 kOldCompressionAlgo,
+                                kLZ4,
+                                kZSTD,
                                 // if adding new algorithm types,
                                 // keep this enum value last
                                 kUndefinedCompressionAlgorithm
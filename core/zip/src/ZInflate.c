@@ -20,6 +20,8 @@ static const int qflag = 0;
 #include "zlib.h"
 #include "RConfigure.h"
 #include "ZipLZMA.h"
+#include "ZipLZ4.h"
+#include "ZipZSTD.h"
 
 
 /* inflate.c -- put in the public domain by Mark Adler
@@ -1130,7 +1132,11 @@ int R__unzip_header(int *srcsize, uch *src, int *tgtsize)
   /*   C H E C K   H E A D E R   */
   if (!(src[0] == 'Z' && src[1] == 'L' && src[2] == Z_DEFLATED) &&
       !(src[0] == 'C' && src[1] == 'S' && src[2] == Z_DEFLATED) &&
-      !(src[0] == 'X' && src[1] == 'Z' && src[2] == 0)) {
+      !(src[0] == 'X' && src[1] == 'Z' && src[2] == 0) &&
+      !(src[0] == 'L' && src[1] == '4' && src[2] == 0) &&
+      !(src[0] == 'Z' && src[1] == 'S' && src[2] == 0) &&
+      !(src[0] == 'D' && src[1] == 'Z' && src[2] == Z_DEFLATED) &&
+      !(src[0] == 'D' && src[1] == 'S' && src[2] == 0)) {
     fprintf(stderr, "Error R__unzip_header: error in header\n");
     return 1;
   }
@@ -1141,6 +1147,15 @@ int R__unzip_header(int *srcsize, uch *src, int *tgtsize)
   return 0;
 }
 
+int R__unzip_needdict(uch *src)
+{
+  // Returns 1 if the buffer was compressed with a dictionary (see R__zipDict)
+  // and must be decompressed with R__unzipDict.
+
+  return (src[0] == 'D' && src[1] == 'Z' && src[2] == Z_DEFLATED) ||
+         (src[0] == 'D' && src[1] == 'S' && src[2] == 0);
+}
+
 void R__unzip(int *srcsize, uch *src, int *tgtsize, uch *tgt, int *irep)
 {
   long isize;
@@ -1157,9 +1172,15 @@ void R__unzip(int *srcsize, uch *src, int *tgtsize, uch *tgt, int *irep)
   }
 
   /*   C H E C K   H E A D E R   */
+  if (R__unzip_needdict(src)) {
+    fprintf(stderr,"Error R__unzip: buffer compressed with a dictionary, use R__unzipDict\n");
+    return;
+  }
   if (!(src[0] == 'Z' && src[1] == 'L' && src[2] == Z_DEFLATED) &&
       !(src[0] == 'C' && src[1] == 'S' && src[2] == Z_DEFLATED) &&
-      !(src[0] == 'X' && src[1] == 'Z' && src[2] == 0)) {
+      !(src[0] == 'X' && src[1] == 'Z' && src[2] == 0) &&
+      !(src[0] == 'L' && src[1] == '4' && src[2] == 0) &&
+      !(src[0] == 'Z' && src[1] == 'S' && src[2] == 0)) {
     fprintf(stderr,"Error R__unzip: error in header\n");
     return;
   }
@@ -1217,6 +1238,14 @@ void R__unzip(int *srcsize, uch *src, int *tgtsize, uch *tgt, int *irep)
     R__unzipLZMA(srcsize, src, tgtsize, tgt, irep);
     return;
   }
+  else if (src[0] == 'L' && src[1] == '4') {
+    R__unzipLZ4(srcsize, src, tgtsize, tgt, irep);
+    return;
+  }
+  else if (src[0] == 'Z' && src[1] == 'S') {
+    R__unzipZSTD(srcsize, src, tgtsize, tgt, irep);
+    return;
+  }
 
   /* Old zlib format */
   if (R__Inflate(&ibufptr, &ibufcnt, &obufptr, &obufcnt)) {
@@ -1236,6 +1265,84 @@ void R__unzip(int *srcsize, uch *src, int *tgtsize, uch *tgt, int *irep)
   *irep = isize;
 }
 
+void R__unzipDict(int *srcsize, uch *src, int *tgtsize, uch *tgt, int *irep,
+                  const uch *dict, int dictsize)
+{
+  // Decompress a buffer compressed by R__zipDict with the dictionary dict.
+  // The buffers compressed without a dictionary are passed to R__unzip.
+
+  long isize, ibufcnt;
+
+  *irep = 0L;
+
+  if (*srcsize < HDRSIZE) {
+    fprintf(stderr,"R__unzipDict: too small source\n");
+    return;
+  }
+  if (!R__unzip_needdict(src)) {
+    R__unzip(srcsize, src, tgtsize, tgt, irep);
+    return;
+  }
+  if (!dict || dictsize <= 0) {
+    fprintf(stderr,"Error R__unzipDict: the dictionary of the buffer is missing\n");
+    return;
+  }
+
+  ibufcnt = (long)src[3] | ((long)src[4] << 8) | ((long)src[5] << 16);
+  isize   = (long)src[6] | ((long)src[7] << 8) | ((long)src[8] << 16);
+
+  if (*tgtsize < isize) {
+    fprintf(stderr,"R__unzipDict: too small target\n");
+    return;
+  }
+  if (ibufcnt + HDRSIZE != *srcsize) {
+    fprintf(stderr,"R__unzipDict: discrepancy in source length\n");
+    return;
+  }
+
+  if (src[1] == 'S') {
+    R__unzipZSTDDict(srcsize, src, tgtsize, tgt, irep, dict, dictsize);
+    return;
+  } else {
+    z_stream stream; /* decompression stream */
+    int err = 0;
+
+    stream.next_in   = (Bytef*)(&src[HDRSIZE]);
+    stream.avail_in  = (uInt)(*srcsize);
+    stream.next_out  = (Bytef*)tgt;
+    stream.avail_out = (uInt)(*tgtsize);
+    stream.zalloc    = (alloc_func)0;
+    stream.zfree     = (free_func)0;
+    stream.opaque    = (voidpf)0;
+
+    err = inflateInit(&stream);
+    if (err != Z_OK) {
+      fprintf(stderr,"R__unzipDict: error %d in inflateInit (zlib)\n",err);
+      return;
+    }
+
+    /* Same 32KB as in R__zipDict */
+    if (dictsize > 32768) {
+      dict     += dictsize - 32768;
+      dictsize  = 32768;
+    }
+    err = inflate(&stream, Z_FINISH);
+    if (err == Z_NEED_DICT) {
+      err = inflateSetDictionary(&stream, (const Bytef*)dict, (uInt)dictsize);
+      if (err == Z_OK) err = inflate(&stream, Z_FINISH);
+    }
+    if (err != Z_STREAM_END) {
+      inflateEnd(&stream);
+      fprintf(stderr,"R__unzipDict: error %d in inflate (zlib)\n",err);
+      return;
+    }
+
+    inflateEnd(&stream);
+
+    *irep = stream.total_out;
+  }
+}
+
 #ifndef CHECK_EOF
 static int R__ReadByte (uch** ibufptr, long*  ibufcnt)
 {
@@ -0,0 +1,99 @@
+// @(#)root/zip:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2012, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+/* Compression with the LZ4 algorithm (http://code.google.com/p/lz4/).
+   LZ4 compresses less than zlib, but decompresses several times faster.
+   The levels 1 to 3 use the fast LZ4 compressor, the higher levels the
+   LZ4 HC compressor (slower compression, same decompression speed).
+   The compressed buffers have the usual 9 bytes header of ROOT, with
+   the signature 'L' '4'. */
+
+#include "ZipLZ4.h"
+#include "RConfigure.h"
+#include <stdio.h>
+
+#ifdef R__HAS_LZ4
+#include "lz4.h"
+#include "lz4hc.h"
+#endif
+
+static const int kHeaderSize = 9;
+
+void R__zipLZ4(int cxlevel, int *srcsize, char *src, int *tgtsize, char *tgt, int *irep)
+{
+#ifdef R__HAS_LZ4
+   int out_size;
+   unsigned in_size = (unsigned) (*srcsize);
+
+   *irep = 0;
+
+   if (*tgtsize <= kHeaderSize) {
+      return;
+   }
+
+   if (*srcsize > 0xffffff || *srcsize < 0) {
+      return;
+   }
+
+   if (cxlevel > 9) cxlevel = 9;
+   if (cxlevel < 4) {
+      out_size = LZ4_compress_default(src, &tgt[kHeaderSize], *srcsize, *tgtsize - kHeaderSize);
+   } else {
+      out_size = LZ4_compress_HC(src, &tgt[kHeaderSize], *srcsize, *tgtsize - kHeaderSize, cxlevel);
+   }
+   if (out_size <= 0) {
+      /* No need to print an error message. We simply abandon the compression
+         the buffer cannot be compressed or compressed buffer would be larger than original buffer
+      */
+      return;
+   }
+
+   tgt[0] = 'L';  /* Signature of LZ4 */
+   tgt[1] = '4';
+   tgt[2] = 0;
+
+   tgt[3] = (char)(out_size & 0xff);
+   tgt[4] = (char)((out_size >> 8) & 0xff);
+   tgt[5] = (char)((out_size >> 16) & 0xff);
+
+   tgt[6] = (char)(in_size & 0xff);         /* decompressed size */
+   tgt[7] = (char)((in_size >> 8) & 0xff);
+   tgt[8] = (char)((in_size >> 16) & 0xff);
+
+   *irep = out_size + kHeaderSize;
+#else
+   (void)cxlevel; (void)srcsize; (void)src; (void)tgtsize; (void)tgt;
+   *irep = 0;
+#endif
+}
+
+void R__unzipLZ4(int *srcsize, unsigned char *src, int *tgtsize, unsigned char *tgt, int *irep)
+{
+#ifdef R__HAS_LZ4
+   int out_size;
+
+   *irep = 0;
+
+   out_size = LZ4_decompress_safe((const char *)(&src[kHeaderSize]), (char *)tgt,
+                                  *srcsize - kHeaderSize, *tgtsize);
+   if (out_size < 0) {
+      fprintf(stderr,
+              "R__unzipLZ4: error %d in LZ4_decompress_safe\n",
+              out_size);
+      return;
+   }
+
+   *irep = out_size;
+#else
+   (void)srcsize; (void)src; (void)tgtsize; (void)tgt;
+   *irep = 0;
+   fprintf(stderr, "R__unzipLZ4: ROOT was built without LZ4 support\n");
+#endif
+}
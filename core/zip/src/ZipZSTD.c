@@ -0,0 +1,200 @@
+// @(#)root/zip:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2012, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+/* Compression with the Zstandard algorithm (https://github.com/facebook/zstd).
+   Zstandard reaches compression factors close to LZMA at the high levels,
+   with a decompression speed several times faster than zlib at all levels.
+   The ROOT compression level is used as the Zstandard level.
+   The compressed buffers have the usual 9 bytes header of ROOT, with
+   the signature 'Z' 'S', or 'D' 'S' when they were compressed with a
+   dictionary (see TBranch::SetCompressionDictionary). */
+
+#include "ZipZSTD.h"
+#include "RConfigure.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef R__HAS_ZSTD
+#include "zstd.h"
+#include "zdict.h"
+#endif
+
+static const int kHeaderSize = 9;
+
+void R__zipZSTD(int cxlevel, int *srcsize, char *src, int *tgtsize, char *tgt, int *irep)
+{
+#ifdef R__HAS_ZSTD
+   size_t out_size;
+   unsigned in_size = (unsigned) (*srcsize);
+
+   *irep = 0;
+
+   if (*tgtsize <= kHeaderSize) {
+      return;
+   }
+
+   if (*srcsize > 0xffffff || *srcsize < 0) {
+      return;
+   }
+
+   if (cxlevel > ZSTD_maxCLevel()) cxlevel = ZSTD_maxCLevel();
+   out_size = ZSTD_compress(&tgt[kHeaderSize], (size_t)(*tgtsize - kHeaderSize),
+                            src, (size_t)(*srcsize), cxlevel);
+   if (ZSTD_isError(out_size)) {
+      /* No need to print an error message. We simply abandon the compression
+         the buffer cannot be compressed or compressed buffer would be larger than original buffer
+      */
+      return;
+   }
+
+   tgt[0] = 'Z';  /* Signature of Zstandard */
+   tgt[1] = 'S';
+   tgt[2] = 0;
+
+   tgt[3] = (char)(out_size & 0xff);
+   tgt[4] = (char)((out_size >> 8) & 0xff);
+   tgt[5] = (char)((out_size >> 16) & 0xff);
+
+   tgt[6] = (char)(in_size & 0xff);         /* decompressed size */
+   tgt[7] = (char)((in_size >> 8) & 0xff);
+   tgt[8] = (char)((in_size >> 16) & 0xff);
+
+   *irep = (int)out_size + kHeaderSize;
+#else
+   (void)cxlevel; (void)srcsize; (void)src; (void)tgtsize; (void)tgt;
+   *irep = 0;
+#endif
+}
+
+void R__unzipZSTD(int *srcsize, unsigned char *src, int *tgtsize, unsigned char *tgt, int *irep)
+{
+#ifdef R__HAS_ZSTD
+   size_t out_size;
+
+   *irep = 0;
+
+   out_size = ZSTD_decompress(tgt, (size_t)(*tgtsize),
+                              &src[kHeaderSize], (size_t)(*srcsize - kHeaderSize));
+   if (ZSTD_isError(out_size)) {
+      fprintf(stderr,
+              "R__unzipZSTD: error in ZSTD_decompress: %s\n",
+              ZSTD_getErrorName(out_size));
+      return;
+   }
+
+   *irep = (int)out_size;
+#else
+   (void)srcsize; (void)src; (void)tgtsize; (void)tgt;
+   *irep = 0;
+   fprintf(stderr, "R__unzipZSTD: ROOT was built without Zstandard support\n");
+#endif
+}
+
+void R__zipZSTDDict(int cxlevel, int *srcsize, char *src, int *tgtsize, char *tgt, int *irep,
+                    const char *dict, int dictsize)
+{
+#ifdef R__HAS_ZSTD
+   ZSTD_CCtx *ctx;
+   size_t out_size;
+   unsigned in_size = (unsigned) (*srcsize);
+
+   *irep = 0;
+
+   if (*tgtsize <= kHeaderSize) {
+      return;
+   }
+
+   if (*srcsize > 0xffffff || *srcsize < 0) {
+      return;
+   }
+
+   /* A context per call, so that several threads can compress at the same time */
+   ctx = ZSTD_createCCtx();
+   if (!ctx) return;
+   if (cxlevel > ZSTD_maxCLevel()) cxlevel = ZSTD_maxCLevel();
+   out_size = ZSTD_compress_usingDict(ctx, &tgt[kHeaderSize], (size_t)(*tgtsize - kHeaderSize),
+                                      src, (size_t)(*srcsize), dict, (size_t)dictsize, cxlevel);
+   ZSTD_freeCCtx(ctx);
+   if (ZSTD_isError(out_size)) {
+      return;
+   }
+
+   tgt[0] = 'D';  /* Signature of Zstandard with a dictionary */
+   tgt[1] = 'S';
+   tgt[2] = 0;
+
+   tgt[3] = (char)(out_size & 0xff);
+   tgt[4] = (char)((out_size >> 8) & 0xff);
+   tgt[5] = (char)((out_size >> 16) & 0xff);
+
+   tgt[6] = (char)(in_size & 0xff);         /* decompressed size */
+   tgt[7] = (char)((in_size >> 8) & 0xff);
+   tgt[8] = (char)((in_size >> 16) & 0xff);
+
+   *irep = (int)out_size + kHeaderSize;
+#else
+   (void)dict; (void)dictsize;
+   R__zipZSTD(cxlevel, srcsize, src, tgtsize, tgt, irep);
+#endif
+}
+
+void R__unzipZSTDDict(int *srcsize, unsigned char *src, int *tgtsize, unsigned char *tgt, int *irep,
+                      const unsigned char *dict, int dictsize)
+{
+#ifdef R__HAS_ZSTD
+   ZSTD_DCtx *ctx;
+   size_t out_size;
+
+   *irep = 0;
+
+   ctx = ZSTD_createDCtx();
+   if (!ctx) return;
+   out_size = ZSTD_decompress_usingDict(ctx, tgt, (size_t)(*tgtsize),
+                                        &src[kHeaderSize], (size_t)(*srcsize - kHeaderSize),
+                                        dict, (size_t)dictsize);
+   ZSTD_freeDCtx(ctx);
+   if (ZSTD_isError(out_size)) {
+      fprintf(stderr,
+              "R__unzipZSTDDict: error in ZSTD_decompress_usingDict: %s\n",
+              ZSTD_getErrorName(out_size));
+      return;
+   }
+
+   *irep = (int)out_size;
+#else
+   (void)srcsize; (void)src; (void)tgtsize; (void)tgt; (void)dict; (void)dictsize;
+   *irep = 0;
+   fprintf(stderr, "R__unzipZSTDDict: ROOT was built without Zstandard support\n");
+#endif
+}
+
+int R__trainZSTDDict(int nsamples, const int *sizes, const char *samples, int capacity, char *dict)
+{
+   /* Train a Zstandard dictionary of at most capacity bytes from the nsamples
+      buffers concatenated in samples. Returns the size of the dictionary,
+      0 if the training failed (typically when there are too few samples). */
+#ifdef R__HAS_ZSTD
+   size_t *ssizes;
+   size_t dictsize;
+   int i;
+
+   if (nsamples <= 0 || capacity <= 0) return 0;
+   ssizes = (size_t*)malloc(nsamples * sizeof(size_t));
+   if (!ssizes) return 0;
+   for (i = 0; i < nsamples; ++i) ssizes[i] = (size_t)sizes[i];
+   dictsize = ZDICT_trainFromBuffer(dict, (size_t)capacity, samples, ssizes, (unsigned)nsamples);
+   free(ssizes);
+   if (ZDICT_isError(dictsize)) return 0;
+   return (int)dictsize;
+#else
+   (void)nsamples; (void)sizes; (void)samples; (void)capacity; (void)dict;
+   return 0;
+#endif
+}
@@ -55,7 +55,7 @@ include/%.h:    $(HISTDIRI)/%.h
 $(HISTLIB):     $(HISTO) $(HISTDO) $(ORDER_) $(MAINLIBS) $(HISTLIBDEP)
 		@$(MAKELIB) $(PLATFORM) $(LD) "$(LDFLAGS)" \
 		   "$(SOFLAGS)" libHist.$(SOEXT) $@ "$(HISTO) $(HISTDO)" \
-		   "$(HISTLIBEXTRA)"
+		   "$(HISTLIBEXTRA) $(OSTHREADLIBDIR) $(OSTHREADLIB)"
 
 $(HISTDS):      $(HISTHH) $(HISTL) $(ROOTCINTTMPDEP)
 		$(MAKEDIR)
@@ -80,3 +80,6 @@ distclean::     distclean-$(MODNAME)
 
 # Optimize dictionary with stl containers.
 $(HISTDO): NOOPT = $(OPT)
+
+# the projections of THnSparse are done by several threads
+$(call stripsrc,$(HISTDIRS)/THnSparse.o): CXXFLAGS += $(OSTHREADFLAG)
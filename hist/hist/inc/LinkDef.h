@@ -58,6 +58,8 @@
 #pragma link C++ class TH3F-;
 #pragma link C++ class TH3S-;
 #pragma link C++ class TH3I+;
+#pragma link C++ class THistConcurrentFill;
+#pragma link C++ class THistConcurrentFiller;
 #pragma link C++ class THLimitsFinder+;
 #pragma link C++ class THnBase+;
 #pragma link C++ class THnIter+;
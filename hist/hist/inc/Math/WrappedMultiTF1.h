@@ -124,6 +124,11 @@ private:
       return fFunc->EvalPar(x,p); 
    }
 
+   /// evaluate function at n points, by blocks for the functions defined by an expression
+   void DoEvalParN(unsigned int n, const double * x, double * f, const double * p) const { 
+      fFunc->EvalParN(n,x,f,p); 
+   }
+
    /// evaluate the partial derivative with respect to the parameter
    double DoParameterDerivative(const double * x, const double * p, unsigned int ipar) const; 
 
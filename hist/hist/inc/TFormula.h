@@ -231,6 +231,7 @@ public:
    virtual Double_t    DefinedValue(Int_t code);
    virtual Int_t       DefinedVariable(TString &variable,Int_t &action);
    virtual Double_t    Eval(Double_t x, Double_t y=0, Double_t z=0, Double_t t=0) const;
+   virtual void        EvalParN(Int_t n, const Double_t *x, Double_t *result, const Double_t *params=0);
    virtual Double_t    EvalParOld(const Double_t *x, const Double_t *params=0);
    virtual Double_t    EvalPar(const Double_t *x, const Double_t *params=0){return ((*this).*fOptimal)(x,params);};
    virtual const TObject *GetLinearPart(Int_t i);
@@ -0,0 +1,117 @@
+// @(#)root/hist:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2012, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_THistConcurrentFill
+#define ROOT_THistConcurrentFill
+
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// THistConcurrentFill                                                  //
+//                                                                      //
+// Fill a histogram from several threads without a lock for each entry: //
+// each thread fills its own THistConcurrentFiller, whose buffer is     //
+// flushed into the histogram when full or on demand (FlushAll flushes  //
+// the buffers of all the fillers).                                     //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef ROOT_TObject
+#include "TObject.h"
+#endif
+#ifndef ROOT_TError
+#include "TError.h"
+#endif
+
+#include <vector>
+
+class TH1;
+class TVirtualMutex;
+class THistConcurrentFiller;
+
+class THistConcurrentFill : public TObject {
+
+private:
+   TH1            *fHist;        //Histogram filled (not owned)
+   TVirtualMutex  *fMutex;       //!Protect the histogram while a buffer is flushed
+   Int_t           fNdim;        //Number of values of an entry, without the weight
+   Int_t           fBufferSize;  //Number of entries of the buffer of a filler
+   std::vector<THistConcurrentFiller*> fFillers; //!Fillers of the histogram not yet deleted
+
+   THistConcurrentFill(const THistConcurrentFill&);            // Not implemented
+   THistConcurrentFill &operator=(const THistConcurrentFill&); // Not implemented
+
+   friend class THistConcurrentFiller;
+   void            AddFiller(THistConcurrentFiller *filler);
+   void            RemoveFiller(THistConcurrentFiller *filler);
+
+public:
+   THistConcurrentFill(TH1 *h = 0, Int_t bufsize = 1000);
+   virtual ~THistConcurrentFill();
+
+   void            FillEntries(Int_t n, const Double_t *entries);
+   void            FlushAll();
+   Int_t           GetBufferSize() const { return fBufferSize; }
+   TH1            *GetHist() const { return fHist; }
+   TVirtualMutex  *GetMutex();
+   Int_t           GetNdim() const { return fNdim; }
+   Int_t           GetNFillers() const { return (Int_t)fFillers.size(); }
+
+   ClassDef(THistConcurrentFill,0)  //Fill a histogram from several threads
+};
+
+
+class THistConcurrentFiller {
+
+private:
+   THistConcurrentFill *fManager;  //Histogram and lock shared by the fillers
+   Int_t                fNdim;     //Number of values of an entry, without the weight
+   Int_t                fSize;     //Maximum number of entries in the buffer
+   Int_t                fN;        //Number of entries in the buffer
+   Double_t            *fBuffer;   //[fSize*(fNdim+1)] Entries not yet flushed: weight, then values
+
+   THistConcurrentFiller(const THistConcurrentFiller&);            // Not implemented
+   THistConcurrentFiller &operator=(const THistConcurrentFiller&); // Not implemented
+
+   friend class THistConcurrentFill;
+   void            FillEntry(const Double_t *v, Int_t n);
+
+public:
+   THistConcurrentFiller(THistConcurrentFill &manager);
+   virtual ~THistConcurrentFiller();
+
+   void            Fill(Double_t x) { FillEntry(&x, 1); }
+   void            Fill(Double_t x, Double_t y) { Double_t v[2] = {x, y}; FillEntry(v, 2); }
+   void            Fill(Double_t x, Double_t y, Double_t z) { Double_t v[3] = {x, y, z}; FillEntry(v, 3); }
+   void            Fill(Double_t x, Double_t y, Double_t z, Double_t t) { Double_t v[4] = {x, y, z, t}; FillEntry(v, 4); }
+   void            Fill(Double_t x, Double_t y, Double_t z, Double_t t, Double_t w) { Double_t v[5] = {x, y, z, t, w}; FillEntry(v, 5); }
+   void            Flush();
+   Int_t           GetN() const { return fN; }
+
+   ClassDef(THistConcurrentFiller,0)  //Buffer of the entries of a thread for a THistConcurrentFill
+};
+
+//______________________________________________________________________________
+inline void THistConcurrentFiller::FillEntry(const Double_t *v, Int_t n)
+{
+   // Add to the buffer an entry of n values: the values of the histogram
+   // entry, followed by its weight if n is one more.
+
+   if (n != fNdim && n != fNdim + 1) {
+      ::Error("THistConcurrentFiller::Fill", "an entry needs %d values (%d given)", fNdim, n);
+      return;
+   }
+   Double_t *entry = fBuffer + fN * (fNdim + 1);
+   entry[0] = (n > fNdim) ? v[fNdim] : 1.;
+   for (Int_t i = 0; i < fNdim; ++i) entry[i+1] = v[i];
+   if (++fN == fSize) Flush();
+}
+
+#endif
@@ -113,6 +113,8 @@ private:
                    const TObjArray* axes, Bool_t keepTargetAxis) const;
    TObject* ProjectionAny(Int_t ndim, const Int_t* dim,
                           Bool_t wantNDim, Option_t* option = "") const;
+   virtual Bool_t ProjectBins(THnBase* hn, TH1* hist, Int_t ndim, const Int_t* dim,
+                              Bool_t keepTargetAxis, Bool_t wantErrors) const;
    Bool_t PrintBin(Long64_t idx, Int_t* coord, Option_t* options) const;
    void AddInternal(const THnBase* h, Double_t c, Bool_t rebinned);
    THnBase* RebinBase(Int_t group) const;
@@ -160,6 +162,7 @@ private:
       FillBin(bin, w);
       return bin;
    }
+   virtual void FillN(Int_t nentries, const Double_t* x, const Double_t* w = 0);
    void SetBinEdges(Int_t idim, const Double_t* bins);
    Bool_t IsInRange(Int_t *coord) const;
    Double_t GetBinError(const Int_t *idx) const { return GetBinError(GetBin(idx)); }
@@ -23,9 +23,6 @@
 #ifndef ROOT_THnBase
 #include "THnBase.h"
 #endif
-#ifndef ROOT_TExMap
-#include "TExMap.h"
-#endif
 #ifndef ROOT_THnSparse_Internal
 #include "THnSparse_Internal.h"
 #endif
@@ -48,16 +45,18 @@
 #endif
 
 class THnSparseCompactBinCoord;
+class THnSparseBinHash;
 
 class THnSparse: public THnBase {
  private:
    Int_t      fChunkSize;    // number of entries for each chunk
    Long64_t   fFilledBins;   // number of filled bins
    TObjArray  fBinContent;   // array of THnSparseArrayChunk
-   TExMap     fBins;         //! filled bins
-   TExMap     fBinsContinued;//! filled bins for non-unique hashes, containing pairs of (bin index 0, bin index 1)
+   THnSparseBinHash *fBinHash;  //! filled bins: hash of the compact coordinates to bin index
    THnSparseCompactBinCoord *fCompactCoord; //! compact coordinate
 
+   static Int_t fgProjectionThreads; // number of threads used by Projection()
+
    THnSparse(const THnSparse&); // Not implemented
    THnSparse& operator=(const THnSparse&); // Not implemented
 
@@ -73,7 +72,7 @@ class THnSparse: public THnBase {
 
    THnSparseArrayChunk* AddChunk();
    void Reserve(Long64_t nbins);
-   void FillExMap();
+   void FillBinHash();
    virtual TArray* GenerateArray() const = 0;
    Long64_t GetBinIndexForCurrentBin(Bool_t allocate);
    void FillBin(Long64_t bin, Double_t w) {
@@ -84,6 +83,8 @@ class THnSparse: public THnBase {
       FillBinBase(w);
    }
    void InitStorage(Int_t* nbins, Int_t chunkSize);
+   Bool_t ProjectBins(THnBase* hn, TH1* hist, Int_t ndim, const Int_t* dim,
+                      Bool_t keepTargetAxis, Bool_t wantErrors) const;
 
  public:
    virtual ~THnSparse();
@@ -99,6 +100,8 @@ class THnSparse: public THnBase {
                                        chunkSize);
    }
 
+   void FillN(Int_t nentries, const Double_t* x, const Double_t* w = 0);
+
    Int_t GetChunkSize() const { return fChunkSize; }
    Int_t GetNChunks() const { return fBinContent.GetEntriesFast(); }
 
@@ -178,6 +181,9 @@ class THnSparse: public THnBase {
    void Reset(Option_t* option = "");
    void Sumw2();
 
+   static Int_t GetProjectionThreads() { return fgProjectionThreads; }
+   static void  SetProjectionThreads(Int_t nthreads = 0);
+
    ClassDef(THnSparse, 3); // Interfaces of sparse n-dimensional histogram
 };
 
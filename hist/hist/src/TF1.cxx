@@ -13,6 +13,8 @@
 #include "TROOT.h"
 #include "TMath.h"
 #include "TF1.h"
+#include "TF2.h"
+#include "TF3.h"
 #include "TH1.h"
 #include "TGraph.h"
 #include "TVirtualPad.h"
@@ -44,6 +46,7 @@
 #include "Math/ChebyshevPol.h"
 #include "Fit/FitResult.h"
 
+#include <typeinfo>
 //#include <iostream>
 
 Bool_t TF1::fgAbsValue    = kFALSE;
@@ -1333,6 +1336,36 @@ Double_t TF1::EvalPar(const Double_t *x, const Double_t *params)
 }
 
 
+//______________________________________________________________________________
+void TF1::EvalParN(Int_t n, const Double_t *x, Double_t *result, const Double_t *params)
+{
+   // Evaluate function at n points and store the values in result.
+   //
+   // The coordinates of each point (GetNdim() values) are stored one after
+   // the other in x. If argument params is omitted or equal 0, the internal
+   // values of parameters (array fParams) will be used instead.
+   // The functions defined by an expression are evaluated by blocks of
+   // points (see TFormula::EvalParN), the other ones point by point. So
+   // are the classes deriving from TF1, TF2 or TF3, which may override
+   // EvalPar (typeid also catches the classes without ClassDef).
+
+   fgCurrent = this;
+
+   const std::type_info &type = typeid(*this);
+   if (fType == 0 && (type == typeid(TF1) || type == typeid(TF2) || type == typeid(TF3))) {
+      TFormula::EvalParN(n,x,result,params);
+      return;
+   }
+   Int_t ndim = GetNdim() > 0 ? GetNdim() : 1;
+   const Double_t *p = params ? params : fParams;
+   for (Int_t i = 0; i < n; i++) {
+      const Double_t *xx = x + i*ndim;
+      if (fMethodCall) InitArgs(xx,p);
+      result[i] = EvalPar(xx,params);
+   }
+}
+
+
 //______________________________________________________________________________
 void TF1::ExecuteEvent(Int_t event, Int_t px, Int_t py)
 {
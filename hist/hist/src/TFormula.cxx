@@ -10,6 +10,7 @@
  *************************************************************************/
 
 #include <math.h>
+#include <vector>
 
 #include "Riostream.h"
 #include "TROOT.h"
@@ -2633,6 +2634,223 @@ Double_t TFormula::Eval(Double_t x, Double_t y, Double_t z, Double_t t) const
    return ((TFormula*)this)->EvalPar(xx);
 }
 
+//______________________________________________________________________________
+void TFormula::EvalParN(Int_t n, const Double_t *x, Double_t *result, const Double_t *uparams)
+{
+   // Evaluate this formula at n points and store the values in result.
+   // The coordinates of each point (GetNdim() values) are stored one after
+   // the other in x. The parameters used will be the ones in the array
+   // params if given, otherwise the ones stored in fParams.
+   //
+   // Each operation of the formula is applied to a block of points at once,
+   // so that it is decoded once per block instead of once per point and the
+   // loops over the points can be vectorized by the compiler. This is done
+   // as well for the predefined gaus, expo, landau and pol functions.
+   // The formulas using strings, conditional jumps, function calls or
+   // variables defined by a derived class are evaluated point by point
+   // with EvalPar.
+
+   if (n <= 0) return;
+
+   const Int_t ndim = fNdim > 0 ? fNdim : 1;
+   const Double_t *params = uparams ? uparams : fParams;
+
+   // Check that all the operations can be applied to blocks and compute
+   // the depth of the stack.
+   Bool_t vectorize = (fNoper > 0);
+   Int_t pos = 0, depth = 0;
+   for (Int_t i = 0; vectorize && i < fNoper; ++i) {
+      const Int_t opcode = fOper[i] >> kTFOperShift;
+      const Int_t param  = fOper[i] & kTFOperMask;
+      switch (opcode) {
+         case kEnd:  i = fNoper; continue;
+         case kBoolOptimize: continue;
+         case kVariable:
+            if (param >= ndim) vectorize = kFALSE;
+            pos++; break;
+         case kyexpo: case kygaus: case kylandau: case kypol:
+         case kxyexpo: case kxygaus: case kxylandau:
+            if (ndim < 2) vectorize = kFALSE;
+            pos++; break;
+         case kzexpo: case kzgaus: case kzlandau: case kzpol:
+            if (ndim < 3) vectorize = kFALSE;
+            pos++; break;
+         case kParameter: case kConstant: case kpi:
+         case kxexpo: case kxgaus: case kxlandau: case kxpol:
+            pos++; break;
+         case kAdd: case kSubstract: case kMultiply: case kDivide: case kModulo:
+         case katan2: case kfmod: case kpow: case kmin: case kmax:
+         case kAnd: case kOr: case kEqual: case kNotEqual:
+         case kLess: case kGreater: case kLessThan: case kGreaterThan:
+         case kBitAnd: case kBitOr: case kLeftShift: case kRightShift:
+            if (pos < 2) vectorize = kFALSE;
+            pos--; break;
+         case kcos: case ksin: case ktan: case kacos: case kasin: case katan:
+         case kcosh: case ksinh: case ktanh: case kacosh: case kasinh: case katanh:
+         case ksq: case ksqrt: case klog: case kexp: case klog10:
+         case kabs: case ksign: case kint: case kSignInv: case kNot:
+            if (pos < 1) vectorize = kFALSE;
+            break;
+         default:
+            vectorize = kFALSE;
+      }
+      if (pos > depth) depth = pos;
+   }
+   if (!vectorize || depth == 0) {
+      for (Int_t i = 0; i < n; ++i) result[i] = EvalPar(x + i*ndim, params);
+      return;
+   }
+
+   const Int_t kBlock = 256;
+   std::vector<Double_t> stack(depth*kBlock);
+   Double_t *tab = &stack[0];
+   const Bool_t norm = IsNormalized();
+
+#define R__PUSH(expr)                                                \
+   { Double_t *t = tab + (pos++)*kBlock;                             \
+     for (Int_t k = 0; k < nb; ++k) { t[k] = (expr); }               \
+     continue; }
+#define R__UNARY(expr)                                               \
+   { Double_t *t = tab + (pos-1)*kBlock;                             \
+     for (Int_t k = 0; k < nb; ++k) { const Double_t a = t[k]; t[k] = (expr); } \
+     continue; }
+#define R__BINARY(expr)                                              \
+   { pos--; Double_t *t = tab + (pos-1)*kBlock; const Double_t *u = tab + pos*kBlock; \
+     for (Int_t k = 0; k < nb; ++k) { const Double_t a = t[k], b = u[k]; t[k] = (expr); } \
+     continue; }
+#define R__X(var) xb[k*ndim+(var)]
+
+   for (Int_t first = 0; first < n; first += kBlock) {
+      const Int_t nb = (n - first < kBlock) ? n - first : kBlock;
+      const Double_t *xb = x + first*ndim;
+      pos = 0;
+      for (Int_t i = 0; i < fNoper; ++i) {
+         const Int_t oper   = fOper[i];
+         const Int_t opcode = oper >> kTFOperShift;
+         const Int_t param  = oper & kTFOperMask;
+         switch (opcode) {
+            case kEnd         : i = fNoper; continue;
+            case kBoolOptimize: continue; // both sides are always computed
+            case kParameter   : { const Double_t v = params[param]; R__PUSH(v); }
+            case kConstant    : { const Double_t v = fConst[param]; R__PUSH(v); }
+            case kVariable    : R__PUSH(R__X(param));
+            case kpi          : { const Double_t v = TMath::ACos(-1); R__PUSH(v); }
+
+            case kAdd        : R__BINARY(a + b);
+            case kSubstract  : R__BINARY(a - b);
+            case kMultiply   : R__BINARY(a * b);
+            case kDivide     : R__BINARY(b == 0 ? 0 : a / b);
+            case kModulo     : R__BINARY(Double_t(Long64_t(a) % Long64_t(b)));
+            case katan2      : R__BINARY(TMath::ATan2(a,b));
+            case kfmod       : R__BINARY(fmod(a,b));
+            case kpow        : R__BINARY(TMath::Power(a,b));
+            case kmin        : R__BINARY(TMath::Min(a,b));
+            case kmax        : R__BINARY(TMath::Max(a,b));
+            case kAnd        : R__BINARY((a != 0 && b != 0) ? 1 : 0);
+            case kOr         : R__BINARY((a != 0 || b != 0) ? 1 : 0);
+            case kEqual      : R__BINARY(a == b ? 1 : 0);
+            case kNotEqual   : R__BINARY(a != b ? 1 : 0);
+            case kLess       : R__BINARY(a <  b ? 1 : 0);
+            case kGreater    : R__BINARY(a >  b ? 1 : 0);
+            case kLessThan   : R__BINARY(a <= b ? 1 : 0);
+            case kGreaterThan: R__BINARY(a >= b ? 1 : 0);
+            case kBitAnd     : R__BINARY(((Int_t) a) & ((Int_t) b));
+            case kBitOr      : R__BINARY(((Int_t) a) | ((Int_t) b));
+            case kLeftShift  : R__BINARY(((Int_t) a) << ((Int_t) b));
+            case kRightShift : R__BINARY(((Int_t) a) >> ((Int_t) b));
+
+            case kcos    : R__UNARY(TMath::Cos(a));
+            case ksin    : R__UNARY(TMath::Sin(a));
+            case ktan    : R__UNARY(TMath::Cos(a) == 0 ? 0 : TMath::Tan(a));
+            case kacos   : R__UNARY(TMath::Abs(a) > 1 ? 0 : TMath::ACos(a));
+            case kasin   : R__UNARY(TMath::Abs(a) > 1 ? 0 : TMath::ASin(a));
+            case katan   : R__UNARY(TMath::ATan(a));
+            case kcosh   : R__UNARY(TMath::CosH(a));
+            case ksinh   : R__UNARY(TMath::SinH(a));
+            case ktanh   : R__UNARY(TMath::CosH(a) == 0 ? 0 : TMath::TanH(a));
+            case kacosh  : R__UNARY(a < 1 ? 0 : TMath::ACosH(a));
+            case kasinh  : R__UNARY(TMath::ASinH(a));
+            case katanh  : R__UNARY(TMath::Abs(a) > 1 ? 0 : TMath::ATanH(a));
+            case ksq     : R__UNARY(a*a);
+            case ksqrt   : R__UNARY(TMath::Sqrt(TMath::Abs(a)));
+            case klog    : R__UNARY(a > 0 ? TMath::Log(a) : 0);
+            case kexp    : R__UNARY(a < -700 ? 0 : TMath::Exp(a > 700 ? 700 : a));
+            case klog10  : R__UNARY(a > 0 ? TMath::Log10(a) : 0);
+            case kabs    : R__UNARY(TMath::Abs(a));
+            case ksign   : R__UNARY(a < 0 ? -1 : 1);
+            case kint    : R__UNARY(Double_t(Int_t(a)));
+            case kSignInv: R__UNARY(-1 * a);
+            case kNot    : R__UNARY(a != 0 ? 0 : 1);
+
+            case kxexpo: case kyexpo: case kzexpo: {
+               const Int_t var = opcode - kxexpo;
+               const Double_t p0 = params[param], p1 = params[param+1];
+               R__PUSH(TMath::Exp(p0+p1*R__X(var)));
+            }
+            case kxyexpo: {
+               const Double_t p0 = params[param], p1 = params[param+1], p2 = params[param+2];
+               R__PUSH(TMath::Exp(p0+p1*R__X(0)+p2*R__X(1)));
+            }
+            case kxgaus: case kygaus: case kzgaus: {
+               // Same as params[param]*TMath::Gaus(x,mean,sigma,norm), inlined.
+               const Int_t var = opcode - kxgaus;
+               const Double_t c = params[param], mean = params[param+1], sigma = params[param+2];
+               if (sigma == 0) R__PUSH(c*1.e30);
+               const Double_t d = 2.50662827463100024*sigma;
+               if (norm) R__PUSH(c*(TMath::Exp(-0.5*((R__X(var)-mean)/sigma)*((R__X(var)-mean)/sigma))/d));
+               R__PUSH(c*TMath::Exp(-0.5*((R__X(var)-mean)/sigma)*((R__X(var)-mean)/sigma)));
+            }
+            case kxygaus: {
+               const Double_t c = params[param];
+               const Double_t m1 = params[param+1], s1 = params[param+2];
+               const Double_t m2 = params[param+3], s2 = params[param+4];
+               Double_t *t = tab + (pos++)*kBlock;
+               for (Int_t k = 0; k < nb; ++k) {
+                  const Double_t i1 = (s1 == 0) ? 1e10 : Double_t((R__X(0)-m1)/s1);
+                  const Double_t i2 = (s2 == 0) ? 1e10 : Double_t((R__X(1)-m2)/s2);
+                  t[k] = c*TMath::Exp(-0.5*(i1*i1+i2*i2));
+               }
+               continue;
+            }
+            case kxlandau: case kylandau: case kzlandau: {
+               const Int_t var = opcode - kxlandau;
+               const Double_t c = params[param], mu = params[param+1], sigma = params[param+2];
+               R__PUSH(c*TMath::Landau(R__X(var),mu,sigma,norm));
+            }
+            case kxylandau: {
+               const Double_t c = params[param];
+               const Double_t m1 = params[param+1], s1 = params[param+2];
+               const Double_t m2 = params[param+3], s2 = params[param+4];
+               R__PUSH(c*TMath::Landau(R__X(0),m1,s1,norm)*TMath::Landau(R__X(1),m2,s2,norm));
+            }
+            case kxpol: case kypol: case kzpol: {
+               // Same summation order as in EvalParOld, vectorized over the points.
+               const Int_t var   = opcode - kxpol;
+               const Int_t inter = param/100;
+               const Double_t *p = params + param - inter*100 - 1;
+               Double_t *t = tab + (pos++)*kBlock;
+               Double_t power[kBlock];
+               for (Int_t k = 0; k < nb; ++k) { t[k] = 0; power[k] = 1; }
+               for (Int_t j = 0; j < inter+1; ++j) {
+                  const Double_t pj = p[j];
+                  for (Int_t k = 0; k < nb; ++k) {
+                     t[k] += power[k]*pj;
+                     power[k] *= R__X(var);
+                  }
+               }
+               continue;
+            }
+         }
+      }
+      for (Int_t k = 0; k < nb; ++k) result[first+k] = tab[k];
+   }
+
+#undef R__PUSH
+#undef R__UNARY
+#undef R__BINARY
+#undef R__X
+}
+
 //______________________________________________________________________________
 Double_t TFormula::EvalParOld(const Double_t *x, const Double_t *uparams)
 {
@@ -3070,6 +3070,11 @@ void TH1::FillN(Int_t ntimes, const Double_t *x, const Double_t *w, Int_t stride
 //    by w^2 in the bin corresponding to x. 
 //    if w is NULL each entry is assumed a weight=1
 //
+//    The bins are found by blocks of entries with TAxis::FindFixBins and the
+//    statistics are accumulated in the same pass, unless the axis can be
+//    extended (see TAxis::FindBin), in which case the entries are filled
+//    one at a time.
+//
 //   -*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
 
    Int_t bin,i;
@@ -3082,26 +3087,63 @@ void TH1::FillN(Int_t ntimes, const Double_t *x, const Double_t *w, Int_t stride
    //   return;
    //}
 
+   if (ntimes <= 0) return;
    fEntries += ntimes;
-   Double_t ww = 1;
    Int_t nbins   = fXaxis.GetNbins();
-   ntimes *= stride;
-   for (i=0;i<ntimes;i+=stride) {
-      bin =fXaxis.FindBin(x[i]);
-      if (bin <0) continue;
-      if (w) ww = w[i];
-      if (!fSumw2.fN && ww != 1.0)  Sumw2(); 
-      if (fSumw2.fN) fSumw2.fArray[bin] += ww*ww;
-      AddBinContent(bin, ww);
-      if (bin == 0 || bin > nbins) {
-         if (!fgStatOverflows) continue;
+   // a weight not equal to 1 needs the sum of squares of weights
+   if (!fSumw2.fN && w) {
+      for (i=0;i<ntimes;i++) {
+         if (w[i*stride] != 1.0) { Sumw2(); break; }
+      }
+   }
+   Double_t ww = 1;
+   if (fXaxis.CanExtend()) {
+      ntimes *= stride;
+      for (i=0;i<ntimes;i+=stride) {
+         bin =fXaxis.FindBin(x[i]);
+         if (bin <0) continue;
+         if (w) ww = w[i];
+         if (fSumw2.fN) fSumw2.fArray[bin] += ww*ww;
+         AddBinContent(bin, ww);
+         if (bin == 0 || bin > nbins) {
+            if (!fgStatOverflows) continue;
+         }
+         Double_t z= ww;
+         fTsumw   += z;
+         fTsumw2  += z*z;
+         fTsumwx  += z*x[i];
+         fTsumwx2 += z*x[i]*x[i];
+      }
+      return;
+   }
+
+   const Int_t kBlock = 512;
+   Int_t bins[kBlock];
+   Double_t tsumw = 0, tsumw2 = 0, tsumwx = 0, tsumwx2 = 0;
+   for (Int_t first=0;first<ntimes;first+=kBlock) {
+      Int_t n = TMath::Min(kBlock, ntimes-first);
+      const Double_t *xb = x + first*stride;
+      const Double_t *wb = w ? w + first*stride : 0;
+      fXaxis.FindFixBins(n, xb, bins, stride);
+      for (i=0;i<n;i++) {
+         bin = bins[i];
+         if (wb) ww = wb[i*stride];
+         if (fSumw2.fN) fSumw2.fArray[bin] += ww*ww;
+         AddBinContent(bin, ww);
+         if (bin == 0 || bin > nbins) {
+            if (!fgStatOverflows) continue;
+         }
+         Double_t xi = xb[i*stride];
+         tsumw   += ww;
+         tsumw2  += ww*ww;
+         tsumwx  += ww*xi;
+         tsumwx2 += ww*xi*xi;
       }
-      Double_t z= ww;
-      fTsumw   += z;
-      fTsumw2  += z*z;
-      fTsumwx  += z*x[i];
-      fTsumwx2 += z*x[i]*x[i];
    }
+   fTsumw   += tsumw;
+   fTsumw2  += tsumw2;
+   fTsumwx  += tsumwx;
+   fTsumwx2 += tsumwx2;
 }
 
 //______________________________________________________________________________
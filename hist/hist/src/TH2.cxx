@@ -497,10 +497,65 @@ void TH2::FillN(Int_t ntimes, const Double_t *x, const Double_t *y, const Double
    //*-*
    //*-* NB: function only valid for a TH2x object
    //*-*
+   //*-*  The bins are found by blocks of entries with TAxis::FindFixBins and the
+   //*-*  statistics are accumulated in the same pass, unless an axis can be
+   //*-*  extended (see TAxis::FindBin).
+   //*-*
    //*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
    Int_t binx, biny, bin, i;
+   if (ntimes <= 0) return;
    fEntries += ntimes;
    Double_t ww = 1;
+   if (!fXaxis.CanExtend() && !fYaxis.CanExtend()) {
+      // a weight not equal to 1 needs the sum of squares of weights
+      if (!fSumw2.fN && w) {
+         for (i=0;i<ntimes;i++) {
+            if (w[i*stride] != 1.0) { Sumw2(); break; }
+         }
+      }
+      const Int_t nbinsx = fXaxis.GetNbins();
+      const Int_t nbinsy = fYaxis.GetNbins();
+      const Int_t kBlock = 512;
+      Int_t binsx[kBlock], binsy[kBlock];
+      Double_t tsumw = 0, tsumw2 = 0, tsumwx = 0, tsumwx2 = 0;
+      Double_t tsumwy = 0, tsumwy2 = 0, tsumwxy = 0;
+      for (Int_t first=0;first<ntimes;first+=kBlock) {
+         Int_t n = TMath::Min(kBlock, ntimes-first);
+         const Double_t *xb = x + first*stride;
+         const Double_t *yb = y + first*stride;
+         const Double_t *wb = w ? w + first*stride : 0;
+         fXaxis.FindFixBins(n, xb, binsx, stride);
+         fYaxis.FindFixBins(n, yb, binsy, stride);
+         for (i=0;i<n;i++) {
+            binx = binsx[i];
+            biny = binsy[i];
+            bin  = biny*(nbinsx+2) + binx;
+            if (wb) ww = wb[i*stride];
+            if (fSumw2.fN) fSumw2.fArray[bin] += ww*ww;
+            AddBinContent(bin,ww);
+            if (binx == 0 || binx > nbinsx || biny == 0 || biny > nbinsy) {
+               if (!fgStatOverflows) continue;
+            }
+            Double_t xi = xb[i*stride];
+            Double_t yi = yb[i*stride];
+            tsumw   += ww;
+            tsumw2  += ww*ww;
+            tsumwx  += ww*xi;
+            tsumwx2 += ww*xi*xi;
+            tsumwy  += ww*yi;
+            tsumwy2 += ww*yi*yi;
+            tsumwxy += ww*xi*yi;
+         }
+      }
+      fTsumw   += tsumw;
+      fTsumw2  += tsumw2;
+      fTsumwx  += tsumwx;
+      fTsumwx2 += tsumwx2;
+      fTsumwy  += tsumwy;
+      fTsumwy2 += tsumwy2;
+      fTsumwxy += tsumwxy;
+      return;
+   }
    ntimes *= stride;
    for (i=0;i<ntimes;i+=stride) {
       binx = fXaxis.FindBin(x[i]);
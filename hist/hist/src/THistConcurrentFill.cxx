@@ -0,0 +1,233 @@
+// @(#)root/hist:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2012, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// THistConcurrentFill                                                  //
+//                                                                      //
+// TH1::Fill is not thread-safe: the bin contents and the statistics    //
+// are updated without any lock. THistConcurrentFill fills a histogram  //
+// (TH1, TH2, TH3 and the profiles) from several threads without        //
+// locking it for each entry, nor keeping a copy of the histogram per   //
+// thread.                                                              //
+//                                                                      //
+// Each thread creates its own THistConcurrentFiller, and fills it as   //
+// the histogram itself. The entries are stored in the buffer of the    //
+// filler, and the buffer is flushed into the histogram, under a lock   //
+// of the THistConcurrentFill, when it is full, when Flush is called    //
+// and when the filler is deleted:                                      //
+//                                                                      //
+//    TH1D *h = new TH1D("h","energy",100,0,100);                       //
+//    THistConcurrentFill fill(h);                                      //
+//    // in each thread:                                                //
+//    THistConcurrentFiller filler(fill);                               //
+//    for (...) filler.Fill(e, w);                                      //
+//    filler.Flush(); // or delete the filler                           //
+//                                                                      //
+// The arguments of THistConcurrentFiller::Fill are the ones of the     //
+// Fill function of the histogram with the values of the entry and an   //
+// optional weight: Fill(x,w) for a TH1, Fill(x,y,w) for a TH2 or a     //
+// TProfile, Fill(x,y,z,t,w) for a TProfile3D.                          //
+//                                                                      //
+// The histogram holds all the entries once all the fillers have been   //
+// flushed. When the threads keep their fillers for more entries (e.g.  //
+// between two event loops), FlushAll flushes the buffers of all the    //
+// fillers; it must be called while no thread is filling them. To read  //
+// the histogram while the threads are filling it (e.g. for             //
+// monitoring), take the lock returned by GetMutex:                     //
+//    R__LOCKGUARD(fill.GetMutex());                                    //
+// The entries still in the buffers are then not in the histogram.      //
+//                                                                      //
+// The lock is created by the constructor, which initializes the        //
+// thread support of ROOT (TThread::Initialize) if needed: the          //
+// THistConcurrentFill must be created before the threads are started.  //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#include "THistConcurrentFill.h"
+#include "TH1.h"
+#include "TH2.h"
+#include "TH3.h"
+#include "TProfile.h"
+#include "TProfile2D.h"
+#include "TProfile3D.h"
+#include "TROOT.h"
+#include "TVirtualMutex.h"
+
+#include <algorithm>
+
+ClassImp(THistConcurrentFill)
+ClassImp(THistConcurrentFiller)
+
+//______________________________________________________________________________
+THistConcurrentFill::THistConcurrentFill(TH1 *h, Int_t bufsize) :
+   fHist(h), fMutex(0), fNdim(0), fBufferSize(bufsize > 0 ? bufsize : 1000)
+{
+   // Fill the histogram h (not owned) with fillers buffering bufsize
+   // entries.
+
+   if (!h) return;
+   fNdim = h->GetDimension();
+   // A profile has the averaged value in addition to the coordinates.
+   if (h->InheritsFrom(TProfile::Class()) || h->InheritsFrom(TProfile2D::Class()) ||
+       h->InheritsFrom(TProfile3D::Class())) {
+      ++fNdim;
+   }
+   // The flushes must always be protected: initialize the thread support
+   // (libThread is loaded on demand) if it was not done yet.
+   if (!gGlobalMutex) gROOT->ProcessLine("TThread::Initialize();");
+   if (!GetMutex()) {
+      Error("THistConcurrentFill", "the thread support cannot be initialized, the flushes of the fillers are not protected");
+   }
+}
+
+//______________________________________________________________________________
+THistConcurrentFill::~THistConcurrentFill()
+{
+   // Destructor. The fillers should have been deleted before: the ones
+   // left are flushed and detached.
+
+   if (!fFillers.empty()) {
+      FlushAll();
+      for (UInt_t i = 0; i < fFillers.size(); ++i) fFillers[i]->fManager = 0;
+   }
+   delete fMutex;
+}
+
+//______________________________________________________________________________
+void THistConcurrentFill::AddFiller(THistConcurrentFiller *filler)
+{
+   // Register a new filler, flushed by FlushAll.
+
+   R__LOCKGUARD(GetMutex());
+   fFillers.push_back(filler);
+}
+
+//______________________________________________________________________________
+void THistConcurrentFill::RemoveFiller(THistConcurrentFiller *filler)
+{
+   // Unregister a filler being deleted.
+
+   R__LOCKGUARD(GetMutex());
+   std::vector<THistConcurrentFiller*>::iterator i = std::find(fFillers.begin(), fFillers.end(), filler);
+   if (i != fFillers.end()) fFillers.erase(i);
+}
+
+//______________________________________________________________________________
+void THistConcurrentFill::FillEntries(Int_t n, const Double_t *entries)
+{
+   // Fill the histogram with the n entries stored in entries, each made of
+   // the weight followed by the GetNdim() values. Can be called by several
+   // threads at the same time.
+
+   if (!fHist || n <= 0) return;
+
+   R__LOCKGUARD(GetMutex());
+
+   const Int_t stride = fNdim + 1;
+   const Double_t *w = entries;
+   const Double_t *x = entries + 1;
+   // FillN does not use the buffer of the histogram (see TH1::SetBuffer).
+   Bool_t fillN = fHist->GetBuffer() == 0;
+   switch (fNdim) {
+      case 1:
+         if (fillN) {
+            fHist->FillN(n, x, w, stride);
+         } else {
+            for (Int_t i = 0; i < n; ++i) fHist->Fill(x[i*stride], w[i*stride]);
+         }
+         break;
+      case 2:
+         if (fillN) {
+            fHist->FillN(n, x, x + 1, w, stride);
+         } else if (fHist->InheritsFrom(TProfile::Class())) {
+            TProfile *p = (TProfile*)fHist;
+            for (Int_t i = 0; i < n; ++i) p->Fill(x[i*stride], x[i*stride+1], w[i*stride]);
+         } else {
+            TH2 *h2 = (TH2*)fHist;
+            for (Int_t i = 0; i < n; ++i) h2->Fill(x[i*stride], x[i*stride+1], w[i*stride]);
+         }
+         break;
+      case 3:
+         if (fHist->InheritsFrom(TProfile2D::Class())) {
+            TProfile2D *p = (TProfile2D*)fHist;
+            for (Int_t i = 0; i < n; ++i) p->Fill(x[i*stride], x[i*stride+1], x[i*stride+2], w[i*stride]);
+         } else {
+            TH3 *h3 = (TH3*)fHist;
+            for (Int_t i = 0; i < n; ++i) h3->Fill(x[i*stride], x[i*stride+1], x[i*stride+2], w[i*stride]);
+         }
+         break;
+      case 4:
+         {
+            TProfile3D *p = (TProfile3D*)fHist;
+            for (Int_t i = 0; i < n; ++i) p->Fill(x[i*stride], x[i*stride+1], x[i*stride+2], x[i*stride+3], w[i*stride]);
+         }
+         break;
+      default:
+         break;
+   }
+}
+
+//______________________________________________________________________________
+void THistConcurrentFill::FlushAll()
+{
+   // Flush the buffers of all the fillers into the histogram, for example
+   // before reading it while the threads keep their fillers. A filler is
+   // not locked while its thread fills it: FlushAll must be called when no
+   // thread is filling (e.g. at the end of an event loop).
+
+   R__LOCKGUARD(GetMutex());
+   for (UInt_t i = 0; i < fFillers.size(); ++i) fFillers[i]->Flush();
+}
+
+//______________________________________________________________________________
+TVirtualMutex *THistConcurrentFill::GetMutex()
+{
+   // Return the lock held while a buffer is flushed into the histogram.
+   // It is null only if the thread support could not be initialized.
+
+   if (gGlobalMutex && !fMutex) {
+      R__LOCKGUARD(gGlobalMutex);
+      if (!fMutex) fMutex = gGlobalMutex->Factory(kTRUE);
+   }
+   return fMutex;
+}
+
+//______________________________________________________________________________
+THistConcurrentFiller::THistConcurrentFiller(THistConcurrentFill &manager) :
+   fManager(&manager), fNdim(manager.GetNdim()), fSize(manager.GetBufferSize()),
+   fN(0), fBuffer(0)
+{
+   // Create the buffer of a thread filling the histogram of manager.
+
+   fBuffer = new Double_t[fSize * (fNdim + 1)];
+   manager.AddFiller(this);
+}
+
+//______________________________________________________________________________
+THistConcurrentFiller::~THistConcurrentFiller()
+{
+   // Flush the entries left in the buffer and delete it.
+
+   Flush();
+   if (fManager) fManager->RemoveFiller(this);
+   delete [] fBuffer;
+}
+
+//______________________________________________________________________________
+void THistConcurrentFiller::Flush()
+{
+   // Fill the histogram with the entries of the buffer, and empty it.
+   // The entries are lost if the THistConcurrentFill was deleted.
+
+   if (!fN) return;
+   if (fManager) fManager->FillEntries(fN, fBuffer);
+   fN = 0;
+}
@@ -508,6 +508,50 @@ TObject* THnBase::ProjectionAny(Int_t ndim, const Int_t* dim,
    Bool_t haveErrors = GetCalculateErrors();
    Bool_t wantErrors = haveErrors || (option && (strchr(option, 'E') || strchr(option, 'e')));
 
+   Bool_t haveSkippedBin = ProjectBins(hn, hist, ndim, dim, keepTargetAxis, wantErrors);
+
+   if (wantNDim) {
+      hn->SetEntries(fEntries);
+   } else {
+      if (!haveSkippedBin) {
+         hist->SetEntries(fEntries);
+      } else {
+         // re-compute the entries
+         // in case of error calculation (i.e. when Sumw2() is set)
+         // use the effective entries for the entries
+         // since this  is the only way to estimate them
+         hist->ResetStats();
+         Double_t entries = hist->GetEffectiveEntries();
+         if (!wantErrors) {
+            // to avoid numerical rounding
+            entries = TMath::Floor(entries + 0.5);
+         }
+         hist->SetEntries(entries);
+      }
+   }
+
+   if (hadRange) {
+      // reset kAxisRange bit:
+      for (Int_t d = 0; d < ndim; ++d)
+         GetAxis(dim[d])->SetBit(TAxis::kAxisRange, hadRange[d]);
+
+      delete [] hadRange;
+   }
+
+   return ret;
+}
+
+//______________________________________________________________________________
+Bool_t THnBase::ProjectBins(THnBase* hn, TH1* hist, Int_t ndim, const Int_t* dim,
+                            Bool_t keepTargetAxis, Bool_t wantErrors) const
+{
+   // Fill the projection created by ProjectionAny, either the n-dimensional
+   // histogram hn or the TH1/2/3 hist, with the bins in the axis ranges.
+   // Return whether bins outside the ranges have been skipped.
+
+   Bool_t haveErrors = GetCalculateErrors();
+   Bool_t wantNDim = (hn != 0);
+
    Int_t* bins  = new Int_t[ndim];
    Long64_t myLinBin = 0;
 
@@ -556,35 +600,7 @@ TObject* THnBase::ProjectionAny(Int_t ndim, const Int_t* dim,
 
    delete [] bins;
 
-   if (wantNDim) {
-      hn->SetEntries(fEntries);
-   } else {
-      if (!iter.HaveSkippedBin()) {
-         hist->SetEntries(fEntries);
-      } else {
-         // re-compute the entries
-         // in case of error calculation (i.e. when Sumw2() is set)
-         // use the effective entries for the entries
-         // since this  is the only way to estimate them
-         hist->ResetStats();
-         Double_t entries = hist->GetEffectiveEntries();
-         if (!wantErrors) {
-            // to avoid numerical rounding
-            entries = TMath::Floor(entries + 0.5);
-         }
-         hist->SetEntries(entries);
-      }
-   }
-
-   if (hadRange) {
-      // reset kAxisRange bit:
-      for (Int_t d = 0; d < ndim; ++d)
-         GetAxis(dim[d])->SetBit(TAxis::kAxisRange, hadRange[d]);
-
-      delete [] hadRange;
-   }
-
-   return ret;
+   return iter.HaveSkippedBin();
 }
 
 //______________________________________________________________________________
@@ -983,6 +999,17 @@ Bool_t THnBase::CheckConsistency(const THnBase *h, const char *tag) const
    return kTRUE;
 }
 
+//______________________________________________________________________________
+void THnBase::FillN(Int_t nentries, const Double_t* x, const Double_t* w /*= 0*/)
+{
+   // Fill the histogram with nentries entries. x holds the coordinates of
+   // the entries, one entry after the other (nentries * GetNdimensions()
+   // values); w holds their weights, or is null for a weight of 1.
+
+   for (Int_t i = 0; i < nentries; ++i)
+      Fill(x + i * fNdimensions, w ? w[i] : 1.);
+}
+
 //______________________________________________________________________________
 void THnBase::SetBinEdges(Int_t idim, const Double_t* bins)
 {
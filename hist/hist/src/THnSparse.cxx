@@ -15,6 +15,15 @@
 #include "TClass.h"
 #include "TDataMember.h"
 #include "TDataType.h"
+#include "TH1.h"
+#include "TMath.h"
+#include "TSystem.h"
+
+#include <vector>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
 
 namespace {
 //______________________________________________________________________________
@@ -268,9 +277,9 @@ ULong64_t THnSparseCoordCompression::GetHashFromCoords(const Int_t* coord) const
 
    // Bins are addressed in two different modes, depending
    // on whether the compact bin index fits into a Long64_t or not.
-   // If it does, we can use it as a "perfect hash" for the TExMap.
+   // If it does, we can use it as a "perfect hash" for the bin hash table.
    // If not we build a hash from the compact bin index, and use that
-   // as the TExMap's hash.
+   // as the table's hash.
 
    if (fCoordBufferSize <= 8) {
       // fits into a Long64_t
@@ -316,9 +325,9 @@ ULong64_t THnSparseCoordCompression::GetHashFromBuffer(const Char_t* buf) const
 
    // Bins are addressed in two different modes, depending
    // on whether the compact bin index fits into a Long64_t or not.
-   // If it does, we can use it as a "perfect hash" for the TExMap.
+   // If it does, we can use it as a "perfect hash" for the bin hash table.
    // If not we build a hash from the compact bin index, and use that
-   // as the TExMap's hash.
+   // as the table's hash.
 
    if (fCoordBufferSize <= 8) {
       // fits into a Long64_t
@@ -408,6 +417,148 @@ THnSparseCompactBinCoord::~THnSparseCompactBinCoord()
    delete [] fCurrentBin;
 }
 
+//______________________________________________________________________________
+//
+// THnSparseBinHash is a class used by THnSparse internally. It is an open
+// addressing hash table (with linear probing) from the hash of the compact
+// bin coordinates to the linear bin index. Each slot holds the hash next to
+// the bin index, so that probing reads consecutive memory. When the compact
+// coordinates fit into a Long64_t they are their own hash: they are then
+// stored in the table itself and a lookup does not touch the chunks. Bins
+// with the same hash occupy different slots of the probe sequence.
+//______________________________________________________________________________
+
+class THnSparseBinHash {
+public:
+   struct Slot_t {
+      ULong64_t fHash;  // hash of the compact bin coordinates
+      Long64_t  fIndex; // linear bin index + 1; 0 for an empty slot
+   };
+
+   THnSparseBinHash(): fSlots(0), fCapacity(0), fShift(64), fSize(0) { Expand(16); }
+   ~THnSparseBinHash() { delete [] fSlots; }
+
+   Long64_t GetCapacity() const { return fCapacity; }
+   Long64_t GetSize() const { return fSize; }
+   const Slot_t& GetSlot(Long64_t slot) const { return fSlots[slot]; }
+   Long64_t FirstSlot(ULong64_t hash) const {
+      // Multiplicative hashing: the high bits of the product depend on all
+      // the bits of hash, i.e. on the coordinates of all the axes.
+      return (Long64_t) ((hash * 0x9E3779B97F4A7C15ULL) >> fShift);
+   }
+   Long64_t NextSlot(Long64_t slot) const { return (slot + 1) & (fCapacity - 1); }
+
+   void Add(ULong64_t hash, Long64_t idx) {
+      // Add the bin index idx for hash, which must not be in the table yet
+      // for this bin.
+      if (4 * (fSize + 1) > 3 * fCapacity) Expand(2 * fCapacity);
+      Insert(hash, idx + 1);
+      ++fSize;
+   }
+   void Reserve(Long64_t n) {
+      // Make room for n bins without rehashing.
+      Long64_t capacity = fCapacity;
+      while (4 * n > 3 * capacity) capacity *= 2;
+      if (capacity > fCapacity) Expand(capacity);
+   }
+
+private:
+   THnSparseBinHash(const THnSparseBinHash&); // intentionally not implemented
+   THnSparseBinHash& operator=(const THnSparseBinHash&); // intentionally not implemented
+
+   void Insert(ULong64_t hash, Long64_t index) {
+      Long64_t slot = FirstSlot(hash);
+      while (fSlots[slot].fIndex) slot = NextSlot(slot);
+      fSlots[slot].fHash = hash;
+      fSlots[slot].fIndex = index;
+   }
+   void Expand(Long64_t capacity) {
+      // Set the number of slots (a power of 2) and rehash.
+      Slot_t* old = fSlots;
+      Long64_t oldCapacity = fCapacity;
+      fSlots = new Slot_t[capacity];
+      memset(fSlots, 0, capacity * sizeof(Slot_t));
+      fCapacity = capacity;
+      fShift = 64;
+      while (capacity > 1) { capacity /= 2; --fShift; }
+      for (Long64_t i = 0; i < oldCapacity; ++i)
+         if (old[i].fIndex) Insert(old[i].fHash, old[i].fIndex);
+      delete [] old;
+   }
+
+   Slot_t*  fSlots;    //[fCapacity] hash table
+   Long64_t fCapacity; // number of slots, a power of 2
+   Int_t    fShift;    // 64 - log2(fCapacity)
+   Long64_t fSize;     // number of filled slots
+};
+
+
+//______________________________________________________________________________
+//
+// THnSparseProjectionTask projects a range of the filled bins of a THnSparse
+// to a TH1, TH2 or TH3 for THnSparse::ProjectBins: the contents and the
+// squared errors are summed in arrays indexed by the bins of the projection,
+// which are added to the projection once all the tasks are done.
+//______________________________________________________________________________
+
+class THnSparseProjectionTask {
+public:
+   THnSparseProjectionTask(const THnSparse* hs, const TH1* hist, Int_t ndim, const Int_t* dim,
+                           Bool_t keepTargetAxis, Bool_t wantErrors, Long64_t first, Long64_t last):
+      fHs(hs), fHist(hist), fNdim(ndim), fDim(dim), fKeepTargetAxis(keepTargetAxis),
+      fWantErrors(wantErrors), fFirst(first), fLast(last), fHaveSkippedBin(kFALSE) {}
+
+   void Run();
+   static void* RunThread(void* task) {
+      ((THnSparseProjectionTask*) task)->Run();
+      return 0;
+   }
+
+   const THnSparse*      fHs;             // projected histogram
+   const TH1*            fHist;           // projection, only used to compute the bins
+   Int_t                 fNdim;           // number of dimensions of the projection
+   const Int_t*          fDim;            // projected axes
+   Bool_t                fKeepTargetAxis; // whether the projection has the whole axes
+   Bool_t                fWantErrors;     // whether the errors are computed
+   Long64_t              fFirst;          // first bin of the range
+   Long64_t              fLast;           // end of the range
+   Bool_t                fHaveSkippedBin; // whether bins outside the axis ranges were skipped
+   std::vector<Double_t> fContent;        // contents of the bins of the projection
+   std::vector<Double_t> fError2;         // squared errors of the bins of the projection
+};
+
+//______________________________________________________________________________
+void THnSparseProjectionTask::Run()
+{
+   // Project the bins [fFirst, fLast), as THnBase::ProjectBins does.
+
+   fContent.assign(fHist->GetNcells(), 0.);
+   if (fWantErrors) fError2.assign(fHist->GetNcells(), 0.);
+   const Bool_t haveErrors = fHs->GetCalculateErrors();
+   std::vector<Int_t> coord(fHs->GetNdimensions());
+   Int_t bins[3] = {0, 0, 0};
+   for (Long64_t i = fFirst; i < fLast; ++i) {
+      Double_t v = fHs->GetBinContent(i, &coord[0]);
+      if (!fHs->IsInRange(&coord[0])) {
+         fHaveSkippedBin = kTRUE;
+         continue;
+      }
+      for (Int_t d = 0; d < fNdim; ++d) {
+         bins[d] = coord[fDim[d]];
+         const TAxis* axis = fHs->GetAxis(fDim[d]);
+         if (!fKeepTargetAxis && axis->TestBit(TAxis::kAxisRange))
+            bins[d] -= axis->GetFirst() - 1;
+      }
+      Int_t target = bins[0];
+      if (fNdim == 2) target = fHist->GetBin(bins[0], bins[1]);
+      else if (fNdim == 3) target = fHist->GetBin(bins[0], bins[1], bins[2]);
+      fContent[target] += v;
+      if (fWantErrors)
+         fError2[target] += haveErrors ? fHs->GetBinError2(i) : v;
+   }
+}
+
+
 //______________________________________________________________________________
 //
 // THnSparseArrayChunk is used internally by THnSparse.
@@ -567,21 +718,31 @@ void THnSparseArrayChunk::Sumw2()
 // the chunks is done by GetBin(). It creates a hash from the compacted bin
 // coordinates (the hash of a bin coordinate is the compacted coordinate itself
 // if it takes less than 8 bytes, the size of a Long64_t.
-// This hash is used to lookup the linear index in the TExMap member fBins;
-// the coordinates of the entry fBins points to is compared to the coordinates
-// passed to GetBin(). If they do not match, these two coordinates have the same
-// hash - which is extremely unlikely but (for the case where the compact bin
-// coordinates are larger than 4 bytes) possible. In this case, fBinsContinued
-// contains a chain of linear indexes with the same hash. Iterating through this
-// chain and comparing each bin coordinates with the one passed to GetBin() will
-// retrieve the matching bin.
+// This hash is used to lookup the linear index in the open addressing hash
+// table fBinHash (THnSparseBinHash), which stores the hash of each filled bin
+// next to its linear index. If the compacted coordinates take less than 8
+// bytes, a matching hash identifies the bin. Otherwise two coordinates can
+// have the same hash - which is extremely unlikely but possible: the
+// coordinates of the bin are then compared to the ones passed to GetBin(),
+// and the search goes on with the next slots of the table.
+//
+// * Filling many entries
+// FillN() fills the histogram with an array of entries: the bins of each axis
+// are found by blocks of entries (see TAxis::FindFixBins) before the lookup
+// of the filled bins.
+//
+// * Parallel projections
+// The projections to a TH1, TH2 or TH3 of a histogram with many filled bins
+// can be done by several threads, see SetProjectionThreads().
 
 
 ClassImp(THnSparse);
 
+Int_t THnSparse::fgProjectionThreads = 1;
+
 //______________________________________________________________________________
 THnSparse::THnSparse():
-   fChunkSize(1024), fFilledBins(0), fCompactCoord(0)
+   fChunkSize(1024), fFilledBins(0), fBinHash(0), fCompactCoord(0)
 {
    // Construct an empty THnSparse.
    fBinContent.SetOwner();
@@ -592,7 +753,7 @@ THnSparse::THnSparse(const char* name, const char* title, Int_t dim,
                      const Int_t* nbins, const Double_t* xmin, const Double_t* xmax,
                      Int_t chunksize):
    THnBase(name, title, dim, nbins, xmin, xmax),
-   fChunkSize(chunksize), fFilledBins(0), fCompactCoord(0)
+   fChunkSize(chunksize), fFilledBins(0), fBinHash(0), fCompactCoord(0)
 {
    // Construct a THnSparse with "dim" dimensions,
    // with chunksize as the size of the chunks.
@@ -609,6 +770,7 @@ THnSparse::THnSparse(const char* name, const char* title, Int_t dim,
 THnSparse::~THnSparse() {
    // Destruct a THnSparse
 
+   delete fBinHash;
    delete fCompactCoord;
 }
 
@@ -643,47 +805,32 @@ void THnSparse::InitStorage(Int_t* nbins, Int_t chunkSize)
 }
 
 //______________________________________________________________________________
-void THnSparse::FillExMap()
+void THnSparse::FillBinHash()
 {
-   //We have been streamed; set up fBins
+   // Create fBinHash for the bins of the chunks (we have been streamed, or
+   // reset).
+   delete fBinHash;
+   fBinHash = new THnSparseBinHash();
+   fBinHash->Reserve(GetNbins());
    TIter iChunk(&fBinContent);
    THnSparseArrayChunk* chunk = 0;
    THnSparseCoordCompression compactCoord(*GetCompactCoord());
    Long64_t idx = 0;
-   if (2 * GetNbins() > fBins.Capacity())
-      fBins.Expand(3 * GetNbins());
    while ((chunk = (THnSparseArrayChunk*) iChunk())) {
       const Int_t chunkSize = chunk->GetEntries();
       Char_t* buf = chunk->fCoordinates;
       const Int_t singleCoordSize = chunk->fSingleCoordinateSize;
       const Char_t* endbuf = buf + singleCoordSize * chunkSize;
-      for (; buf < endbuf; buf += singleCoordSize, ++idx) {
-         Long64_t hash = compactCoord.GetHashFromBuffer(buf);
-         Long64_t linidx = fBins.GetValue(hash);
-         if (linidx) {
-            Long64_t nextidx = linidx;
-            while (nextidx) {
-               // must be a collision, so go to fBinsContinued.
-               linidx = nextidx;
-               nextidx = fBinsContinued.GetValue(linidx);
-            }
-            fBinsContinued.Add(linidx, idx + 1);
-         } else {
-            fBins.Add(hash, idx + 1);
-         }
-      }
+      for (; buf < endbuf; buf += singleCoordSize, ++idx)
+         fBinHash->Add(compactCoord.GetHashFromBuffer(buf), idx);
    }
 }
 
 //______________________________________________________________________________
 void THnSparse::Reserve(Long64_t nbins) {
    // Initialize storage for nbins
-   if (!fBins.GetSize() && fBinContent.GetSize()) {
-      FillExMap();
-   }
-   if (2 * nbins > fBins.Capacity()) {
-      fBins.Expand(3 * nbins);
-   }
+   if (!fBinHash) FillBinHash();
+   fBinHash->Reserve(nbins);
 }
 
 //______________________________________________________________________________
@@ -726,6 +873,44 @@ Long64_t THnSparse::GetBin(const Int_t* coord, Bool_t allocate /*= kTRUE*/)
    return GetBinIndexForCurrentBin(allocate);
 }
 
+//______________________________________________________________________________
+void THnSparse::FillN(Int_t nentries, const Double_t* x, const Double_t* w /*= 0*/)
+{
+   // Fill the histogram with nentries entries. x holds the coordinates of
+   // the entries, one entry after the other (nentries * GetNdimensions()
+   // values); w holds their weights, or is null for a weight of 1.
+   //
+   // The bins of the entries are found by blocks, axis by axis (see
+   // TAxis::FindFixBins), before their filled bins are looked up.
+
+   for (Int_t d = 0; d < fNdimensions; ++d) {
+      if (GetAxis(d)->CanExtend()) {
+         // the axes can change while filling: fill entry by entry
+         THnBase::FillN(nentries, x, w);
+         return;
+      }
+   }
+
+   const Int_t kBlock = 256;
+   std::vector<Int_t> bins(kBlock * fNdimensions);
+   THnSparseCompactBinCoord* cc = GetCompactCoord();
+   Int_t *coord = cc->GetCoord();
+   for (Int_t first = 0; first < nentries; first += kBlock) {
+      const Int_t n = TMath::Min(kBlock, nentries - first);
+      const Double_t* xblock = x + (Long64_t)first * fNdimensions;
+      for (Int_t d = 0; d < fNdimensions; ++d)
+         GetAxis(d)->FindFixBins(n, xblock + d, &bins[d * kBlock], fNdimensions);
+      for (Int_t i = 0; i < n; ++i) {
+         for (Int_t d = 0; d < fNdimensions; ++d)
+            coord[d] = bins[d * kBlock + i];
+         cc->UpdateCoord();
+         const Double_t wi = w ? w[first + i] : 1.;
+         UpdateXStat(xblock + i * fNdimensions, wi);
+         FillBin(GetBinIndexForCurrentBin(kTRUE), wi);
+      }
+   }
+}
+
 //______________________________________________________________________________
 Double_t THnSparse::GetBinContent(Long64_t idx, Int_t* coord /* = 0 */) const
 {
@@ -781,19 +966,19 @@ Long64_t THnSparse::GetBinIndexForCurrentBin(Bool_t allocate)
 
    THnSparseCompactBinCoord* cc = GetCompactCoord();
    ULong64_t hash = cc->GetHash();
-   if (fBinContent.GetSize() && !fBins.GetSize())
-      FillExMap();
-   Long64_t linidx = (Long64_t) fBins.GetValue(hash);
-   while (linidx) {
-      // fBins stores index + 1!
-      THnSparseArrayChunk* chunk = GetChunk((linidx - 1)/ fChunkSize);
-      if (chunk->Matches((linidx - 1) % fChunkSize, cc->GetBuffer()))
-         return linidx - 1; // we store idx+1, 0 is "TExMap: not found"
-
-      Long64_t nextlinidx = fBinsContinued.GetValue(linidx);
-      if (!nextlinidx) break;
-
-      linidx = nextlinidx;
+   if (!fBinHash)
+      FillBinHash();
+   // the hash is the compact coordinate itself if it fits into a Long64_t
+   const Bool_t perfectHash = cc->GetBufferSize() <= 8;
+   for (Long64_t slot = fBinHash->FirstSlot(hash); ; slot = fBinHash->NextSlot(slot)) {
+      const THnSparseBinHash::Slot_t& entry = fBinHash->GetSlot(slot);
+      if (!entry.fIndex) break;
+      if (entry.fHash != hash) continue;
+      // fBinHash stores index + 1!
+      Long64_t linidx = entry.fIndex - 1;
+      if (perfectHash
+          || GetChunk(linidx / fChunkSize)->Matches(linidx % fChunkSize, cc->GetBuffer()))
+         return linidx;
    }
    if (!allocate) return -1;
 
@@ -810,16 +995,7 @@ Long64_t THnSparse::GetBinIndexForCurrentBin(Bool_t allocate)
 
    // store translation between hash and bin
    newidx += (fBinContent.GetEntriesFast() - 1) * fChunkSize;
-   if (!linidx) {
-      // fBins didn't find it
-      if (2 * GetNbins() > fBins.Capacity())
-         fBins.Expand(3 * GetNbins());
-      fBins.Add(hash, newidx + 1);
-   } else {
-      // fBins contains one, but it's the wrong one;
-      // add entry to fBinsContinued.
-      fBinsContinued.Add(linidx, newidx + 1);
-   }
+   fBinHash->Add(hash, newidx);
    return newidx;
 }
 
@@ -871,7 +1047,8 @@ Double_t THnSparse::GetSparseFractionMem() const {
 
    Double_t size = 0.;
    size += fBinContent.GetEntries() * (GetChunkSize() * sizePerChunkElement + sizeof(THnSparseArrayChunk));
-   size += + 3 * sizeof(Long64_t) * fBins.GetSize() /* TExMap */;
+   if (fBinHash)
+      size += sizeof(THnSparseBinHash::Slot_t) * fBinHash->GetCapacity();
 
    Double_t nbinsTotal = 1.;
    for (Int_t d = 0; d < fNdimensions; ++d)
@@ -888,6 +1065,81 @@ ROOT::THnBaseBinIter* THnSparse::CreateIter(Bool_t respectAxisRange) const
    return new THnSparseBinIter(respectAxisRange, this);
 }
 
+//______________________________________________________________________________
+Bool_t THnSparse::ProjectBins(THnBase* hn, TH1* hist, Int_t ndim, const Int_t* dim,
+                              Bool_t keepTargetAxis, Bool_t wantErrors) const
+{
+   // Fill the projection created by ProjectionAny with the bins in the axis
+   // ranges. Return whether bins outside the ranges have been skipped.
+   //
+   // The projections to a TH1, TH2 or TH3 are split into ranges of filled
+   // bins projected by GetProjectionThreads() threads, if there are enough
+   // filled bins; the projections to a THnBase are done sequentially.
+
+   Int_t nthreads = fgProjectionThreads;
+   if (hist && hist->GetNcells() > 0) {
+      const Long64_t maxthreads = GetNbins() / hist->GetNcells();
+      if (nthreads > maxthreads) nthreads = (Int_t) maxthreads;
+   }
+   if (hn || !hist || nthreads <= 1)
+      return THnBase::ProjectBins(hn, hist, ndim, dim, keepTargetAxis, wantErrors);
+
+   // the bins are read by the threads: create the compact coordinates now
+   GetCompactCoord();
+
+   std::vector<THnSparseProjectionTask*> tasks(nthreads);
+   const Long64_t nbins = GetNbins();
+   for (Int_t t = 0; t < nthreads; ++t)
+      tasks[t] = new THnSparseProjectionTask(this, hist, ndim, dim, keepTargetAxis, wantErrors,
+                                             nbins * t / nthreads, nbins * (t + 1) / nthreads);
+
+   // libHist does not link libThread, so the threads are created directly:
+   // the tasks only read this THnSparse and write their own arrays, they
+   // create no TObject and need none of the locks set up by TThread.
+#ifndef _WIN32
+   std::vector<pthread_t> threads(nthreads);
+   std::vector<Bool_t> started(nthreads, kFALSE);
+   for (Int_t t = 1; t < nthreads; ++t)
+      started[t] = !pthread_create(&threads[t], 0, THnSparseProjectionTask::RunThread, tasks[t]);
+   tasks[0]->Run();
+   for (Int_t t = 1; t < nthreads; ++t) {
+      if (started[t]) pthread_join(threads[t], 0);
+      else tasks[t]->Run();
+   }
+#else
+   for (Int_t t = 0; t < nthreads; ++t)
+      tasks[t]->Run();
+#endif
+
+   // sum the projections of the tasks, in the order of the bins
+   Bool_t haveSkippedBin = kFALSE;
+   const Int_t ncells = hist->GetNcells();
+   std::vector<Double_t> content(ncells, 0.);
+   std::vector<Double_t> err2(wantErrors ? ncells : 0, 0.);
+   for (Int_t t = 0; t < nthreads; ++t) {
+      THnSparseProjectionTask* task = tasks[t];
+      haveSkippedBin |= task->fHaveSkippedBin;
+      for (Int_t bin = 0; bin < ncells; ++bin) {
+         content[bin] += task->fContent[bin];
+         if (wantErrors) err2[bin] += task->fError2[bin];
+      }
+      delete task;
+   }
+
+   // as THnBase::ProjectBins, which sets the errors of the filled bins
+   if (wantErrors && !hist->GetSumw2N()) hist->Sumw2();
+   for (Int_t bin = 0; bin < ncells; ++bin) {
+      if (wantErrors && err2[bin] != 0.) {
+         Double_t preverr = hist->GetBinError(bin);
+         hist->SetBinError(bin, TMath::Sqrt(preverr * preverr + err2[bin]));
+      }
+      // only _after_ error calculation, or sqrt(v) is taken into account!
+      if (content[bin] != 0.)
+         hist->AddBinContent(bin, content[bin]);
+   }
+   return haveSkippedBin;
+}
+
 //______________________________________________________________________________
 void THnSparse::SetBinContent(Long64_t bin, Double_t v)
 {
@@ -946,13 +1198,28 @@ void THnSparse::Sumw2()
       chunk->Sumw2();
 }
 
+//______________________________________________________________________________
+void THnSparse::SetProjectionThreads(Int_t nthreads /*= 0*/)
+{
+   // Static function setting the number of threads projecting a THnSparse
+   // to a TH1, TH2 or TH3 (see Projection()): by default the number of
+   // CPUs of the machine. 1 (the initial value) projects in the calling
+   // thread only.
+
+   if (nthreads <= 0) {
+      SysInfo_t info;
+      nthreads = (gSystem && gSystem->GetSysInfo(&info) == 0) ? info.fCpus : 1;
+   }
+   fgProjectionThreads = TMath::Max(nthreads, 1);
+}
+
 //______________________________________________________________________________
 void THnSparse::Reset(Option_t *option /*= ""*/)
 {
    // Clear the histogram
    fFilledBins = 0;
-   fBins.Delete();
-   fBinsContinued.Clear();
+   delete fBinHash;
+   fBinHash = 0;
    fBinContent.Delete();
    ResetBase(option);
 }
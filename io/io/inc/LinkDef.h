@@ -20,6 +20,8 @@
 #pragma link C++ class TFileCacheRead+;
 #pragma link C++ class TFileCacheWrite+;
 #pragma link C++ class TFileMerger+;
+#pragma link C++ class TFileReadPlan+;
+#pragma link C++ class TFileBlockCache+;
 #pragma link C++ class TFree;
 #pragma link C++ class TKey-;
 #pragma link C++ class TKeyMapFile;
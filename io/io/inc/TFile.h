@@ -40,6 +40,7 @@ class TFileCacheWrite;
 class TProcessID;
 class TStopwatch;
 class TFilePrefetch;
+class TFileBlockCache;
 
 class TFile : public TDirectoryFile {
   friend class TDirectoryFile;
@@ -82,6 +83,9 @@ protected:
    TMap            *fCacheReadMap;   //!Pointer to the read cache (if any)
    TFileCacheWrite *fCacheWrite;     //!Pointer to the write cache (if any)
    Long64_t         fArchiveOffset;  //!Offset at which file starts in archive
+   char            *fMapAddress;     //!Address of the memory mapping of the file (see SetMemoryMap)
+   Long64_t         fMapSize;        //!Size of the memory mapping of the file
+   TFileBlockCache *fBlockCache;     //!Local disk cache of the blocks of a remote file (see TFileBlockCache)
    Bool_t           fIsArchive;      //!True if this is a pure archive file
    Bool_t           fNoAnchorInName; //!True if we don't want to force the anchor to be appended to the file name
    Bool_t           fIsRootFile;     //!True is this is a ROOT file, raw file otherwise
@@ -112,6 +116,8 @@ protected:
    virtual void  Init(Bool_t create);
    Bool_t        FlushWriteCache();
    Int_t         ReadBufferViaCache(char *buf, Int_t len);
+   Int_t         ReadBufferViaBlockCache(char *buf, Int_t len);
+   Int_t         ReadBuffersViaBlockCache(char *buf, Long64_t *pos, Int_t *len, Int_t nbuf);
    Int_t         WriteBufferViaCache(const char *buf, Int_t len);
 
    // Creating projects
@@ -163,6 +169,7 @@ public:
    virtual void        Close(Option_t *option=""); // *MENU*
    virtual void        Copy(TObject &) const { MayNotUse("Copy(TObject &)"); }
    virtual Bool_t      Cp(const char *dst, Bool_t progressbar = kTRUE,UInt_t buffersize = 1000000);
+   void                CountMapRead(Int_t len, Double_t start);
    virtual TKey*       CreateKey(TDirectory* mother, const TObject* obj, const char* name, Int_t bufsize);
    virtual TKey*       CreateKey(TDirectory* mother, const void* obj, const TClass* cl,
                                  const char* name, Int_t bufsize);
@@ -190,6 +197,7 @@ public:
    virtual const TUrl *GetEndpointUrl() const { return &fUrl; }
    TObjArray          *GetListOfProcessIDs() const {return fProcessIDs;}
    TList              *GetListOfFree() const { return fFree; }
+   char               *GetMapBuffer(Long64_t pos, Int_t len) const;
    virtual Int_t       GetNfree() const { return fFree->GetSize(); }
    virtual Int_t       GetNProcessIDs() const { return fNProcessIDs; }
    Option_t           *GetOption() const { return fOption.Data(); }
@@ -238,6 +246,7 @@ public:
    virtual void        SetCompressionLevel(Int_t level=1);
    virtual void        SetCompressionSettings(Int_t settings=1);
    virtual void        SetEND(Long64_t last) { fEND = last; }
+   virtual Bool_t      SetMemoryMap(Bool_t map = kTRUE);
    virtual void        SetOffset(Long64_t offset, ERelativeTo pos = kBeg);
    virtual void        SetOption(Option_t *option=">") { fOption = option; }
    virtual void        SetReadCalls(Int_t readcalls = 0) { fReadCalls = readcalls; }
@@ -0,0 +1,79 @@
+// @(#)root/io:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2012, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TFileBlockCache
+#define ROOT_TFileBlockCache
+
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TFileBlockCache                                                      //
+//                                                                      //
+// Cache on the local disk of the blocks read from a remote file.       //
+// The blocks are shared by all the processes of the node using the     //
+// same cache directory and the least recently used ones are evicted.   //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef ROOT_TObject
+#include "TObject.h"
+#endif
+#ifndef ROOT_TString
+#include "TString.h"
+#endif
+
+class TFile;
+class TVirtualMutex;
+
+class TFileBlockCache : public TObject {
+
+private:
+   TFile          *fFile;          //!File whose blocks are cached
+   TString         fDir;           //Directory holding the blocks of this file
+   Bool_t          fFetching;      //True while the missing blocks are read from the file
+   Long64_t        fNHits;         //Number of blocks found in the cache
+   Long64_t        fNMisses;       //Number of blocks read from the file
+   TVirtualMutex  *fMutex;         //!Serialize the reads through the cache (block files and fFetching)
+
+   static TString  fgDirectory;    //Cache directory, empty if the cache is disabled (see GetDirectory)
+   static Long64_t fgMaxSize;      //Maximum size of the cache directory in bytes (-1 means not set)
+   static Long64_t fgWritten;      //Number of bytes written since the last eviction
+   static Bool_t   fgInit;         //True once the settings have been read from gEnv
+
+   TFileBlockCache(const TFileBlockCache&);            // not implemented
+   TFileBlockCache& operator=(const TFileBlockCache&); // not implemented
+
+   TString         GetBlockPath(Long64_t block) const;
+   Bool_t          ReadBlock(Long64_t block, char *buf, Int_t len) const;
+   void            WriteBlock(Long64_t block, const char *buf, Int_t len) const;
+
+   static void     Init();
+
+public:
+   enum { kBlockSize = 262144 };   //Size of the cached blocks
+
+   TFileBlockCache(TFile *file);
+   virtual ~TFileBlockCache();
+
+   const char     *GetBlockDirectory() const { return fDir; }
+   Long64_t        GetNHits() const { return fNHits; }
+   Long64_t        GetNMisses() const { return fNMisses; }
+   virtual void    Print(Option_t *option = "") const;
+   Int_t           ReadBuffers(char *buf, Long64_t *pos, Int_t *len, Int_t nbuf);
+
+   static void     Evict();
+   static const char *GetDirectory();
+   static Long64_t GetMaxSize();
+   static Bool_t   SetDirectory(const char *dir, Long64_t maxsize = 0);
+
+   ClassDef(TFileBlockCache,0)  //Local disk cache of the blocks of remote files
+};
+
+#endif
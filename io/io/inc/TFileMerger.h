@@ -40,6 +40,8 @@
 class TList;
 class TFile;
 class TDirectory;
+class TKey;
+class TFileMergeInfo;
 
 
 class TFileMerger : public TObject {
@@ -65,9 +67,11 @@ protected:
    TString        fObjectNames;     // List of object names to be either merged exclusively or skipped
    TList         *fMergeList;       // list of TObjString containing the name of the files need to be merged
    TList         *fExcessFiles;     //! List of TObjString containing the name of the files not yet added to fFileList due to user or system limitiation on the max number of files opened.
+   Int_t          fNThreads;        //! Number of threads used to open, read and merge the sources (0 means sequential)
 
    Bool_t         OpenExcessFiles();
    virtual Bool_t AddFile(TFile *source, Bool_t own, Bool_t cpProgress);
+   virtual void   MergeParallel(TObject *obj, TKey *key, const char *path, TList *sourcelist, TFile *firstsource, TFileMergeInfo &info, Bool_t oneGo);
    virtual Bool_t MergeRecursive(TDirectory *target, TList *sourcelist, Int_t type = kRegular | kAll);
 
 public:
@@ -94,6 +98,8 @@ public:
    TFile      *GetOutputFile() const { return fOutputFile; }
    Int_t       GetMaxOpenedFies() const { return fMaxOpenedFiles; }
    void        SetMaxOpenedFiles(Int_t newmax);
+   Int_t       GetParallelMerge() const { return fNThreads; }
+   void        SetParallelMerge(Int_t nthreads = -1);
    const char *GetMsgPrefix() const { return fMsgPrefix; }
    void        SetMsgPrefix(const char *prefix);
    void        AddObjectNames(const char *name) {fObjectNames += name; fObjectNames += " ";}
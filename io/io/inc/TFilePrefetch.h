@@ -76,16 +76,20 @@ private:
    TMutex     *fMutexPendingList;  // mutex for the pending list
    TMutex     *fMutexReadList;     // mutex for the list of read blocks
    TCondition *fNewBlockAdded;     // signal the addition of a new pending block
-   TCondition *fReadBlockAdded;    // signal the addition of a new red block
+   TCondition *fReadBlockAdded;    // signal the addition of a new red block (uses fMutexReadList)
    TCondition *fCondNextFile;      // signal TChain that we can move to the next file
    TSemaphore *fSemMasterWorker;   // semaphore used to kill the consumer thread
    TSemaphore *fSemWorkerMaster;   // semaphore used to notify the master that worker is killed
    TString     fPathCache;         // path to the cache directory
    TStopwatch  fWaitTime;          // time wating to prefetch a buffer (in usec)
    Bool_t      fThreadJoined;      // mark if async thread was joined
+   TFPBlock   *fReadingBlock;      // block being read by the worker thread (guarded by fMutexReadList)
+   Int_t       fMaxReadBlocks;     // maximum number of blocks kept in the list of blocks read
 
    static TThread::VoidRtnFunc_t ThreadProc(void*);  //create a joinable worker thread
 
+   Bool_t    IsPending(Long64_t, Int_t);
+
 public:
    TFilePrefetch(TFile*);
    virtual ~TFilePrefetch();
@@ -115,6 +119,7 @@ public:
    Long64_t  GetWaitTime();
 
    void      SetFile(TFile*);
+   void      SetMaxReadBlocks(Int_t);
    TCondition* GetCondNextFile() const { return fCondNextFile; };
    void      WaitFinishPrefetch();
 
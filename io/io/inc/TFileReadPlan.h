@@ -0,0 +1,76 @@
+// @(#)root/io:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2012, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TFileReadPlan
+#define ROOT_TFileReadPlan
+
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TFileReadPlan                                                        //
+//                                                                      //
+// Plan the requests used by the remote files (TWebFile, TNetFile) to   //
+// read a list of blocks: the blocks separated by small gaps are merged //
+// into a single range and the large ranges are split.                  //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+#include <vector>
+
+class TFileReadPlan {
+
+private:
+   std::vector<Long64_t> fPos;         // Position of the planned ranges
+   std::vector<Int_t>    fLen;         // Length of the planned ranges
+   std::vector<Long64_t> fBlockOffset; // Offset of each requested block in the planned buffer
+   std::vector<Int_t>    fBlockLen;    // Length of each requested block
+   Long64_t              fSize;        // Total length of the planned ranges
+   Bool_t                fDirect;      // True if the planned buffer is the requested buffer
+
+   static Int_t          fgMaxGap;         // Largest gap between two blocks read in a single range (-1 means not set)
+   static Int_t          fgMaxSize;        // Largest range read at once, 0 means no limit (-1 means not set)
+   static Int_t          fgConnections;    // Number of connections used concurrently (-1 means not set)
+   static Long64_t       fgNBlocks;        // Number of blocks requested
+   static Long64_t       fgNRanges;        // Number of ranges actually read
+   static Long64_t       fgBytesWasted;    // Number of bytes read in the gaps between the blocks
+
+   TFileReadPlan(const TFileReadPlan&);            // not implemented
+   TFileReadPlan& operator=(const TFileReadPlan&); // not implemented
+
+public:
+   TFileReadPlan();
+   TFileReadPlan(const Long64_t *pos, const Int_t *len, Int_t nbuf);
+   virtual ~TFileReadPlan() {}
+
+   Long64_t        GetBufferSize() const { return fSize; }
+   Int_t           GetNRanges() const { return (Int_t)fPos.size(); }
+   Long64_t       *GetPos() { return fPos.empty() ? 0 : &fPos[0]; }
+   Int_t          *GetLen() { return fLen.empty() ? 0 : &fLen[0]; }
+   Bool_t          IsDirect() const { return fDirect; }
+   void            Plan(const Long64_t *pos, const Int_t *len, Int_t nbuf);
+   void            Scatter(const char *planned, char *buf) const;
+
+   static Int_t    GetConnections();
+   static Int_t    GetMaxGap();
+   static Int_t    GetMaxSize();
+   static void     PrintStats();
+   static void     ResetStats();
+   static void     SetConnections(Int_t n = 1);
+   static void     SetMaxGap(Int_t bytes = 0);
+   static void     SetMaxSize(Int_t bytes = 0);
+
+   ClassDef(TFileReadPlan,0)  //Plan of the requests reading a list of blocks from a remote file
+};
+
+#endif
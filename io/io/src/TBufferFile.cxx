@@ -37,15 +37,6 @@
 #include "TStreamerInfoActions.h"
 #include "TArrayC.h"
 
-#if (defined(__linux) || defined(__APPLE__)) && defined(__i386__) && \
-     defined(__GNUC__)
-#define USE_BSWAPCPY
-#endif
-
-#ifdef USE_BSWAPCPY
-#include "Bswapcpy.h"
-#endif
-
 
 const UInt_t kNullTag           = 0;
 const UInt_t kNewClassTag       = 0xFFFFFFFF;
@@ -69,6 +60,101 @@ static inline ULong_t Void_Hash(const void *ptr)
    return TString::Hash(&ptr, sizeof(void*));
 }
 
+// Number of values converted at once by the Float16_t and Double32_t
+// array routines before being byte swapped in bulk.
+const Int_t kConvertChunk = 256;
+
+//______________________________________________________________________________
+template <typename T>
+static void ReadArrayWithFactor(char *&buf, T *x, Int_t n, Double_t factor, Double_t minvalue)
+{
+   // Read n integers from buf and convert them back to values in the range
+   // given by minvalue and factor (see TBufferFile::WriteFloat16).
+
+   UInt_t aint[kConvertChunk];
+   for (Int_t i = 0; i < n; i += kConvertChunk) {
+      Int_t k = n - i < kConvertChunk ? n - i : kConvertChunk;
+      frombuf(buf, aint, k);
+      for (Int_t j = 0; j < k; j++) x[i+j] = (T)(aint[j]/factor + minvalue);
+   }
+}
+
+//______________________________________________________________________________
+template <typename T>
+static void WriteArrayWithFactor(char *&buf, const T *x, Int_t n, Double_t factor, Double_t xmin, Double_t xmax)
+{
+   // Normalize n values to the range [xmin,xmax] and write them into buf
+   // as integers using the scaling factor (see TBufferFile::WriteFloat16).
+
+   UInt_t aint[kConvertChunk];
+   for (Int_t i = 0; i < n; i += kConvertChunk) {
+      Int_t k = n - i < kConvertChunk ? n - i : kConvertChunk;
+      for (Int_t j = 0; j < k; j++) {
+         T v = x[i+j];
+         if (v < xmin) v = xmin;
+         if (v > xmax) v = xmax;
+         aint[j] = UInt_t(0.5+factor*(v-xmin));
+      }
+      tobuf(buf, aint, k);
+   }
+}
+
+//______________________________________________________________________________
+template <typename T>
+static void ReadArrayWithNbits(char *&buf, T *x, Int_t n, Int_t nbits)
+{
+   // Rebuild n values from the exponent (UChar_t) and the mantissa truncated
+   // to nbits (UShort_t) stored in buf (see TBufferFile::WriteFloat16).
+   // The 3 bytes of each value are decoded directly from the buffer.
+
+   const UChar_t *b = (const UChar_t *)buf;
+   const Int_t mask = (1<<(nbits+1))-1;
+   const Int_t sign = 1<<(nbits+1);
+   union {
+      Float_t fFloatValue;
+      Int_t   fIntValue;
+   };
+   for (Int_t i = 0; i < n; i++, b += 3) {
+      UShort_t theMan = (UShort_t)((b[1] << 8) | b[2]);
+      fIntValue = b[0];
+      fIntValue <<= 23;
+      fIntValue |= (theMan & mask) << (23-nbits);
+      if (sign & theMan) fFloatValue = -fFloatValue;
+      x[i] = (T)fFloatValue;
+   }
+   buf += 3*n;
+}
+
+//______________________________________________________________________________
+template <typename T>
+static void WriteArrayWithNbits(char *&buf, const T *x, Int_t n, Int_t nbits)
+{
+   // Write n values as their exponent (UChar_t) and their mantissa truncated
+   // to nbits (UShort_t) into buf (see TBufferFile::WriteFloat16).
+   // The 3 bytes of each value are encoded directly into the buffer, which
+   // must have room for them.
+
+   UChar_t *b = (UChar_t *)buf;
+   const Int_t mask = (1<<(nbits+1))-1;
+   union {
+      Float_t fFloatValue;
+      Int_t   fIntValue;
+   };
+   for (Int_t i = 0; i < n; i++, b += 3) {
+      fFloatValue = (Float_t)x[i];
+      UChar_t  theExp = (UChar_t)(0x000000ff & ((fIntValue<<1)>>24));
+      UShort_t theMan = mask & (fIntValue>>(23-nbits-1));
+      theMan++;
+      theMan = theMan>>1;
+      if (theMan&1<<nbits) theMan = (1<<nbits) - 1;
+      if (fFloatValue < 0) theMan |= 1<<(nbits+1);
+      b[0] = theExp;
+      b[1] = (UChar_t)(theMan >> 8);
+      b[2] = (UChar_t)(theMan & 0xff);
+   }
+   buf += 3*n;
+}
+
 //______________________________________________________________________________
 TBufferFile::TBufferFile(TBuffer::EMode mode)
             :TBuffer(mode),
@@ -727,18 +813,7 @@ Int_t TBufferFile::ReadArray(Short_t *&h)
 
    if (!h) h = new Short_t[n];
 
-#ifdef R__BYTESWAP
-# ifdef USE_BSWAPCPY
-   bswapcpy16(h, fBufCur, n);
-   fBufCur += l;
-# else
-   for (int i = 0; i < n; i++)
-      frombuf(fBufCur, &h[i]);
-# endif
-#else
-   memcpy(h, fBufCur, l);
-   fBufCur += l;
-#endif
+   frombuf(fBufCur, h, n);
 
    return n;
 }
@@ -760,18 +835,7 @@ Int_t TBufferFile::ReadArray(Int_t *&ii)
 
    if (!ii) ii = new Int_t[n];
 
-#ifdef R__BYTESWAP
-# ifdef USE_BSWAPCPY
-   bswapcpy32(ii, fBufCur, n);
-   fBufCur += l;
-# else
-   for (int i = 0; i < n; i++)
-      frombuf(fBufCur, &ii[i]);
-# endif
-#else
-   memcpy(ii, fBufCur, l);
-   fBufCur += l;
-#endif
+   frombuf(fBufCur, ii, n);
 
    return n;
 }
@@ -819,13 +883,7 @@ Int_t TBufferFile::ReadArray(Long64_t *&ll)
 
    if (!ll) ll = new Long64_t[n];
 
-#ifdef R__BYTESWAP
-   for (int i = 0; i < n; i++)
-      frombuf(fBufCur, &ll[i]);
-#else
-   memcpy(ll, fBufCur, l);
-   fBufCur += l;
-#endif
+   frombuf(fBufCur, ll, n);
 
    return n;
 }
@@ -847,18 +905,7 @@ Int_t TBufferFile::ReadArray(Float_t *&f)
 
    if (!f) f = new Float_t[n];
 
-#ifdef R__BYTESWAP
-# ifdef USE_BSWAPCPY
-   bswapcpy32(f, fBufCur, n);
-   fBufCur += l;
-# else
-   for (int i = 0; i < n; i++)
-      frombuf(fBufCur, &f[i]);
-# endif
-#else
-   memcpy(f, fBufCur, l);
-   fBufCur += l;
-#endif
+   frombuf(fBufCur, f, n);
 
    return n;
 }
@@ -880,13 +927,7 @@ Int_t TBufferFile::ReadArray(Double_t *&d)
 
    if (!d) d = new Double_t[n];
 
-#ifdef R__BYTESWAP
-   for (int i = 0; i < n; i++)
-      frombuf(fBufCur, &d[i]);
-#else
-   memcpy(d, fBufCur, l);
-   fBufCur += l;
-#endif
+   frombuf(fBufCur, d, n);
 
    return n;
 }
@@ -1000,18 +1041,7 @@ Int_t TBufferFile::ReadStaticArray(Short_t *h)
 
    if (!h) return 0;
 
-#ifdef R__BYTESWAP
-# ifdef USE_BSWAPCPY
-   bswapcpy16(h, fBufCur, n);
-   fBufCur += l;
-# else
-   for (int i = 0; i < n; i++)
-      frombuf(fBufCur, &h[i]);
-# endif
-#else
-   memcpy(h, fBufCur, l);
-   fBufCur += l;
-#endif
+   frombuf(fBufCur, h, n);
 
    return n;
 }
@@ -1032,18 +1062,7 @@ Int_t TBufferFile::ReadStaticArray(Int_t *ii)
 
    if (!ii) return 0;
 
-#ifdef R__BYTESWAP
-# ifdef USE_BSWAPCPY
-   bswapcpy32(ii, fBufCur, n);
-   fBufCur += sizeof(Int_t)*n;
-# else
-   for (int i = 0; i < n; i++)
-      frombuf(fBufCur, &ii[i]);
-# endif
-#else
-   memcpy(ii, fBufCur, l);
-   fBufCur += l;
-#endif
+   frombuf(fBufCur, ii, n);
 
    return n;
 }
@@ -1089,13 +1108,7 @@ Int_t TBufferFile::ReadStaticArray(Long64_t *ll)
 
    if (!ll) return 0;
 
-#ifdef R__BYTESWAP
-   for (int i = 0; i < n; i++)
-      frombuf(fBufCur, &ll[i]);
-#else
-   memcpy(ll, fBufCur, l);
-   fBufCur += l;
-#endif
+   frombuf(fBufCur, ll, n);
 
    return n;
 }
@@ -1116,18 +1129,7 @@ Int_t TBufferFile::ReadStaticArray(Float_t *f)
 
    if (!f) return 0;
 
-#ifdef R__BYTESWAP
-# ifdef USE_BSWAPCPY
-   bswapcpy32(f, fBufCur, n);
-   fBufCur += sizeof(Float_t)*n;
-# else
-   for (int i = 0; i < n; i++)
-      frombuf(fBufCur, &f[i]);
-# endif
-#else
-   memcpy(f, fBufCur, l);
-   fBufCur += l;
-#endif
+   frombuf(fBufCur, f, n);
 
    return n;
 }
@@ -1148,13 +1150,7 @@ Int_t TBufferFile::ReadStaticArray(Double_t *d)
 
    if (!d) return 0;
 
-#ifdef R__BYTESWAP
-   for (int i = 0; i < n; i++)
-      frombuf(fBufCur, &d[i]);
-#else
-   memcpy(d, fBufCur, l);
-   fBufCur += l;
-#endif
+   frombuf(fBufCur, d, n);
 
    return n;
 }
@@ -1266,18 +1262,7 @@ void TBufferFile::ReadFastArray(Short_t *h, Int_t n)
    Int_t l = sizeof(Short_t)*n;
    if (n <= 0 || l > fBufSize) return;
 
-#ifdef R__BYTESWAP
-# ifdef USE_BSWAPCPY
-   bswapcpy16(h, fBufCur, n);
-   fBufCur += sizeof(Short_t)*n;
-# else
-   for (int i = 0; i < n; i++)
-      frombuf(fBufCur, &h[i]);
-# endif
-#else
-   memcpy(h, fBufCur, l);
-   fBufCur += l;
-#endif
+   frombuf(fBufCur, h, n);
 }
 
 //______________________________________________________________________________
@@ -1288,18 +1273,7 @@ void TBufferFile::ReadFastArray(Int_t *ii, Int_t n)
    Int_t l = sizeof(Int_t)*n;
    if (l <= 0 || l > fBufSize) return;
 
-#ifdef R__BYTESWAP
-# ifdef USE_BSWAPCPY
-   bswapcpy32(ii, fBufCur, n);
-   fBufCur += sizeof(Int_t)*n;
-# else
-   for (int i = 0; i < n; i++)
-      frombuf(fBufCur, &ii[i]);
-# endif
-#else
-   memcpy(ii, fBufCur, l);
-   fBufCur += l;
-#endif
+   frombuf(fBufCur, ii, n);
 }
 
 //______________________________________________________________________________
@@ -1326,13 +1300,7 @@ void TBufferFile::ReadFastArray(Long64_t *ll, Int_t n)
    Int_t l = sizeof(Long64_t)*n;
    if (l <= 0 || l > fBufSize) return;
 
-#ifdef R__BYTESWAP
-   for (int i = 0; i < n; i++)
-      frombuf(fBufCur, &ll[i]);
-#else
-   memcpy(ll, fBufCur, l);
-   fBufCur += l;
-#endif
+   frombuf(fBufCur, ll, n);
 }
 
 //______________________________________________________________________________
@@ -1343,18 +1311,7 @@ void TBufferFile::ReadFastArray(Float_t *f, Int_t n)
    Int_t l = sizeof(Float_t)*n;
    if (l <= 0 || l > fBufSize) return;
 
-#ifdef R__BYTESWAP
-# ifdef USE_BSWAPCPY
-   bswapcpy32(f, fBufCur, n);
-   fBufCur += sizeof(Float_t)*n;
-# else
-   for (int i = 0; i < n; i++)
-      frombuf(fBufCur, &f[i]);
-# endif
-#else
-   memcpy(f, fBufCur, l);
-   fBufCur += l;
-#endif
+   frombuf(fBufCur, f, n);
 }
 
 //______________________________________________________________________________
@@ -1365,13 +1322,7 @@ void TBufferFile::ReadFastArray(Double_t *d, Int_t n)
    Int_t l = sizeof(Double_t)*n;
    if (l <= 0 || l > fBufSize) return;
 
-#ifdef R__BYTESWAP
-   for (int i = 0; i < n; i++)
-      frombuf(fBufCur, &d[i]);
-#else
-   memcpy(d, fBufCur, l);
-   fBufCur += l;
-#endif
+   frombuf(fBufCur, d, n);
 }
 
 //______________________________________________________________________________
@@ -1384,33 +1335,14 @@ void TBufferFile::ReadFastArrayFloat16(Float_t *f, Int_t n, TStreamerElement *el
 
    if (ele && ele->GetFactor() != 0) {
       //a range was specified. We read an integer and convert it back to a float
-      Double_t xmin = ele->GetXmin();
-      Double_t factor = ele->GetFactor();
-      for (int j=0;j < n; j++) {
-         UInt_t aint; *this >> aint; f[j] = (Float_t)(aint/factor + xmin);
-      }
+      ReadArrayWithFactor(fBufCur, f, n, ele->GetFactor(), ele->GetXmin());
    } else {
-      Int_t i;
       Int_t nbits = 0;
       if (ele) nbits = (Int_t)ele->GetXmin();
       if (!nbits) nbits = 12;
       //we read the exponent and the truncated mantissa of the float
       //and rebuild the new float.
-      union {
-         Float_t fFloatValue;
-         Int_t   fIntValue;
-      };
-      UChar_t  theExp;
-      UShort_t theMan;
-      for (i = 0; i < n; i++) {
-         *this >> theExp;
-         *this >> theMan;
-         fIntValue = theExp;
-         fIntValue <<= 23;
-         fIntValue |= (theMan & ((1<<(nbits+1))-1)) <<(23-nbits);
-         if(1<<(nbits+1) & theMan) fFloatValue = -fFloatValue;
-         f[i] = fFloatValue;
-      }
+      ReadArrayWithNbits(fBufCur, f, n, nbits);
    }
 }
 
@@ -1423,9 +1355,7 @@ void TBufferFile::ReadFastArrayWithFactor(Float_t *ptr, Int_t n, Double_t factor
    if (n <= 0 || 3*n > fBufSize) return;
 
    //a range was specified. We read an integer and convert it back to a float
-   for (int j=0;j < n; j++) {
-      UInt_t aint; *this >> aint; ptr[j] = (Float_t)(aint/factor + minvalue);
-   }
+   ReadArrayWithFactor(fBufCur, ptr, n, factor, minvalue);
 }
 
 //______________________________________________________________________________
@@ -1439,21 +1369,7 @@ void TBufferFile::ReadFastArrayWithNbits(Float_t *ptr, Int_t n, Int_t nbits)
    if (!nbits) nbits = 12;
    //we read the exponent and the truncated mantissa of the float
    //and rebuild the new float.
-   union {
-      Float_t fFloatValue;
-      Int_t   fIntValue;
-   };
-   UChar_t  theExp;
-   UShort_t theMan;
-   for (Int_t i = 0; i < n; i++) {
-      *this >> theExp;
-      *this >> theMan;
-      fIntValue = theExp;
-      fIntValue <<= 23;
-      fIntValue |= (theMan & ((1<<(nbits+1))-1)) <<(23-nbits);
-      if(1<<(nbits+1) & theMan) fFloatValue = -fFloatValue;
-      ptr[i] = fFloatValue;
-   }
+   ReadArrayWithNbits(fBufCur, ptr, n, nbits);
 }
 
 //______________________________________________________________________________
@@ -1466,40 +1382,22 @@ void TBufferFile::ReadFastArrayDouble32(Double_t *d, Int_t n, TStreamerElement *
 
    if (ele && ele->GetFactor() != 0) {
       //a range was specified. We read an integer and convert it back to a double.
-      Double_t xmin = ele->GetXmin();
-      Double_t factor = ele->GetFactor();
-      for (int j=0;j < n; j++) {
-         UInt_t aint; *this >> aint; d[j] = (Double_t)(aint/factor + xmin);
-      }
+      ReadArrayWithFactor(fBufCur, d, n, ele->GetFactor(), ele->GetXmin());
    } else {
-      Int_t i;
       Int_t nbits = 0;
       if (ele) nbits = (Int_t)ele->GetXmin();
       if (!nbits) {
          //we read a float and convert it to double
-         Float_t afloat;
-         for (i = 0; i < n; i++) {
-            *this >> afloat;
-            d[i] = (Double_t)afloat;
+         Float_t afloat[kConvertChunk];
+         for (Int_t i = 0; i < n; i += kConvertChunk) {
+            Int_t k = n - i < kConvertChunk ? n - i : kConvertChunk;
+            frombuf(fBufCur, afloat, k);
+            for (Int_t j = 0; j < k; j++) d[i+j] = (Double_t)afloat[j];
          }
       } else {
          //we read the exponent and the truncated mantissa of the float
          //and rebuild the double.
-         union {
-            Float_t fFloatValue;
-            Int_t   fIntValue;
-         };
-         UChar_t  theExp;
-         UShort_t theMan;
-         for (i = 0; i < n; i++) {
-            *this >> theExp;
-            *this >> theMan;
-            fIntValue = theExp;
-            fIntValue <<= 23;
-            fIntValue |= (theMan & ((1<<(nbits+1))-1)) <<(23-nbits);
-            if (1<<(nbits+1) & theMan) fFloatValue = -fFloatValue;
-            d[i] = (Double_t)fFloatValue;
-         }
+         ReadArrayWithNbits(fBufCur, d, n, nbits);
       }
    }
 }
@@ -1513,9 +1411,7 @@ void TBufferFile::ReadFastArrayWithFactor(Double_t *d, Int_t n, Double_t factor,
    if (n <= 0 || 3*n > fBufSize) return;
 
    //a range was specified. We read an integer and convert it back to a double.
-   for (int j=0;j < n; j++) {
-      UInt_t aint; *this >> aint; d[j] = (Double_t)(aint/factor + minvalue);
-   }
+   ReadArrayWithFactor(fBufCur, d, n, factor, minvalue);
 }
 
 //______________________________________________________________________________
@@ -1528,29 +1424,16 @@ void TBufferFile::ReadFastArrayWithNbits(Double_t *d, Int_t n, Int_t nbits)
 
    if (!nbits) {
       //we read a float and convert it to double
-      Float_t afloat;
-      for (Int_t i = 0; i < n; i++) {
-         *this >> afloat;
-         d[i] = (Double_t)afloat;
+      Float_t afloat[kConvertChunk];
+      for (Int_t i = 0; i < n; i += kConvertChunk) {
+         Int_t k = n - i < kConvertChunk ? n - i : kConvertChunk;
+         frombuf(fBufCur, afloat, k);
+         for (Int_t j = 0; j < k; j++) d[i+j] = (Double_t)afloat[j];
       }
    } else {
       //we read the exponent and the truncated mantissa of the float
       //and rebuild the double.
-      union {
-         Float_t fFloatValue;
-         Int_t   fIntValue;
-      };
-      UChar_t  theExp;
-      UShort_t theMan;
-      for (Int_t i = 0; i < n; i++) {
-         *this >> theExp;
-         *this >> theMan;
-         fIntValue = theExp;
-         fIntValue <<= 23;
-         fIntValue |= (theMan & ((1<<(nbits+1))-1)) <<(23-nbits);
-         if (1<<(nbits+1) & theMan) fFloatValue = -fFloatValue;
-         d[i] = (Double_t)fFloatValue;
-      }
+      ReadArrayWithNbits(fBufCur, d, n, nbits);
    }
 }
 
@@ -1698,18 +1581,7 @@ void TBufferFile::WriteArray(const Short_t *h, Int_t n)
    Int_t l = sizeof(Short_t)*n;
    if (fBufCur + l > fBufMax) AutoExpand(fBufSize+l);
 
-#ifdef R__BYTESWAP
-# ifdef USE_BSWAPCPY
-   bswapcpy16(fBufCur, h, n);
-   fBufCur += l;
-# else
-   for (int i = 0; i < n; i++)
-      tobuf(fBufCur, h[i]);
-# endif
-#else
-   memcpy(fBufCur, h, l);
-   fBufCur += l;
-#endif
+   tobuf(fBufCur, h, n);
 }
 
 //______________________________________________________________________________
@@ -1728,18 +1600,7 @@ void TBufferFile::WriteArray(const Int_t *ii, Int_t n)
    Int_t l = sizeof(Int_t)*n;
    if (fBufCur + l > fBufMax) AutoExpand(fBufSize+l);
 
-#ifdef R__BYTESWAP
-# ifdef USE_BSWAPCPY
-   bswapcpy32(fBufCur, ii, n);
-   fBufCur += l;
-# else
-   for (int i = 0; i < n; i++)
-      tobuf(fBufCur, ii[i]);
-# endif
-#else
-   memcpy(fBufCur, ii, l);
-   fBufCur += l;
-#endif
+   tobuf(fBufCur, ii, n);
 }
 
 //______________________________________________________________________________
@@ -1796,13 +1657,7 @@ void TBufferFile::WriteArray(const Long64_t *ll, Int_t n)
    Int_t l = sizeof(Long64_t)*n;
    if (fBufCur + l > fBufMax) AutoExpand(fBufSize+l);
 
-#ifdef R__BYTESWAP
-   for (int i = 0; i < n; i++)
-      tobuf(fBufCur, ll[i]);
-#else
-   memcpy(fBufCur, ll, l);
-   fBufCur += l;
-#endif
+   tobuf(fBufCur, ll, n);
 }
 
 //______________________________________________________________________________
@@ -1821,18 +1676,7 @@ void TBufferFile::WriteArray(const Float_t *f, Int_t n)
    Int_t l = sizeof(Float_t)*n;
    if (fBufCur + l > fBufMax) AutoExpand(fBufSize+l);
 
-#ifdef R__BYTESWAP
-# ifdef USE_BSWAPCPY
-   bswapcpy32(fBufCur, f, n);
-   fBufCur += l;
-# else
-   for (int i = 0; i < n; i++)
-      tobuf(fBufCur, f[i]);
-# endif
-#else
-   memcpy(fBufCur, f, l);
-   fBufCur += l;
-#endif
+   tobuf(fBufCur, f, n);
 }
 
 //______________________________________________________________________________
@@ -1851,13 +1695,7 @@ void TBufferFile::WriteArray(const Double_t *d, Int_t n)
    Int_t l = sizeof(Double_t)*n;
    if (fBufCur + l > fBufMax) AutoExpand(fBufSize+l);
 
-#ifdef R__BYTESWAP
-   for (int i = 0; i < n; i++)
-      tobuf(fBufCur, d[i]);
-#else
-   memcpy(fBufCur, d, l);
-   fBufCur += l;
-#endif
+   tobuf(fBufCur, d, n);
 }
 
 //______________________________________________________________________________
@@ -1964,18 +1802,7 @@ void TBufferFile::WriteFastArray(const Short_t *h, Int_t n)
    Int_t l = sizeof(Short_t)*n;
    if (fBufCur + l > fBufMax) AutoExpand(fBufSize+l);
 
-#ifdef R__BYTESWAP
-# ifdef USE_BSWAPCPY
-   bswapcpy16(fBufCur, h, n);
-   fBufCur += l;
-# else
-   for (int i = 0; i < n; i++)
-      tobuf(fBufCur, h[i]);
-# endif
-#else
-   memcpy(fBufCur, h, l);
-   fBufCur += l;
-#endif
+   tobuf(fBufCur, h, n);
 }
 
 //______________________________________________________________________________
@@ -1988,18 +1815,7 @@ void TBufferFile::WriteFastArray(const Int_t *ii, Int_t n)
    Int_t l = sizeof(Int_t)*n;
    if (fBufCur + l > fBufMax) AutoExpand(fBufSize+l);
 
-#ifdef R__BYTESWAP
-# ifdef USE_BSWAPCPY
-   bswapcpy32(fBufCur, ii, n);
-   fBufCur += l;
-# else
-   for (int i = 0; i < n; i++)
-      tobuf(fBufCur, ii[i]);
-# endif
-#else
-   memcpy(fBufCur, ii, l);
-   fBufCur += l;
-#endif
+   tobuf(fBufCur, ii, n);
 }
 
 //______________________________________________________________________________
@@ -2040,13 +1856,7 @@ void TBufferFile::WriteFastArray(const Long64_t *ll, Int_t n)
    Int_t l = sizeof(Long64_t)*n;
    if (fBufCur + l > fBufMax) AutoExpand(fBufSize+l);
 
-#ifdef R__BYTESWAP
-   for (int i = 0; i < n; i++)
-      tobuf(fBufCur, ll[i]);
-#else
-   memcpy(fBufCur, ll, l);
-   fBufCur += l;
-#endif
+   tobuf(fBufCur, ll, n);
 }
 
 //______________________________________________________________________________
@@ -2059,18 +1869,7 @@ void TBufferFile::WriteFastArray(const Float_t *f, Int_t n)
    Int_t l = sizeof(Float_t)*n;
    if (fBufCur + l > fBufMax) AutoExpand(fBufSize+l);
 
-#ifdef R__BYTESWAP
-# ifdef USE_BSWAPCPY
-   bswapcpy32(fBufCur, f, n);
-   fBufCur += l;
-# else
-   for (int i = 0; i < n; i++)
-      tobuf(fBufCur, f[i]);
-# endif
-#else
-   memcpy(fBufCur, f, l);
-   fBufCur += l;
-#endif
+   tobuf(fBufCur, f, n);
 }
 
 //______________________________________________________________________________
@@ -2083,13 +1882,7 @@ void TBufferFile::WriteFastArray(const Double_t *d, Int_t n)
    Int_t l = sizeof(Double_t)*n;
    if (fBufCur + l > fBufMax) AutoExpand(fBufSize+l);
 
-#ifdef R__BYTESWAP
-   for (int i = 0; i < n; i++)
-      tobuf(fBufCur, d[i]);
-#else
-   memcpy(fBufCur, d, l);
-   fBufCur += l;
-#endif
+   tobuf(fBufCur, d, n);
 }
 
 //______________________________________________________________________________
@@ -2107,39 +1900,16 @@ void TBufferFile::WriteFastArrayFloat16(const Float_t *f, Int_t n, TStreamerElem
       //A range is specified. We normalize the float to the range and
       //convert it to an integer using a scaling factor that is a function of nbits.
       //see TStreamerElement::GetRange.
-      Double_t factor = ele->GetFactor();
-      Double_t xmin = ele->GetXmin();
-      Double_t xmax = ele->GetXmax();
-      for (int j = 0; j < n; j++) {
-         Float_t x = f[j];
-         if (x < xmin) x = xmin;
-         if (x > xmax) x = xmax;
-         UInt_t aint = UInt_t(0.5+factor*(x-xmin)); *this << aint;
-      }
+      WriteArrayWithFactor(fBufCur, f, n, ele->GetFactor(), ele->GetXmin(), ele->GetXmax());
    } else {
       Int_t nbits = 0;
       //number of bits stored in fXmin (see TStreamerElement::GetRange)
       if (ele) nbits = (Int_t)ele->GetXmin();
       if (!nbits) nbits = 12;
-      Int_t i;
       //a range is not specified, but nbits is.
       //In this case we truncate the mantissa to nbits and we stream
       //the exponent as a UChar_t and the mantissa as a UShort_t.
-      union {
-         Float_t fFloatValue;
-         Int_t   fIntValue;
-      };
-      for (i = 0; i < n; i++) {
-         fFloatValue = f[i];
-         UChar_t  theExp = (UChar_t)(0x000000ff & ((fIntValue<<1)>>24));
-         UShort_t theMan = ((1<<(nbits+1))-1) & (fIntValue>>(23-nbits-1));
-         theMan++;
-         theMan = theMan>>1;
-         if (theMan&1<<nbits) theMan = (1<<nbits) - 1;
-         if (fFloatValue < 0) theMan |= 1<<(nbits+1);
-         *this << theExp;
-         *this << theMan;
-      }
+      WriteArrayWithNbits(fBufCur, f, n, nbits);
    }
 }
 
@@ -2158,45 +1928,24 @@ void TBufferFile::WriteFastArrayDouble32(const Double_t *d, Int_t n, TStreamerEl
       //A range is specified. We normalize the double to the range and
       //convert it to an integer using a scaling factor that is a function of nbits.
       //see TStreamerElement::GetRange.
-      Double_t factor = ele->GetFactor();
-      Double_t xmin = ele->GetXmin();
-      Double_t xmax = ele->GetXmax();
-      for (int j = 0; j < n; j++) {
-         Double_t x = d[j];
-         if (x < xmin) x = xmin;
-         if (x > xmax) x = xmax;
-         UInt_t aint = UInt_t(0.5+factor*(x-xmin)); *this << aint;
-      }
+      WriteArrayWithFactor(fBufCur, d, n, ele->GetFactor(), ele->GetXmin(), ele->GetXmax());
    } else {
       Int_t nbits = 0;
       //number of bits stored in fXmin (see TStreamerElement::GetRange)
       if (ele) nbits = (Int_t)ele->GetXmin();
-      Int_t i;
       if (!nbits) {
          //if no range and no bits specified, we convert from double to float
-         for (i = 0; i < n; i++) {
-            Float_t afloat = (Float_t)d[i];
-            *this << afloat;
+         Float_t afloat[kConvertChunk];
+         for (Int_t i = 0; i < n; i += kConvertChunk) {
+            Int_t k = n - i < kConvertChunk ? n - i : kConvertChunk;
+            for (Int_t j = 0; j < k; j++) afloat[j] = (Float_t)d[i+j];
+            tobuf(fBufCur, afloat, k);
          }
       } else {
          //a range is not specified, but nbits is.
          //In this case we truncate the mantissa to nbits and we stream
          //the exponent as a UChar_t and the mantissa as a UShort_t.
-         union {
-            Float_t fFloatValue;
-            Int_t   fIntValue;
-         };
-         for (i = 0; i < n; i++) {
-            fFloatValue = (Float_t)d[i];
-            UChar_t  theExp = (UChar_t)(0x000000ff & ((fIntValue<<1)>>24));
-            UShort_t theMan = ((1<<(nbits+1))-1) & (fIntValue>>(23-nbits-1));
-            theMan++;
-            theMan = theMan>>1;
-            if(theMan&1<<nbits) theMan = (1<<nbits) - 1;
-            if (fFloatValue < 0) theMan |= 1<<(nbits+1);
-            *this << theExp;
-            *this << theMan;
-         }
+         WriteArrayWithNbits(fBufCur, d, n, nbits);
       }
    }
 }
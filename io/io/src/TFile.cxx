@@ -70,6 +70,7 @@
 #include <sys/stat.h>
 #ifndef WIN32
 #   include <unistd.h>
+#   include <sys/mman.h>
 #else
 #   define ssize_t int
 #   include <io.h>
@@ -88,6 +89,7 @@
 #include "TDatime.h"
 #include "TError.h"
 #include "TFile.h"
+#include "TFileBlockCache.h"
 #include "TFileCacheRead.h"
 #include "TFileCacheWrite.h"
 #include "TFree.h"
@@ -135,6 +137,8 @@ Bool_t   TFile::fgOnlyStaged = 0;
 
 const Int_t kBEGIN = 100;
 
+static TVirtualMutex *gBlockCacheCreateMutex = 0; // protects the creation of fBlockCache
+
 ClassImp(TFile)
 
 //*-*x17 macros/layout_file
@@ -159,6 +163,9 @@ TFile::TFile() : TDirectoryFile(), fInfoCache(0)
    fCacheReadMap    = new TMap();
    fCacheWrite      = 0;
    fArchiveOffset   = 0;
+   fMapAddress      = 0;
+   fMapSize         = 0;
+   fBlockCache      = 0;
    fReadCalls       = 0;
    fInfoCache       = 0;
    fOpenPhases      = 0;
@@ -353,6 +360,9 @@ TFile::TFile(const char *fname1, Option_t *option, const char *ftitle, Int_t com
    fArchiveOffset = 0;
    fIsArchive     = kFALSE;
    fArchive       = 0;
+   fMapAddress    = 0;
+   fMapSize       = 0;
+   fBlockCache    = 0;
    if (fIsRootFile) {
       fArchive = TArchiveFile::Open(fUrl.GetUrl(), this);
       if (fArchive) {
@@ -510,6 +520,7 @@ TFile::~TFile()
    SafeDelete(fCacheRead);
    SafeDelete(fCacheReadMap);   
    SafeDelete(fCacheWrite);
+   SafeDelete(fBlockCache);
    SafeDelete(fProcessIDs);
    SafeDelete(fFree);
    SafeDelete(fArchive);
@@ -794,6 +805,10 @@ void TFile::Init(Bool_t create)
       }
    }
 
+   if (!create && !fWritable && IsA() == TFile::Class() && gEnv->GetValue("TFile.MemoryMap", 0)) {
+      SetMemoryMap(kTRUE);
+   }
+
    {
       R__LOCKGUARD2(gROOTMutex);
       gROOT->GetListOfFiles()->Add(this);
@@ -861,6 +876,7 @@ void TFile::Close(Option_t *option)
 
    if (fIsArchive || !fIsRootFile) {
       FlushWriteCache();
+      SetMemoryMap(kFALSE);
       SysClose(fD);
       fD = -1;
 
@@ -911,6 +927,9 @@ void TFile::Close(Option_t *option)
       fFree->Delete();
    }
 
+   // The trees, and so the baskets pointing into the mapping, are gone.
+   SetMemoryMap(kFALSE);
+
    if (IsOpen()) {
       SysClose(fD);
       fD = -1;
@@ -1155,6 +1174,19 @@ TFileCacheWrite *TFile::GetCacheWrite() const
    return fCacheWrite;
 }
 
+//______________________________________________________________________________
+char *TFile::GetMapBuffer(Long64_t pos, Int_t len) const
+{
+   // Return the address of the len bytes at offset pos of the file in its
+   // memory mapping (see SetMemoryMap), or 0 if the file is not mapped or
+   // the bytes are not part of the mapping.
+
+   if (!fMapAddress || fWritable || pos < 0 || len < 0) return 0;
+   Long64_t off = pos + fArchiveOffset;
+   if (off + len > fMapSize) return 0;
+   return fMapAddress + off;
+}
+
 //______________________________________________________________________________
 Int_t TFile::GetRecordHeader(char *buf, Long64_t first, Int_t maxbytes, Int_t &nbytes, Int_t &objlen, Int_t &keylen)
 {
@@ -1487,6 +1519,15 @@ Bool_t TFile::ReadBuffer(char *buf, Long64_t pos, Int_t len)
          return kFALSE;
       }
 
+      const char *mapped = GetMapBuffer(pos, len);
+      if (mapped) {
+         // No system call for memory mapped files.
+         memcpy(buf, mapped, len);
+         fOffset = pos + fArchiveOffset + len;
+         CountMapRead(len, start);
+         return kFALSE;
+      }
+
       Seek(pos);
       ssize_t siz;
 
@@ -1583,6 +1624,25 @@ Bool_t TFile::ReadBuffers(char *buf, Long64_t *pos, Int_t *len, Int_t nbuf)
       return kFALSE;
    }
 
+   if (fMapAddress) {
+      // Memory mapped file: copy the blocks directly from the mapping.
+      Int_t j;
+      for (j = 0; j < nbuf; j++) {
+         if (!GetMapBuffer(pos[j], len[j])) break;
+      }
+      if (j == nbuf) {
+         Double_t start = 0;
+         if (gPerfStats != 0) start = TTimeStamp();
+         Int_t k = 0;
+         for (j = 0; j < nbuf; j++) {
+            memcpy(&buf[k], GetMapBuffer(pos[j], len[j]), len[j]);
+            k += len[j];
+         }
+         CountMapRead(k, start);
+         return kFALSE;
+      }
+   }
+
    Int_t k = 0;
    Bool_t result = kTRUE;
    TFileCacheRead *old = fCacheRead;
@@ -1667,6 +1727,43 @@ Int_t TFile::ReadBufferViaCache(char *buf, Int_t len)
    return 0;
 }
 
+//______________________________________________________________________________
+Int_t TFile::ReadBufferViaBlockCache(char *buf, Int_t len)
+{
+   // Read buffer at the current offset via the local block cache (see
+   // TFileBlockCache). Returns 0 if the block cache is not used, 1 in
+   // case the read was successful, 2 in case it failed.
+
+   Long64_t off = GetRelOffset();
+   Int_t st = ReadBuffersViaBlockCache(buf, &off, &len, 1);
+   if (st == 1)
+      SetOffset(off + len);
+   return st;
+}
+
+//______________________________________________________________________________
+Int_t TFile::ReadBuffersViaBlockCache(char *buf, Long64_t *pos, Int_t *len, Int_t nbuf)
+{
+   // Read the nbuf blocks described in arrays pos and len via the local
+   // block cache, which is created the first time it is needed if a cache
+   // directory is set (see TFileBlockCache::SetDirectory). Only the remote
+   // files opened for reading, and not being archive members, use it.
+   // The cache is created under a lock, since the file may be read by
+   // several threads at once (e.g. the TTreeCache read-ahead).
+   // Returns 0 if the block cache is not used, 1 in case the read was
+   // successful, 2 in case it failed.
+
+   if (!buf) return 0;
+   if (!fBlockCache) {
+      if (!fInitDone || fWritable || fArchiveOffset || !TFileBlockCache::GetDirectory())
+         return 0;
+      R__LOCKGUARD2(gBlockCacheCreateMutex);
+      if (!fBlockCache)
+         fBlockCache = new TFileBlockCache(this);
+   }
+   return fBlockCache->ReadBuffers(buf, pos, len, nbuf);
+}
+
 //______________________________________________________________________________
 void TFile::ReadFree()
 {
@@ -2078,6 +2175,67 @@ void TFile::SetCompressionSettings(Int_t settings)
    fCompress = settings;
 }
 
+//______________________________________________________________________________
+Bool_t TFile::SetMemoryMap(Bool_t map)
+{
+   // Map (map=kTRUE) or unmap the file in memory. Only local files opened
+   // in read mode can be mapped. The mapping can also be requested for all
+   // the files opened in read mode with the resource TFile.MemoryMap.
+   //
+   // The reads of a memory mapped file are copies from the mapping instead
+   // of system calls, and the baskets of the branches which are not
+   // compressed point directly into the mapping (see TBasket::ReadBasketBuffers),
+   // avoiding the copy altogether. This is useful when the same local,
+   // uncompressed, files are analysed several times, since the system keeps
+   // their pages in memory.
+   // The mapping is private: the data are byte swapped when they are read
+   // from the buffers and the file is never modified; a page written to
+   // in memory would be copied by the system.
+   //
+   // Since baskets may point into the mapping, it is only removed when the
+   // file is closed, after the deletion of its trees.
+   // Returns kTRUE if the file is mapped (or unmapped if map=kFALSE).
+
+#ifndef WIN32
+   if (!map) {
+      if (fMapAddress) {
+         munmap(fMapAddress, (size_t)fMapSize);
+         fMapAddress = 0;
+         fMapSize    = 0;
+      }
+      return kTRUE;
+   }
+   if (fMapAddress) return kTRUE;
+   if (IsA() != TFile::Class() || !IsOpen() || IsWritable()) {
+      Warning("SetMemoryMap", "only local files opened in read mode can be mapped (%s)", GetName());
+      return kFALSE;
+   }
+
+   Long_t id, flags, modtime;
+   Long64_t size;
+   if (SysStat(fD, &id, &size, &flags, &modtime) || size <= 0) {
+      return kFALSE;
+   }
+   if ((ULong64_t)size != (ULong64_t)(size_t)size) {
+      Warning("SetMemoryMap", "file %s is too large to be mapped", GetName());
+      return kFALSE;
+   }
+   void *addr = mmap(0, (size_t)size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fD, 0);
+   if (addr == MAP_FAILED) {
+      SysError("SetMemoryMap", "cannot map file %s", GetName());
+      return kFALSE;
+   }
+   fMapAddress = (char*)addr;
+   fMapSize    = size;
+   if (gDebug > 0)
+      Info("SetMemoryMap", "mapped %lld bytes of %s", fMapSize, GetName());
+   return kTRUE;
+#else
+   if (map) Warning("SetMemoryMap", "memory mapped files are not supported on this platform");
+   return !map;
+#endif
+}
+
 //______________________________________________________________________________
 void TFile::SetCacheRead(TFileCacheRead *cache, TObject* tree)
 {
@@ -4746,6 +4904,27 @@ copyout:
    return success;
 }
 
+//______________________________________________________________________________
+void TFile::CountMapRead(Int_t len, Double_t start)
+{
+   // Account for len bytes taken from the memory mapping of the file (see
+   // SetMemoryMap) instead of being read, as ReadBuffer does for a read:
+   // update the byte and call counters, the monitoring and gPerfStats.
+   // start is the time at which the copy started (see TTimeStamp), it is
+   // only used if gPerfStats is set.
+
+   fBytesRead  += len;
+   fgBytesRead += len;
+   fReadCalls++;
+   fgReadCalls++;
+
+   if (gMonitoringWriter)
+      gMonitoringWriter->SendFileReadProgress(this);
+   if (gPerfStats != 0) {
+      gPerfStats->FileReadEvent(this, len, start);
+   }
+}
+
 //______________________________________________________________________________
 Bool_t TFile::Cp(const char *src, const char *dst, Bool_t progressbar,
                  UInt_t buffersize)
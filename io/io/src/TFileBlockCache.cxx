@@ -0,0 +1,422 @@
+// @(#)root/io:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2012, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TFileBlockCache                                                      //
+//                                                                      //
+// Cache on the local disk (typically an SSD) of the blocks read from   //
+// the remote files (TWebFile, TNetFile, TXNetFile). Contrary to the    //
+// "CACHEREAD" option of TFile::Open, which copies the whole file       //
+// before opening it, only the blocks actually read are stored, so      //
+// that the jobs reading a few branches of the same files over and      //
+// over do not download them again.                                     //
+//                                                                      //
+// The file is divided in blocks of kBlockSize bytes. The requests of   //
+// ReadBuffer and ReadBuffers are extended to whole blocks; the blocks  //
+// found in the cache are read from the local disk and the missing      //
+// ones are read from the remote file in a single ReadBuffers call and  //
+// then stored. Each block is a file named after its index in the       //
+// directory <cachedir>/<uuid>.<end> of the remote file, where uuid is  //
+// the UUID of the file and end its size (to avoid using the blocks of  //
+// a file updated since they were cached).                              //
+//                                                                      //
+// The cache directory may be shared by several processes: a block is   //
+// written to a temporary file renamed once complete, so that a reader  //
+// never sees a partial block. The modification time of a block is      //
+// updated each time it is read. When the directory grows beyond the    //
+// maximum size, the least recently used blocks are removed by Evict,   //
+// under the protection of a TLockFile, together with the directories   //
+// left empty.                                                          //
+//                                                                      //
+// Within a process, the reads of a file through its cache are          //
+// serialized: the blocks of a request are looked up, fetched and       //
+// stored by one thread at a time.                                      //
+//                                                                      //
+// The cache is enabled with SetDirectory or with the rootrc resources  //
+//    TFile.BlockCacheDir:    /ssd/rootcache                            //
+//    TFile.BlockCacheSize:   10000                                     //
+// (the size is in MBytes). The files opened when the cache directory   //
+// is set use the cache.                                                //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#include "TFileBlockCache.h"
+#include "TFile.h"
+#include "TEnv.h"
+#include "TSystem.h"
+#include "TLockFile.h"
+#include "TMath.h"
+#include "TVirtualMutex.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <vector>
+
+TString  TFileBlockCache::fgDirectory;
+Long64_t TFileBlockCache::fgMaxSize = -1;
+Long64_t TFileBlockCache::fgWritten = 0;
+Bool_t   TFileBlockCache::fgInit    = kFALSE;
+
+static TVirtualMutex *gBlockCacheMutex = 0; // protects the static members
+
+namespace {
+   // A block file of the cache directory, for the eviction.
+   struct BlockFile_t {
+      Long_t   fMtime;
+      Long64_t fSize;
+      Int_t    fDir;   // index of the directory of the block
+      TString  fPath;
+      bool operator<(const BlockFile_t &b) const { return fMtime < b.fMtime; }
+   };
+}
+
+ClassImp(TFileBlockCache)
+
+//______________________________________________________________________________
+TFileBlockCache::TFileBlockCache(TFile *file) :
+   fFile(file), fFetching(kFALSE), fNHits(0), fNMisses(0), fMutex(0)
+{
+   // Create the cache of the blocks of file. The file must have been
+   // initialized (its UUID and size are known) and the cache directory
+   // must be set (see SetDirectory). If the directory of the blocks of
+   // the file cannot be created the cache is not used.
+
+   const char *dir = GetDirectory();
+   if (!dir || !file) return;
+   fDir.Form("%s/%s.%lld", dir, file->GetUUID().AsString(), file->GetEND());
+   if (gSystem->AccessPathName(fDir, kFileExists) && gSystem->mkdir(fDir, kTRUE) &&
+       gSystem->AccessPathName(fDir, kFileExists)) {
+      Warning("TFileBlockCache", "cannot create the block cache directory %s", fDir.Data());
+      fDir = "";
+   }
+}
+
+//______________________________________________________________________________
+TFileBlockCache::~TFileBlockCache()
+{
+   // Destructor.
+
+   delete fMutex;
+}
+
+//______________________________________________________________________________
+void TFileBlockCache::Evict()
+{
+   // Static function removing the least recently used blocks from the
+   // cache directory, until it uses less than 90% of GetMaxSize(), and
+   // then the directories without any block left.
+   // The blocks of all the files (and of all the processes) sharing the
+   // directory are considered. Only one process at a time scans the
+   // directory; a lock older than one minute is considered stale.
+
+   const char *dir = GetDirectory();
+   Long64_t maxsize = GetMaxSize();
+   {
+      R__LOCKGUARD2(gBlockCacheMutex);
+      fgWritten = 0;
+   }
+   if (!dir || maxsize <= 0) return;
+
+   TString topdir = dir;
+   TLockFile lock(topdir + "/.lock", 60);
+
+   std::vector<BlockFile_t> blocks;
+   std::vector<TString>     subdirs;
+   std::vector<Int_t>       nblocks;   // number of blocks left in each directory
+   Long64_t total = 0;
+
+   void *dirp = gSystem->OpenDirectory(topdir);
+   if (!dirp) return;
+   const char *ent;
+   while ((ent = gSystem->GetDirEntry(dirp))) {
+      if (ent[0] == '.') continue;
+      TString subdir = topdir + "/" + ent;
+      FileStat_t st;
+      if (gSystem->GetPathInfo(subdir, st) || !R_ISDIR(st.fMode)) continue;
+      void *subp = gSystem->OpenDirectory(subdir);
+      if (!subp) continue;
+      subdirs.push_back(subdir);
+      nblocks.push_back(0);
+      const char *name;
+      while ((name = gSystem->GetDirEntry(subp))) {
+         if (name[0] == '.') continue;
+         BlockFile_t b;
+         b.fPath = subdir + "/" + name;
+         if (gSystem->GetPathInfo(b.fPath, st)) continue;
+         b.fMtime = st.fMtime;
+         b.fSize  = st.fSize;
+         b.fDir   = subdirs.size() - 1;
+         total += b.fSize;
+         nblocks.back()++;
+         blocks.push_back(b);
+      }
+      gSystem->FreeDirectory(subp);
+   }
+   gSystem->FreeDirectory(dirp);
+
+   Long64_t target = maxsize / 10 * 9;
+   Int_t nremoved = 0;
+   if (total > target) {
+      std::sort(blocks.begin(), blocks.end());
+      for (UInt_t i = 0; i < blocks.size() && total > target; ++i) {
+         if (!gSystem->Unlink(blocks[i].fPath)) {
+            total -= blocks[i].fSize;
+            nblocks[blocks[i].fDir]--;
+            ++nremoved;
+         }
+      }
+   }
+   // The files still open recreate their directory when they store a
+   // block again (see WriteBlock).
+   Int_t ndirs = 0;
+   for (UInt_t d = 0; d < subdirs.size(); ++d) {
+      if (nblocks[d] == 0 && !gSystem->Unlink(subdirs[d])) ++ndirs;
+   }
+   if (gDebug > 0)
+      ::Info("TFileBlockCache::Evict", "removed %d blocks and %d directories from %s, %lld bytes left",
+             nremoved, ndirs, dir, total);
+}
+
+//______________________________________________________________________________
+TString TFileBlockCache::GetBlockPath(Long64_t block) const
+{
+   // Return the name of the file holding the given block.
+
+   return TString::Format("%s/%lld", fDir.Data(), block);
+}
+
+//______________________________________________________________________________
+const char *TFileBlockCache::GetDirectory()
+{
+   // Static function returning the cache directory, or 0 if the cache
+   // is disabled.
+
+   Init();
+   return fgDirectory.IsNull() ? 0 : fgDirectory.Data();
+}
+
+//______________________________________________________________________________
+Long64_t TFileBlockCache::GetMaxSize()
+{
+   // Static function returning the maximum size (in bytes) of the cache
+   // directory.
+
+   Init();
+   return fgMaxSize;
+}
+
+//______________________________________________________________________________
+void TFileBlockCache::Init()
+{
+   // Read the settings not given with SetDirectory from the rootrc
+   // resources TFile.BlockCacheDir and TFile.BlockCacheSize (in MBytes).
+
+   R__LOCKGUARD2(gBlockCacheMutex);
+   if (fgInit) return;
+   fgInit = kTRUE;
+   if (fgDirectory.IsNull()) {
+      const char *dir = gEnv->GetValue("TFile.BlockCacheDir", "");
+      if (dir && strlen(dir))
+         SetDirectory(dir, fgMaxSize > 0 ? fgMaxSize : 0);
+   }
+   if (fgMaxSize < 0)
+      fgMaxSize = Long64_t(gEnv->GetValue("TFile.BlockCacheSize", 1024)) * 1024 * 1024;
+}
+
+//______________________________________________________________________________
+void TFileBlockCache::Print(Option_t *) const
+{
+   // Print the number of blocks found in the cache and read from the file.
+
+   printf("******TFileBlockCache statistics for file: %s ******\n", fFile ? fFile->GetName() : "");
+   printf("Block directory................: %s\n", fDir.Data());
+   printf("Number of blocks found in cache: %lld\n", fNHits);
+   printf("Number of blocks read from file: %lld\n", fNMisses);
+   printf("Maximum size of the cache......: %lld\n", GetMaxSize());
+}
+
+//______________________________________________________________________________
+Bool_t TFileBlockCache::ReadBlock(Long64_t block, char *buf, Int_t len) const
+{
+   // Read the block from the cache directory and mark it as recently
+   // used. Returns kFALSE if the block is not (or not entirely) cached.
+
+   TString path = GetBlockPath(block);
+   FILE *fp = fopen(path, "rb");
+   if (!fp) return kFALSE;
+   Bool_t ok = fread(buf, 1, len, fp) == (size_t)len;
+   fclose(fp);
+   if (ok)
+      gSystem->Utime(path, (Long_t)time(0), 0);
+   return ok;
+}
+
+//______________________________________________________________________________
+Int_t TFileBlockCache::ReadBuffers(char *buf, Long64_t *pos, Int_t *len, Int_t nbuf)
+{
+   // Read the nbuf blocks described in arrays pos and len into buf, as
+   // TFile::ReadBuffers does, through the cache.
+   // Returns 0 if the request cannot be served by the cache (the caller
+   // must read the file itself), 1 in case of success and 2 in case the
+   // missing blocks could not be read from the file.
+
+   if (fDir.IsNull() || nbuf <= 0) return 0;
+
+   // The block files and fFetching are used by one thread at a time. The
+   // lock is recursive: the read of the missing blocks by the file comes
+   // back here with fFetching set, and is not served by the cache.
+   R__LOCKGUARD2(fMutex);
+   if (fFetching) return 0;
+
+   const Long64_t end = fFile->GetEND();
+   std::vector<Long64_t> blocks;
+   for (Int_t i = 0; i < nbuf; ++i) {
+      if (len[i] <= 0) continue;
+      if (pos[i] < 0 || pos[i] + len[i] > end) return 0;
+      for (Long64_t b = pos[i] / kBlockSize; b <= (pos[i] + len[i] - 1) / kBlockSize; ++b)
+         blocks.push_back(b);
+   }
+   std::sort(blocks.begin(), blocks.end());
+   blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
+   if (blocks.empty()) return 0;
+
+   // Read the cached blocks and list the missing ones.
+   const Int_t nblocks = blocks.size();
+   std::vector<char>     data(Long64_t(nblocks) * kBlockSize);
+   std::vector<Int_t>    blen(nblocks);
+   std::vector<Int_t>    missing;
+   std::vector<Long64_t> mpos;
+   std::vector<Int_t>    mlen;
+   Long64_t              mbytes = 0;
+   for (Int_t k = 0; k < nblocks; ++k) {
+      Long64_t bpos = blocks[k] * kBlockSize;
+      blen[k] = Int_t(TMath::Min(Long64_t(kBlockSize), end - bpos));
+      if (ReadBlock(blocks[k], &data[Long64_t(k) * kBlockSize], blen[k])) {
+         ++fNHits;
+      } else {
+         missing.push_back(k);
+         mpos.push_back(bpos);
+         mlen.push_back(blen[k]);
+         mbytes += blen[k];
+         ++fNMisses;
+      }
+   }
+
+   if (!missing.empty()) {
+      // Read all the missing blocks at once from the file.
+      std::vector<char> fetched(mbytes);
+      fFetching = kTRUE;
+      Bool_t failed = fFile->ReadBuffers(&fetched[0], &mpos[0], &mlen[0], missing.size());
+      fFetching = kFALSE;
+      if (failed) return 2;
+      Long64_t off = 0;
+      for (UInt_t m = 0; m < missing.size(); ++m) {
+         Int_t k = missing[m];
+         memcpy(&data[Long64_t(k) * kBlockSize], &fetched[off], blen[k]);
+         WriteBlock(blocks[k], &fetched[off], blen[k]);
+         off += blen[k];
+      }
+      Bool_t evict;
+      {
+         R__LOCKGUARD2(gBlockCacheMutex);
+         evict = fgWritten > GetMaxSize() / 10;
+      }
+      if (evict)
+         Evict();
+   }
+
+   // Copy the requested buffers out of the blocks.
+   Long64_t k = 0;
+   for (Int_t i = 0; i < nbuf; ++i) {
+      Long64_t p    = pos[i];
+      Long64_t left = len[i];
+      while (left > 0) {
+         Long64_t b = p / kBlockSize;
+         Long64_t idx = std::lower_bound(blocks.begin(), blocks.end(), b) - blocks.begin();
+         Long64_t inblock = p - b * kBlockSize;
+         Long64_t n = TMath::Min(left, Long64_t(kBlockSize) - inblock);
+         memcpy(buf + k, &data[idx * kBlockSize + inblock], n);
+         k    += n;
+         p    += n;
+         left -= n;
+      }
+   }
+   return 1;
+}
+
+//______________________________________________________________________________
+Bool_t TFileBlockCache::SetDirectory(const char *dir, Long64_t maxsize)
+{
+   // Static function setting the directory where the blocks are cached,
+   // and if maxsize > 0 the maximum size (in bytes) it may use. The
+   // directory is created if needed. With an empty dir the cache is
+   // disabled for the files opened afterwards.
+   // Returns kFALSE if the directory is not writable by us.
+
+   R__LOCKGUARD2(gBlockCacheMutex);
+   fgInit = kTRUE;
+   if (maxsize > 0) fgMaxSize = maxsize;
+   if (fgMaxSize < 0)
+      fgMaxSize = Long64_t(gEnv->GetValue("TFile.BlockCacheSize", 1024)) * 1024 * 1024;
+
+   TString cached = dir;
+   while (cached.Length() > 1 && cached.EndsWith("/"))
+      cached.Remove(cached.Length() - 1);
+   if (cached.IsNull()) {
+      fgDirectory = "";
+      return kTRUE;
+   }
+   gSystem->ExpandPathName(cached);
+   if (gSystem->AccessPathName(cached, kFileExists)) {
+      gSystem->mkdir(cached, kTRUE);
+      if (gSystem->AccessPathName(cached, kFileExists)) {
+         ::Error("TFileBlockCache::SetDirectory", "no sufficient permissions on cache directory %s or cannot create it", dir);
+         fgDirectory = "";
+         return kFALSE;
+      }
+   }
+   if (gSystem->AccessPathName(cached, kWritePermission)) {
+      ::Error("TFileBlockCache::SetDirectory", "cache directory %s is not writable", dir);
+      fgDirectory = "";
+      return kFALSE;
+   }
+   fgDirectory = cached;
+   return kTRUE;
+}
+
+//______________________________________________________________________________
+void TFileBlockCache::WriteBlock(Long64_t block, const char *buf, Int_t len) const
+{
+   // Store the block in the cache directory. The block is written to a
+   // temporary file renamed once complete, so that the other processes
+   // never read a partial block. Errors are silently ignored: the block
+   // will simply be read again from the file next time.
+
+   TString path = GetBlockPath(block);
+   TString tmp  = TString::Format("%s.%d.tmp", path.Data(), gSystem->GetPid());
+   FILE *fp = fopen(tmp, "wb");
+   if (!fp) {
+      // The directory may have been removed by Evict.
+      gSystem->mkdir(fDir, kTRUE);
+      fp = fopen(tmp, "wb");
+   }
+   if (!fp) return;
+   Bool_t ok = fwrite(buf, 1, len, fp) == (size_t)len;
+   if (fclose(fp)) ok = kFALSE;
+   if (!ok || gSystem->Rename(tmp, path)) {
+      gSystem->Unlink(tmp);
+      return;
+   }
+   R__LOCKGUARD2(gBlockCacheMutex);
+   fgWritten += len;
+}
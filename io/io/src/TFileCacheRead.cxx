@@ -417,8 +417,9 @@ Int_t TFileCacheRead::ReadBufferExtPrefetch(char *buf, Long64_t pos, Int_t len,
    if (loc >= 0 && loc < fNseek && pos == fSeekSort[loc]) {
       if (buf && fPrefetch){
          // prefetch with the new method                  
-         fPrefetch->ReadBuffer(buf, pos, len);
-         return 1;
+         if (!fPrefetch->ReadBuffer(buf, pos, len)) {
+            return 1;
+         }
       }
    }
    else if (buf && fPrefetch){
@@ -426,7 +427,7 @@ Int_t TFileCacheRead::ReadBufferExtPrefetch(char *buf, Long64_t pos, Int_t len,
       loc = (Int_t)TMath::BinarySearch(fBNseek, fBSeekSort, pos);
 
       if (loc >= 0 && loc < fBNseek && pos == fBSeekSort[loc]){
-         if (fPrefetch->ReadBuffer(buf, pos, len)) {
+         if (!fPrefetch->ReadBuffer(buf, pos, len)) {
            return 1;
         }
       }
@@ -22,6 +22,11 @@
 // The merging interface allows files containing histograms and trees   //
 // to be merged, like the standalone hadd program.                      //
 //                                                                      //
+// With SetParallelMerge the objects to merge are read from the source  //
+// files by several threads, in bounded batches, and the histograms are //
+// merged in parallel. The output file is written by the calling thread //
+// only, in the same order as in the sequential mode.                   //
+//                                                                      //
 //////////////////////////////////////////////////////////////////////////
 
 #include "TFileMerger.h"
@@ -40,6 +45,11 @@
 #include "TClassRef.h"
 #include "TROOT.h"
 #include "TMemFile.h"
+#include "TThread.h"
+#include "TMutex.h"
+#include "TVirtualMutex.h"
+
+#include <vector>
 
 #ifdef WIN32
 // For _getmaxstdio
@@ -83,11 +93,182 @@ static Int_t R__GetSystemMaxOpenedFiles()
    }
 }
 
+typedef void (*R__MergeJob_t)(void *data, Int_t index);
+
+class TMergeParallelJobs {
+public:
+   TMutex         *fMutex;    // Protect fNext
+   Int_t           fNext;     // Next job to run
+   Int_t           fNJobs;    // Number of jobs
+   R__MergeJob_t   fJob;      // Function running one job
+   void           *fData;     // Data shared by the jobs
+};
+
+class TMergeOpenFiles {
+public:
+   std::vector<TString>  fUrls;       // Files to open
+   std::vector<TString>  fLocalCopy;  // Local copy of each file (if fLocal)
+   std::vector<TFile*>   fFiles;      // Opened files (0 in case of failure)
+   std::vector<Int_t>    fCpFailed;   // The local copy of the file failed
+   Bool_t                fLocal;      // Make local copies of the files
+};
+
+class TMergeReadObjects {
+public:
+   std::vector<TKey*>    fKeys;       // Key of the object in each source file (0 if not found)
+   std::vector<TObject*> fObjects;    // Object read, or partial result, of each job (0 if none)
+   std::vector<Int_t>    fFailed;     // For each file, 1 if the object could not be read, 2 if its merge failed
+   Int_t                 fFirst;      // Index of the file read by the first job
+   Int_t                 fStride;     // If not 0, the job i merges the files fFirst+i, fFirst+i+fStride, ...
+   TMutex               *fMutex;      // Serialize the creation of the objects
+   ROOT::MergeFunc_t     fFunc;       // Merge function of the objects
+   TDirectory           *fTarget;     // Output directory
+   TString               fOptions;    // Options of the merge
+};
+
+//______________________________________________________________________________
+static void *R__MergeParallelLoop(void *arg)
+{
+   // Main loop of the threads of the parallel mode of TFileMerger: run the
+   // jobs until there are none left.
+
+   TMergeParallelJobs *jobs = (TMergeParallelJobs*)arg;
+   while (1) {
+      Int_t index;
+      {
+         R__LOCKGUARD(jobs->fMutex);
+         if (jobs->fNext >= jobs->fNJobs) break;
+         index = jobs->fNext++;
+      }
+      jobs->fJob(jobs->fData, index);
+   }
+   return (void *)0;
+}
+
+//______________________________________________________________________________
+static void R__MergeParallel(Int_t nthreads, Int_t njobs, R__MergeJob_t job, void *data)
+{
+   // Run the njobs jobs with nthreads threads, the calling thread being
+   // one of them, and wait for their completion.
+
+   TMutex mutex;
+   TMergeParallelJobs jobs;
+   jobs.fMutex = &mutex;
+   jobs.fNext  = 0;
+   jobs.fNJobs = njobs;
+   jobs.fJob   = job;
+   jobs.fData  = data;
+
+   std::vector<TThread*> threads;
+   for (Int_t i = 1; i < nthreads && i < njobs; ++i) {
+      TThread *th = new TThread("TFileMerger", R__MergeParallelLoop, (void*)&jobs);
+      if (th->Run()) {
+         delete th;
+         break;
+      }
+      threads.push_back(th);
+   }
+   R__MergeParallelLoop(&jobs);
+   for (UInt_t i = 0; i < threads.size(); ++i) {
+      threads[i]->Join();
+      delete threads[i];
+   }
+}
+
+//______________________________________________________________________________
+static void R__MergeOpenFile(void *data, Int_t index)
+{
+   // Open the index-th file, after making a local copy of it if requested.
+
+   TMergeOpenFiles *open = (TMergeOpenFiles*)data;
+
+   // We want gDirectory untouched by anything going on here
+   TDirectory::TContext ctx(0);
+   if (open->fLocal) {
+      TUUID uuid;
+      TString &localcopy = open->fLocalCopy[index];
+      localcopy.Form("file:%s/ROOTMERGE-%s.root", gSystem->TempDirectory(), uuid.AsString());
+      // No progress bar, it would be mixed with the ones of the other threads.
+      if (!TFile::Cp(open->fUrls[index], localcopy, kFALSE)) {
+         open->fCpFailed[index] = 1;
+         return;
+      }
+      open->fFiles[index] = TFile::Open(localcopy, "READ");
+   } else {
+      open->fFiles[index] = TFile::Open(open->fUrls[index], "READ");
+   }
+}
+
+//______________________________________________________________________________
+static TObject *R__MergeReadKey(TKey *key, TMutex *mutex)
+{
+   // Read the object of the key. The compressed record is read from the
+   // file without lock: each source file is only used by one thread at a
+   // time. Its unzipping and streaming, which create the object and may
+   // build the streamer infos of its class, are serialized with mutex.
+
+   char *buffer = 0;
+   if (key->GetObjlen() > key->GetNbytes() - key->GetKeylen()) {
+      buffer = new char[key->GetNbytes()];
+      if (key->GetFile()->ReadBuffer(buffer, key->GetSeekKey(), key->GetNbytes())) {
+         delete [] buffer;
+         return 0;
+      }
+   }
+   TObject *obj;
+   {
+      R__LOCKGUARD(mutex);
+      TDirectory::TContext ctx(0);
+      obj = buffer ? key->ReadObjWithBuffer(buffer) : key->ReadObj();
+   }
+   delete [] buffer;
+   if (!obj) return 0;
+   // Set ownership for collections
+   if (obj->InheritsFrom(TCollection::Class())) {
+      ((TCollection*)obj)->SetOwner();
+   }
+   obj->ResetBit(kMustCleanup);
+   return obj;
+}
+
+//______________________________________________________________________________
+static void R__MergeReadObject(void *data, Int_t index)
+{
+   // Without stride, read the object of the file fFirst+index. With a
+   // stride, merge the objects of the files fFirst+index, fFirst+index+fStride...
+   // into the first one read: the job then holds at most two objects.
+
+   TMergeReadObjects *read = (TMergeReadObjects*)data;
+
+   Int_t nfiles = (Int_t)read->fKeys.size();
+   Int_t step = read->fStride ? read->fStride : nfiles;
+   for (Int_t i = read->fFirst + index; i < nfiles; i += step) {
+      TKey *key = read->fKeys[i];
+      if (!key) continue;
+      TObject *obj = R__MergeReadKey(key, read->fMutex);
+      if (!obj) {
+         read->fFailed[i] = 1;
+      } else if (!read->fObjects[index]) {
+         read->fObjects[index] = obj;
+      } else {
+         TList inputs;
+         inputs.Add(obj);
+         TFileMergeInfo info(read->fTarget);
+         info.fOptions = read->fOptions;
+         if (read->fFunc(read->fObjects[index], &inputs, &info) < 0) {
+            read->fFailed[i] = 2;
+         }
+         inputs.Delete();
+      }
+      if (!read->fStride) break;
+   }
+}
+
 //______________________________________________________________________________
 TFileMerger::TFileMerger(Bool_t isLocal, Bool_t histoOneGo)
             : fOutputFile(0), fFastMethod(kTRUE), fNoTrees(kFALSE), fExplicitCompLevel(kFALSE), fCompressionChange(kFALSE),
               fPrintLevel(0), fMsgPrefix("TFileMerger"), fMaxOpenedFiles( R__GetSystemMaxOpenedFiles() ),
-              fLocal(isLocal), fHistoOneGo(histoOneGo), fObjectNames()
+              fLocal(isLocal), fHistoOneGo(histoOneGo), fObjectNames(), fNThreads(0)
 {
    // Create file merger object.
 
@@ -341,6 +522,85 @@ Bool_t TFileMerger::Merge(Bool_t)
    return PartialMerge(kAll | kRegular);
 }
 
+//______________________________________________________________________________
+void TFileMerger::MergeParallel(TObject *obj, TKey *key, const char *path, TList *sourcelist,
+                                TFile *firstsource, TFileMergeInfo &info, Bool_t oneGo)
+{
+   // Merge obj with the objects of the same name found in the directory
+   // path of the source files, starting at firstsource, using fNThreads
+   // threads (see SetParallelMerge).
+   // For the histograms, each thread merges the objects of every
+   // fNThreads-th file into the first one it read, and these partial
+   // results are merged into obj in order. The other objects are read by
+   // groups of fNThreads files and merged into obj, in the order of the
+   // files, by the calling thread. Either way no more than about
+   // 2*fNThreads source objects are in memory at once.
+
+   ROOT::MergeFunc_t func = obj->IsA()->GetMerge();
+
+   TMutex mutex;
+   TMergeReadObjects read;
+   std::vector<TFile*> sources;
+   {
+      // GetDirectory may read the directory from the file, which is done
+      // by this thread only.
+      TDirectory::TContext ctx(0);
+      for (TFile *source = firstsource; source; source = (TFile*)sourcelist->After(source)) {
+         TDirectory *ndir = source->GetDirectory(path);
+         sources.push_back(source);
+         read.fKeys.push_back(ndir ? (TKey*)ndir->GetListOfKeys()->FindObject(key->GetName()) : 0);
+      }
+   }
+   Int_t nfiles = (Int_t)sources.size();
+   Int_t nthreads = TMath::Min(fNThreads, nfiles);
+   read.fFailed.assign(nfiles, 0);
+   read.fMutex   = &mutex;
+   read.fFunc    = func;
+   read.fTarget  = info.fOutputDirectory;
+   read.fOptions = info.fOptions;
+
+   // The order of the other objects might matter (e.g. the points of a graph).
+   Bool_t strided = obj->IsA()->InheritsFrom(R__TH1_Class);
+   TList inputs;
+   for (Int_t first = 0; first < nfiles; first += nthreads) {
+      Int_t last = strided ? nfiles : TMath::Min(first + nthreads, nfiles);
+      read.fFirst  = first;
+      read.fStride = strided ? nthreads : 0;
+      read.fObjects.assign(nthreads, (TObject*)0);
+      R__MergeParallel(nthreads, TMath::Min(nthreads, last - first), R__MergeReadObject, &read);
+
+      for (Int_t i = first; i < last; ++i) {
+         if (read.fFailed[i] == 1) {
+            Info("MergeRecursive", "could not read object for key {%s, %s}; skipping file %s",
+                 key->GetName(), key->GetTitle(), sources[i]->GetName());
+         } else if (read.fFailed[i] == 2) {
+            Error("MergeRecursive", "calling Merge() on '%s' with the corresponding object in '%s'",
+                  obj->GetName(), sources[i]->GetName());
+         }
+      }
+      for (Int_t j = 0; j < nthreads; ++j) {
+         if (!read.fObjects[j]) continue;
+         inputs.Add(read.fObjects[j]);
+         if (!oneGo) {
+            Long64_t result = func(obj, &inputs, &info);
+            info.fIsFirst = kFALSE;
+            if (result < 0) {
+               Error("MergeRecursive", "calling Merge() on '%s' with the corresponding object in '%s'",
+                     obj->GetName(), sources[first + j]->GetName());
+            }
+            inputs.Delete();
+         }
+      }
+      if (strided) break;
+   }
+   // Merge the list, if still to be done
+   if (oneGo || info.fIsFirst) {
+      func(obj, &inputs, &info);
+      info.fIsFirst = kFALSE;
+      inputs.Delete();
+   }
+}
+
 //______________________________________________________________________________
 Bool_t TFileMerger::MergeRecursive(TDirectory *target, TList *sourcelist, Int_t type /* = kRegular | kAll */)
 {
@@ -525,6 +785,9 @@ Bool_t TFileMerger::MergeRecursive(TDirectory *target, TList *sourcelist, Int_t
                   ROOT::MergeFunc_t func = obj->IsA()->GetMerge();
                   func(obj, &inputs, &info);
                   info.fIsFirst = kFALSE;
+               } else if (fNThreads > 1 && !obj->IsA()->InheritsFrom(R__TTree_Class)) {
+                  // The trees are written while being merged, they stay in this thread.
+                  MergeParallel(obj, key, path, sourcelist, nextsource, info, oneGo);
                } else {
                   do {
                      // make sure we are at the correct directory level by cd'ing to path
@@ -869,6 +1132,46 @@ Bool_t TFileMerger::OpenExcessFiles()
    if (fPrintLevel > 0) {
       Printf("%s Opening the next %d files",fMsgPrefix.Data(),TMath::Min(fExcessFiles->GetEntries(),(fMaxOpenedFiles-1)));
    }   
+   if (fNThreads > 1) {
+      // Open the files concurrently, and add them in order to the list.
+      TMergeOpenFiles open;
+      open.fLocal = fLocal;
+      TIter nextopen(fExcessFiles);
+      TObjString *urlopen = 0;
+      while ((Int_t)open.fUrls.size() < (fMaxOpenedFiles-1) && ( urlopen = (TObjString*)nextopen() ) ) {
+         open.fUrls.push_back(urlopen->GetName());
+      }
+      Int_t nopen = (Int_t)open.fUrls.size();
+      open.fLocalCopy.resize(nopen);
+      open.fFiles.assign(nopen, (TFile*)0);
+      open.fCpFailed.assign(nopen, 0);
+      R__MergeParallel(fNThreads, nopen, R__MergeOpenFile, &open);
+
+      for (Int_t i = 0; i < nopen; ++i) {
+         TFile *newfile = open.fFiles[i];
+         if (!newfile) {
+            if (open.fCpFailed[i])
+               Error("OpenExcessFiles", "cannot get a local copy of file %s", open.fUrls[i].Data());
+            else if (fLocal)
+               Error("OpenExcessFiles", "cannot open local copy %s of URL %s",
+                     open.fLocalCopy[i].Data(), open.fUrls[i].Data());
+            else
+               Error("OpenExcessFiles", "cannot open file %s", open.fUrls[i].Data());
+            // Do not leak the files opened after the failing one.
+            for (Int_t j = i + 1; j < nopen; ++j) {
+               delete open.fFiles[j];
+            }
+            return kFALSE;
+         }
+         if (fOutputFile && fOutputFile->GetCompressionLevel() != newfile->GetCompressionLevel()) fCompressionChange = kTRUE;
+
+         newfile->SetBit(kCanDelete);
+         fFileList->Add(newfile);
+         delete fExcessFiles->Remove(fExcessFiles->First());
+      }
+      return kTRUE;
+   }
+
    Int_t nfiles = 0;
    TIter next(fExcessFiles);
    TObjString *url = 0;
@@ -945,3 +1248,29 @@ void TFileMerger::SetMsgPrefix(const char *prefix)
    fMsgPrefix = prefix;
 }
 
+//______________________________________________________________________________
+void TFileMerger::SetParallelMerge(Int_t nthreads)
+{
+   // Merge the files with nthreads threads. If nthreads is negative the
+   // number of cores is used, 0 or 1 restores the sequential merge.
+   // In parallel mode:
+   //  - the source files exceeding the maximum number of opened files
+   //    (see SetMaxOpenedFiles) are opened concurrently; the other ones
+   //    are still opened and checked by AddFile;
+   //  - each object to merge is read concurrently from the files, at most
+   //    about 2*nthreads of them being in memory at once (see MergeParallel);
+   //  - the histograms are merged in parallel. Since the contents are not
+   //    summed in the same order, the result can differ from the
+   //    sequential one by rounding errors;
+   //  - the TTrees, as well as the output file, are still handled by the
+   //    calling thread only.
+
+   if (nthreads < 0) {
+      SysInfo_t sysinfo;
+      gSystem->GetSysInfo(&sysinfo);
+      nthreads = sysinfo.fCpus;
+   }
+   fNThreads = nthreads > 1 ? nthreads : 0;
+   if (fNThreads) TThread::Initialize();
+}
+
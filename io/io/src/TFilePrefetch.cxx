@@ -21,7 +21,7 @@
 #include <cstdlib>
 #include <cctype>
 
-static const int kMAX_READ_SIZE    = 2;   //maximum size of the read list of blocks
+static const int kMAX_READ_SIZE    = 2;   //default maximum size of the read list of blocks
 
 inline int xtod(char c) { return (c>='0' && c<='9') ? c-'0' : ((c>='A' && c<='F') ? c-'A'+10 : ((c>='a' && c<='f') ? c-'a'+10 : 0)); }
 
@@ -33,7 +33,9 @@ ClassImp(TFilePrefetch)
 TFilePrefetch::TFilePrefetch(TFile* file) :
   fFile(file),
   fConsumer(0),
-  fThreadJoined(kTRUE)
+  fThreadJoined(kTRUE),
+  fReadingBlock(0),
+  fMaxReadBlocks(kMAX_READ_SIZE)
 {
    // Constructor.
 
@@ -42,7 +44,7 @@ TFilePrefetch::TFilePrefetch(TFile* file) :
    fMutexReadList    = new TMutex();
    fMutexPendingList = new TMutex();
    fNewBlockAdded    = new TCondition(0);
-   fReadBlockAdded   = new TCondition(0);
+   fReadBlockAdded   = new TCondition(fMutexReadList);
    fCondNextFile     = new TCondition(0);
    fSemMasterWorker  = new TSemaphore(0);
    fSemWorkerMaster  = new TSemaphore(0);
@@ -60,10 +62,10 @@ TFilePrefetch::~TFilePrefetch()
    SafeDelete(fConsumer);
    SafeDelete(fPendingBlocks);
    SafeDelete(fReadBlocks);
+   SafeDelete(fReadBlockAdded);
    SafeDelete(fMutexReadList);
    SafeDelete(fMutexPendingList);
    SafeDelete(fNewBlockAdded);
-   SafeDelete(fReadBlockAdded);
    SafeDelete(fCondNextFile);
    SafeDelete(fSemMasterWorker);
    SafeDelete(fSemWorkerMaster);
@@ -164,15 +166,20 @@ Long64_t TFilePrefetch::GetWaitTime()
 //____________________________________________________________________________________________
 Bool_t TFilePrefetch::ReadBuffer(char* buf, Long64_t offset, Int_t len)
 {
-   // Return a prefetched element.
+   // Copy into buf the prefetched element at offset, waiting for the
+   // block containing it if it is still pending or being read.
+   // Returns kTRUE in case of failure, i.e. when the element is neither
+   // in a block read nor in a block still to be read.
 
    Bool_t found = false;
    TFPBlock* blockObj = 0;
    TMutex *mutexBlocks = fMutexReadList;
    Int_t index = -1;
 
+   // fReadBlockAdded uses fMutexReadList: the list cannot change between
+   // the search and the wait, hence no signal is lost.
+   mutexBlocks->Lock();
    while (1){
-      mutexBlocks->Lock();
       TIter iter(fReadBlocks);
       while ((blockObj = (TFPBlock*) iter.Next())){
          index = -1;
@@ -181,15 +188,12 @@ Bool_t TFilePrefetch::ReadBuffer(char* buf, Long64_t offset, Int_t len)
             break;
          }
       }
-      if (found)
+      if (found || !IsPending(offset, len))
          break;
-      else{
-         mutexBlocks->UnLock();
 
-         fWaitTime.Start(kFALSE);
-         fReadBlockAdded->Wait(); //wait for a new block to be added
-         fWaitTime.Stop();
-      }
+      fWaitTime.Start(kFALSE);
+      fReadBlockAdded->Wait(); //wait for a new block to be added
+      fWaitTime.Stop();
    }
 
    if (found){
@@ -198,7 +202,28 @@ Bool_t TFilePrefetch::ReadBuffer(char* buf, Long64_t offset, Int_t len)
       memcpy(buf, pBuff, len);
    }
    mutexBlocks->UnLock();
-   return found;
+   return !found;
+}
+
+//____________________________________________________________________________________________
+Bool_t TFilePrefetch::IsPending(Long64_t offset, Int_t len)
+{
+   // Return true if the element at offset may still be added to the list
+   // of blocks read: a block is being read, or a pending block contains it.
+   // Must be called with fMutexReadList locked.
+
+   if (fReadingBlock)
+      return true;
+
+   Bool_t pending = false;
+   Int_t index = -1;
+   fMutexPendingList->Lock();
+   TIter iter(fPendingBlocks);
+   TFPBlock* blockObj = 0;
+   while (!pending && (blockObj = (TFPBlock*) iter.Next()))
+      pending = BinarySearchReadList(blockObj, offset, len, &index);
+   fMutexPendingList->UnLock();
+   return pending;
 }
 
 //____________________________________________________________________________________________
@@ -230,17 +255,21 @@ void TFilePrefetch::AddPendingBlock(TFPBlock* block)
 //____________________________________________________________________________________________
 TFPBlock* TFilePrefetch::GetPendingBlock()
 {
-   // Safe method to remove a block from the pendingList.
+   // Safe method to remove a block from the pendingList. The block is
+   // marked as being read until it is added to the readList.
 
    TFPBlock* block = 0;
    TMutex *mutex = fMutexPendingList;
+   fMutexReadList->Lock();
    mutex->Lock();
 
    if (fPendingBlocks->GetSize()){
       block = (TFPBlock*)fPendingBlocks->First();
       block = (TFPBlock*)fPendingBlocks->Remove(block);
    }
+   fReadingBlock = block;
    mutex->UnLock();
+   fMutexReadList->UnLock();
    return block;
 }
 
@@ -249,11 +278,10 @@ void TFilePrefetch::AddReadBlock(TFPBlock* block)
 {
    // Safe method to add a block to the readList.
 
-   TMutex *mutexCond = fReadBlockAdded->GetMutex();
    TMutex *mutex = fMutexReadList;
    mutex->Lock();
 
-   if (fReadBlocks->GetSize() >= kMAX_READ_SIZE){
+   if (fReadBlocks->GetSize() >= fMaxReadBlocks){
       TFPBlock* movedBlock = (TFPBlock*) fReadBlocks->First();
       movedBlock = (TFPBlock*)fReadBlocks->Remove(movedBlock);
       delete movedBlock;
@@ -261,12 +289,11 @@ void TFilePrefetch::AddReadBlock(TFPBlock* block)
    }
 
    fReadBlocks->Add(block);
-   mutex->UnLock();
+   fReadingBlock = 0;
 
-   //signal the addition of a new block
-   mutexCond->Lock();
+   //signal the addition of a new block, under the lock of the readList
    fReadBlockAdded->Signal();
-   mutexCond->UnLock();
+   mutex->UnLock();
 }
 
 
@@ -280,7 +307,7 @@ TFPBlock* TFilePrefetch::CreateBlockObj(Long64_t* offset, Int_t* len, Int_t nobl
 
    mutex->Lock();
 
-   if (fReadBlocks->GetSize() >= kMAX_READ_SIZE){
+   if (fReadBlocks->GetSize() >= fMaxReadBlocks){
       blockObj = static_cast<TFPBlock*>(fReadBlocks->First());
       fReadBlocks->Remove(blockObj);
       mutex->UnLock();
@@ -311,6 +338,20 @@ void TFilePrefetch::SetFile(TFile *file)
 }
 
 
+//____________________________________________________________________________________________
+void TFilePrefetch::SetMaxReadBlocks(Int_t nblocks)
+{
+   // Set the maximum number of blocks kept in the list of blocks read
+   // (2 by default). When a new block is read, the oldest one is
+   // dropped or recycled, hence a client queuing several blocks in
+   // advance must keep it larger than the number of blocks it has
+   // queued and not yet read.
+
+   if (nblocks < kMAX_READ_SIZE) nblocks = kMAX_READ_SIZE;
+   fMaxReadBlocks = nblocks;
+}
+
+
 //____________________________________________________________________________________________
 Int_t TFilePrefetch::ThreadStart()
 {
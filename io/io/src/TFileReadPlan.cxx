@@ -0,0 +1,240 @@
+// @(#)root/io:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2012, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TFileReadPlan                                                        //
+//                                                                      //
+// Plan the requests used by the remote files to read the list of       //
+// blocks given to TFile::ReadBuffers (typically the baskets of a       //
+// TTreeCache fill).                                                    //
+//                                                                      //
+// With a high latency server each range costs a round trip, or at      //
+// least a header in a multi-range request. When reading a subset of    //
+// the branches, the baskets are separated by small gaps and the        //
+// requests are made of many tiny ranges. The plan:                     //
+//   - sorts the blocks by position,                                    //
+//   - merges the blocks separated by at most GetMaxGap() bytes into a  //
+//     single range (the bytes of the gaps are read and thrown away),   //
+//   - splits the ranges larger than GetMaxSize() bytes, so that they   //
+//     can be spread over several connections (see GetConnections()).   //
+// The ranges are read into a buffer of GetBufferSize() bytes, from     //
+// which Scatter copies the requested blocks. When no gap has been      //
+// merged, the planned buffer is the requested one (IsDirect()) and no  //
+// copy is needed.                                                      //
+//                                                                      //
+// The parameters are set with the static functions SetMaxGap,          //
+// SetMaxSize and SetConnections or with the rootrc resources           //
+//    TFile.ReadCoalesceGap:   0                                        //
+//    TFile.ReadMaxRequest:    0                                        //
+//    TFile.ReadConnections:   1                                        //
+// PrintStats reports the number of ranges saved and of bytes wasted.   //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#include "TFileReadPlan.h"
+#include "TEnv.h"
+#include "TMath.h"
+
+#include <string.h>
+
+Int_t    TFileReadPlan::fgMaxGap       = -1;
+Int_t    TFileReadPlan::fgMaxSize      = -1;
+Int_t    TFileReadPlan::fgConnections  = -1;
+Long64_t TFileReadPlan::fgNBlocks      = 0;
+Long64_t TFileReadPlan::fgNRanges      = 0;
+Long64_t TFileReadPlan::fgBytesWasted  = 0;
+
+ClassImp(TFileReadPlan)
+
+//______________________________________________________________________________
+TFileReadPlan::TFileReadPlan() : fSize(0), fDirect(kTRUE)
+{
+   // Default constructor, the plan is empty.
+}
+
+//______________________________________________________________________________
+TFileReadPlan::TFileReadPlan(const Long64_t *pos, const Int_t *len, Int_t nbuf) :
+   fSize(0), fDirect(kTRUE)
+{
+   // Plan the reading of the nbuf blocks described by pos and len (see Plan).
+
+   Plan(pos, len, nbuf);
+}
+
+//______________________________________________________________________________
+Int_t TFileReadPlan::GetConnections()
+{
+   // Static function returning the number of connections a remote file
+   // may use concurrently to read the ranges of a plan.
+
+   if (fgConnections < 0) fgConnections = gEnv->GetValue("TFile.ReadConnections", 1);
+   return fgConnections > 0 ? fgConnections : 1;
+}
+
+//______________________________________________________________________________
+Int_t TFileReadPlan::GetMaxGap()
+{
+   // Static function returning the largest gap (in bytes) between two
+   // blocks merged in a single range.
+
+   if (fgMaxGap < 0) fgMaxGap = gEnv->GetValue("TFile.ReadCoalesceGap", 0);
+   return fgMaxGap > 0 ? fgMaxGap : 0;
+}
+
+//______________________________________________________________________________
+Int_t TFileReadPlan::GetMaxSize()
+{
+   // Static function returning the size of the largest range read at once,
+   // 0 meaning no limit.
+
+   if (fgMaxSize < 0) fgMaxSize = gEnv->GetValue("TFile.ReadMaxRequest", 0);
+   return fgMaxSize > 0 ? fgMaxSize : 0;
+}
+
+//______________________________________________________________________________
+void TFileReadPlan::Plan(const Long64_t *pos, const Int_t *len, Int_t nbuf)
+{
+   // Compute the ranges to read to get the nbuf blocks of length len[i]
+   // starting at pos[i]. The blocks may be given in any order and overlap.
+
+   fPos.clear();
+   fLen.clear();
+   fBlockOffset.resize(nbuf > 0 ? nbuf : 0);
+   fBlockLen.assign(len, len + (nbuf > 0 ? nbuf : 0));
+   fSize   = 0;
+   fDirect = kTRUE;
+   if (nbuf <= 0) return;
+
+   const Long64_t maxgap  = GetMaxGap();
+   const Long64_t maxsize = GetMaxSize();
+
+   std::vector<Int_t> index(nbuf);
+   TMath::Sort(nbuf, pos, &index[0], kFALSE);
+
+   Long64_t requested = 0;
+   Long64_t start = pos[index[0]];
+   Long64_t end   = start;
+   for (Int_t i = 0; i < nbuf; ++i) {
+      Int_t j = index[i];
+      Long64_t bend = pos[j] + len[j];
+      requested += len[j];
+      if (i > 0 && pos[j] > end + maxgap) {
+         // Too far from the current range: close it.
+         fPos.push_back(start);
+         fLen.push_back(Int_t(end - start));
+         fSize += end - start;
+         start = pos[j];
+         end   = pos[j];
+      }
+      fBlockOffset[j] = fSize + (pos[j] - start);
+      if (bend > end) end = bend;
+      // The planned buffer matches the requested one only if the blocks
+      // are already in order and neither overlap nor leave any gap.
+      if (j != i || fBlockOffset[j] != requested - len[j]) fDirect = kFALSE;
+   }
+   fPos.push_back(start);
+   fLen.push_back(Int_t(end - start));
+   fSize += end - start;
+   if (fSize != requested) fDirect = kFALSE;
+
+   if (maxsize > 0) {
+      // Split the ranges too large to be read at once. The pieces are
+      // contiguous in the planned buffer, so the offsets do not change.
+      std::vector<Long64_t> spos;
+      std::vector<Int_t>    slen;
+      for (UInt_t r = 0; r < fPos.size(); ++r) {
+         Long64_t p    = fPos[r];
+         Long64_t left = fLen[r];
+         while (left > maxsize) {
+            spos.push_back(p);
+            slen.push_back(Int_t(maxsize));
+            p    += maxsize;
+            left -= maxsize;
+         }
+         spos.push_back(p);
+         slen.push_back(Int_t(left));
+      }
+      fPos.swap(spos);
+      fLen.swap(slen);
+   }
+
+   fgNBlocks     += nbuf;
+   fgNRanges     += fPos.size();
+   fgBytesWasted += fSize - requested;
+}
+
+//______________________________________________________________________________
+void TFileReadPlan::PrintStats()
+{
+   // Static function printing the number of blocks requested, of ranges
+   // actually read and of bytes read in the gaps between the blocks.
+
+   printf("******TFileReadPlan statistics ******\n");
+   printf("Number of blocks requested: %lld\n", fgNBlocks);
+   printf("Number of ranges read: %lld (%lld saved)\n", fgNRanges, fgNBlocks - fgNRanges);
+   printf("Number of bytes wasted in gaps: %lld\n", fgBytesWasted);
+   printf("Largest gap: %d, largest range: %d, connections: %d\n", GetMaxGap(), GetMaxSize(), GetConnections());
+}
+
+//______________________________________________________________________________
+void TFileReadPlan::ResetStats()
+{
+   // Static function resetting the statistics printed by PrintStats.
+
+   fgNBlocks     = 0;
+   fgNRanges     = 0;
+   fgBytesWasted = 0;
+}
+
+//______________________________________________________________________________
+void TFileReadPlan::Scatter(const char *planned, char *buf) const
+{
+   // Copy the requested blocks from the planned buffer (holding the
+   // planned ranges one after the other) to buf, in the order in which
+   // they were given to Plan. Nothing is done if the plan IsDirect.
+
+   if (fDirect) return;
+   Long64_t k = 0;
+   for (UInt_t i = 0; i < fBlockLen.size(); ++i) {
+      memcpy(buf + k, planned + fBlockOffset[i], fBlockLen[i]);
+      k += fBlockLen[i];
+   }
+}
+
+//______________________________________________________________________________
+void TFileReadPlan::SetConnections(Int_t n)
+{
+   // Static function setting the number of connections a remote file may
+   // use concurrently to read the ranges of a plan. Only the files able
+   // to open independent connections (TWebFile with a server running
+   // mod_root) use more than one.
+
+   fgConnections = n > 0 ? n : 1;
+}
+
+//______________________________________________________________________________
+void TFileReadPlan::SetMaxGap(Int_t bytes)
+{
+   // Static function setting the largest gap (in bytes) between two blocks
+   // read in a single range. With 0 only the overlapping or adjacent blocks
+   // are merged.
+
+   fgMaxGap = bytes > 0 ? bytes : 0;
+}
+
+//______________________________________________________________________________
+void TFileReadPlan::SetMaxSize(Int_t bytes)
+{
+   // Static function setting the size of the largest range read at once.
+   // The larger ranges are split. With 0 the ranges are never split.
+
+   fgMaxSize = bytes > 0 ? bytes : 0;
+}
@@ -953,12 +953,61 @@ namespace TStreamerInfoActions
       }
    }
 
+   class TConfBasicRun : public TConfiguration {
+      // Configuration of a run of consecutive members of the same basic type,
+      // read member-wise by a single action (see VectorLooper::ReadBasicTypeRun).
+   public:
+      std::vector<Int_t>        fOffsets;      // Offset of each member of the run, the first one is fOffset
+      TStreamerInfoLoopAction_t fMemberAction; // Action reading a single member of the run
+      TConfBasicRun(TVirtualStreamerInfo *info, UInt_t id, Int_t offset, TStreamerInfoLoopAction_t action) : TConfiguration(info,id,offset),fMemberAction(action) { fOffsets.push_back(offset); };
+      virtual void AddToOffset(Int_t delta)
+      {
+         // Add the (potentially negative) delta to the offset of all the members.
+
+         fOffset += delta;
+         for(UInt_t m = 0; m < fOffsets.size(); ++m) {
+            fOffsets[m] += delta;
+         }
+      }
+      virtual TConfiguration *Copy() { return new TConfBasicRun(*this); }
+   };
+
+   static const Int_t kBasicChunk = 256; // Number of values converted at once by the member-wise loops.
+
+   template <typename T>
+   static INLINE_TEMPLATE_ARGS void ReadBasicScatter(TBuffer &buf, char *addr, Int_t n, Long_t incr)
+   {
+      // Read the n values of a member, contiguous in the buffer, into the
+      // n elements of the collection starting at addr and incr bytes apart.
+      // The values are converted kBasicChunk at a time by ReadFastArray.
+
+      if (incr == sizeof(T)) {
+         buf.ReadFastArray((T*)addr, n);
+         return;
+      }
+      T temp[kBasicChunk];
+      while (n > 0) {
+         Int_t nchunk = n < kBasicChunk ? n : kBasicChunk;
+         buf.ReadFastArray(temp, nchunk);
+         for(Int_t i = 0; i < nchunk; ++i, addr += incr) {
+            *(T*)addr = temp[i];
+         }
+         n -= nchunk;
+      }
+   }
+
    struct VectorLooper {
 
       template <typename T> 
       static INLINE_TEMPLATE_ARGS Int_t ReadBasicType(TBuffer &buf, void *iter, const void *end, const TLoopConfiguration *loopconfig, const TConfiguration *config)
       {
          const Int_t incr = ((TVectorLoopConfig*)loopconfig)->fIncrement;
+         if (buf.IsA() == TBufferFile::Class()) {
+            // In a TBufferFile, the values are stored contiguously and can be converted in bulk.
+            Int_t n = (((char*)end)-((char*)iter))/incr;
+            ReadBasicScatter<T>(buf, ((char*)iter) + config->fOffset, n, incr);
+            return 0;
+         }
          iter = (char*)iter + config->fOffset;
          end = (char*)end + config->fOffset;
          for(; iter != end; iter = (char*)iter + incr ) {
@@ -968,6 +1017,44 @@ namespace TStreamerInfoActions
          return 0;
       }
 
+      template <typename T> 
+      static INLINE_TEMPLATE_ARGS Int_t ReadBasicTypeRun(TBuffer &buf, void *iter, const void *end, const TLoopConfiguration *loopconfig, const TConfiguration *config)
+      {
+         // Read a run of consecutive members of type T (see TConfBasicRun).
+         // When the whole run fits in kBasicChunk values it is converted with
+         // a single call to ReadFastArray.
+
+         const TConfBasicRun *conf = (const TConfBasicRun*)config;
+         const Int_t incr = ((TVectorLoopConfig*)loopconfig)->fIncrement;
+         const Int_t nmembers = conf->fOffsets.size();
+         if (buf.IsA() != TBufferFile::Class()) {
+            // The other buffers (e.g. TBufferXML) need to know which member is read.
+            for(Int_t m = 0; m < nmembers; ++m) {
+               if (m) buf.SetStreamerElementNumber(conf->fElemId + m);
+               TConfiguration single(conf->fInfo, conf->fElemId + m, conf->fOffsets[m]);
+               ReadBasicType<T>(buf, iter, end, loopconfig, &single);
+            }
+            return 0;
+         }
+         const Int_t n = (((char*)end)-((char*)iter))/incr;
+         if (n*nmembers <= kBasicChunk) {
+            T temp[kBasicChunk];
+            buf.ReadFastArray(temp, n*nmembers);
+            const T *value = temp;
+            for(Int_t m = 0; m < nmembers; ++m) {
+               char *addr = ((char*)iter) + conf->fOffsets[m];
+               for(Int_t i = 0; i < n; ++i, addr += incr) {
+                  *(T*)addr = *value++;
+               }
+            }
+         } else {
+            for(Int_t m = 0; m < nmembers; ++m) {
+               ReadBasicScatter<T>(buf, ((char*)iter) + conf->fOffsets[m], n, incr);
+            }
+         }
+         return 0;
+      }
+
       template <typename From, typename To>
       struct ConvertBasicType {
          static INLINE_TEMPLATE_ARGS Int_t Action(TBuffer &buf, void *iter, const void *end, const TLoopConfiguration *loopconfig, const TConfiguration *config)
@@ -2054,6 +2141,33 @@ static TConfiguredAction GetConvertCollectionReadAction(Int_t oldtype, Int_t new
    return TConfiguredAction();
 }
 
+//______________________________________________________________________________
+static TStreamerInfoLoopAction_t GetVectorReadRunAction(Int_t type, TStreamerInfoLoopAction_t &member)
+{
+   // Return the action reading member-wise a run of consecutive members of
+   // the given basic type, and set 'member' to the action reading only one
+   // of them. Return 0 if the type cannot be part of a run.
+
+   switch (type) {
+      case TStreamerInfo::kBool:    member = VectorLooper::ReadBasicType<Bool_t>;    return VectorLooper::ReadBasicTypeRun<Bool_t>;
+      case TStreamerInfo::kChar:    member = VectorLooper::ReadBasicType<Char_t>;    return VectorLooper::ReadBasicTypeRun<Char_t>;
+      case TStreamerInfo::kShort:   member = VectorLooper::ReadBasicType<Short_t>;   return VectorLooper::ReadBasicTypeRun<Short_t>;
+      case TStreamerInfo::kInt:     member = VectorLooper::ReadBasicType<Int_t>;     return VectorLooper::ReadBasicTypeRun<Int_t>;
+      case TStreamerInfo::kLong:    member = VectorLooper::ReadBasicType<Long_t>;    return VectorLooper::ReadBasicTypeRun<Long_t>;
+      case TStreamerInfo::kLong64:  member = VectorLooper::ReadBasicType<Long64_t>;  return VectorLooper::ReadBasicTypeRun<Long64_t>;
+      case TStreamerInfo::kFloat:   member = VectorLooper::ReadBasicType<Float_t>;   return VectorLooper::ReadBasicTypeRun<Float_t>;
+      case TStreamerInfo::kDouble:  member = VectorLooper::ReadBasicType<Double_t>;  return VectorLooper::ReadBasicTypeRun<Double_t>;
+      case TStreamerInfo::kUChar:   member = VectorLooper::ReadBasicType<UChar_t>;   return VectorLooper::ReadBasicTypeRun<UChar_t>;
+      case TStreamerInfo::kUShort:  member = VectorLooper::ReadBasicType<UShort_t>;  return VectorLooper::ReadBasicTypeRun<UShort_t>;
+      case TStreamerInfo::kUInt:    member = VectorLooper::ReadBasicType<UInt_t>;    return VectorLooper::ReadBasicTypeRun<UInt_t>;
+      case TStreamerInfo::kULong:   member = VectorLooper::ReadBasicType<ULong_t>;   return VectorLooper::ReadBasicTypeRun<ULong_t>;
+      case TStreamerInfo::kULong64: member = VectorLooper::ReadBasicType<ULong64_t>; return VectorLooper::ReadBasicTypeRun<ULong64_t>;
+      default:
+         member = 0;
+         return 0;
+   }
+}
+
 template <class Looper>
 static TConfiguredAction GetCollectionReadAction(TVirtualStreamerInfo *info, TStreamerElement *element, Int_t type, UInt_t i, Int_t offset)
 {
@@ -2842,6 +2956,7 @@ TStreamerInfoActions::TActionSequence *TStreamerInfoActions::TActionSequence::Cr
    } else {
       sequence->fLoopConfig = new TGenericLoopConfig(&proxy);
    }
+   Int_t runType = -1; // Type of the members of the last action if it reads a run of basic members.
    for (UInt_t i = 0; i < ndata; ++i) {
       TStreamerElement *element = (TStreamerElement*) info->GetElements()->At(i);
       if (!element) {
@@ -2883,8 +2998,23 @@ TStreamerInfoActions::TActionSequence *TStreamerInfoActions::TActionSequence::Cr
          if (element->TestBit(TStreamerElement::kCache)) {
             TConfiguredAction action( GetCollectionReadAction<VectorLooper>(info,element,oldType,i,offset) );
             sequence->AddAction( UseCacheVectorLoop,  new TConfigurationUseCache(info,action,element->TestBit(TStreamerElement::kRepeat)) );
+            runType = -1;
          } else {
-            sequence->AddAction( GetCollectionReadAction<VectorLooper>(info,element,oldType,i,offset));
+            TStreamerInfoLoopAction_t member = 0;
+            TStreamerInfoLoopAction_t run = GetVectorReadRunAction(oldType, member);
+            if (run && oldType == runType && sequence->fActions.back().fConfiguration->fElemId + 1 == i) {
+               // Same type as the previous member: add it to the run, the values
+               // of both are then converted together.
+               TConfiguredAction &last( sequence->fActions.back() );
+               if (last.fLoopAction != run) {
+                  TConfBasicRun *conf = new TConfBasicRun(info,last.fConfiguration->fElemId,last.fConfiguration->fOffset,member);
+                  last = TConfiguredAction( run, conf );
+               }
+               ((TConfBasicRun*)last.fConfiguration)->fOffsets.push_back(offset);
+            } else {
+               sequence->AddAction( GetCollectionReadAction<VectorLooper>(info,element,oldType,i,offset));
+               runType = run ? oldType : -1;
+            }
          }
          break;
       case kGenericLooper:
@@ -3119,7 +3249,14 @@ TStreamerInfoActions::TActionSequence *TStreamerInfoActions::TActionSequence::Cr
          for(TStreamerInfoActions::ActionContainer_t::iterator iter = fActions.begin();
              iter != end;
              ++iter) {
-            if ( iter->fConfiguration->fElemId == (UInt_t)element_ids[id] ) {
+            TConfBasicRun *run = dynamic_cast<TConfBasicRun*>(iter->fConfiguration);
+            if (run) {
+               // Only extract the requested member of the run.
+               UInt_t m = (UInt_t)element_ids[id] - run->fElemId;
+               if ( (UInt_t)element_ids[id] >= run->fElemId && m < run->fOffsets.size() ) {
+                  sequence->AddAction( run->fMemberAction, new TConfiguration(run->fInfo,element_ids[id],run->fOffsets[m] + offset) );
+               }
+            } else if ( iter->fConfiguration->fElemId == (UInt_t)element_ids[id] ) {
                TConfiguration *conf = iter->fConfiguration->Copy();
                conf->AddToOffset(offset);
                sequence->AddAction( iter->fAction, conf );
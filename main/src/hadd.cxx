@@ -77,7 +77,7 @@ int main( int argc, char **argv )
 {
 
    if ( argc < 3 || "-h" == std::string(argv[1]) || "--help" == std::string(argv[1]) ) {
-      std::cout << "Usage: " << argv[0] << " [-f[0-9]] [-k] [-T] [-O] [-n maxopenedfiles] [-v verbosity] targetfile source1 [source2 source3 ...]" << std::endl;
+      std::cout << "Usage: " << argv[0] << " [-f[0-9]] [-k] [-T] [-O] [-n maxopenedfiles] [-j nthreads] [-v verbosity] targetfile source1 [source2 source3 ...]" << std::endl;
       std::cout << "This program will add histograms from a list of root files and write them" << std::endl;
       std::cout << "to a target root file. The target file is newly created and must not " << std::endl;
       std::cout << "exist, or if -f (\"force\") is given, must not be one of the source files." << std::endl;
@@ -87,6 +87,7 @@ int main( int argc, char **argv )
       std::cout << "If the option -O is used, when merging TTree, the basket size is re-optimized" <<std::endl;
       std::cout << "If the option -v is used, explicitly set the verbosity level; 0 request no output, 99 is the default" <<std::endl;
       std::cout << "If the option -n is used, hadd will open at most 'maxopenedfiles' at once, use 0 to request to use the system maximum." << std::endl;
+      std::cout << "If the option -j is used, hadd will open and read the source files and merge the histograms with 'nthreads' threads, use 0 to request to use the number of cores." << std::endl;
       std::cout << "When -the -f option is specified, one can also specify the compression" <<std::endl;
       std::cout << "level of the target file. By default the compression level is 1, but" <<std::endl;
       std::cout << "if \"-f0\" is specified, the target file will not be compressed." <<std::endl;
@@ -101,6 +102,7 @@ int main( int argc, char **argv )
    Bool_t reoptimize = kFALSE;
    Bool_t noTrees = kFALSE;
    Int_t maxopenedfiles = 0;
+   Int_t nthreads = 1;
    Int_t verbosity = 99;
 
    int outputPlace = 0;
@@ -133,6 +135,20 @@ int main( int argc, char **argv )
             }
          }
          ++ffirst;
+      } else if ( strcmp(argv[a],"-j") == 0 ) {
+         if (a+1 >= argc) {
+            std::cerr << "Error: no number of threads was provided after -j.\n";
+         } else {
+            Long_t request = strtol(argv[a+1], 0, 10);
+            if (request < kMaxLong && request >= 0) {
+               nthreads = (Int_t)request;
+               ++a;
+               ++ffirst;
+            } else {
+               std::cerr << "Error: could not parse the number of threads passed after -j: " << argv[a+1] << ". The files will be merged sequentially.\n";
+            }
+         }
+         ++ffirst;
       } else if ( strcmp(argv[a],"-v") == 0 ) {
          if (a+1 >= argc) {
             std::cerr << "Error: no verbosity level was provided after -v.\n";
@@ -187,6 +203,9 @@ int main( int argc, char **argv )
    if (maxopenedfiles > 0) {
       merger.SetMaxOpenedFiles(maxopenedfiles);
    }
+   if (nthreads != 1) {
+      merger.SetParallelMerge(nthreads > 0 ? nthreads : -1);
+   }
    if (!merger.OutputFile(targetname,force,newcomp) ) {
       std::cerr << "hadd error opening target file (does " << argv[ffirst-1] << " exist?)." << std::endl;
       std::cerr << "Pass \"-f\" argument to force re-creation of output file." << std::endl;
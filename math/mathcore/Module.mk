@@ -130,7 +130,7 @@ $(MATHCORELIB): $(MATHCOREO) $(MATHCOREDO) $(ORDER_) $(MAINLIBS)
 		@$(MAKELIB) $(PLATFORM) $(LD) "$(LDFLAGS)"  \
 		   "$(SOFLAGS)" libMathCore.$(SOEXT) $@     \
 		   "$(MATHCOREO) $(MATHCOREDO)" \
-		   "$(MATHCORELIBEXTRA)"
+		   "$(MATHCORELIBEXTRA) $(OSTHREADLIBDIR) $(OSTHREADLIB)"
 
 $(MATHCOREDS1): $(MATHCOREDH1) $(MATHCOREL1) $(ROOTCINTTMPDEP)
 		$(MAKEDIR)
@@ -181,6 +181,8 @@ endif
 ##### extra rules ######
 $(MATHCOREO): CXXFLAGS += -DUSE_ROOT_ERROR
 $(MATHCOREDO): CXXFLAGS += -DUSE_ROOT_ERROR 
+# the fit functions are evaluated by several threads (see FitUtil.cxx)
+$(call stripsrc,$(MATHCOREDIRS)/FitUtil.o): CXXFLAGS += $(OSTHREADFLAG)
 # add optimization to G__Math compilation
 # Optimize dictionary with stl containers.
 $(MATHCOREDO1) : NOOPT = $(OPT)
@@ -379,6 +379,65 @@ public :
    }
 
 
+   /**
+      Store the data also by columns: one contiguous array for each element of the fit point 
+      (the coordinates, the value and the errors, in the order of the point structure, 
+      see FitData::Column), in addition to the data stored point after point. 
+      The columns are filled with the points already added and are then kept up to date by Add. 
+      They are built only on demand, when this function is called, since they double the memory 
+      used by the data. They give a contiguous access to each coordinate (see CoordColumn and GetCoords), 
+      used by the Chi2 and likelihood evaluations of FitUtil to evaluate the model function on blocks 
+      of points. With on = false the columns are deleted. 
+      External data (DataWrapper) are already stored by columns and are not copied
+   */
+   void SetColumnLayout(bool on = true); 
+
+   /**
+      return the array of the coordinate icoord for all the fit points, 
+      from the columns or from the external data. 
+      Return a NULL pointer if the data are not stored by columns 
+   */
+   const double * CoordColumn(unsigned int icoord) const { 
+      if (fDataWrapper) return (fNPoints > 0) ? fDataWrapper->CoordArray(icoord) : 0; 
+      return Column(icoord); 
+   }
+
+   /**
+      return the array of the values for all the fit points, 
+      from the columns or from the external data. 
+      Return a NULL pointer if the data are not stored by columns 
+   */
+   const double * ValueColumn() const { 
+      if (fDataWrapper) return (fNPoints > 0) ? fDataWrapper->ValueArray() : 0; 
+      return Column(fDim); 
+   }
+
+   /**
+      return the array of the inverse errors on the values for all the fit points. 
+      Available only for the type kValueError when the data are stored by columns, 
+      otherwise a NULL pointer is returned 
+   */
+   const double * InvErrorColumn() const { 
+      if (fPointSize != fDim + 2) return 0; 
+      return Column(fDim+1); 
+   }
+
+   /**
+      copy the coordinates of the n fit points starting from ipoint in the array x, 
+      point after point (x must have a size of at least n*NDim() ). 
+      This is the layout expected by IParamMultiFunction::EvalParN. 
+   */
+   void GetCoords(unsigned int ipoint, unsigned int n, double * x) const { 
+      assert(ipoint + n <= fNPoints); 
+      CopyCoords(ipoint, n, fDim, fDataWrapper, fDataVector, fPointSize, x); 
+   }
+
+   /**
+      copy the values of the n fit points starting from ipoint in the array y
+   */
+   void GetValues(unsigned int ipoint, unsigned int n, double * y) const; 
+
+
 #ifdef USE_BINPOINT_CLASS
    const BinPoint & GetPoint(unsigned int ipoint) const { 
       if (fDataVector) { 
@@ -516,6 +575,11 @@ protected:
 
 private: 
 
+   /// add the last inserted point to the columns
+   void AddLastToColumns() { 
+      AddToColumns( &((fDataVector->Data())[ (fNPoints-1)*fPointSize ]) );
+   }
+
 
    unsigned int fDim;       // coordinate dimension
    unsigned int fPointSize; // total point size including value and errors (= fDim + 2 for error in only Y ) 
@@ -31,14 +31,6 @@
 #include "Fit/FitUtil.h"
 #endif
 
-//#define ROOT_FIT_PARALLEL
-
-#ifdef ROOT_FIT_PARALLEL
-#ifndef ROOT_Fit_FitUtilParallel
-#include "Fit/FitUtilParallel.h"
-#endif
-#endif
-
 /** 
 @defgroup FitMethodFunc Fit Method Classes 
 
@@ -82,6 +74,7 @@ public:
       fData(data), 
       fFunc(func), 
       fNEffPoints(0),
+      fNThreads(1),
       fGrad ( std::vector<double> ( func.NPar() ) )
    { }
 
@@ -111,6 +104,7 @@ public:
    virtual BaseFunction * Clone() const { 
       // clone the function
       Chi2FCN * fcn =  new Chi2FCN(fData,fFunc); 
+      fcn->SetNThreads(fNThreads); 
       return fcn; 
    }
  
@@ -132,9 +126,15 @@ public:
    // need to be virtual to be instantiated
    virtual void Gradient(const double *x, double *g) const { 
       // evaluate the chi2 gradient
-      FitUtil::EvaluateChi2Gradient(fFunc, fData, x, g, fNEffPoints);
+      FitUtil::EvaluateChi2Gradient(fFunc, fData, x, g, fNEffPoints, fNThreads);
    }
 
+   /// set the number of threads evaluating the data points (0 = number of cores, see FitUtil.h)
+   void SetNThreads(unsigned int nthreads) { fNThreads = nthreads; }
+
+   /// number of threads evaluating the data points
+   unsigned int NThreads() const { return fNThreads; }
+
    /// get type of fit method function
    virtual  typename BaseObjFunction::Type_t Type() const { return BaseObjFunction::kLeastSquare; }
 
@@ -159,14 +159,10 @@ private:
     */
    virtual double DoEval (const double * x) const { 
       this->UpdateNCalls();
-#ifdef ROOT_FIT_PARALLEL
-      return FitUtilParallel::EvaluateChi2(fFunc, fData, x, fNEffPoints); 
-#else 
       if (!fData.HaveCoordErrors() ) 
-         return FitUtil::EvaluateChi2(fFunc, fData, x, fNEffPoints); 
+         return FitUtil::EvaluateChi2(fFunc, fData, x, fNEffPoints, fNThreads); 
       else 
-         return FitUtil::EvaluateChi2Effective(fFunc, fData, x, fNEffPoints); 
-#endif
+         return FitUtil::EvaluateChi2Effective(fFunc, fData, x, fNEffPoints, fNThreads); 
    } 
 
    // for derivatives 
@@ -180,6 +176,8 @@ private:
 
    mutable unsigned int fNEffPoints;  // number of effective points used in the fit 
 
+   unsigned int fNThreads;            // number of threads evaluating the data points
+
    mutable std::vector<double> fGrad; // for derivatives
 
 
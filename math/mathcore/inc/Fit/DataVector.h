@@ -45,6 +45,9 @@ namespace ROOT {
 
    namespace Fit { 
 
+   class DataVector; 
+   class DataWrapper; 
+
 
 /**
    Base class for all the fit data types
@@ -100,6 +103,47 @@ public:
       return (unsigned int) (-1) / sizeof (double);
    }
 
+   /**
+      query if the data are stored also by columns 
+      (see SetColumnLayout of BinData and UnBinData)
+    */
+   bool HasColumnLayout() const { return !fColumns.empty(); }
+
+   /**
+      return the array of the element icol of the points for all the points, 
+      or a NULL pointer if the data are not stored by columns 
+    */
+   const double * Column(unsigned int icol) const { 
+      if (icol >= fColumns.size() || fColumns[icol].empty() ) return 0; 
+      return &(fColumns[icol].front());
+   }
+
+
+protected: 
+
+   /// fill one column for each of the pointSize elements of the npoints first points 
+   /// of data, reserving the space for all the points of data 
+   void FillColumns(const DataVector * data, unsigned int npoints, unsigned int pointSize); 
+
+   /// add a point of the data to the columns 
+   void AddToColumns(const double * point) { 
+      for (unsigned int i = 0; i < fColumns.size(); ++i) 
+         fColumns[i].push_back(point[i]); 
+   }
+
+   /// delete the columns 
+   void ClearColumns() { 
+      std::vector<std::vector<double> >().swap(fColumns);
+   }
+
+   /// copy the ndim coordinates of the n points starting from ipoint, point after point, in x. 
+   /// They are read from the external data if wrapper is not null, else from the columns 
+   /// if any, else from the points of pointSize elements of data 
+   void CopyCoords(unsigned int ipoint, unsigned int n, unsigned int ndim, const DataWrapper * wrapper, 
+                   const DataVector * data, unsigned int pointSize, double * x) const; 
+
+   std::vector<std::vector<double> > fColumns;  // copy of the data by columns (empty if not used)
+
 
 private: 
 
@@ -352,6 +396,16 @@ public:
       return fValues[ipoint];
    }
 
+   /// return the array of the icoord coordinate of all the points
+   const double * CoordArray(unsigned int icoord) const { 
+      return fCoords[icoord];
+   }
+
+   /// return the array of the values of all the points (null if not present)
+   const double * ValueArray() const { 
+      return fValues;
+   }
+
    double Error(unsigned int ipoint) const {       
       return (fErrors) ?  fErrors[ipoint]  : 0. ;
    } 
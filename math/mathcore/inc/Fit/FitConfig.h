@@ -182,6 +182,9 @@ public:
    ///Apply Weight correction for error matrix computation
    bool UseWeightCorrection() const { return fWeightCorr; }
 
+   /// number of threads evaluating the data points of the fit (1 = sequential, 0 = number of cores)
+   unsigned int NThreads() const { return fNThreads; }
+
 
    /// return vector of parameter indeces for which the Minos Error will be computed
    const std::vector<unsigned int> & MinosParams() const { return fMinosParams; }
@@ -200,6 +203,14 @@ public:
    ///apply the weight correction for error matric computation
    void SetWeightCorrection(bool on = true) { fWeightCorr = on; }
 
+   /**
+      set the number of threads evaluating in parallel the data points of the Chi2, 
+      likelihood or Poisson likelihood fits and of their gradients: 1 (the default) 
+      for the sequential evaluation, 0 for one thread per core. 
+      The model function must then be thread safe (see FitUtil.h)
+   */
+   void SetNThreads(unsigned int nthreads) { fNThreads = nthreads; }
+
    /// set parameter indeces for running Minos
    /// this can be used for running Minos on a subset of parameters - otherwise is run on all of them 
    /// if MinosErrors() is set 
@@ -217,6 +228,15 @@ public:
    */
    static void SetDefaultMinimizer(const char * type, const char * algo = 0); 
 
+   /**
+      static function to control the default number of threads of the fits (see SetNThreads), 
+      used by the configurations created afterwards (e.g. by TH1::Fit)
+   */
+   static void SetDefaultNThreads(unsigned int nthreads); 
+
+   /// default number of threads of the fits
+   static unsigned int DefaultNThreads(); 
+
  
 
 
@@ -230,6 +250,7 @@ private:
    bool fMinosErrors;      // do full error analysis using Minos
    bool fUpdateAfterFit;   // update the configuration after a fit using the result
    bool fWeightCorr;       // apply correction to errors for weights fits 
+   unsigned int fNThreads; // number of threads evaluating the data points
 
    std::vector<ROOT::Fit::ParameterSettings> fSettings;  // vector with the parameter settings
    std::vector<unsigned int> fMinosParams;               // vector with the parameter indeces for running Minos
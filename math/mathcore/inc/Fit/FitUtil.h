@@ -40,51 +40,72 @@ namespace FitUtil {
    typedef  ROOT::Math::IParamMultiFunction IModelFunction;
    typedef  ROOT::Math::IParamMultiGradFunction IGradModelFunction;
 
+   /** 
+       Parallel evaluation
+
+       The functions evaluating the Chi2, the LogL, the Poisson LogL and their gradients 
+       can use nthreads threads (nthreads = 0 means one thread per core, 1 the sequential 
+       evaluation). The data points are split in blocks of fixed size, evaluated by a pool 
+       of threads kept for the following evaluations, and the sums of the blocks are added 
+       in the order of the blocks: the result does not depend on the number of threads 
+       nor on their scheduling (but can differ in the last digits from the sequential 
+       evaluation). The model function is evaluated concurrently by the threads and must 
+       then be thread safe when called with the parameters (like a TF1 defined by an 
+       expression or a compiled function, but not an interpreted function). 
+       The integral fits (option "I") and the external data (DataWrapper) are always 
+       evaluated sequentially. 
+   */
+
+   /** 
+       return the number of threads used for nthreads (the number of cores if nthreads is 0)
+   */ 
+   unsigned int GetNThreads(unsigned int nthreads);
+
    /** Chi2 Functions */
 
    /** 
        evaluate the Chi2 given a model function and the data at the point x. 
        return also nPoints as the effective number of used points in the Chi2 evaluation
    */ 
-   double EvaluateChi2(const IModelFunction & func, const BinData & data, const double * x, unsigned int & nPoints);  
+   double EvaluateChi2(const IModelFunction & func, const BinData & data, const double * x, unsigned int & nPoints, unsigned int nthreads = 1);  
 
    /** 
        evaluate the effective Chi2 given a model function and the data at the point x. 
        The effective chi2 uses the errors on the coordinates : W = 1/(sigma_y**2 + ( sigma_x_i * df/dx_i )**2 )
        return also nPoints as the effective number of used points in the Chi2 evaluation
    */ 
-   double EvaluateChi2Effective(const IModelFunction & func, const BinData & data, const double * x, unsigned int & nPoints);  
+   double EvaluateChi2Effective(const IModelFunction & func, const BinData & data, const double * x, unsigned int & nPoints, unsigned int nthreads = 1);  
 
    /** 
        evaluate the Chi2 gradient given a model function and the data at the point x. 
        return also nPoints as the effective number of used points in the Chi2 evaluation
    */ 
-   void EvaluateChi2Gradient(const IModelFunction & func, const BinData & data, const double * x, double * grad, unsigned int & nPoints);  
+   void EvaluateChi2Gradient(const IModelFunction & func, const BinData & data, const double * x, double * grad, unsigned int & nPoints, unsigned int nthreads = 1);  
 
    /** 
        evaluate the LogL given a model function and the data at the point x. 
        return also nPoints as the effective number of used points in the LogL evaluation
    */ 
-   double EvaluateLogL(const IModelFunction & func, const UnBinData & data, const double * x, int iWeight, bool extended, unsigned int & nPoints);  
+   double EvaluateLogL(const IModelFunction & func, const UnBinData & data, const double * x, int iWeight, bool extended, unsigned int & nPoints, unsigned int nthreads = 1);  
 
    /** 
        evaluate the LogL gradient given a model function and the data at the point x. 
        return also nPoints as the effective number of used points in the LogL evaluation
    */ 
-   void EvaluateLogLGradient(const IModelFunction & func, const UnBinData & data, const double * x, double * grad, unsigned int & nPoints);  
+   void EvaluateLogLGradient(const IModelFunction & func, const UnBinData & data, const double * x, double * grad, unsigned int & nPoints, unsigned int nthreads = 1);  
 
    /** 
        evaluate the Poisson LogL given a model function and the data at the point x. 
        return also nPoints as the effective number of used points in the LogL evaluation
        By default is extended, pass extedend to false if want to be not extended (MultiNomial)
    */ 
-   double EvaluatePoissonLogL(const IModelFunction & func, const BinData & data, const double * x, int iWeight, bool extended, unsigned int & nPoints);  
+   double EvaluatePoissonLogL(const IModelFunction & func, const BinData & data, const double * x, int iWeight, bool extended, unsigned int & nPoints, unsigned int nthreads = 1);  
 
    /** 
        evaluate the Poisson LogL given a model function and the data at the point x. 
        return also nPoints as the effective number of used points in the LogL evaluation
    */ 
-   void EvaluatePoissonLogLGradient(const IModelFunction & func, const BinData & data, const double * x, double * grad);  
+   void EvaluatePoissonLogLGradient(const IModelFunction & func, const BinData & data, const double * x, double * grad, unsigned int nthreads = 1);  
 
 //    /** 
 //        Parallel evaluate the Chi2 given a model function and the data at the point x. 
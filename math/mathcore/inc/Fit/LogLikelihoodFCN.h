@@ -29,12 +29,6 @@
 #include "Fit/FitUtil.h"
 #endif
 
-#ifdef ROOT_FIT_PARALLEL
-#ifndef ROOT_Fit_FitUtilParallel
-#include "Fit/FitUtilParallel.h"
-#endif
-#endif
-
 namespace ROOT { 
 
    namespace Fit { 
@@ -72,6 +66,7 @@ public:
       fData(data), 
       fFunc(func), 
       fNEffPoints(0),
+      fNThreads(1),
       fGrad ( std::vector<double> ( func.NPar() ) )
    {}
   
@@ -97,7 +92,11 @@ private:
 public: 
 
    /// clone the function (need to return Base for Windows)
-   virtual BaseFunction * Clone() const { return  new LogLikelihoodFCN(fData,fFunc,fWeight,fIsExtended); }
+   virtual BaseFunction * Clone() const { 
+      LogLikelihoodFCN * fcn = new LogLikelihoodFCN(fData,fFunc,fWeight,fIsExtended); 
+      fcn->SetNThreads(fNThreads); 
+      return fcn; 
+   }
 
 
    //using BaseObjFunction::operator();
@@ -115,9 +114,15 @@ public:
    // need to be virtual to be instantited
    virtual void Gradient(const double *x, double *g) const { 
       // evaluate the chi2 gradient
-      FitUtil::EvaluateLogLGradient(fFunc, fData, x, g, fNEffPoints);
+      FitUtil::EvaluateLogLGradient(fFunc, fData, x, g, fNEffPoints, fNThreads);
    }
 
+   /// set the number of threads evaluating the data points (0 = number of cores, see FitUtil.h)
+   void SetNThreads(unsigned int nthreads) { fNThreads = nthreads; }
+
+   /// number of threads evaluating the data points
+   unsigned int NThreads() const { return fNThreads; }
+
    /// get type of fit method function
    virtual  typename BaseObjFunction::Type_t Type() const { return BaseObjFunction::kLogLikelihood; }
 
@@ -147,12 +152,7 @@ private:
     */
    virtual double DoEval (const double * x) const { 
       this->UpdateNCalls();
-
-#ifdef ROOT_FIT_PARALLEL
-      return FitUtilParallel::EvaluateLogL(fFunc, fData, x, fNEffPoints); 
-#else 
-      return FitUtil::EvaluateLogL(fFunc, fData, x, fWeight, fIsExtended, fNEffPoints); 
-#endif
+      return FitUtil::EvaluateLogL(fFunc, fData, x, fWeight, fIsExtended, fNEffPoints, fNThreads); 
    } 
 
    // for derivatives 
@@ -171,6 +171,8 @@ private:
 
    mutable unsigned int fNEffPoints;  // number of effective points used in the fit 
 
+   unsigned int fNThreads;            // number of threads evaluating the data points
+
    mutable std::vector<double> fGrad; // for derivatives
 
 
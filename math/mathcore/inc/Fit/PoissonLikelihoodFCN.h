@@ -71,6 +71,7 @@ public:
       fData(data),
       fFunc(func),
       fNEffPoints(0),
+      fNThreads(1),
       fGrad ( std::vector<double> ( func.NPar() ) )
    { }
 
@@ -96,7 +97,11 @@ private:
 public:
 
    /// clone the function (need to return Base for Windows)
-   virtual BaseFunction * Clone() const { return new  PoissonLikelihoodFCN(fData,fFunc,fWeight,fIsExtended); }
+   virtual BaseFunction * Clone() const {
+      PoissonLikelihoodFCN * fcn = new  PoissonLikelihoodFCN(fData,fFunc,fWeight,fIsExtended);
+      fcn->SetNThreads(fNThreads);
+      return fcn;
+   }
 
    // effective points used in the fit
    virtual unsigned int NFitPoints() const { return fNEffPoints; }
@@ -110,9 +115,15 @@ public:
    /// evaluate gradient
    virtual void Gradient(const double *x, double *g) const {
       // evaluate the chi2 gradient
-      FitUtil::EvaluatePoissonLogLGradient(fFunc, fData, x, g );
+      FitUtil::EvaluatePoissonLogLGradient(fFunc, fData, x, g, fNThreads );
    }
 
+   /// set the number of threads evaluating the data points (0 = number of cores, see FitUtil.h)
+   void SetNThreads(unsigned int nthreads) { fNThreads = nthreads; }
+
+   /// number of threads evaluating the data points
+   unsigned int NThreads() const { return fNThreads; }
+
    /// get type of fit method function
    virtual  typename BaseObjFunction::Type_t Type() const { return BaseObjFunction::kLogLikelihood; }
 
@@ -149,7 +160,7 @@ private:
     */
    virtual double DoEval (const double * x) const {
       this->UpdateNCalls();
-      return FitUtil::EvaluatePoissonLogL(fFunc, fData, x, fWeight, fIsExtended, fNEffPoints);
+      return FitUtil::EvaluatePoissonLogL(fFunc, fData, x, fWeight, fIsExtended, fNEffPoints, fNThreads);
    }
 
    // for derivatives
@@ -169,6 +180,7 @@ private:
 
    mutable unsigned int fNEffPoints;  // number of effective points used in the fit
 
+   unsigned int fNThreads;            // number of threads evaluating the data points
 
    mutable std::vector<double> fGrad; // for derivatives
 
@@ -205,6 +205,7 @@ public:
       (fDataVector->Data())[ index ] = x;
 
       fNPoints++;
+      if (HasColumnLayout()) AddLastToColumns();
    }
 
 
@@ -222,6 +223,7 @@ public:
       (fDataVector->Data())[ index+1 ] = y;
 
       fNPoints++;
+      if (HasColumnLayout()) AddLastToColumns();
    }
 
    /**
@@ -239,6 +241,7 @@ public:
       (fDataVector->Data())[ index+2 ] = z;
 
       fNPoints++;
+      if (HasColumnLayout()) AddLastToColumns();
    }
 
    /**
@@ -256,6 +259,7 @@ public:
          *itr++ = x[i]; 
 
       fNPoints++;
+      if (HasColumnLayout()) AddLastToColumns();
    }
 
    /**
@@ -274,6 +278,7 @@ public:
       *itr = w;
 
       fNPoints++;
+      if (HasColumnLayout()) AddLastToColumns();
    }
 
    /**
@@ -299,6 +304,38 @@ public:
    }
 
 
+   /**
+      Store the data also by columns: one contiguous array for each coordinate (and for the weight), 
+      in addition to the data stored point after point. 
+      The columns are filled with the points already added and are then kept up to date by Add. 
+      They are built only on demand, when this function is called, since they double the memory 
+      used by the data. They give a contiguous access to each coordinate (see CoordColumn and GetCoords), 
+      used by the Chi2 and likelihood evaluations of FitUtil to evaluate the model function on blocks 
+      of points. With on = false the columns are deleted. 
+      External data (DataWrapper) are already stored by columns and are not copied
+   */
+   void SetColumnLayout(bool on = true); 
+
+   /**
+      return the array of the coordinate icoord for all the points (icoord = NDim() for the weight), 
+      from the columns or from the external data. 
+      Return a NULL pointer if the data are not stored by columns 
+   */
+   const double * CoordColumn(unsigned int icoord) const { 
+      if (fDataWrapper) return (fNPoints > 0) ? fDataWrapper->CoordArray(icoord) : 0; 
+      return Column(icoord); 
+   }
+
+   /**
+      copy the coordinates of the n points starting from ipoint in the array x, 
+      point after point (x must have a size of at least n*NDim() ). 
+      This is the layout expected by IParamMultiFunction::EvalParN. 
+   */
+   void GetCoords(unsigned int ipoint, unsigned int n, double * x) const { 
+      assert(ipoint + n <= fNPoints); 
+      CopyCoords(ipoint, n, fDim, fDataWrapper, fDataVector, fPointSize, x); 
+   }
+
    /**
       resize the vector to the given npoints 
     */
@@ -340,6 +377,13 @@ protected:
 
    void SetNPoints(unsigned int n) { fNPoints = n; }
 
+private: 
+
+   /// add the last inserted point to the columns
+   void AddLastToColumns() { 
+      AddToColumns( &((fDataVector->Data())[ (fNPoints-1)*fPointSize ]) );
+   }
+
 private: 
 
    unsigned int fDim;         // coordinate data dimension
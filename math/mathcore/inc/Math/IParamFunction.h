@@ -125,6 +125,15 @@ public:
       return DoEvalPar(x, p); 
    }
 
+   /**
+      Evaluate function at the n points x and for given parameters p, storing the values in f.
+      The NDim() coordinates of each point are stored one after the other in x.
+      Use the virtual function DoEvalParN, which by default calls DoEvalPar for each point
+   */
+   void EvalParN(unsigned int n, const double * x, double * f, const double * p) const { 
+      DoEvalParN(n, x, f, p); 
+   }
+
    using BaseFunc::operator();
 
 
@@ -136,6 +145,15 @@ private:
    */
    virtual double DoEvalPar(const double * x, const double * p) const = 0; 
 
+   /**
+      Implementation of the evaluation at several points. 
+      Can be re-implemented by derived classes able to evaluate the points together
+   */
+   virtual void DoEvalParN(unsigned int n, const double * x, double * f, const double * p) const { 
+      const unsigned int ndim = NDim(); 
+      for (unsigned int i = 0; i < n; ++i) f[i] = DoEvalPar(x + i*ndim, p); 
+   }
+
    /**
       Implement the ROOT::Math::IBaseFunctionMultiDim interface DoEval(x) using the cached parameter values
    */
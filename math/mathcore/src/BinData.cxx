@@ -15,6 +15,7 @@
 
 #include <cassert> 
 #include <cmath>
+#include <algorithm>
 
 
 namespace ROOT { 
@@ -164,6 +165,7 @@ BinData::BinData(const BinData & rhs) :
    fBinEdge(rhs.fBinEdge)
 {
    // copy constructor (copy data vector or just the pointer)
+   fColumns = rhs.fColumns; 
    if (rhs.fDataVector != 0) fDataVector = new DataVector(*rhs.fDataVector);
    else if (rhs.fDataWrapper != 0) fDataWrapper = new DataWrapper(*rhs.fDataWrapper);
 }
@@ -189,6 +191,7 @@ BinData & BinData::operator= (const BinData & rhs) {
    fSumError2 = rhs.fSumError2;
    fBinEdge = rhs.fBinEdge;
    fRefVolume = rhs.fRefVolume;
+   fColumns = rhs.fColumns;
    // delete previous pointers 
    if (fDataVector) delete fDataVector; 
    if (fDataWrapper) delete fDataWrapper; 
@@ -240,6 +243,8 @@ void BinData::Initialize(unsigned int maxpoints, unsigned int dim , ErrorType er
    }
    // reserve space for bin width in case of integral options
    if (Opt().fIntegral) fBinEdge.reserve( maxpoints * fDim);
+   // the point size can have changed 
+   if (HasColumnLayout()) FillColumns(fDataVector, fNPoints, fPointSize); 
 }
 
 void BinData::Resize(unsigned int npoints) { 
@@ -255,6 +260,7 @@ void BinData::Resize(unsigned int npoints) {
       // delete extra points
       if (!fDataVector) return; 
       (fDataVector->Data()).resize( npoints * fPointSize);
+      if (HasColumnLayout()) FillColumns(fDataVector, fNPoints, fPointSize); 
    } 
    else 
       Initialize(nextraPoints, fDim, GetErrorType() ); 
@@ -273,6 +279,7 @@ void BinData::Add(double x, double y ) {
    *itr++ = y; 
    
    fNPoints++;
+   if (HasColumnLayout()) AddLastToColumns();
    fSumContent += y;  
 }
    
@@ -294,6 +301,7 @@ void BinData::Add(double x, double y, double ey) {
    *itr++ =  (ey!= 0) ? 1.0/ey : 0; 
    
    fNPoints++;
+   if (HasColumnLayout()) AddLastToColumns();
    fSumContent += y;  
    fSumError2 += ey*ey;  
 }
@@ -316,6 +324,7 @@ void BinData::Add(double x, double y, double ex, double ey) {
    *itr++ = ey; 
    
    fNPoints++;
+   if (HasColumnLayout()) AddLastToColumns();
    fSumContent += y;  
    fSumError2  += ey*ey;  
 }
@@ -339,6 +348,7 @@ void BinData::Add(double x, double y, double ex, double eyl , double eyh) {
    *itr++ = eyh; 
    
    fNPoints++;
+   if (HasColumnLayout()) AddLastToColumns();
    fSumContent += y;  
    fSumError2  += (eyl+eyh)*(eyl+eyh)/4;  
 }
@@ -364,6 +374,7 @@ void BinData::Add(const double *x, double val) {
    *itr++ = val; 
    
    fNPoints++;
+   if (HasColumnLayout()) AddLastToColumns();
    fSumContent += val;  
 }
 
@@ -388,6 +399,7 @@ void BinData::Add(const double *x, double val, double  eval) {
    *itr++ =  (eval!= 0) ? 1.0/eval : 0; 
    
    fNPoints++;
+   if (HasColumnLayout()) AddLastToColumns();
    fSumContent += val;  
    fSumError2  += eval*eval;  
 }
@@ -416,6 +428,7 @@ void BinData::Add(const double *x, double val, const double * ex, double  eval)
    *itr++ = eval; 
    
    fNPoints++;
+   if (HasColumnLayout()) AddLastToColumns();
    fSumContent += val;  
    fSumError2  += eval*eval;  
 }
@@ -444,6 +457,7 @@ void BinData::Add(const double *x, double val, const double * ex, double  elval,
    *itr++ = ehval; 
    
    fNPoints++;
+   if (HasColumnLayout()) AddLastToColumns();
    fSumContent += val;  
    fSumError2  += (elval+ehval)*(elval+ehval)/4;  
 }
@@ -476,6 +490,36 @@ void BinData::AddBinUpEdge(const double *xup ) {
 }
 
 
+void BinData::SetColumnLayout(bool on) { 
+   // store (or not) the data also by columns. 
+   // Nothing is done for external data, which are already stored by columns
+   if (!on) { 
+      ClearColumns(); 
+      return; 
+   }
+   if (fDataVector == 0 || fPointSize == 0) return; 
+   FillColumns(fDataVector, fNPoints, fPointSize); 
+}
+
+void BinData::GetValues(unsigned int ipoint, unsigned int n, double * y) const { 
+   // copy the values of the n points starting from ipoint
+   assert(ipoint + n <= fNPoints); 
+   if (n == 0) return; 
+   const double * col = ValueColumn(); 
+   if (col) { 
+      std::copy(col + ipoint, col + ipoint + n, y); 
+      return; 
+   }
+   if (fDataWrapper) { 
+      for (unsigned int i = 0; i < n; ++i) 
+         y[i] = fDataWrapper->Value(ipoint + i); 
+      return; 
+   }
+   const double * p = &((fDataVector->Data())[ ipoint*fPointSize + fDim ]);
+   for (unsigned int i = 0; i < n; ++i, p += fPointSize) 
+      y[i] = *p; 
+}
+
 BinData & BinData::LogTransform() { 
    // apply log transform on the bin data values
 
@@ -539,6 +583,7 @@ BinData & BinData::LogTransform() {
          ip++;
       }
       // in case of Noerror since we added the errors we have changes the type 
+      if (HasColumnLayout()) FillColumns(fDataVector, fNPoints, fPointSize); 
    return *this; 
    }
    // case of data wrapper - we copy the data and build a datavector
@@ -12,11 +12,48 @@
 
 #include "Fit/DataVector.h"
 
+#include <algorithm>
+
 
 namespace ROOT { 
 
    namespace Fit { 
 
+void FitData::FillColumns(const DataVector * data, unsigned int npoints, unsigned int pointSize) { 
+   // fill the columns with the points of data, 
+   // reserving the space for all the points which can be added
+   unsigned int capacity = (data && pointSize > 0) ? data->Size()/pointSize : 0; 
+   npoints = std::min(npoints, capacity); 
+   const double * p = (npoints > 0) ? &((data->Data()).front()) : 0; 
+   fColumns.resize(pointSize); 
+   for (unsigned int icol = 0; icol < pointSize; ++icol) { 
+      std::vector<double> & col = fColumns[icol]; 
+      col.clear(); 
+      col.reserve(capacity);
+      for (unsigned int i = 0; i < npoints; ++i) 
+         col.push_back(p[i*pointSize + icol]); 
+   }
+}
+
+void FitData::CopyCoords(unsigned int ipoint, unsigned int n, unsigned int ndim, const DataWrapper * wrapper, 
+                         const DataVector * data, unsigned int pointSize, double * x) const { 
+   // copy the coordinates of the n points starting from ipoint, point after point. 
+   // The external data are read by coordinate (DataWrapper::Coords uses a cache)
+   if (n == 0) return; 
+   if (wrapper || !fColumns.empty() ) { 
+      for (unsigned int icoord = 0; icoord < ndim; ++icoord) { 
+         const double * col = (wrapper) ? wrapper->CoordArray(icoord) : Column(icoord); 
+         col += ipoint; 
+         double * xc = x + icoord; 
+         for (unsigned int i = 0; i < n; ++i) 
+            xc[i*ndim] = col[i]; 
+      }
+      return; 
+   }
+   const double * p = &((data->Data())[ ipoint*pointSize ]);
+   for (unsigned int i = 0; i < n; ++i, p += pointSize, x += ndim) 
+      std::copy(p, p + ndim, x); 
+}
 
    } // end namespace Fit
 
@@ -37,6 +37,7 @@ namespace ROOT {
 namespace Fit { 
 
 
+static unsigned int gDefaultNThreads = 1; // default number of threads of the fits
 
 FitConfig::FitConfig(unsigned int npar) : 
    fNormErrors(false),
@@ -44,6 +45,7 @@ FitConfig::FitConfig(unsigned int npar) :
    fMinosErrors(false),    // do full Minos error analysis for all parameters
    fUpdateAfterFit(true),    // update after fit
    fWeightCorr(false),
+   fNThreads(gDefaultNThreads), 
    fSettings(std::vector<ParameterSettings>(npar) )  
 {
    // constructor implementation
@@ -69,6 +71,7 @@ FitConfig & FitConfig::operator = (const FitConfig &rhs) {
    fMinosErrors = rhs.fMinosErrors; 
    fUpdateAfterFit = rhs.fUpdateAfterFit;
    fWeightCorr     = rhs.fWeightCorr;
+   fNThreads       = rhs.fNThreads;
 
    fSettings = rhs.fSettings; 
    fMinosParams = rhs.fMinosParams; 
@@ -262,6 +265,16 @@ void FitConfig::SetDefaultMinimizer(const char * type, const char *algo ) {
    ROOT::Math::MinimizerOptions::SetDefaultMinimizer(type, algo); 
 } 
 
+void FitConfig::SetDefaultNThreads(unsigned int nthreads) { 
+   // set the default number of threads evaluating the data points
+   gDefaultNThreads = nthreads; 
+} 
+
+unsigned int FitConfig::DefaultNThreads() { 
+   // return the default number of threads evaluating the data points
+   return gDefaultNThreads; 
+} 
+
 void FitConfig::SetMinimizerOptions(const ROOT::Math::MinimizerOptions & minopt) {  
    // set all the minimizer options
    fMinimizerOpts = minopt; 
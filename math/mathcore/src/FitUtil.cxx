@@ -27,10 +27,17 @@
 #include "Math/Util.h"  // for safe log(x)
 
 #include <limits>
+#include <algorithm>
+#include <vector>
 #include <cmath>
 #include <cassert> 
 //#include <memory>
 
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
 //#define DEBUG
 #ifdef DEBUG
 #define NSAMPLE 10
@@ -174,6 +181,58 @@ namespace ROOT {
             unsigned int fIpar; 
          };
 
+         // internal class to evaluate the model function at the coordinates of the
+         // data points by blocks of points (see IParamMultiFunction::EvalParN), 
+         // which is much faster than one point at the time for TF1 formulas.
+         // The values must be requested in increasing point order. 
+         // The coordinates are read from the columns of the data (BinData or UnBinData) if any
+         template<class Data = BinData> 
+         class BlockEvaluator { 
+
+         public: 
+
+            BlockEvaluator(const IModelFunction & func, const Data & data, const double * p) : 
+               fFunc(func), 
+               fData(data), 
+               fParams(p), 
+               fFirst(0), 
+               fSize(0)
+            {}
+
+            double operator() (unsigned int i) { 
+               if (i < fFirst || i >= fFirst + fSize) Fill(i); 
+               return fValues[i - fFirst]; 
+            }
+
+         private: 
+
+            void Fill(unsigned int first) { 
+               const unsigned int kBlock = 256; 
+               const unsigned int ndim = fData.NDim(); 
+               fFirst = first; 
+               fSize = std::min(kBlock, fData.Size() - first); 
+               fValues.resize(kBlock); 
+               // in one dimension the columns (or the external data) are used directly
+               const double * x = (ndim == 1) ? fData.CoordColumn(0) : 0; 
+               if (x) 
+                  x += first; 
+               else { 
+                  fX.resize(kBlock*ndim); 
+                  fData.GetCoords(first, fSize, &fX.front()); 
+                  x = &fX.front(); 
+               }
+               fFunc.EvalParN(fSize, x, &fValues.front(), fParams); 
+            }
+
+            const IModelFunction & fFunc; 
+            const Data & fData; 
+            const double * fParams; 
+            unsigned int fFirst;            // first point of the current block
+            unsigned int fSize;             // number of points of the current block
+            std::vector<double> fX;         // coordinates of the points of the block
+            std::vector<double> fValues;    // function values of the points of the block
+         };
+
          // simple gradient calculator using the 2 points rule
 
          class SimpleGradientCalculator { 
@@ -321,27 +380,344 @@ namespace ROOT {
             }
          }
 
+         // number of data points of the blocks evaluated by the threads. The blocks 
+         // do not depend on the number of threads, such that the sums are the same
+         // (multiple of the blocks of BlockEvaluator)
+         const unsigned int kThreadBlock = 1024;
 
+         // task evaluating the iblock-th block of points 
+         typedef void (*BlockTask)(void * arg, unsigned int iblock);
 
-      } // end namespace  FitUtil      
+#ifndef _WIN32
+         // internal pool of threads running the blocks of a task. 
+         // The threads are created when first needed and then wait for the next tasks, 
+         // such that the many evaluations of a minimization do not create new threads. 
+         // The blocks are taken one after the other by the threads (the fastest ones 
+         // do more blocks), the calling thread included
+         class ThreadPool { 
 
+         public: 
+
+            static ThreadPool & Instance() { 
+               // the pool is never deleted since its threads are still waiting at exit
+               static ThreadPool * pool = new ThreadPool(); 
+               return *pool; 
+            }
+
+            // run the blocks [first, nblocks) of task with nthreads threads (caller included)
+            // return false if the pool is already running a task (of another fit or of the 
+            // model function itself): the caller must then run the blocks 
+            bool Run(unsigned int nthreads, BlockTask task, void * arg, unsigned int first, unsigned int nblocks) { 
+               if (pthread_mutex_trylock(&fRunMutex) != 0) return false; 
+               pthread_mutex_lock(&fMutex); 
+               // create the missing threads
+               while (fNThreads + 1 < nthreads) { 
+                  WorkerArg * warg = new WorkerArg(this, fNThreads, fGeneration); 
+                  pthread_t thread; 
+                  if (pthread_create(&thread, 0, &ThreadPool::Worker, warg) != 0) { 
+                     delete warg; 
+                     break; 
+                  }
+                  pthread_detach(thread); 
+                  fNThreads++; 
+               }
+               fTask = task; 
+               fArg = arg; 
+               fNext = first; 
+               fNBlocks = nblocks; 
+               fNActive = std::min(fNThreads, nthreads-1); 
+               fNRunning = fNActive; 
+               fGeneration++; 
+               pthread_cond_broadcast(&fWakeUp); 
+               pthread_mutex_unlock(&fMutex); 
+
+               RunBlocks(); 
+
+               pthread_mutex_lock(&fMutex); 
+               while (fNRunning > 0) pthread_cond_wait(&fDone, &fMutex); 
+               pthread_mutex_unlock(&fMutex); 
+               pthread_mutex_unlock(&fRunMutex); 
+               return true; 
+            }
+
+         private: 
+
+            struct WorkerArg { 
+               WorkerArg(ThreadPool * pool, unsigned int id, unsigned long generation) : 
+                  fPool(pool), fId(id), fGeneration(generation) {}
+               ThreadPool * fPool; 
+               unsigned int fId; 
+               unsigned long fGeneration; 
+            };
+
+            ThreadPool() : 
+               fNThreads(0), fNActive(0), fNRunning(0), fGeneration(0), 
+               fTask(0), fArg(0), fNext(0), fNBlocks(0)
+            { 
+               pthread_mutex_init(&fRunMutex, 0); 
+               pthread_mutex_init(&fMutex, 0); 
+               pthread_cond_init(&fWakeUp, 0); 
+               pthread_cond_init(&fDone, 0); 
+            }
+
+            // objects of this class are not meant to be copied / assigned
+            ThreadPool(const ThreadPool & rhs);
+            ThreadPool & operator=(const ThreadPool & rhs);
+
+            // take and run the blocks until there is none left
+            void RunBlocks() { 
+               for (;;) { 
+                  pthread_mutex_lock(&fMutex); 
+                  unsigned int iblock = fNext++; 
+                  pthread_mutex_unlock(&fMutex); 
+                  if (iblock >= fNBlocks) return; 
+                  fTask(fArg, iblock); 
+               }
+            }
+
+            static void * Worker(void * p) { 
+               WorkerArg * warg = (WorkerArg *) p; 
+               ThreadPool & pool = *warg->fPool; 
+               unsigned int id = warg->fId; 
+               unsigned long seen = warg->fGeneration; 
+               delete warg; 
+               pthread_mutex_lock(&pool.fMutex); 
+               for (;;) { 
+                  while (pool.fGeneration == seen) pthread_cond_wait(&pool.fWakeUp, &pool.fMutex); 
+                  seen = pool.fGeneration; 
+                  // threads beyond the ones requested by the task wait for the next one
+                  if (id >= pool.fNActive) continue; 
+                  pthread_mutex_unlock(&pool.fMutex); 
+                  pool.RunBlocks(); 
+                  pthread_mutex_lock(&pool.fMutex); 
+                  if (--pool.fNRunning == 0) pthread_cond_signal(&pool.fDone); 
+               }
+               return 0; 
+            }
+
+            pthread_mutex_t fRunMutex;    // held while a task is running
+            pthread_mutex_t fMutex;       // protects the data members below
+            pthread_cond_t fWakeUp;       // signal a new task to the threads
+            pthread_cond_t fDone;         // signal the end of the task to the caller
+            unsigned int fNThreads;       // number of threads created 
+            unsigned int fNActive;        // number of threads running the current task
+            unsigned int fNRunning;       // number of threads still running the current task
+            unsigned long fGeneration;    // number of tasks started
+            BlockTask fTask;              // current task
+            void * fArg;                  // argument of the current task
+            unsigned int fNext;           // next block to run 
+            unsigned int fNBlocks;        // number of blocks of the current task
+         }; 
+#endif
+
+         // run the blocks [0,nblocks) of task with nthreads threads. 
+         // The first block is always run by the calling thread alone, such that 
+         // what is initialized at the first evaluation (e.g. the caches of the 
+         // function) is not done concurrently 
+         void RunBlocks(unsigned int nthreads, BlockTask task, void * arg, unsigned int nblocks) { 
+            if (nblocks == 0) return; 
+            task(arg, 0); 
+#ifndef _WIN32
+            if (nthreads > 1 && nblocks > 2 && ThreadPool::Instance().Run(nthreads, task, arg, 1, nblocks) ) return; 
+#endif
+            for (unsigned int iblock = 1; iblock < nblocks; ++iblock) task(arg, iblock); 
+         }
+
+         // internal class to compute nsum sums over the data points [0,n) by blocks 
+         // of kThreadBlock points in parallel. 
+         // The functor BlockFunc computes the sums of the points [ibegin, iend) with 
+         // operator()(ibegin, iend, double * sums) const and is called concurrently.
+         // The sums of the blocks are then added in the order of the blocks
+         template<class BlockFunc> 
+         class BlockSum { 
+
+         public: 
+
+            BlockSum(const BlockFunc & func, unsigned int n, unsigned int nsum) : 
+               fFunc(func), 
+               fN(n), 
+               fNSum(nsum), 
+               fNBlocks( (n + kThreadBlock - 1) / kThreadBlock ), 
+               fBlockSums( std::vector<double>( fNBlocks * nsum ) )
+            {}
+
+            void Evaluate(unsigned int nthreads, double * sums) { 
+               RunBlocks(nthreads, &BlockSum::Task, this, fNBlocks); 
+               std::fill(sums, sums + fNSum, 0.); 
+               for (unsigned int iblock = 0; iblock < fNBlocks; ++iblock) { 
+                  const double * bsums = &fBlockSums[iblock*fNSum]; 
+                  for (unsigned int k = 0; k < fNSum; ++k) sums[k] += bsums[k]; 
+               }
+            }
+
+         private: 
+
+            static void Task(void * arg, unsigned int iblock) { 
+               BlockSum * bs = (BlockSum *) arg; 
+               unsigned int ibegin = iblock * kThreadBlock; 
+               unsigned int iend = std::min(ibegin + kThreadBlock, bs->fN); 
+               bs->fFunc(ibegin, iend, &bs->fBlockSums[iblock*bs->fNSum]); 
+            }
+
+            const BlockFunc & fFunc; 
+            unsigned int fN; 
+            unsigned int fNSum; 
+            unsigned int fNBlocks; 
+            std::vector<double> fBlockSums;   // sums of each block
+         };
+
+         // compute the nsum sums of func over the n data points with nthreads threads
+         template<class BlockFunc> 
+         void ParallelSum(const BlockFunc & func, unsigned int n, unsigned int nthreads, unsigned int nsum, double * sums) { 
+            BlockSum<BlockFunc> bs(func, n, nsum); 
+            bs.Evaluate(nthreads, sums); 
+         }
+
+         // return true if the data points are evaluated in parallel. They are kept sequential: 
+         // - for external data (DataWrapper), since Coords() fills a cache shared by all the threads 
+         // - for the integral fits (option "I"), since each block creates its own integrator, 
+         //   through the plugin manager, which cannot be done at the same time by several threads
+         template<class Data> 
+         bool UseThreads(unsigned int nthreads, const Data & data) { 
+            return nthreads > 1 && data.Size() > kThreadBlock && data.DataSize() > 0 && !data.Opt().fIntegral; 
+         }
+
+
+         // evaluation of the data points [ibegin, iend) (implemented below)
+         double EvaluateChi2Points(const IModelFunction & func, const BinData & data, const double * p, unsigned int ibegin, unsigned int iend);
+         double EvaluateChi2EffectivePoints(const IModelFunction & func, const BinData & data, const double * p, unsigned int ibegin, unsigned int iend);
+         unsigned int EvaluateChi2GradientPoints(const IGradModelFunction & func, const BinData & data, const double * p, unsigned int ibegin, unsigned int iend, double * g);
+         double EvaluateLogLPoints(const IModelFunction & func, const UnBinData & data, const double * p, int iWeight, bool extended, double norm, 
+                                   unsigned int ibegin, unsigned int iend, double & sumW, double & sumW2);
+         void EvaluateLogLGradientPoints(const IGradModelFunction & func, const UnBinData & data, const double * p, unsigned int ibegin, unsigned int iend, double * g);
+         double EvaluatePoissonLogLPoints(const IModelFunction & func, const BinData & data, const double * p, int iWeight, bool extended, 
+                                          unsigned int ibegin, unsigned int iend, unsigned int & nPoints);
+         void EvaluatePoissonLogLGradientPoints(const IGradModelFunction & func, const BinData & data, const double * p, unsigned int ibegin, unsigned int iend, double * g);
+
+         // functors computing the sums of a block of points for ParallelSum
+
+         struct Chi2Block { 
+            Chi2Block(const IModelFunction & func, const BinData & data, const double * p) : 
+               fFunc(func), fData(data), fParams(p) {}
+            void operator() (unsigned int ibegin, unsigned int iend, double * sums) const { 
+               sums[0] = EvaluateChi2Points(fFunc, fData, fParams, ibegin, iend);
+            }
+            const IModelFunction & fFunc; 
+            const BinData & fData; 
+            const double * fParams; 
+         };
+
+         struct Chi2EffectiveBlock { 
+            Chi2EffectiveBlock(const IModelFunction & func, const BinData & data, const double * p) : 
+               fFunc(func), fData(data), fParams(p) {}
+            void operator() (unsigned int ibegin, unsigned int iend, double * sums) const { 
+               sums[0] = EvaluateChi2EffectivePoints(fFunc, fData, fParams, ibegin, iend);
+            }
+            const IModelFunction & fFunc; 
+            const BinData & fData; 
+            const double * fParams; 
+         };
+
+         // sums are the gradient followed by the number of rejected points
+         struct Chi2GradientBlock { 
+            Chi2GradientBlock(const IGradModelFunction & func, const BinData & data, const double * p) : 
+               fFunc(func), fData(data), fParams(p) {}
+            void operator() (unsigned int ibegin, unsigned int iend, double * sums) const { 
+               unsigned int npar = fFunc.NPar();
+               std::fill(sums, sums + npar, 0.);
+               sums[npar] = EvaluateChi2GradientPoints(fFunc, fData, fParams, ibegin, iend, sums);
+            }
+            const IGradModelFunction & fFunc; 
+            const BinData & fData; 
+            const double * fParams; 
+         };
+
+         // sums are the log likelihood, the sum of weights and the sum of weight squares
+         struct LogLBlock { 
+            LogLBlock(const IModelFunction & func, const UnBinData & data, const double * p, int iWeight, bool extended, double norm) : 
+               fFunc(func), fData(data), fParams(p), fWeight(iWeight), fExtended(extended), fNorm(norm) {}
+            void operator() (unsigned int ibegin, unsigned int iend, double * sums) const { 
+               sums[1] = 0; 
+               sums[2] = 0; 
+               sums[0] = EvaluateLogLPoints(fFunc, fData, fParams, fWeight, fExtended, fNorm, ibegin, iend, sums[1], sums[2]);
+            }
+            const IModelFunction & fFunc; 
+            const UnBinData & fData; 
+            const double * fParams; 
+            int fWeight; 
+            bool fExtended; 
+            double fNorm; 
+         };
+
+         struct LogLGradientBlock { 
+            LogLGradientBlock(const IGradModelFunction & func, const UnBinData & data, const double * p) : 
+               fFunc(func), fData(data), fParams(p) {}
+            void operator() (unsigned int ibegin, unsigned int iend, double * sums) const { 
+               std::fill(sums, sums + fFunc.NPar(), 0.);
+               EvaluateLogLGradientPoints(fFunc, fData, fParams, ibegin, iend, sums);
+            }
+            const IGradModelFunction & fFunc; 
+            const UnBinData & fData; 
+            const double * fParams; 
+         };
+
+         // sums are the log likelihood and the number of non empty bins
+         struct PoissonLogLBlock { 
+            PoissonLogLBlock(const IModelFunction & func, const BinData & data, const double * p, int iWeight, bool extended) : 
+               fFunc(func), fData(data), fParams(p), fWeight(iWeight), fExtended(extended) {}
+            void operator() (unsigned int ibegin, unsigned int iend, double * sums) const { 
+               unsigned int nPoints = 0; 
+               sums[0] = EvaluatePoissonLogLPoints(fFunc, fData, fParams, fWeight, fExtended, ibegin, iend, nPoints);
+               sums[1] = nPoints; 
+            }
+            const IModelFunction & fFunc; 
+            const BinData & fData; 
+            const double * fParams; 
+            int fWeight; 
+            bool fExtended; 
+         };
+
+         struct PoissonLogLGradientBlock { 
+            PoissonLogLGradientBlock(const IGradModelFunction & func, const BinData & data, const double * p) : 
+               fFunc(func), fData(data), fParams(p) {}
+            void operator() (unsigned int ibegin, unsigned int iend, double * sums) const { 
+               std::fill(sums, sums + fFunc.NPar(), 0.);
+               EvaluatePoissonLogLGradientPoints(fFunc, fData, fParams, ibegin, iend, sums);
+            }
+            const IGradModelFunction & fFunc; 
+            const BinData & fData; 
+            const double * fParams; 
+         };
+
+
+
+      } // end namespace  FitUtil
+
+
+unsigned int FitUtil::GetNThreads(unsigned int nthreads) {
+   // return the number of threads to use for nthreads: the number of cores if nthreads is 0
+   if (nthreads > 0) return nthreads;
+#ifndef _WIN32
+   long ncores = sysconf(_SC_NPROCESSORS_ONLN);
+   if (ncores > 1) return ncores;
+#endif
+   return 1;
+}
 
 
 //___________________________________________________________________________________________________________________________
 // for chi2 functions
 //___________________________________________________________________________________________________________________________
 
-double FitUtil::EvaluateChi2(const IModelFunction & func, const BinData & data, const double * p, unsigned int & nPoints) {  
-   // evaluate the chi2 given a  function reference  , the data and returns the value and also in nPoints 
-   // the actual number of used points
+double FitUtil::EvaluateChi2Points(const IModelFunction & func, const BinData & data, const double * p, unsigned int ibegin, unsigned int iend) {
+   // evaluate the chi2 of the data points [ibegin, iend) given a function reference and the data
    // normal chi2 using only error on values (from fitting histogram)
-   // optionally the integral of function in the bin is used 
-   
+   // optionally the integral of function in the bin is used
+
    unsigned int n = data.Size();
 
    double chi2 = 0;
-   nPoints = 0; // count the effective non-zero points
-   
+
    // do not cache parameter values (it is not thread safe)
    //func.SetParameters(p); 
 
@@ -362,6 +738,7 @@ double FitUtil::EvaluateChi2(const IModelFunction & func, const BinData & data,
 
 
    IntegralEvaluator<> igEval( func, p, useBinIntegral); 
+   BlockEvaluator<> blockEval( func, data, p); 
 
    double maxResValue = std::numeric_limits<double>::max() /n;
    double wrefVolume = 1.0; 
@@ -371,12 +748,24 @@ double FitUtil::EvaluateChi2(const IModelFunction & func, const BinData & data,
       xc.resize(data.NDim() );
    }
 
-   for (unsigned int i = 0; i < n; ++ i) { 
+   // when the data are stored by columns the values and the inverse errors are read from them 
+   // (the coordinates are then needed only by the block evaluator)
+   const double * yColumn = data.ValueColumn(); 
+   const double * invErrorColumn = data.InvErrorColumn(); 
+   bool useColumns = (yColumn != 0 && invErrorColumn != 0 && !useBinVolume && !useBinIntegral); 
+
+   for (unsigned int i = ibegin; i < iend; ++ i) { 
 
 
       double y, invError; 
-      // in case of no error in y invError=1 is returned
-      const double * x1 = data.GetPoint(i,y, invError);
+      const double * x1 = 0; 
+      if (useColumns) { 
+         y = yColumn[i]; 
+         invError = invErrorColumn[i]; 
+      }
+      else 
+         // in case of no error in y invError=1 is returned
+         x1 = data.GetPoint(i,y, invError);
 
       double fval = 0;
 
@@ -394,7 +783,10 @@ double FitUtil::EvaluateChi2(const IModelFunction & func, const BinData & data,
 
       const double * x = (useBinVolume) ? &xc.front() : x1;
 
-      if (!useBinIntegral) {
+      if (!useBinIntegral && !useBinVolume) {
+         fval = blockEval(i);
+      }
+      else if (!useBinIntegral) {
          fval = func ( x, p );
       }
       else {
@@ -427,7 +819,6 @@ double FitUtil::EvaluateChi2(const IModelFunction & func, const BinData & data,
 
 
       if (invError > 0) { 
-         nPoints++;
 
          double tmp = ( y -fval )* invError;  	  
          double resval = tmp * tmp;
@@ -444,22 +835,36 @@ double FitUtil::EvaluateChi2(const IModelFunction & func, const BinData & data,
 
       
    }
-   nPoints=n;
 
 #ifdef DEBUG
-   std::cout << "chi2 = " << chi2 << " n = " << nPoints  /*<< " rejected = " << nRejected */ << std::endl;
+   std::cout << "chi2 = " << chi2 << " points = [ " << ibegin << " , " << iend << " ) " << std::endl;
 #endif
 
 
    return chi2;
 }
 
+double FitUtil::EvaluateChi2(const IModelFunction & func, const BinData & data, const double * p, unsigned int & nPoints, unsigned int nthreads) {  
+   // evaluate the chi2 given a  function reference  , the data and returns the value and also in nPoints 
+   // the actual number of used points
+   // the data points are evaluated by nthreads threads (see FitUtil.h)
+
+   unsigned int n = data.Size();
+   nPoints = n;
+
+   nthreads = GetNThreads(nthreads);
+   if (!UseThreads(nthreads, data) ) return EvaluateChi2Points(func, data, p, 0, n);
+
+   double chi2 = 0;
+   ParallelSum(Chi2Block(func, data, p), n, nthreads, 1, &chi2);
+   return chi2;
+}
+
 
 //___________________________________________________________________________________________________________________________
 
-double FitUtil::EvaluateChi2Effective(const IModelFunction & func, const BinData & data, const double * p, unsigned int & nPoints) {  
-   // evaluate the chi2 given a  function reference  , the data and returns the value and also in nPoints 
-   // the actual number of used points
+double FitUtil::EvaluateChi2EffectivePoints(const IModelFunction & func, const BinData & data, const double * p, unsigned int ibegin, unsigned int iend) {
+   // evaluate the chi2 of the data points [ibegin, iend) given a function reference and the data
    // method using the error in the coordinates
    // integral of bin does not make sense in this case
    
@@ -487,7 +892,7 @@ double FitUtil::EvaluateChi2Effective(const IModelFunction & func, const BinData
 
 
 
-   for (unsigned int i = 0; i < n; ++ i) { 
+   for (unsigned int i = ibegin; i < iend; ++ i) { 
 
 
       double y = 0;
@@ -558,18 +963,32 @@ double FitUtil::EvaluateChi2Effective(const IModelFunction & func, const BinData
       
    }
    
-   // reset the number of fitting data points
-   nPoints = n;  // no points are rejected 
-   //if (nRejected != 0)  nPoints = n - nRejected;   
-
 #ifdef DEBUG
-   std::cout << "chi2 = " << chi2 << " n = " << nPoints  << std::endl;
+   std::cout << "chi2 = " << chi2 << " points = [ " << ibegin << " , " << iend << " ) " << std::endl;
 #endif
 
    return chi2;
 
 }
 
+double FitUtil::EvaluateChi2Effective(const IModelFunction & func, const BinData & data, const double * p, unsigned int & nPoints, unsigned int nthreads) {  
+   // evaluate the chi2 given a  function reference  , the data and returns the value and also in nPoints 
+   // the actual number of used points
+   // method using the error in the coordinates
+   // the data points are evaluated by nthreads threads (see FitUtil.h)
+
+   unsigned int n = data.Size();
+   // reset the number of fitting data points
+   nPoints = n;  // no points are rejected 
+
+   nthreads = GetNThreads(nthreads);
+   if (!UseThreads(nthreads, data) ) return EvaluateChi2EffectivePoints(func, data, p, 0, n);
+
+   double chi2 = 0;
+   ParallelSum(Chi2EffectiveBlock(func, data, p), n, nthreads, 1, &chi2);
+   return chi2;
+}
+
 
 //___________________________________________________________________________________________________________________________
 double FitUtil::EvaluateChi2Residual(const IModelFunction & func, const BinData & data, const double * p, unsigned int i, double * g) {  
@@ -683,28 +1102,15 @@ double FitUtil::EvaluateChi2Residual(const IModelFunction & func, const BinData
 
 }
 
-void FitUtil::EvaluateChi2Gradient(const IModelFunction & f, const BinData & data, const double * p, double * grad, unsigned int & nPoints) { 
-   // evaluate the gradient of the chi2 function
-   // this function is used when the model function knows how to calculate the derivative and we can  
-   // avoid that the minimizer re-computes them 
-   //
-   // case of chi2 effective (errors on coordinate) is not supported
-
-   if ( data.HaveCoordErrors() ) {
-      MATH_ERROR_MSG("FitUtil::EvaluateChi2Residual","Error on the coordinates are not used in calculating Chi2 gradient");            return; // it will assert otherwise later in GetPoint
-   }
+unsigned int FitUtil::EvaluateChi2GradientPoints(const IGradModelFunction & func, const BinData & data, const double * p, unsigned int ibegin, unsigned int iend, double * g) {
+   // add to g the gradient of the chi2 of the data points [ibegin, iend)
+   // return the number of points rejected for an overflow in the gradient calculation
 
    unsigned int nRejected = 0; 
 
-   const IGradModelFunction * fg = dynamic_cast<const IGradModelFunction *>( &f); 
-   assert (fg != 0); // must be called by a gradient function
-
-   const IGradModelFunction & func = *fg; 
-   unsigned int n = data.Size();
-
 
 #ifdef DEBUG
-   std::cout << "\n\nFit data size = " << n << std::endl;
+   std::cout << "\n\nFit data size = " << data.Size() << std::endl;
    std::cout << "evaluate chi2 using function gradient " << &func << "  " << p << std::endl; 
 #endif
 
@@ -727,10 +1133,8 @@ void FitUtil::EvaluateChi2Gradient(const IModelFunction & f, const BinData & dat
    unsigned int npar = func.NPar(); 
    //   assert (npar == NDim() );  // npar MUST be  Chi2 dimension
    std::vector<double> gradFunc( npar ); 
-   // set all vector values to zero
-   std::vector<double> g( npar); 
 
-   for (unsigned int i = 0; i < n; ++ i) { 
+   for (unsigned int i = ibegin; i < iend; ++ i) { 
 
 
       double y, invError = 0; 
@@ -806,6 +1210,37 @@ void FitUtil::EvaluateChi2Gradient(const IModelFunction & f, const BinData & dat
 
    } 
 
+   return nRejected;
+}
+
+void FitUtil::EvaluateChi2Gradient(const IModelFunction & f, const BinData & data, const double * p, double * grad, unsigned int & nPoints, unsigned int nthreads) { 
+   // evaluate the gradient of the chi2 function
+   // this function is used when the model function knows how to calculate the derivative and we can  
+   // avoid that the minimizer re-computes them 
+   // the data points are evaluated by nthreads threads (see FitUtil.h)
+   //
+   // case of chi2 effective (errors on coordinate) is not supported
+
+   if ( data.HaveCoordErrors() ) {
+      MATH_ERROR_MSG("FitUtil::EvaluateChi2Residual","Error on the coordinates are not used in calculating Chi2 gradient");            return; // it will assert otherwise later in GetPoint
+   }
+
+   const IGradModelFunction * fg = dynamic_cast<const IGradModelFunction *>( &f); 
+   assert (fg != 0); // must be called by a gradient function
+
+   const IGradModelFunction & func = *fg; 
+   unsigned int n = data.Size();
+   unsigned int npar = func.NPar(); 
+
+   // gradient followed by the number of rejected points
+   std::vector<double> g( npar + 1 ); 
+   nthreads = GetNThreads(nthreads);
+   if (!UseThreads(nthreads, data) ) 
+      g[npar] = EvaluateChi2GradientPoints(func, data, p, 0, n, &g[0]);
+   else 
+      ParallelSum(Chi2GradientBlock(func, data, p), n, nthreads, npar + 1, &g[0]);
+   unsigned int nRejected = (unsigned int) g[npar];
+
    // correct the number of points
    nPoints = n; 
    if (nRejected != 0)  {
@@ -815,7 +1250,7 @@ void FitUtil::EvaluateChi2Gradient(const IModelFunction & f, const BinData & dat
    } 
 
    // copy result 
-   std::copy(g.begin(), g.end(), grad);
+   std::copy(g.begin(), g.begin() + npar, grad);
 
 }
 
@@ -875,42 +1310,22 @@ double FitUtil::EvaluatePdf(const IModelFunction & func, const UnBinData & data,
    return logPdf;
 }
 
-double FitUtil::EvaluateLogL(const IModelFunction & func, const UnBinData & data, const double * p,
-                                   int iWeight,  bool extended, unsigned int &nPoints) {  
-   // evaluate the LogLikelihood 
-
-   unsigned int n = data.Size();
-
-#ifdef DEBUG
-   std::cout << "\n\nFit data size = " << n << std::endl;
-   std::cout << "func pointer is " << typeid(func).name() << std::endl;
-#endif
+double FitUtil::EvaluateLogLPoints(const IModelFunction & func, const UnBinData & data, const double * p,
+                                   int iWeight, bool extended, double norm, unsigned int ibegin, unsigned int iend, 
+                                   double & sumW, double & sumW2) {
+   // evaluate the sum of the log of the pdf of the data points [ibegin, iend), divided by norm
+   // add to sumW and sumW2 the sums of weights and weights square needed by the extended likelihood
 
    double logl = 0;
-   //unsigned int nRejected = 0; 
 
-   // this is needed if function must be normalized 
-   bool normalizeFunc = false; 
-   double norm = 1.0;
-   if (normalizeFunc) { 
-      // compute integral of the function 
-      std::vector<double> xmin(data.NDim());
-      std::vector<double> xmax(data.NDim());
-      IntegralEvaluator<> igEval( func, p, true); 
-      data.Range().GetRange(&xmin[0],&xmax[0]);
-      norm = igEval.Integral(&xmin[0],&xmax[0]);
-   }
-
-   // needed to compue effective global weight in case of extended likelihood 
-   double sumW = 0;
-   double sumW2 = 0;
+   BlockEvaluator<UnBinData> blockEval( func, data, p); 
 
-   for (unsigned int i = 0; i < n; ++ i) { 
-      const double * x = data.Coords(i);
-      double fval = func ( x, p ); 
-      if (normalizeFunc) fval = fval / norm;
+   for (unsigned int i = ibegin; i < iend; ++ i) { 
+      double fval = blockEval(i); 
+      if (norm != 1.0) fval = fval / norm;
 
 #ifdef DEBUG      
+      const double * x = data.Coords(i);
       std::cout << "x [ " << data.NDim() << " ] = "; 
       for (unsigned int j = 0; j < data.NDim(); ++j)
          std::cout << x[j] << "\t"; 
@@ -936,6 +1351,52 @@ double FitUtil::EvaluateLogL(const IModelFunction & func, const UnBinData & data
       logl += logval;
    }
 
+   return logl;
+}
+
+double FitUtil::EvaluateLogL(const IModelFunction & func, const UnBinData & data, const double * p,
+                                   int iWeight,  bool extended, unsigned int &nPoints, unsigned int nthreads) {  
+   // evaluate the LogLikelihood 
+   // the data points are evaluated by nthreads threads (see FitUtil.h)
+
+   unsigned int n = data.Size();
+
+#ifdef DEBUG
+   std::cout << "\n\nFit data size = " << n << std::endl;
+   std::cout << "func pointer is " << typeid(func).name() << std::endl;
+#endif
+
+   double logl = 0;
+   //unsigned int nRejected = 0; 
+
+   // this is needed if function must be normalized 
+   bool normalizeFunc = false; 
+   double norm = 1.0;
+   if (normalizeFunc) { 
+      // compute integral of the function 
+      std::vector<double> xmin(data.NDim());
+      std::vector<double> xmax(data.NDim());
+      IntegralEvaluator<> igEval( func, p, true); 
+      data.Range().GetRange(&xmin[0],&xmax[0]);
+      norm = igEval.Integral(&xmin[0],&xmax[0]);
+   }
+
+   // needed to compue effective global weight in case of extended likelihood 
+   double sumW = 0;
+   double sumW2 = 0;
+
+   nthreads = GetNThreads(nthreads);
+   if (!UseThreads(nthreads, data) ) { 
+      logl = EvaluateLogLPoints(func, data, p, iWeight, extended, norm, 0, n, sumW, sumW2);
+   }
+   else { 
+      double sums[3];
+      ParallelSum(LogLBlock(func, data, p, iWeight, extended, norm), n, nthreads, 3, sums);
+      logl = sums[0];
+      sumW = sums[1];
+      sumW2 = sums[2];
+   }
+
    if (extended) { 
       // add Poisson extended term
       double extendedTerm = 0; // extended term in likelihood  
@@ -991,21 +1452,16 @@ double FitUtil::EvaluateLogL(const IModelFunction & func, const UnBinData & data
    return -logl;
 }
 
-void FitUtil::EvaluateLogLGradient(const IModelFunction & f, const UnBinData & data, const double * p, double * grad, unsigned int & ) { 
-   // evaluate the gradient of the log likelihood function
-
-   const IGradModelFunction * fg = dynamic_cast<const IGradModelFunction *>( &f); 
-   assert (fg != 0); // must be called by a grad function
-   const IGradModelFunction & func = *fg; 
+void FitUtil::EvaluateLogLGradientPoints(const IGradModelFunction & func, const UnBinData & data, const double * p, unsigned int ibegin, unsigned int iend, double * g) { 
+   // add to g the gradient of the log likelihood of the data points [ibegin, iend)
 
    unsigned int n = data.Size();
    //int nRejected = 0; 
 
    unsigned int npar = func.NPar(); 
    std::vector<double> gradFunc( npar ); 
-   std::vector<double> g( npar); 
 
-   for (unsigned int i = 0; i < n; ++ i) { 
+   for (unsigned int i = ibegin; i < iend; ++ i) { 
       const double * x = data.Coords(i);
       double fval = func ( x , p); 
       func.ParameterGradient( x, p, &gradFunc[0] );
@@ -1022,11 +1478,30 @@ void FitUtil::EvaluateLogLGradient(const IModelFunction & f, const UnBinData & d
          }
          // if func derivative is zero term is also zero so do not add in g[kpar]
       }
-            
-    // copy result 
-   std::copy(g.begin(), g.end(), grad);
    }
 }
+
+void FitUtil::EvaluateLogLGradient(const IModelFunction & f, const UnBinData & data, const double * p, double * grad, unsigned int &, unsigned int nthreads ) { 
+   // evaluate the gradient of the log likelihood function
+   // the data points are evaluated by nthreads threads (see FitUtil.h)
+
+   const IGradModelFunction * fg = dynamic_cast<const IGradModelFunction *>( &f); 
+   assert (fg != 0); // must be called by a grad function
+   const IGradModelFunction & func = *fg; 
+
+   unsigned int n = data.Size();
+   unsigned int npar = func.NPar(); 
+   std::vector<double> g( npar); 
+
+   nthreads = GetNThreads(nthreads);
+   if (!UseThreads(nthreads, data) ) 
+      EvaluateLogLGradientPoints(func, data, p, 0, n, &g[0]);
+   else 
+      ParallelSum(LogLGradientBlock(func, data, p), n, nthreads, npar, &g[0]);
+
+   // copy result 
+   std::copy(g.begin(), g.end(), grad);
+}
 //_________________________________________________________________________________________________
 // for binned log likelihood functions      
 //------------------------------------------------------------------------------------------------
@@ -1136,35 +1611,19 @@ double FitUtil::EvaluatePoissonBinPdf(const IModelFunction & func, const BinData
    return logPdf;
 }
 
-double FitUtil::EvaluatePoissonLogL(const IModelFunction & func, const BinData & data, 
-                                    const double * p, int iWeight, bool extended,  unsigned int &   nPoints ) {  
-   // evaluate the Poisson Log Likelihood
-   // for binned likelihood fits
-   // this is Sum ( f(x_i)  -  y_i * log( f (x_i) ) )
-   // add as well constant term for saturated model to make it like a Chi2/2
-   // by default is etended. If extended is false the fit is not extended and 
-   // the global poisson term is removed (i.e is a binomial fit)
-   // (remember that in this case one needs to have a function with a fixed normalization
-   // like in a non extended binned fit)
-   //
-   // if use Weight use a weighted dataset 
-   // iWeight = 1 ==> logL = Sum( w f(x_i) )
-   // case of iWeight==1 is actually identical to weight==0
-   // iWeight = 2 ==> logL = Sum( w*w * f(x_i) )
-   //
-   // nPoints returns the points where bin content is not zero
-         
+double FitUtil::EvaluatePoissonLogLPoints(const IModelFunction & func, const BinData & data, 
+                                    const double * p, int iWeight, bool extended, unsigned int ibegin, unsigned int iend, 
+                                    unsigned int & nPoints ) {  
+   // evaluate the Poisson Log Likelihood of the data points [ibegin, iend) (see EvaluatePoissonLogL)
+   // add to nPoints the points where bin content is not zero
 
-   unsigned int n = data.Size();
 #ifdef DEBUG
    std::cout << "Evaluate PoissonLogL for params = [ "; 
    for (unsigned int j=0; j < func.NPar(); ++j) std::cout << p[j] << " , ";
-   std::cout << "]  - data size = " << n << std::endl;
+   std::cout << "]  - data size = " << data.Size() << std::endl;
 #endif
    
    double nloglike = 0;  // negative loglikelihood 
-   nPoints = 0;  // npoints
-
 
    // get fit option and check case of using integral of bins
    const DataOptions & fitOpt = data.Opt();
@@ -1180,13 +1639,14 @@ double FitUtil::EvaluatePoissonLogL(const IModelFunction & func, const BinData &
    }
 
    IntegralEvaluator<> igEval( func, p, fitOpt.fIntegral); 
+   BlockEvaluator<> blockEval( func, data, p); 
 
    // double nuTot = 0; // total number of expected events (needed for non-extended fits) 
    // double wTot = 0; // sum of all weights  
    // double w2Tot = 0; // sum of weight squared  (these are needed for useW2)
 
 
-   for (unsigned int i = 0; i < n; ++ i) { 
+   for (unsigned int i = ibegin; i < iend; ++ i) { 
       const double * x1 = data.Coords(i);
       double y = data.Value(i);
       
@@ -1206,7 +1666,10 @@ double FitUtil::EvaluatePoissonLogL(const IModelFunction & func, const BinData &
 
       const double * x = (useBinVolume) ? &xc.front() : x1;
 
-      if (!useBinIntegral) {
+      if (!useBinIntegral && !useBinVolume) {
+         fval = blockEval(i);
+      }
+      else if (!useBinIntegral) {
          fval = func ( x, p );
       }
       else {
@@ -1303,12 +1766,40 @@ double FitUtil::EvaluatePoissonLogL(const IModelFunction & func, const BinData &
    return nloglike;  
 }
 
-void FitUtil::EvaluatePoissonLogLGradient(const IModelFunction & f, const BinData & data, const double * p, double * grad ) { 
-   // evaluate the gradient of the Poisson log likelihood function
+double FitUtil::EvaluatePoissonLogL(const IModelFunction & func, const BinData & data, 
+                                    const double * p, int iWeight, bool extended,  unsigned int &   nPoints, unsigned int nthreads ) {  
+   // evaluate the Poisson Log Likelihood
+   // for binned likelihood fits
+   // this is Sum ( f(x_i)  -  y_i * log( f (x_i) ) )
+   // add as well constant term for saturated model to make it like a Chi2/2
+   // by default is etended. If extended is false the fit is not extended and 
+   // the global poisson term is removed (i.e is a binomial fit)
+   // (remember that in this case one needs to have a function with a fixed normalization
+   // like in a non extended binned fit)
+   //
+   // if use Weight use a weighted dataset 
+   // iWeight = 1 ==> logL = Sum( w f(x_i) )
+   // case of iWeight==1 is actually identical to weight==0
+   // iWeight = 2 ==> logL = Sum( w*w * f(x_i) )
+   //
+   // nPoints returns the points where bin content is not zero
+   // the data points are evaluated by nthreads threads (see FitUtil.h)
 
-   const IGradModelFunction * fg = dynamic_cast<const IGradModelFunction *>( &f); 
-   assert (fg != 0); // must be called by a grad function
-   const IGradModelFunction & func = *fg; 
+   unsigned int n = data.Size();
+   nPoints = 0;  // npoints
+
+   nthreads = GetNThreads(nthreads);
+   if (!UseThreads(nthreads, data) ) return EvaluatePoissonLogLPoints(func, data, p, iWeight, extended, 0, n, nPoints);
+
+   // negative loglikelihood and number of points 
+   double sums[2];
+   ParallelSum(PoissonLogLBlock(func, data, p, iWeight, extended), n, nthreads, 2, sums);
+   nPoints = (unsigned int) sums[1];
+   return sums[0];
+}
+
+void FitUtil::EvaluatePoissonLogLGradientPoints(const IGradModelFunction & func, const BinData & data, const double * p, unsigned int ibegin, unsigned int iend, double * g ) { 
+   // add to g the gradient of the Poisson log likelihood of the data points [ibegin, iend)
 
    unsigned int n = data.Size();
 
@@ -1327,9 +1818,8 @@ void FitUtil::EvaluatePoissonLogLGradient(const IModelFunction & f, const BinDat
 
    unsigned int npar = func.NPar(); 
    std::vector<double> gradFunc( npar ); 
-   std::vector<double> g( npar); 
 
-   for (unsigned int i = 0; i < n; ++ i) { 
+   for (unsigned int i = ibegin; i < iend; ++ i) { 
       const double * x1 = data.Coords(i);
       double y = data.Value(i);
       double fval = 0; 
@@ -1380,11 +1870,30 @@ void FitUtil::EvaluatePoissonLogLGradient(const IModelFunction & f, const BinDat
             g[kpar] -= gg;
          }
       }            
-
-      // copy result 
-      std::copy(g.begin(), g.end(), grad);
    }
 }
+
+void FitUtil::EvaluatePoissonLogLGradient(const IModelFunction & f, const BinData & data, const double * p, double * grad, unsigned int nthreads ) { 
+   // evaluate the gradient of the Poisson log likelihood function
+   // the data points are evaluated by nthreads threads (see FitUtil.h)
+
+   const IGradModelFunction * fg = dynamic_cast<const IGradModelFunction *>( &f); 
+   assert (fg != 0); // must be called by a grad function
+   const IGradModelFunction & func = *fg; 
+
+   unsigned int n = data.Size();
+   unsigned int npar = func.NPar(); 
+   std::vector<double> g( npar); 
+
+   nthreads = GetNThreads(nthreads);
+   if (!UseThreads(nthreads, data) ) 
+      EvaluatePoissonLogLGradientPoints(func, data, p, 0, n, &g[0]);
+   else 
+      ParallelSum(PoissonLogLGradientBlock(func, data, p), n, nthreads, npar, &g[0]);
+
+   // copy result 
+   std::copy(g.begin(), g.end(), grad);
+}
    
 }
 
@@ -194,6 +194,8 @@ void UnBinData::Initialize(unsigned int maxpoints, unsigned int dim, bool isWeig
       (fDataVector->Data()).resize( fDataVector->Size() + n );
    else 
       fDataVector = new DataVector( n);
+   // the point size can have changed 
+   if (HasColumnLayout()) FillColumns(fDataVector, fNPoints, fPointSize); 
 }
 
 void UnBinData::Resize(unsigned int npoints) { 
@@ -208,6 +210,7 @@ void UnBinData::Resize(unsigned int npoints) {
       if  (nextraPoints < 0) {
          // delete extra points
          (fDataVector->Data()).resize( npoints * fPointSize);
+         if (HasColumnLayout()) FillColumns(fDataVector, fNPoints, fPointSize); 
       }
       else if (nextraPoints > 0) { 
          // add extra points 
@@ -222,6 +225,17 @@ void UnBinData::Resize(unsigned int npoints) {
 
 
 
+void UnBinData::SetColumnLayout(bool on) { 
+   // store (or not) the data also by columns. 
+   // Nothing is done for external data, which are already stored by columns
+   if (!on) { 
+      ClearColumns(); 
+      return; 
+   }
+   if (fDataVector == 0 || fPointSize == 0) return; 
+   FillColumns(fDataVector, fNPoints, fPointSize); 
+}
+
    } // end namespace Fit
 
 } // end namespace ROOT
@@ -60,6 +60,8 @@ protected:
 
    static TUrl       fgProxy;           // globally set proxy URL
 
+   static void        *ThreadedGetFromWeb(void *arg);
+
    virtual void        Init(Bool_t readHeadOnly);
    virtual void        CheckProxy();
    virtual TString     BasicAuthentication();
@@ -71,6 +73,7 @@ protected:
    virtual Int_t       GetFromWeb10(char *buf, Int_t len, const TString &msg);
    virtual Bool_t      ReadBuffer10(char *buf, Int_t len);
    virtual Bool_t      ReadBuffers10(char *buf, Long64_t *pos, Int_t *len, Int_t nbuf);
+   virtual Bool_t      ReadBuffersModRoot(char *buf, Long64_t *pos, Int_t *len, Int_t nbuf);
    virtual void        SetMsgReadBuffer10(const char *redirectLocation = 0, Bool_t tempRedirect = kFALSE);
    virtual void        ProcessHttpHeader(const TString& headerLine);
 
@@ -73,6 +73,7 @@
 #include "TSystem.h"
 #include "TTimeStamp.h"
 #include "TVirtualPerfStats.h"
+#include "TFileReadPlan.h"
 
 // fgClientProtocol is now in TAuthenticate
 
@@ -323,6 +324,9 @@ Bool_t TNetFile::ReadBuffer(char *buf, Int_t len)
       return kFALSE;
    }
 
+   if ((st = ReadBufferViaBlockCache(buf, len)))
+      return st == 2;
+
    if (gApplication && gApplication->GetSignalHandler())
       gApplication->GetSignalHandler()->Delay();
 
@@ -391,11 +395,16 @@ Bool_t TNetFile::ReadBuffer(char *buf, Long64_t pos, Int_t len)
 Bool_t TNetFile::ReadBuffers(char *buf,  Long64_t *pos, Int_t *len, Int_t nbuf)
 {
    // Read a list of buffers given in pos[] and len[] and return it in a single
-   // buffer.
+   // buffer. The buffers close to each other are requested as a single
+   // range (see TFileReadPlan).
    // Returns kTRUE in case of error.
 
    if (!fSocket) return kTRUE;
 
+   Int_t st;
+   if ((st = ReadBuffersViaBlockCache(buf, pos, len, nbuf)))
+      return st == 2;
+
    // If it's an old version of the protocol try the default TFile::ReadBuffers
    if (fProtocol < 17)
       return TFile::ReadBuffers(buf, pos, len, nbuf);
@@ -412,19 +421,26 @@ Bool_t TNetFile::ReadBuffers(char *buf,  Long64_t *pos, Int_t *len, Int_t nbuf)
    Double_t start = 0;
    if (gPerfStats) start = TTimeStamp();
 
+   // Merge the buffers separated by small gaps
+   TFileReadPlan plan(pos, len, nbuf);
+   Int_t     nranges  = plan.GetNRanges();
+   Long64_t *rpos     = plan.GetPos();
+   Int_t    *rlen     = plan.GetLen();
+   char     *planned  = plan.IsDirect() ? buf : new char[plan.GetBufferSize()];
+
    // Make the string with a list of offsets and lengths
    Long64_t total_len = 0;
    Long64_t actual_pos;
-   for(Int_t i = 0; i < nbuf; i++) {
-      data_buf += pos[i] + fArchiveOffset;
+   for(Int_t i = 0; i < nranges; i++) {
+      data_buf += rpos[i] + fArchiveOffset;
       data_buf += "-";
-      data_buf += len[i];
+      data_buf += rlen[i];
       data_buf += "/";
-      total_len += len[i];
+      total_len += rlen[i];
    }
 
    // Send the command with the length of the info and number of buffers
-   if (fSocket->Send(Form("%d %d %d", nbuf, data_buf.Length(), blockSize),
+   if (fSocket->Send(Form("%d %d %d", nranges, data_buf.Length(), blockSize),
                           kROOTD_GETS) < 0) {
       Error("ReadBuffers", "error sending kROOTD_GETS command");
       result = kTRUE;
@@ -451,7 +467,7 @@ Bool_t TNetFile::ReadBuffers(char *buf,  Long64_t *pos, Int_t *len, Int_t nbuf)
          left = blockSize;
 
       Int_t n;
-      while ((n = fSocket->RecvRaw(buf + actual_pos, Int_t(left))) < 0 &&
+      while ((n = fSocket->RecvRaw(planned + actual_pos, Int_t(left))) < 0 &&
              TSystem::GetErrno() == EINTR)
          TSystem::ResetErrno();
 
@@ -476,6 +492,22 @@ Bool_t TNetFile::ReadBuffers(char *buf,  Long64_t *pos, Int_t *len, Int_t nbuf)
 
 end:
 
+   if (planned != buf) {
+      if (!result) {
+         plan.Scatter(planned, buf);
+         // The bytes of the gaps are not counted as read (see TFile::ReadBuffers).
+         Long64_t extra = total_len;
+         for (Int_t i = 0; i < nbuf; i++)
+            extra -= len[i];
+         if (extra > 0) {
+            fBytesReadExtra += extra;
+            fBytesRead      -= extra;
+            fgBytesRead     -= extra;
+         }
+      }
+      delete [] planned;
+   }
+
    if (gPerfStats)
       gPerfStats->FileReadEvent(this, total_len, start);
 
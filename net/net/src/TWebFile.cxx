@@ -26,12 +26,16 @@
 #include "TSystem.h"
 #include "TBase64.h"
 #include "TVirtualPerfStats.h"
+#include "TFileReadPlan.h"
+#include "TThread.h"
+#include "TVirtualMutex.h"
 #ifdef R__SSL
 #include "TSSLSocket.h"
 #endif
 
 #include <errno.h>
 #include <stdlib.h>
+#include <vector>
 
 #ifdef WIN32
 # ifndef EADDRINUSE
@@ -44,6 +48,25 @@
 
 static const char *gUserAgent = "User-Agent: ROOT-TWebFile/1.1";
 
+// Protect the statistics updated by the threads reading with mod_root.
+static TVirtualMutex *gWebFileMutex = 0;
+
+// One mod_root request, sent by ReadBuffersModRoot.
+struct TWebRequest {
+   char    *fBuffer;  // Where the data are received
+   Int_t    fLen;     // Total length of the ranges of the request
+   TString  fMsg;     // The request itself
+};
+
+// The requests sent by one of the threads of ReadBuffersModRoot.
+struct TWebRequestThread {
+   TWebFile                 *fFile;     // File read
+   std::vector<TWebRequest> *fRequests; // All the requests
+   Int_t                     fFirst;    // First request sent by this thread
+   Int_t                     fStep;     // Distance between two requests sent by this thread
+   Bool_t                    fFailed;   // True if one of the requests failed
+};
+
 TUrl TWebFile::fgProxy;
 
 
@@ -404,6 +427,9 @@ Bool_t TWebFile::ReadBuffer(char *buf, Int_t len)
       return kFALSE;
    }
 
+   if ((st = ReadBufferViaBlockCache(buf, len)))
+      return st == 2;
+
    if (!fHasModRoot)
       return ReadBuffer10(buf, len);
 
@@ -480,10 +506,49 @@ Bool_t TWebFile::ReadBuffers(char *buf, Long64_t *pos, Int_t *len, Int_t nbuf)
    // where pos[i] is the seek position of block i of length len[i].
    // Note that for nbuf=1, this call is equivalent to TFile::ReafBuffer
    // This function is overloaded by TNetFile, TWebFile, etc.
+   // The blocks close to each other are read in a single range and the
+   // large ranges are split (see TFileReadPlan). With mod_root the ranges
+   // may be read over several connections at once.
    // Returns kTRUE in case of failure.
 
+   Int_t st;
+   if ((st = ReadBuffersViaBlockCache(buf, pos, len, nbuf)))
+      return st == 2;
+
+   TFileReadPlan plan(pos, len, nbuf);
+   char *planned = plan.IsDirect() ? buf : new char[plan.GetBufferSize()];
+
+   Bool_t result;
    if (!fHasModRoot)
-      return ReadBuffers10(buf, pos, len, nbuf);
+      result = ReadBuffers10(planned, plan.GetPos(), plan.GetLen(), plan.GetNRanges());
+   else
+      result = ReadBuffersModRoot(planned, plan.GetPos(), plan.GetLen(), plan.GetNRanges());
+
+   if (!result && planned != buf) {
+      plan.Scatter(planned, buf);
+      // The bytes of the gaps are not counted as read (see TFile::ReadBuffers).
+      Long64_t extra = plan.GetBufferSize();
+      for (Int_t i = 0; i < nbuf; i++)
+         extra -= len[i];
+      if (extra > 0) {
+         fBytesReadExtra += extra;
+         fBytesRead      -= extra;
+         fgBytesRead     -= extra;
+      }
+   }
+   if (planned != buf) delete [] planned;
+
+   return result;
+}
+
+//______________________________________________________________________________
+Bool_t TWebFile::ReadBuffersModRoot(char *buf, Long64_t *pos, Int_t *len, Int_t nbuf)
+{
+   // Read the nbuf ranges described in arrays pos and len from a server
+   // running mod_root. Each request uses its own connection, so when
+   // TFileReadPlan::GetConnections() is larger than one, the ranges are
+   // spread over that many requests sent concurrently by separate threads.
+   // Returns kTRUE in case of failure.
 
    // Give full URL so Apache's virtual hosts solution works.
    // Use protocol 0.9 for efficiency, we are not interested in the 1.0 headers.
@@ -492,31 +557,90 @@ Bool_t TWebFile::ReadBuffers(char *buf, Long64_t *pos, Int_t *len, Int_t nbuf)
       fMsgReadBuffer += fBasicUrl;
       fMsgReadBuffer += "?";
    }
-   TString msg = fMsgReadBuffer;
 
-   Int_t k = 0, n = 0;
+   Int_t nconn     = TFileReadPlan::GetConnections();
+   Int_t maxranges = nconn > 1 ? (nbuf + nconn - 1) / nconn : nbuf;
+
+   std::vector<TWebRequest> requests;
+   TWebRequest req;
+   req.fBuffer = buf;
+   req.fLen    = 0;
+   req.fMsg    = fMsgReadBuffer;
+   Int_t nranges = 0;
    for (Int_t i = 0; i < nbuf; i++) {
-      if (n) msg += ",";
-      msg += pos[i] + fArchiveOffset;
-      msg += ":";
-      msg += len[i];
-      n   += len[i];
-      if (msg.Length() > 8000) {
-         msg += "\r\n";
-         if (GetFromWeb(&buf[k], n, msg) == -1)
+      if (nranges) req.fMsg += ",";
+      req.fMsg += pos[i] + fArchiveOffset;
+      req.fMsg += ":";
+      req.fMsg += len[i];
+      req.fLen += len[i];
+      nranges++;
+      if (req.fMsg.Length() > 8000 || nranges >= maxranges || i == nbuf-1) {
+         req.fMsg += "\r\n";
+         requests.push_back(req);
+         req.fBuffer += req.fLen;
+         req.fLen     = 0;
+         req.fMsg     = fMsgReadBuffer;
+         nranges      = 0;
+      }
+   }
+
+   Int_t nthreads = nconn < (Int_t)requests.size() ? nconn : (Int_t)requests.size();
+   if (nthreads <= 1) {
+      for (UInt_t r = 0; r < requests.size(); r++) {
+         if (GetFromWeb(requests[r].fBuffer, requests[r].fLen, requests[r].fMsg) == -1)
             return kTRUE;
-         msg = fMsgReadBuffer;
-         k += n;
-         n = 0;
       }
+      return kFALSE;
    }
 
-   msg += "\r\n";
+   // The first share of the requests is sent by this thread.
+   std::vector<TWebRequestThread> args(nthreads);
+   std::vector<TThread*> threads(nthreads, (TThread*)0);
+   for (Int_t t = 0; t < nthreads; t++) {
+      args[t].fFile     = this;
+      args[t].fRequests = &requests;
+      args[t].fFirst    = t;
+      args[t].fStep     = nthreads;
+      args[t].fFailed   = kFALSE;
+      if (t == 0) continue;
+      threads[t] = new TThread("TWebFileRead", ThreadedGetFromWeb, (void*)&args[t]);
+      if (threads[t]->Run()) {
+         // Could not start the thread, send its requests from here.
+         delete threads[t];
+         threads[t] = 0;
+      }
+   }
+   ThreadedGetFromWeb((void*)&args[0]);
 
-   if (GetFromWeb(&buf[k], n, msg) == -1)
-      return kTRUE;
+   Bool_t result = args[0].fFailed;
+   for (Int_t t = 1; t < nthreads; t++) {
+      if (threads[t]) {
+         threads[t]->Join();
+         delete threads[t];
+      } else {
+         ThreadedGetFromWeb((void*)&args[t]);
+      }
+      if (args[t].fFailed) result = kTRUE;
+   }
+   return result;
+}
 
-   return kFALSE;
+//______________________________________________________________________________
+void *TWebFile::ThreadedGetFromWeb(void *arg)
+{
+   // This is a static function.
+   // Send the share of the requests of one of the threads of
+   // ReadBuffersModRoot (arg is a TWebRequestThread).
+
+   TWebRequestThread *share = (TWebRequestThread*)arg;
+   std::vector<TWebRequest> &requests = *share->fRequests;
+   for (UInt_t r = share->fFirst; r < requests.size(); r += share->fStep) {
+      if (share->fFile->GetFromWeb(requests[r].fBuffer, requests[r].fLen, requests[r].fMsg) == -1) {
+         share->fFailed = kTRUE;
+         break;
+      }
+   }
+   return (void *)0;
 }
 
 //______________________________________________________________________________
@@ -607,19 +731,23 @@ Int_t TWebFile::GetFromWeb(char *buf, Int_t len, const TString &msg)
       return -1;
    }
 
-   // collect statistics
-   fBytesRead += len;
-   fReadCalls++;
+   // collect statistics, GetFromWeb may be called by several threads
+   // (see ReadBuffersModRoot)
+   {
+      R__LOCKGUARD2(gWebFileMutex);
+      fBytesRead += len;
+      fReadCalls++;
 #ifdef R__WIN32
-   SetFileBytesRead(GetFileBytesRead() + len);
-   SetFileReadCalls(GetFileReadCalls() + 1);
+      SetFileBytesRead(GetFileBytesRead() + len);
+      SetFileReadCalls(GetFileReadCalls() + 1);
 #else
-   fgBytesRead += len;
-   fgReadCalls++;
+      fgBytesRead += len;
+      fgReadCalls++;
 #endif
 
-   if (gPerfStats)
-      gPerfStats->FileReadEvent(this, len, start);
+      if (gPerfStats)
+         gPerfStats->FileReadEvent(this, len, start);
+   }
 
    delete s;
    return 0;
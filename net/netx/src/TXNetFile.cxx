@@ -639,6 +639,10 @@ Bool_t TXNetFile::ReadBuffer(char *buffer, Int_t bufferLength)
    }
    }
 
+   // Read from the local block cache, if any (see TFileBlockCache)
+   if ((st = ReadBufferViaBlockCache(buffer, bufferLength)))
+      return st == 2;
+
    Double_t start = 0;
    if (gPerfStats) start = TTimeStamp();
 
@@ -774,6 +778,10 @@ Bool_t TXNetFile::ReadBuffers(char *buf,  Long64_t *pos, Int_t *len, Int_t nbuf)
       return kTRUE;
    }
 
+   Int_t st;
+   if ((st = ReadBuffersViaBlockCache(buf, pos, len, nbuf)))
+      return st == 2;
+
    Double_t start = 0;
    if (gPerfStats) start = TTimeStamp();
 
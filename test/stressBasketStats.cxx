@@ -0,0 +1,376 @@
+/////////////////////////////////////////////////////////////////
+//
+//___A stress test for the basket statistics and compression dictionaries___
+//
+//   Writes two trees holding the same entries. The tree "stats" keeps the
+//   range of the values of its baskets (TTree::SetBasketStats) and
+//   compresses some branches with a dictionary
+//   (TTree::SetCompressionDictionary) and with Zstandard; the tree "plain"
+//   uses none of these. The functions below read the trees back:
+//   - Test1() - the entries, the basket ranges and the dictionaries
+//               read back from the file
+//   - Test2() - TTree::Draw with a selection gives the same entries with
+//               the basket filter (tree "stats") and without it (tree "plain")
+//   - Test3() - same as Test2() for TTree::CopyTree
+//   - Test4() - the fast merge of hadd (TFileMerger) copies the basket
+//               ranges, which are still used by TTree::Draw
+//
+//   To run in batch mode, do
+//     stressBasketStats
+//     stressBasketStats 100000
+//   Here the parameter is the number of entries in each TTree.
+//   Default value is 20000
+//
+//   An example of output when all tests pass:
+// **********************************************************************
+// *************Starting basket statistics stress test*******************
+// **********************************************************************
+// **********Generating the data file, 2 trees of 20000 entries**********
+// **********************************************************************
+// Test1: Reading back the basket ranges and dictionaries------------- OK
+// Test2: TTree::Draw with and without the basket filter-------------- OK
+// Test3: TTree::CopyTree with and without the basket filter---------- OK
+// Test4: Basket ranges after the fast merge of hadd------------------ OK
+// **********************************************************************
+// *******************Deleting the data files****************************
+// **********************************************************************
+
+#include <stdlib.h>
+#include "Compression.h"
+#include "TApplication.h"
+#include "TBasketStatsFilter.h"
+#include "TBranch.h"
+#include "TEntryList.h"
+#include "TTree.h"
+#include "TRandom.h"
+#include "TROOT.h"
+#include "TH1F.h"
+#include "TCut.h"
+#include "TFile.h"
+#include "TFileMerger.h"
+#include "TSystem.h"
+
+Int_t stressBasketStats(Int_t nentries = 20000);
+void MakeTrees(Int_t nentries);
+
+const char *gFileName = "stressBasketStats.root";
+const char *gMergedFileName = "stressBasketStatsMerged.root";
+TCut gCut = "x>50 && x<60 && y>0";
+
+Bool_t Test1()
+{
+   //Compare the entries of the two trees and check the basket ranges
+   //and the compression dictionaries read back from the file
+
+   TFile f(gFileName);
+   TTree *stats = (TTree*)f.Get("stats");
+   TTree *plain = (TTree*)f.Get("plain");
+   if (!stats || !plain) return kFALSE;
+   if (stats->GetEntries() != plain->GetEntries()) return kFALSE;
+
+   Double_t sx, sy, px, py;
+   Int_t sn, sm, pn, pm;
+   stats->SetBranchAddress("x", &sx);
+   stats->SetBranchAddress("y", &sy);
+   stats->SetBranchAddress("n", &sn);
+   stats->SetBranchAddress("m", &sm);
+   plain->SetBranchAddress("x", &px);
+   plain->SetBranchAddress("y", &py);
+   plain->SetBranchAddress("n", &pn);
+   plain->SetBranchAddress("m", &pm);
+
+   TBranch *bx = stats->GetBranch("x");
+   TBranch *bn = stats->GetBranch("n");
+   TBranch *bm = stats->GetBranch("m");
+   if (!bx->GetBasketMin() || !bx->GetBasketMax()) return kFALSE;
+   if (plain->GetBranch("x")->GetBasketMin()) return kFALSE;
+   if (bx->GetWriteBasket() < 2) return kFALSE;
+   if (bn->GetCompressionDictionarySize() <= 0) return kFALSE;
+   if (bm->GetCompressionDictionarySize() <= 0) return kFALSE;
+
+   Int_t wrongentries = 0;
+   Int_t wrongranges = 0;
+   Long64_t *bentries = bx->GetBasketEntry();
+   Int_t nbaskets = bx->GetWriteBasket();
+   Int_t basket = 0;
+   Long64_t nentries = stats->GetEntries();
+   for (Long64_t i=0; i<nentries; i++){
+      stats->GetEntry(i);
+      plain->GetEntry(i);
+      if (sx != px || sy != py || sn != pn || sm != pm) wrongentries++;
+      while (basket < nbaskets && bentries[basket+1] <= i) basket++;
+      if (sx < bx->GetBasketMin()[basket] || sx > bx->GetBasketMax()[basket])
+         wrongranges++;
+   }
+   stats->ResetBranchAddresses();
+   plain->ResetBranchAddresses();
+
+   if (wrongentries>0 || wrongranges>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+Bool_t Test2()
+{
+   //Check that TTree::Draw selects the same entries with the basket filter
+   //(tree "stats") and without it (tree "plain"), and that the filter only
+   //skips entries which do not pass the selection
+
+   TFile f(gFileName);
+   TTree *stats = (TTree*)f.Get("stats");
+   TTree *plain = (TTree*)f.Get("plain");
+   if (!stats || !plain) return kFALSE;
+
+   stats->Draw(">>elist_stats", gCut, "entrylist");
+   TEntryList *elist_stats = (TEntryList*)gDirectory->Get("elist_stats");
+   plain->Draw(">>elist_plain", gCut, "entrylist");
+   TEntryList *elist_plain = (TEntryList*)gDirectory->Get("elist_plain");
+   if (!elist_stats || !elist_plain) return kFALSE;
+
+   Int_t wrongentries1 = 0;
+   if (elist_stats->GetN() == 0 || elist_stats->GetN() != elist_plain->GetN())
+      wrongentries1++;
+   else {
+      for (Long64_t i=0; i<elist_stats->GetN(); i++){
+         if (elist_stats->GetEntry(i) != elist_plain->GetEntry(i))
+            wrongentries1++;
+      }
+   }
+
+   Int_t range = 100;
+   TH1F *hstats = new TH1F("hstats", "hstats", range, 0, range);
+   TH1F *hplain = new TH1F("hplain", "hplain", range, 0, range);
+   stats->Draw("x >> hstats", gCut, "goff");
+   plain->Draw("x >> hplain", gCut, "goff");
+   Int_t wrongentries2 = 0;
+   for (Int_t i=0; i<range+2; i++){
+      if (hstats->GetBinContent(i) != hplain->GetBinContent(i))
+         wrongentries2++;
+   }
+   if (hstats->GetEntries() != elist_plain->GetN()) wrongentries2++;
+
+   //the filter must skip some entries, and none of them passes the cut
+   TBasketStatsFilter filter(stats, gCut.GetTitle());
+   Int_t wrongentries3 = 0;
+   if (filter.GetNcuts() == 0) wrongentries3++;
+   Long64_t nentries = stats->GetEntries();
+   for (Long64_t i=0; i<nentries; i++){
+      if (!filter.MayPass(i) && elist_plain->Contains(i))
+         wrongentries3++;
+   }
+   if (filter.GetNSkipped() == 0) wrongentries3++;
+
+   delete hstats;
+   delete hplain;
+   if (wrongentries1>0 || wrongentries2>0 || wrongentries3>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+Bool_t Test3()
+{
+   //Check that TTree::CopyTree copies the same entries with the basket
+   //filter (tree "stats") and without it (tree "plain")
+
+   TFile f(gFileName);
+   TTree *stats = (TTree*)f.Get("stats");
+   TTree *plain = (TTree*)f.Get("plain");
+   if (!stats || !plain) return kFALSE;
+
+   //the file is read only, make the copies in memory
+   gROOT->cd();
+   TTree *cstats = stats->CopyTree(gCut);
+   TTree *cplain = plain->CopyTree(gCut);
+   if (!cstats || !cplain) return kFALSE;
+
+   Int_t wrongentries = 0;
+   if (cstats->GetEntries() == 0 || cstats->GetEntries() != cplain->GetEntries())
+      wrongentries++;
+   else {
+      Double_t sx, sy, px, py;
+      cstats->SetBranchAddress("x", &sx);
+      cstats->SetBranchAddress("y", &sy);
+      cplain->SetBranchAddress("x", &px);
+      cplain->SetBranchAddress("y", &py);
+      for (Long64_t i=0; i<cstats->GetEntries(); i++){
+         cstats->GetEntry(i);
+         cplain->GetEntry(i);
+         if (sx != px || sy != py || !(sx>50 && sx<60 && sy>0))
+            wrongentries++;
+      }
+   }
+
+   delete cstats;
+   delete cplain;
+   if (wrongentries>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+Bool_t Test4()
+{
+   //Merge two copies of the file as hadd does, with the fast cloning of
+   //the baskets, and check that the baskets of the merged tree "stats"
+   //have the ranges of the baskets they were copied from. Then compare
+   //the entries selected by TTree::Draw in the merged trees
+
+   TFileMerger merger(kFALSE);
+   merger.SetPrintLevel(0);
+   if (!merger.OutputFile(gMergedFileName, "RECREATE")) return kFALSE;
+   merger.AddFile(gFileName, kFALSE);
+   merger.AddFile(gFileName, kFALSE);
+   if (!merger.Merge()) return kFALSE;
+
+   TFile f(gFileName);
+   TFile fmerged(gMergedFileName);
+   TTree *stats = (TTree*)f.Get("stats");
+   TTree *mstats = (TTree*)fmerged.Get("stats");
+   TTree *mplain = (TTree*)fmerged.Get("plain");
+   if (!stats || !mstats || !mplain) return kFALSE;
+   if (mstats->GetEntries() != 2*stats->GetEntries()) return kFALSE;
+
+   Int_t wrongranges = 0;
+   TBranch *bx = stats->GetBranch("x");
+   TBranch *mbx = mstats->GetBranch("x");
+   Int_t nbaskets = bx->GetWriteBasket();
+   if (!mbx->GetBasketMin() || mbx->GetWriteBasket() != 2*nbaskets) return kFALSE;
+   for (Int_t i=0; i<mbx->GetWriteBasket(); i++){
+      if (mbx->GetBasketMin()[i] != bx->GetBasketMin()[i%nbaskets] ||
+          mbx->GetBasketMax()[i] != bx->GetBasketMax()[i%nbaskets] ||
+          mbx->GetBasketMax()[i] - mbx->GetBasketMin()[i] > 100)
+         wrongranges++;
+   }
+
+   Int_t wrongentries = 0;
+   Long64_t n1 = mstats->Draw(">>elist_mstats", gCut, "entrylist");
+   TEntryList *elist_mstats = (TEntryList*)gDirectory->Get("elist_mstats");
+   Long64_t n2 = mplain->Draw(">>elist_mplain", gCut, "entrylist");
+   TEntryList *elist_mplain = (TEntryList*)gDirectory->Get("elist_mplain");
+   if (!elist_mstats || !elist_mplain || n1 == 0 || n1 != n2 ||
+       elist_mstats->GetN() != elist_mplain->GetN())
+      wrongentries++;
+   else {
+      for (Long64_t i=0; i<elist_mstats->GetN(); i++){
+         if (elist_mstats->GetEntry(i) != elist_mplain->GetEntry(i))
+            wrongentries++;
+      }
+   }
+   //the ranges of the merged baskets are used
+   TBasketStatsFilter filter(mstats, gCut.GetTitle());
+   for (Long64_t i=0; i<mstats->GetEntries(); i++) filter.MayPass(i);
+   if (filter.GetNSkipped() == 0) wrongentries++;
+
+   if (wrongentries>0 || wrongranges>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+void MakeTrees(Int_t nentries)
+{
+   //Creates a file with 2 trees holding the same nentries entries.
+   //x increases with the entry number, so that the ranges of its small
+   //baskets are narrow and the basket filter skips most of them
+
+   TFile *f1 = new TFile(gFileName, "RECREATE");
+   TTree *stats = new TTree("stats", "with basket statistics");
+   TTree *plain = new TTree("plain", "without basket statistics");
+
+   Double_t x, y;
+   Int_t n, m;
+   TTree *trees[2] = { stats, plain };
+   for (Int_t t=0; t<2; t++){
+      trees[t]->Branch("x", &x, "x/D", 4000);
+      trees[t]->Branch("y", &y, "y/D", 4000);
+      trees[t]->Branch("n", &n, "n/I", 2000);
+      trees[t]->Branch("m", &m, "m/I", 2000);
+   }
+   stats->SetBasketStats("*");
+   //'DZ' baskets for n, 'ZS' for y and 'DS' for m (these fall back to
+   //zlib when ROOT is built without Zstandard)
+   stats->SetCompressionSettings("y", ROOT::CompressionSettings(ROOT::kZSTD, 5));
+   stats->SetCompressionSettings("m", ROOT::CompressionSettings(ROOT::kZSTD, 5));
+   stats->SetCompressionDictionary("n");
+   stats->SetCompressionDictionary("m");
+
+   gRandom->SetSeed(4357);
+   Double_t step = 200./nentries;
+   for (Int_t i=0; i<nentries; i++){
+      x = i*step + gRandom->Gaus(0, 0.5);
+      y = gRandom->Uniform(-1, 1);
+      n = gRandom->Poisson(3);
+      m = 1000 + (i%16)*10 + gRandom->Integer(4);
+      stats->Fill();
+      plain->Fill();
+   }
+
+   f1->Write();
+   f1->Close();
+   delete f1;
+}
+
+void CleanUp()
+{
+   gSystem->Unlink(gFileName);
+   gSystem->Unlink(gMergedFileName);
+}
+
+Int_t stressBasketStats(Int_t nentries)
+{
+   MakeTrees(nentries);
+   printf("**********************************************************************\n");
+   printf("*************Starting basket statistics stress test*******************\n");
+   printf("**********************************************************************\n");
+   printf("**********Generating the data file, 2 trees of %d entries**********\n", nentries);
+   printf("**********************************************************************\n");
+
+   Bool_t ok1=kTRUE;
+   Bool_t ok2=kTRUE;
+   Bool_t ok3=kTRUE;
+   Bool_t ok4=kTRUE;
+
+   ok1 = Test1();
+   if (ok1)
+      printf("Test1: Reading back the basket ranges and dictionaries------------- OK\n");
+   else
+      printf("Test1: Reading back the basket ranges and dictionaries------------- FAILED\n");
+
+   ok2 = Test2();
+   if (ok2)
+      printf("Test2: TTree::Draw with and without the basket filter-------------- OK\n");
+   else
+      printf("Test2: TTree::Draw with and without the basket filter-------------- FAILED\n");
+
+   ok3 = Test3();
+   if (ok3)
+      printf("Test3: TTree::CopyTree with and without the basket filter---------- OK\n");
+   else
+      printf("Test3: TTree::CopyTree with and without the basket filter---------- FAILED\n");
+
+   ok4 = Test4();
+   if (ok4)
+      printf("Test4: Basket ranges after the fast merge of hadd------------------ OK\n");
+   else
+      printf("Test4: Basket ranges after the fast merge of hadd------------------ FAILED\n");
+
+   printf("**********************************************************************\n");
+   printf("*******************Deleting the data files****************************\n");
+   printf("**********************************************************************\n");
+   CleanUp();
+   return (ok1 && ok2 && ok3 && ok4) ? 0 : 1;
+}
+//_____________________________batch only_____________________
+#ifndef __CINT__
+
+int main(int argc, char *argv[])
+{
+   TApplication theApp("App", &argc, argv);
+   Int_t nentries = 20000;
+   if (argc > 1) nentries = atoi(argv[1]);
+   return stressBasketStats(nentries);
+}
+
+#endif
@@ -12,6 +12,10 @@
 //               and using ">>+elist" in TTree::Draw
 //   - Test3() - transforming TEventList objects into TEntryList objects for a TChain
 //   - Test4() - same as Test3() but for a TTree 
+//   - Test5() - entry lists with all or none of the entries of the chain
+//   - Test6() - merging and subtracting entry lists block by block, for
+//               blocks stored as lists and as bits, while they are being
+//               iterated
 //
 //   To run in batch mode, do
 //     stressEntryList
@@ -31,11 +35,14 @@
 // Test2: Adding and subtracting entry lists-------------------------- OK
 // Test3: TEntryList and TEventList for TChain------------------------ OK
 // Test4: TEntryList and TEventList for TTree------------------------- OK
+// Test5: Full and Empty TEntryList----------------------------------- OK
+// Test6: Merging and subtracting by blocks--------------------------- OK
 // **********************************************************************
 // *******************Deleting the data files****************************
 // **********************************************************************
 
 #include <stdlib.h>
+#include <vector>
 #include "TApplication.h"
 #include "TEntryList.h"
 #include "TEventList.h"
@@ -46,6 +53,8 @@
 #include "TCut.h"
 #include "TFile.h"
 #include "TSystem.h"
+#include "TList.h"
+#include "TMath.h"
 
 Int_t stressEntryList(Int_t nentries = 10000, Int_t nfiles = 10);
 void MakeTrees(Int_t nentries, Int_t nfiles);
@@ -511,6 +520,86 @@ Bool_t Test5()
       return kTRUE;
 }
 
+void FillEntryList(TEntryList *elist, std::vector<char> &passed, Double_t fraction)
+{
+   //Enter in elist a fraction of the entries, flagged in passed
+
+   for (UInt_t i=0; i<passed.size(); i++){
+      passed[i] = gRandom->Rndm() < fraction;
+      if (passed[i]) elist->Enter(i);
+   }
+   elist->OptimizeStorage();
+   //leave the list in the middle of an iteration
+   for (Long64_t i=0; i<elist->GetN()/2; i++) elist->Next();
+   elist->GetEntry(elist->GetN()/3);
+}
+
+Int_t CompareEntryList(TEntryList *elist, const std::vector<char> &passed)
+{
+   //Returns the number of entries of elist which differ from the ones
+   //flagged in passed, read in order, at random and with Contains
+
+   std::vector<Long64_t> entries;
+   for (UInt_t i=0; i<passed.size(); i++){
+      if (passed[i]) entries.push_back(i);
+   }
+   if (elist->GetN() != (Long64_t)entries.size()) return 1;
+   Int_t wrongentries = 0;
+   for (UInt_t k=0; k<entries.size(); k++){
+      if (elist->GetEntry(k) != entries[k]) wrongentries++;
+   }
+   for (Int_t j=0; j<100 && !entries.empty(); j++){
+      Int_t k = gRandom->Integer(entries.size());
+      if (elist->GetEntry(k) != entries[k]) wrongentries++;
+   }
+   for (UInt_t i=0; i<passed.size(); i+=7){
+      if ((elist->Contains(i) != 0) != (passed[i] != 0)) wrongentries++;
+   }
+   return wrongentries;
+}
+
+Bool_t Test6()
+{
+   //Merge and subtract entry lists of several blocks, whose blocks are
+   //stored as lists of passing entries, as bits or as lists of entries
+   //not passing. The lists are combined in the middle of an iteration,
+   //which must restart from the first entry
+
+   const Int_t n = 150000;
+   const Double_t fractions[] = { 0.005, 0.3, 0.995 };
+   const Int_t nfractions = sizeof(fractions)/sizeof(fractions[0]);
+   std::vector<char> passed1(n), passed2(n), expected(n);
+   Int_t wrongentries = 0;
+   gRandom->SetSeed(1234);
+   for (Int_t f1=0; f1<nfractions; f1++){
+      for (Int_t f2=0; f2<nfractions; f2++){
+         TEntryList el1("el1", "el1");
+         TEntryList el2("el2", "el2");
+         FillEntryList(&el1, passed1, fractions[f1]);
+         FillEntryList(&el2, passed2, fractions[f2]);
+         TList list;
+         list.Add(&el2);
+         el1.Merge(&list);
+         list.Clear();
+         for (Int_t i=0; i<n; i++) expected[i] = passed1[i] || passed2[i];
+         wrongentries += CompareEntryList(&el1, expected);
+
+         TEntryList el3("el3", "el3");
+         TEntryList el4("el4", "el4");
+         FillEntryList(&el3, passed1, fractions[f1]);
+         FillEntryList(&el4, passed2, fractions[f2]);
+         el3.Subtract(&el4);
+         for (Int_t i=0; i<n; i++) expected[i] = passed1[i] && !passed2[i];
+         wrongentries += CompareEntryList(&el3, expected);
+      }
+   }
+
+   if (wrongentries>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
 
 void MakeTrees(Int_t nentries, Int_t nfiles)
 {
@@ -613,6 +702,12 @@ Int_t stressEntryList(Int_t nentries, Int_t nfiles)
    else
       printf("Test5: Full and Empty TEntryList----------------------------------- FAILED\n");
 
+   Bool_t ok6 = Test6();
+   if (ok6)
+      printf("Test6: Merging and subtracting by blocks--------------------------- OK\n");
+   else
+      printf("Test6: Merging and subtracting by blocks--------------------------- FAILED\n");
+
    printf("**********************************************************************\n");
    printf("*******************Deleting the data files****************************\n");
    printf("**********************************************************************\n");
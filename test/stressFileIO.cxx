@@ -0,0 +1,532 @@
+/////////////////////////////////////////////////////////////////
+//
+//___A stress test for the low level reading of files___
+//
+//   Each test compares the result of an optimized way of reading a file
+//   with the result of the usual reads:
+//   - Test1() - TFile::SetMemoryMap: the entries read from a memory mapped
+//               file, with compressed baskets and baskets used in place,
+//               are the same as without the mapping, and so are the
+//               bytes read and the number of reads counted by the file
+//   - Test2() - TBufferFile arrays: the arrays written and read back in
+//               bulk, with the byte swapping of several values at once, are
+//               the same as the ones written and read value by value
+//   - Test3() - TFileReadPlan: the blocks copied out of the ranges planned
+//               for the remote files, with merged gaps and split ranges,
+//               are the blocks read one by one
+//   - Test4() - TFileBlockCache: the blocks read through the local disk
+//               cache, when they are missing, found or evicted, are the
+//               ones read from the file
+//
+//   To run in batch mode, do
+//     stressFileIO
+//     stressFileIO 100000
+//   Here the parameter is the number of entries in the TTree.
+//   Default value is 20000
+//
+//   An example of output when all tests pass:
+// **********************************************************************
+// *****************Starting file reading stress test********************
+// **********************************************************************
+// Test1: TFile::SetMemoryMap----------------------------------------- OK
+// Test2: TBufferFile arrays------------------------------------------ OK
+// Test3: TFileReadPlan----------------------------------------------- OK
+// Test4: TFileBlockCache--------------------------------------------- OK
+// **********************************************************************
+// *******************Deleting the data files****************************
+// **********************************************************************
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "TApplication.h"
+#include "TBranch.h"
+#include "TBufferFile.h"
+#include "TStreamerElement.h"
+#include "TVirtualStreamerInfo.h"
+#include "TTree.h"
+#include "TRandom.h"
+#include "TFile.h"
+#include "TFileBlockCache.h"
+#include "TFileReadPlan.h"
+#include "TString.h"
+#include "TSystem.h"
+
+Int_t stressFileIO(Int_t nentries = 20000);
+
+const char *gFileName = "stressFileIO.root";
+const char *gCacheDir = "stressFileIO.cache";
+
+class TStressCachedFile : public TFile {
+public:
+   Int_t fNFetches;   //number of ReadBuffers served by the file itself
+
+   TStressCachedFile(const char *name) : TFile(name), fNFetches(0) { }
+   //read through the block cache, as the remote files do
+   virtual Bool_t ReadBuffers(char *buf, Long64_t *pos, Int_t *len, Int_t nbuf)
+   {
+      Int_t st = ReadBuffersViaBlockCache(buf, pos, len, nbuf);
+      if (st) return st == 2;
+      fNFetches++;
+      return TFile::ReadBuffers(buf, pos, len, nbuf);
+   }
+};
+
+void MakeTree(Int_t nentries)
+{
+   //Creates the file holding the tree "T" read by the tests. The baskets
+   //of the branch u are not compressed
+
+   Double_t x;
+   Int_t    u;
+
+   TFile *file = new TFile(gFileName, "RECREATE");
+   TTree *tree = new TTree("T", "stressFileIO");
+   tree->Branch("x", &x, "x/D", 4000);
+   tree->Branch("u", &u, "u/I", 2000);
+   tree->GetBranch("u")->SetCompressionLevel(0);
+
+   gRandom->SetSeed(65539);
+   for (Int_t entry=0; entry<nentries; entry++){
+      x = gRandom->Gaus(0, 10);
+      u = gRandom->Integer(1000);
+      tree->Fill();
+   }
+   file->Write();
+   file->Close();
+   delete file;
+}
+
+Bool_t Test1()
+{
+   //Read the tree from a file with and without memory mapping and compare
+   //the bytes read and the number of reads counted by each file and by
+   //TFile::GetFileBytesRead, then the entries. Read a few blocks with
+   //ReadBuffers from both files too
+
+   TFile f1(gFileName);
+   TFile f2(gFileName);
+#ifndef WIN32
+   if (!f2.SetMemoryMap(kTRUE)) return kFALSE;
+#endif
+   TTree *t1 = (TTree*)f1.Get("T");
+   TTree *t2 = (TTree*)f2.Get("T");
+   if (!t1 || !t2) return kFALSE;
+
+   Double_t x1, x2;
+   Int_t u1, u2;
+   t1->SetBranchAddress("x", &x1);
+   t1->SetBranchAddress("u", &u1);
+   t2->SetBranchAddress("x", &x2);
+   t2->SetBranchAddress("u", &u2);
+
+   Int_t wrongentries = 0;
+   Long64_t bytes1 = f1.GetBytesRead();
+   Int_t    calls1 = f1.GetReadCalls();
+   for (Long64_t i=0; i<t1->GetEntries(); i++){
+      t1->GetEntry(i);
+   }
+   bytes1 = f1.GetBytesRead() - bytes1;
+   calls1 = f1.GetReadCalls() - calls1;
+
+   Long64_t bytes2 = f2.GetBytesRead();
+   Int_t    calls2 = f2.GetReadCalls();
+   Long64_t total2 = TFile::GetFileBytesRead();
+   for (Long64_t i=0; i<t2->GetEntries(); i++){
+      t2->GetEntry(i);
+   }
+   bytes2 = f2.GetBytesRead() - bytes2;
+   calls2 = f2.GetReadCalls() - calls2;
+   total2 = TFile::GetFileBytesRead() - total2;
+   if (bytes1 == 0 || bytes1 != bytes2 || calls1 != calls2 || total2 != bytes2)
+      wrongentries++;
+
+   for (Long64_t i=0; i<t1->GetEntries(); i++){
+      t1->GetEntry(i);
+      t2->GetEntry(i);
+      if (x1 != x2 || u1 != u2) wrongentries++;
+   }
+   t1->ResetBranchAddresses();
+   t2->ResetBranchAddresses();
+
+   //the first baskets of x, in the order of the file
+   TBranch *bx = t1->GetBranch("x");
+   Long64_t pos[4];
+   Int_t len[4];
+   Int_t size = 0;
+   for (Int_t i=0; i<4; i++){
+      pos[i] = bx->GetBasketSeek(i);
+      len[i] = bx->GetBasketBytes()[i];
+      size += len[i];
+   }
+   char *buf1 = new char[size];
+   char *buf2 = new char[size];
+   bytes1 = f1.GetBytesRead();
+   bytes2 = f2.GetBytesRead();
+   calls2 = f2.GetReadCalls();
+   if (f1.ReadBuffers(buf1, pos, len, 4) || f2.ReadBuffers(buf2, pos, len, 4) ||
+       memcmp(buf1, buf2, size))
+      wrongentries++;
+   if (f2.GetBytesRead() - bytes2 != size || f1.GetBytesRead() - bytes1 != size ||
+       f2.GetReadCalls() == calls2)
+      wrongentries++;
+   delete [] buf1;
+   delete [] buf2;
+
+   if (wrongentries>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+template <class T>
+Int_t CompareArrays(const T *x, Int_t n)
+{
+   //Write the array x with WriteFastArray and value by value, and read it
+   //back with ReadFastArray and value by value. Returns the number of
+   //differences between the buffers and between the values read
+
+   TBufferFile b1(TBuffer::kWrite);
+   TBufferFile b2(TBuffer::kWrite);
+   b1.WriteFastArray(x, n);
+   for (Int_t i=0; i<n; i++) b2 << x[i];
+   if (b1.Length() != b2.Length() || memcmp(b1.Buffer(), b2.Buffer(), b1.Length()))
+      return 1;
+
+   std::vector<T> y1(n+1), y2(n+1);
+   b1.SetReadMode();
+   b1.SetBufferOffset(0);
+   b1.ReadFastArray(&y1[0], n);
+   b2.SetReadMode();
+   b2.SetBufferOffset(0);
+   for (Int_t i=0; i<n; i++) b2 >> y2[i];
+   Int_t wrongvalues = 0;
+   for (Int_t i=0; i<n; i++){
+      if (y1[i] != x[i] || y2[i] != x[i]) wrongvalues++;
+   }
+   return wrongvalues;
+}
+
+Int_t CompareTruncatedArrays(Float_t *f, Double_t *d, Int_t n, TStreamerElement *ele)
+{
+   //Same as CompareArrays for the Float16_t and Double32_t arrays written
+   //as described by ele, whose values are compared after the truncation
+
+   Int_t wrongvalues = 0;
+   TBufferFile b1(TBuffer::kWrite);
+   TBufferFile b2(TBuffer::kWrite);
+   b1.WriteFastArrayFloat16(f, n, ele);
+   b1.WriteFastArrayDouble32(d, n, ele);
+   for (Int_t i=0; i<n; i++) b2.WriteFloat16(&f[i], ele);
+   for (Int_t i=0; i<n; i++) b2.WriteDouble32(&d[i], ele);
+   if (b1.Length() != b2.Length() || memcmp(b1.Buffer(), b2.Buffer(), b1.Length()))
+      wrongvalues++;
+
+   std::vector<Float_t> f1(n+1), f2(n+1);
+   std::vector<Double_t> d1(n+1), d2(n+1);
+   b1.SetReadMode();
+   b1.SetBufferOffset(0);
+   b1.ReadFastArrayFloat16(&f1[0], n, ele);
+   b1.ReadFastArrayDouble32(&d1[0], n, ele);
+   b2.SetReadMode();
+   b2.SetBufferOffset(0);
+   for (Int_t i=0; i<n; i++) b2.ReadFloat16(&f2[i], ele);
+   for (Int_t i=0; i<n; i++) b2.ReadDouble32(&d2[i], ele);
+   for (Int_t i=0; i<n; i++){
+      if (f1[i] != f2[i] || d1[i] != d2[i]) wrongvalues++;
+   }
+   return wrongvalues;
+}
+
+Bool_t Test2()
+{
+   //Write and read back arrays of each swapped type, of lengths covering
+   //the blocks swapped at once and the remaining values, in bulk and value
+   //by value (see Bytes.h and TBufferFile::WriteFastArray)
+
+   const Int_t sizes[] = { 0, 1, 3, 4, 7, 8, 15, 16, 17, 31, 33, 100, 257, 1000 };
+   const Int_t nmax = 1000;
+   const char *ranges[] = { "", "[0,0,10]", "[-50,50,14]", "[-50,50]" };
+   std::vector<Short_t>  h(nmax);
+   std::vector<Int_t>    i(nmax);
+   std::vector<Long64_t> l(nmax);
+   std::vector<Float_t>  f(nmax);
+   std::vector<Double_t> d(nmax);
+   gRandom->SetSeed(69069);
+   for (Int_t k=0; k<nmax; k++){
+      h[k] = (Short_t)(gRandom->Integer(65536) - 32768);
+      i[k] = (Int_t)gRandom->Integer(2000000000) - 1000000000;
+      l[k] = (Long64_t)i[k] * 1000003 + k;
+      d[k] = gRandom->Uniform(-50, 50);
+      f[k] = (Float_t)d[k];
+   }
+
+   Int_t wrongvalues = 0;
+   for (UInt_t s=0; s<sizeof(sizes)/sizeof(sizes[0]); s++){
+      Int_t n = sizes[s];
+      wrongvalues += CompareArrays(&h[0], n);
+      wrongvalues += CompareArrays(&i[0], n);
+      wrongvalues += CompareArrays(&l[0], n);
+      wrongvalues += CompareArrays(&f[0], n);
+      wrongvalues += CompareArrays(&d[0], n);
+      //an unaligned start
+      if (n > 0) {
+         wrongvalues += CompareArrays(&h[1], n-1);
+         wrongvalues += CompareArrays(&d[1], n-1);
+      }
+      for (UInt_t r=0; r<sizeof(ranges)/sizeof(ranges[0]); r++){
+         TStreamerElement f16("f", ranges[r], 0, TVirtualStreamerInfo::kFloat16, "Float16_t");
+         TStreamerElement d32("d", ranges[r], 0, TVirtualStreamerInfo::kDouble32, "Double32_t");
+         wrongvalues += CompareTruncatedArrays(&f[0], &d[0], n, &f16);
+         wrongvalues += CompareTruncatedArrays(&f[0], &d[0], n, &d32);
+      }
+   }
+
+   if (wrongvalues>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+Int_t CompareReadPlan(TFile *f, Long64_t *pos, Int_t *len, Int_t nbuf)
+{
+   //Read the nbuf blocks of f through a TFileReadPlan, as done by TWebFile
+   //and TNetFile::ReadBuffers, and compare them with the blocks read one by
+   //one. Check the ranges planned too. Returns the number of differences
+
+   Int_t wrong = 0;
+   TFileReadPlan plan(pos, len, nbuf);
+   Int_t size = 0;
+   for (Int_t i=0; i<nbuf; i++) size += len[i];
+   std::vector<char> expected(size+1), buf(size+1), planned(plan.GetBufferSize()+1);
+   Int_t k = 0;
+   for (Int_t i=0; i<nbuf; i++){
+      if (f->ReadBuffer(&expected[k], pos[i], len[i])) wrong++;
+      k += len[i];
+   }
+
+   //the ranges are sorted, do not overlap, are not larger than the maximum
+   //size and hold the planned buffer
+   char *dest = plan.IsDirect() ? &buf[0] : &planned[0];
+   Long64_t offset = 0;
+   for (Int_t r=0; r<plan.GetNRanges(); r++){
+      Long64_t p = plan.GetPos()[r];
+      Int_t l = plan.GetLen()[r];
+      if (l <= 0 || (r > 0 && p < plan.GetPos()[r-1] + plan.GetLen()[r-1])) wrong++;
+      if (TFileReadPlan::GetMaxSize() > 0 && l > TFileReadPlan::GetMaxSize()) wrong++;
+      if (f->ReadBuffer(dest + offset, p, l)) wrong++;
+      offset += l;
+   }
+   if (offset != plan.GetBufferSize()) wrong++;
+   if (plan.IsDirect() && offset != size) wrong++;
+   plan.Scatter(&planned[0], &buf[0]);
+   if (memcmp(&expected[0], &buf[0], size)) wrong++;
+   return wrong;
+}
+
+Bool_t Test3()
+{
+   //Plan the ranges of lists of blocks of the file, sorted or not, with
+   //gaps or overlapping, for several largest gaps and largest ranges, and
+   //read the blocks through the plans
+
+   TFile f(gFileName);
+   if (f.IsZombie()) return kFALSE;
+   Long64_t fsize = f.GetSize();
+   Int_t maxgap = TFileReadPlan::GetMaxGap();
+   Int_t maxsize = TFileReadPlan::GetMaxSize();
+   const Int_t gaps[] = { 0, 100, 10000 };
+   const Int_t maxsizes[] = { 0, 1000, 100000 };
+   const Int_t nmax = 50;
+   Long64_t pos[nmax];
+   Int_t len[nmax];
+
+   Int_t wrongvalues = 0;
+   gRandom->SetSeed(4357);
+   for (UInt_t g=0; g<sizeof(gaps)/sizeof(gaps[0]); g++){
+      TFileReadPlan::SetMaxGap(gaps[g]);
+      for (UInt_t m=0; m<sizeof(maxsizes)/sizeof(maxsizes[0]); m++){
+         TFileReadPlan::SetMaxSize(maxsizes[m]);
+         for (Int_t nbuf=1; nbuf<=nmax; nbuf+=7){
+            //contiguous blocks, in order: a single range, read in place
+            //unless it is split
+            Long64_t p = 100;
+            for (Int_t i=0; i<nbuf; i++){
+               len[i] = 1 + gRandom->Integer(500);
+               pos[i] = p;
+               p += len[i];
+            }
+            TFileReadPlan contiguous(pos, len, nbuf);
+            if (!contiguous.IsDirect()) wrongvalues++;
+            if (maxsizes[m] == 0 && contiguous.GetNRanges() != 1) wrongvalues++;
+            wrongvalues += CompareReadPlan(&f, pos, len, nbuf);
+            //blocks in order separated by gaps
+            p = 100;
+            for (Int_t i=0; i<nbuf; i++){
+               len[i] = 1 + gRandom->Integer(500);
+               pos[i] = p;
+               p += len[i] + gRandom->Integer(300);
+            }
+            wrongvalues += CompareReadPlan(&f, pos, len, nbuf);
+            //blocks anywhere in the file, in any order and overlapping
+            for (Int_t i=0; i<nbuf; i++){
+               len[i] = 1 + gRandom->Integer(2000);
+               pos[i] = (Long64_t)gRandom->Integer((UInt_t)(fsize - len[i]));
+            }
+            wrongvalues += CompareReadPlan(&f, pos, len, nbuf);
+         }
+      }
+   }
+   TFileReadPlan::SetMaxGap(maxgap);
+   TFileReadPlan::SetMaxSize(maxsize);
+
+   if (wrongvalues>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+Int_t CountCacheEntries()
+{
+   //Returns the number of entries of the cache directory, the lock file
+   //excepted
+
+   void *dirp = gSystem->OpenDirectory(gCacheDir);
+   if (!dirp) return -1;
+   Int_t n = 0;
+   const char *ent;
+   while ((ent = gSystem->GetDirEntry(dirp))) {
+      if (ent[0] != '.') n++;
+   }
+   gSystem->FreeDirectory(dirp);
+   return n;
+}
+
+Int_t CompareCachedRead(Long64_t *pos, Int_t *len, Int_t nbuf, Int_t nfetches)
+{
+   //Read the nbuf blocks through the block cache and directly from the
+   //file and compare them. The cached file must have read nfetches times
+   //from the file. Returns the number of differences
+
+   Int_t size = 0;
+   for (Int_t i=0; i<nbuf; i++) size += len[i];
+   std::vector<char> buf1(size), buf2(size);
+   Int_t wrong = 0;
+   TFile f1(gFileName);
+   TStressCachedFile f2(gFileName);
+   if (f1.ReadBuffers(&buf1[0], pos, len, nbuf) || f2.ReadBuffers(&buf2[0], pos, len, nbuf) ||
+       memcmp(&buf1[0], &buf2[0], size))
+      wrong++;
+   if (f2.fNFetches != nfetches) wrong++;
+   return wrong;
+}
+
+Bool_t Test4()
+{
+   //Read blocks of the file through a TFileBlockCache: the first read
+   //misses and stores the blocks in the cache directory, the second one
+   //finds them there. Evict the blocks, with the directory of the file,
+   //and read them again
+
+   const char *olddir = TFileBlockCache::GetDirectory();
+   TString saveddir = olddir ? olddir : "";
+   Long64_t savedsize = TFileBlockCache::GetMaxSize();
+   if (!TFileBlockCache::SetDirectory(gCacheDir, 100000000)) return kFALSE;
+
+   TFile f(gFileName);
+   TTree *tree = (TTree*)f.Get("T");
+   if (!tree) return kFALSE;
+   //the baskets of x, in the order of the file and spread over several blocks
+   TBranch *bx = tree->GetBranch("x");
+   const Int_t nmax = 100;
+   Long64_t pos[nmax];
+   Int_t len[nmax];
+   Int_t nbuf = 0;
+   for (Int_t i=0; i<bx->GetWriteBasket() && nbuf<nmax; i+=3){
+      pos[nbuf] = bx->GetBasketSeek(i);
+      len[nbuf] = bx->GetBasketBytes()[i];
+      nbuf++;
+   }
+
+   Int_t wrongvalues = 0;
+   //a miss, and the blocks are stored
+   wrongvalues += CompareCachedRead(pos, len, nbuf, 1);
+   if (CountCacheEntries() != 1) wrongvalues++;
+   //a hit
+   wrongvalues += CompareCachedRead(pos, len, nbuf, 0);
+   //the eviction of all the blocks and of the directory of the file
+   TFileBlockCache::SetDirectory(gCacheDir, 1);
+   TFileBlockCache::Evict();
+   if (CountCacheEntries() != 0) wrongvalues++;
+   TFileBlockCache::SetDirectory(gCacheDir, 100000000);
+   wrongvalues += CompareCachedRead(pos, len, nbuf, 1);
+   if (CountCacheEntries() != 1) wrongvalues++;
+
+   //remove the cache directory
+   TFileBlockCache::SetDirectory(gCacheDir, 1);
+   TFileBlockCache::Evict();
+   gSystem->Unlink(gCacheDir);
+   TFileBlockCache::SetDirectory(saveddir, savedsize);
+
+   if (wrongvalues>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+void CleanUp()
+{
+   gSystem->Unlink(gFileName);
+}
+
+void Report(Int_t itest, const char *title, Bool_t ok)
+{
+   //Print the result of a test on a line of 70 characters
+
+   TString line = TString::Format("Test%d: %s", itest, title);
+   while (line.Length() < 67) line += "-";
+   printf("%s %s\n", line.Data(), ok ? "OK" : "FAILED");
+}
+
+Int_t stressFileIO(Int_t nentries)
+{
+   MakeTree(nentries);
+   printf("**********************************************************************\n");
+   printf("*****************Starting file reading stress test********************\n");
+   printf("**********************************************************************\n");
+
+   Bool_t ok = kTRUE;
+   Bool_t ok1 = Test1();
+   Report(1, "TFile::SetMemoryMap", ok1);
+   ok &= ok1;
+
+   Bool_t ok2 = Test2();
+   Report(2, "TBufferFile arrays", ok2);
+   ok &= ok2;
+
+   Bool_t ok3 = Test3();
+   Report(3, "TFileReadPlan", ok3);
+   ok &= ok3;
+
+   Bool_t ok4 = Test4();
+   Report(4, "TFileBlockCache", ok4);
+   ok &= ok4;
+
+   printf("**********************************************************************\n");
+   printf("*******************Deleting the data files****************************\n");
+   printf("**********************************************************************\n");
+   CleanUp();
+   return ok ? 0 : 1;
+}
+//_____________________________batch only_____________________
+#ifndef __CINT__
+
+int main(int argc, char *argv[])
+{
+   TApplication theApp("App", &argc, argv);
+   Int_t nentries = 20000;
+   if (argc > 1) nentries = atoi(argv[1]);
+   return stressFileIO(nentries);
+}
+
+#endif
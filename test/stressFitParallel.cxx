@@ -0,0 +1,374 @@
+/////////////////////////////////////////////////////////////////
+//
+//___A stress test for the evaluation of functions by blocks of points___
+//
+//   Each test compares the result of the evaluation of many points at
+//   once with the result of the evaluation point by point:
+//   - Test1() - TF1::EvalParN: the values of functions defined by an
+//               expression, by a C++ function and by a class overriding
+//               EvalPar are the ones of TF1::EvalPar
+//   - Test2() - FitConfig::SetNThreads: the chi2, binned likelihood,
+//               integral and unbinned likelihood fits, with and without
+//               gradient, give the same result with 1 and 4 threads
+//   - Test3() - SetColumnLayout: the binned, unbinned and external fit data
+//               read by columns give the coordinates, values, chi2 and
+//               likelihood of the data read point after point
+//
+//   To run in batch mode, do
+//     stressFitParallel
+//     stressFitParallel 10000
+//   Here the parameter is the number of points evaluated.
+//   Default value is 1000
+//
+//   An example of output when all tests pass:
+// **********************************************************************
+// *************Starting function evaluation stress test*****************
+// **********************************************************************
+// Test1: TF1::EvalParN----------------------------------------------- OK
+// Test2: Fits with 1 and 4 threads----------------------------------- OK
+// Test3: Fit data stored by columns---------------------------------- OK
+// **********************************************************************
+
+#include <stdlib.h>
+#include <vector>
+#include "TApplication.h"
+#include "TF1.h"
+#include "TF2.h"
+#include "TFitResult.h"
+#include "TFitResultPtr.h"
+#include "TH1.h"
+#include "TMath.h"
+#include "TRandom.h"
+#include "TString.h"
+#include "HFitInterface.h"
+#include "Fit/BinData.h"
+#include "Fit/FitConfig.h"
+#include "Fit/Fitter.h"
+#include "Fit/FitUtil.h"
+#include "Fit/UnBinData.h"
+#include "Math/WrappedMultiTF1.h"
+
+Int_t stressFitParallel(Int_t npoints = 1000);
+
+Double_t StressFunc(Double_t *x, Double_t *p)
+{
+   return p[0] + p[1]*x[0] + p[2]*TMath::Gaus(x[0], p[3], p[4]);
+}
+
+class TStressF1 : public TF1 {
+public:
+   TStressF1(const char *name, const char *formula, Double_t xmin, Double_t xmax)
+      : TF1(name, formula, xmin, xmax) { }
+   //the values of the formula are changed by the derived class
+   virtual Double_t EvalPar(const Double_t *x, const Double_t *params=0)
+      { return 2*TF1::EvalPar(x, params) + 1; }
+};
+
+Int_t CompareEvalParN(TF1 *f, Int_t npoints, Double_t scale = 1, Double_t offset = 0)
+{
+   //Evaluate f at npoints random points with EvalParN, with the parameters
+   //of f and with a copy of them, and compare with scale*TF1::EvalPar+offset.
+   //Returns the number of values which differ
+
+   Int_t ndim = f->GetNdim();
+   std::vector<Double_t> x(npoints*ndim);
+   for (Int_t i=0; i<npoints*ndim; i++) x[i] = gRandom->Uniform(-5, 5);
+   std::vector<Double_t> params(f->GetParameters(), f->GetParameters() + f->GetNpar());
+   std::vector<Double_t> r1(npoints), r2(npoints);
+   f->EvalParN(npoints, &x[0], &r1[0]);
+   f->EvalParN(npoints, &x[0], &r2[0], &params[0]);
+
+   Int_t wrongvalues = 0;
+   for (Int_t i=0; i<npoints; i++){
+      Double_t v = scale * f->TF1::EvalPar(&x[i*ndim]) + offset;
+      Double_t eps = 1e-12 * TMath::Max(1., TMath::Abs(v));
+      if (TMath::Abs(r1[i] - v) > eps || TMath::Abs(r2[i] - v) > eps) wrongvalues++;
+   }
+   return wrongvalues;
+}
+
+Bool_t Test1(Int_t npoints)
+{
+   //Compare TF1::EvalParN with TF1::EvalPar for functions defined by an
+   //expression (evaluated by blocks), by a C++ function and by a class
+   //overriding EvalPar (evaluated point by point)
+
+   gRandom->SetSeed(31415);
+   TF1 f1("f1", "gaus(0)+pol2(3)", -5, 5);
+   f1.SetParameters(10, 0.5, 1.2, 1, 0.1, 0.01);
+   TF1 f2("f2", "[0]*sin([1]*x)/x+expo(2)", -5, 5);
+   f2.SetParameters(3, 2, 0.5, -0.2);
+   TF2 f3("f3", "xygaus+[5]*x*y", -5, 5, -5, 5);
+   f3.SetParameters(5, 0.5, 1, -0.5, 2, 0.3);
+   TF1 f4("f4", StressFunc, -5, 5, 5);
+   f4.SetParameters(1, 0.2, 4, 0.5, 1.5);
+   TStressF1 f5("f5", "gaus(0)+[3]", -5, 5);
+   f5.SetParameters(4, 0, 2, 1);
+
+   Int_t wrongvalues = CompareEvalParN(&f1, npoints)
+                     + CompareEvalParN(&f2, npoints)
+                     + CompareEvalParN(&f3, npoints)
+                     + CompareEvalParN(&f4, npoints)
+                     + CompareEvalParN(&f5, npoints, 2, 1);
+
+   if (wrongvalues>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+Bool_t CompareFitResults(const ROOT::Fit::FitResult &r1, const ROOT::Fit::FitResult &r2)
+{
+   //Compare the results of the same fit done with a different number of
+   //threads: the sums over the points are only added in another order,
+   //so the minima must agree within a small fraction of the errors
+
+   if (r1.Status() != r2.Status() || r1.NPar() != r2.NPar()) return kFALSE;
+   if (TMath::Abs(r1.MinFcnValue() - r2.MinFcnValue()) > 1e-6 * TMath::Max(1., TMath::Abs(r1.MinFcnValue())))
+      return kFALSE;
+   for (UInt_t i=0; i<r1.NPar(); i++){
+      Double_t tolerance = 1e-2 * TMath::Max(r1.Error(i), 1e-10);
+      if (TMath::Abs(r1.Parameter(i) - r2.Parameter(i)) > tolerance) return kFALSE;
+      if (TMath::Abs(r1.Error(i) - r2.Error(i)) > tolerance) return kFALSE;
+   }
+   return kTRUE;
+}
+
+Int_t CompareHistFits(TH1 *h, TF1 *f, Option_t *option, UInt_t nthreads)
+{
+   //Fit h with f with one thread and with nthreads threads (the default of
+   //the fits of TH1::Fit), from the same initial parameters.
+   //Returns 1 if the results differ
+
+   std::vector<Double_t> start(f->GetParameters(), f->GetParameters() + f->GetNpar());
+   TString opt = TString(option) + "QS0";
+   ROOT::Fit::FitConfig::SetDefaultNThreads(1);
+   TFitResultPtr r1 = h->Fit(f, opt);
+   f->SetParameters(&start[0]);
+   ROOT::Fit::FitConfig::SetDefaultNThreads(nthreads);
+   TFitResultPtr r2 = h->Fit(f, opt);
+   ROOT::Fit::FitConfig::SetDefaultNThreads(1);
+   f->SetParameters(&start[0]);
+   if (r1.Get() == 0 || r2.Get() == 0) return 1;
+   return CompareFitResults(*r1, *r2) ? 0 : 1;
+}
+
+template<class Data>
+Int_t CompareFitterFits(const Data &data, TF1 *f, Bool_t likelihood, UInt_t nthreads)
+{
+   //Fit the data with the Fitter using the gradient of f, with one thread
+   //and with nthreads threads. The first parameter is fixed for the
+   //likelihood fits. Returns 1 if the results differ
+
+   ROOT::Math::WrappedMultiTF1 wf(*f, f->GetNdim());
+   ROOT::Fit::FitResult results[2];
+   for (Int_t k=0; k<2; k++){
+      ROOT::Fit::Fitter fitter;
+      fitter.SetFunction(wf, true);
+      fitter.Config().SetNThreads(k == 0 ? 1 : nthreads);
+      if (likelihood) fitter.Config().ParSettings(0).Fix();
+      Bool_t ok = likelihood ? fitter.LikelihoodFit(data) : fitter.Fit(data);
+      if (!ok) return 1;
+      results[k] = fitter.Result();
+   }
+   return CompareFitResults(results[0], results[1]) ? 0 : 1;
+}
+
+Bool_t Test2()
+{
+   //Fit the same histogram with a chi2, a binned likelihood and an integral
+   //chi2 (whose points stay sequential), and the same points with an
+   //unbinned likelihood, with one and with four threads. The data have
+   //more points than a block of the threads (1024), such that they are
+   //really split among the threads
+
+   const UInt_t nthreads = 4;
+   gRandom->SetSeed(27182);
+   TH1D h1("h1", "h1", 5000, -5, 5);
+   TF1 g1("g1", "gaus(0)+pol1(3)", -5, 5);
+   g1.SetParameters(200, 0.5, 1.2, 20, 1);
+   h1.FillRandom("g1", 500000);
+   g1.SetParameters(150, 0, 1, 10, 0);
+   TH1D h2("h2", "h2", 1100, -5, 5);
+   TF1 p2("p2", "pol2", -5, 5);
+   p2.SetParameters(50, 2, -1);
+   h2.FillRandom("p2", 100000);
+   p2.SetParameters(40, 0, 0);
+
+   Int_t wrongfits = CompareHistFits(&h1, &g1, "", nthreads)
+                   + CompareHistFits(&h1, &g1, "L", nthreads)
+                   + CompareHistFits(&h2, &p2, "I", nthreads);
+
+   //chi2 with gradient, on the data of the histogram
+   ROOT::Fit::BinData bindata;
+   ROOT::Fit::FillData(bindata, &h1, &g1);
+   wrongfits += CompareFitterFits(bindata, &g1, kFALSE, nthreads);
+
+   //unbinned likelihood with gradient
+   TF1 pdf("pdf", "gaus", -5, 5);
+   pdf.SetParameters(1, 0.5, 1.2);
+   ROOT::Fit::UnBinData unbindata(20000);
+   for (Int_t i=0; i<20000; i++) unbindata.Add(gRandom->Gaus(0.5, 1.2));
+   pdf.SetParameters(1, 0, 1);
+   wrongfits += CompareFitterFits(unbindata, &pdf, kTRUE, nthreads);
+
+   if (wrongfits>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+template<class Data>
+Int_t CompareCoords(const Data &ref, const Data &data)
+{
+   //Compare the coordinates of data read by GetCoords and by columns with
+   //the coordinates of ref read point after point.
+   //Returns the number of coordinates which differ
+
+   UInt_t n = ref.Size();
+   UInt_t ndim = ref.NDim();
+   if (data.Size() != n || data.NDim() != ndim) return 1;
+   Int_t wrongvalues = 0;
+   std::vector<Double_t> x(n*ndim);
+   data.GetCoords(0, n, &x[0]);
+   for (UInt_t i=0; i<n; i++){
+      const Double_t *xref = ref.Coords(i);
+      for (UInt_t j=0; j<ndim; j++){
+         if (x[i*ndim+j] != xref[j]) wrongvalues++;
+         const Double_t *col = data.CoordColumn(j);
+         if (col && col[i] != xref[j]) wrongvalues++;
+      }
+   }
+   //a block in the middle
+   if (n > 20) {
+      data.GetCoords(7, 13, &x[0]);
+      for (UInt_t i=0; i<13; i++){
+         for (UInt_t j=0; j<ndim; j++) if (x[i*ndim+j] != ref.Coords(7+i)[j]) wrongvalues++;
+      }
+   }
+   return wrongvalues;
+}
+
+Bool_t Test3()
+{
+   //Store binned and unbinned 2-D data also by columns, add points
+   //afterwards, and compare them with the same data stored only point
+   //after point, and with external data: the coordinates, values and
+   //inverse errors must be the same, as well as the chi2 and the
+   //likelihood computed from them with 1 and 4 threads
+
+   gRandom->SetSeed(16180);
+   const UInt_t npoints = 3000;
+   const UInt_t nadded = 10;
+   std::vector<Double_t> xs(npoints+nadded), ys(npoints+nadded), vals(npoints+nadded), errs(npoints+nadded);
+   for (UInt_t i=0; i<npoints+nadded; i++){
+      xs[i] = gRandom->Uniform(-5, 5);
+      ys[i] = gRandom->Uniform(-5, 5);
+      vals[i] = gRandom->Poisson(10) + 1;
+      errs[i] = TMath::Sqrt(vals[i]);
+   }
+
+   ROOT::Fit::BinData bin(npoints+nadded, 2);
+   ROOT::Fit::UnBinData unbin(npoints+nadded, 2);
+   ROOT::Fit::UnBinData unbincols(npoints+nadded, 2);
+   for (UInt_t i=0; i<npoints; i++){
+      Double_t x[2] = { xs[i], ys[i] };
+      bin.Add(x, vals[i], errs[i]);
+      unbin.Add(xs[i], ys[i]);
+      unbincols.Add(xs[i], ys[i]);
+   }
+   ROOT::Fit::BinData bincols(bin);
+   bincols.SetColumnLayout();
+   unbincols.SetColumnLayout();
+   for (UInt_t i=npoints; i<npoints+nadded; i++){
+      Double_t x[2] = { xs[i], ys[i] };
+      bin.Add(x, vals[i], errs[i]);
+      bincols.Add(x, vals[i], errs[i]);
+      unbin.Add(xs[i], ys[i]);
+      unbincols.Add(xs[i], ys[i]);
+   }
+   if (!bincols.HasColumnLayout() || !unbincols.HasColumnLayout() || bin.HasColumnLayout()) return kFALSE;
+
+   Int_t wrongvalues = CompareCoords(bin, bincols) + CompareCoords(unbin, unbincols)
+                     + CompareCoords(bin, bin) + CompareCoords(unbin, unbin);
+   const Double_t *yColumn = bincols.ValueColumn();
+   const Double_t *invErrorColumn = bincols.InvErrorColumn();
+   if (!yColumn || !invErrorColumn) return kFALSE;
+   for (UInt_t i=0; i<bin.Size(); i++){
+      if (yColumn[i] != bin.Value(i) || invErrorColumn[i] != bin.InvError(i)) wrongvalues++;
+   }
+
+   //external data are read by columns without copy
+   ROOT::Fit::BinData binext(npoints+nadded, &xs[0], &ys[0], &vals[0], 0, 0, &errs[0]);
+   ROOT::Fit::UnBinData unbinext(npoints+nadded, &xs[0], &ys[0]);
+   wrongvalues += CompareCoords(bin, binext) + CompareCoords(unbin, unbinext);
+
+   //the chi2 and the likelihood, sequential and with threads
+   TF2 f2("f2", "[0]+[1]*x+[2]*y", -5, 5, -5, 5);
+   f2.SetParameters(10, 0.1, -0.1);
+   TF2 g2("g2", "xygaus", -5, 5, -5, 5);
+   g2.SetParameters(1, 0, 2, 0, 2);
+   ROOT::Math::WrappedMultiTF1 wf2(f2, 2);
+   ROOT::Math::WrappedMultiTF1 wg2(g2, 2);
+   for (UInt_t nthreads=1; nthreads<=4; nthreads+=3){
+      UInt_t n1, n2;
+      Double_t chi2 = ROOT::Fit::FitUtil::EvaluateChi2(wf2, bin, f2.GetParameters(), n1, nthreads);
+      Double_t chi2cols = ROOT::Fit::FitUtil::EvaluateChi2(wf2, bincols, f2.GetParameters(), n2, nthreads);
+      if (n1 != n2 || TMath::Abs(chi2 - chi2cols) > 1e-10 * chi2) wrongvalues++;
+      Double_t logl = ROOT::Fit::FitUtil::EvaluateLogL(wg2, unbin, g2.GetParameters(), 0, false, n1, nthreads);
+      Double_t loglcols = ROOT::Fit::FitUtil::EvaluateLogL(wg2, unbincols, g2.GetParameters(), 0, false, n2, nthreads);
+      if (n1 != n2 || TMath::Abs(logl - loglcols) > 1e-10 * TMath::Abs(logl)) wrongvalues++;
+   }
+
+   bincols.SetColumnLayout(false);
+   if (bincols.HasColumnLayout() || bincols.ValueColumn() != 0) wrongvalues++;
+
+   if (wrongvalues>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+void Report(Int_t itest, const char *title, Bool_t ok)
+{
+   //Print the result of a test on a line of 70 characters
+
+   TString line = TString::Format("Test%d: %s", itest, title);
+   while (line.Length() < 67) line += "-";
+   printf("%s %s\n", line.Data(), ok ? "OK" : "FAILED");
+}
+
+Int_t stressFitParallel(Int_t npoints)
+{
+   printf("**********************************************************************\n");
+   printf("*************Starting function evaluation stress test*****************\n");
+   printf("**********************************************************************\n");
+
+   Bool_t ok = kTRUE;
+   Bool_t ok1 = Test1(npoints);
+   Report(1, "TF1::EvalParN", ok1);
+   ok &= ok1;
+
+   Bool_t ok2 = Test2();
+   Report(2, "Fits with 1 and 4 threads", ok2);
+   ok &= ok2;
+
+   Bool_t ok3 = Test3();
+   Report(3, "Fit data stored by columns", ok3);
+   ok &= ok3;
+
+   printf("**********************************************************************\n");
+   return ok ? 0 : 1;
+}
+//_____________________________batch only_____________________
+#ifndef __CINT__
+
+int main(int argc, char *argv[])
+{
+   TApplication theApp("App", &argc, argv);
+   Int_t npoints = 1000;
+   if (argc > 1) npoints = atoi(argv[1]);
+   return stressFitParallel(npoints);
+}
+
+#endif
@@ -0,0 +1,670 @@
+/////////////////////////////////////////////////////////////////
+//
+//___A stress test for the filling of histograms from several threads___
+//
+//   Each test compares the histograms filled by several threads through
+//   THistConcurrentFill with the same histograms filled entry by entry
+//   by a single thread:
+//   - Test1() - THistConcurrentFill: a TH1D, a TH2D and a TProfile filled
+//               by threads each owning its filler, with a lock created
+//               before any call to TThread::Initialize
+//   - Test2() - THistConcurrentFill::FlushAll: the buffers of the fillers
+//               kept after the threads stopped filling are all flushed
+//   - Test3() - the histograms with their own buffer (TH1::SetBuffer), a
+//               TH3D and a TProfile2D
+//   - Test4() - TH1::FillN and TH2::FillN compared with Fill called for each
+//               entry, with fix and variable bins, strides, weights, under
+//               and overflows, and axes that can be extended
+//   - Test5() - THnSparse::FillN compared with Fill called for each entry,
+//               with compact coordinates of up to and more than 8 bytes,
+//               and with an axis that can be extended
+//   - Test6() - THnSparse projections to TH1, TH2 and TH3 by several
+//               threads compared with the ones by the calling thread, with
+//               and without axis ranges and errors
+//
+//   To run in batch mode, do
+//     stressHistFill
+//     stressHistFill 100000
+//     stressHistFill 100000 4
+//   Here the 1st parameter is the number of entries of each histogram,
+//            2nd parameter is the number of threads
+//   Default values are 20000 4
+//
+//   An example of output when all tests pass:
+// **********************************************************************
+// ************Starting concurrent histogram filling stress test*********
+// **********************************************************************
+// Test1: THistConcurrentFill----------------------------------------- OK
+// Test2: THistConcurrentFill::FlushAll------------------------------- OK
+// Test3: Buffered histograms, TH3D and TProfile2D-------------------- OK
+// Test4: TH1::FillN and TH2::FillN----------------------------------- OK
+// Test5: THnSparse::FillN-------------------------------------------- OK
+// Test6: THnSparse projections by several threads-------------------- OK
+// **********************************************************************
+
+#include <stdlib.h>
+#include <vector>
+#include "TApplication.h"
+#include "TH1.h"
+#include "TH2.h"
+#include "TH3.h"
+#include "THistConcurrentFill.h"
+#include "THnSparse.h"
+#include "TMath.h"
+#include "TProfile.h"
+#include "TProfile2D.h"
+#include "TRandom.h"
+#include "TString.h"
+#include "TThread.h"
+
+Int_t stressHistFill(Int_t nentries = 20000, Int_t nthreads = 4);
+
+struct TFillTask {
+   THistConcurrentFill   *fFill;    //Histogram filled
+   THistConcurrentFiller *fFiller;  //Filler kept after the thread, 0 to use its own one
+   const Double_t        *fEntries; //Values of the entries followed by their weight
+   Int_t                  fN;       //Number of entries
+   Int_t                  fNval;    //Number of values of an entry, weight included
+};
+
+void FillEntries(THistConcurrentFiller &filler, const Double_t *entries, Int_t n, Int_t nval)
+{
+   //Fill the filler with n entries of nval values
+
+   for (Int_t i=0; i<n; i++){
+      const Double_t *e = entries + i*nval;
+      switch (nval) {
+         case 2: filler.Fill(e[0], e[1]); break;
+         case 3: filler.Fill(e[0], e[1], e[2]); break;
+         case 4: filler.Fill(e[0], e[1], e[2], e[3]); break;
+         default: break;
+      }
+   }
+}
+
+void *FillThread(void *arg)
+{
+   //Fill the entries of a task in a thread, with the filler of the task or
+   //with a filler of the thread, flushed when deleted
+
+   TFillTask *task = (TFillTask*)arg;
+   if (task->fFiller) {
+      FillEntries(*task->fFiller, task->fEntries, task->fN, task->fNval);
+   } else {
+      THistConcurrentFiller filler(*task->fFill);
+      FillEntries(filler, task->fEntries, task->fN, task->fNval);
+   }
+   return 0;
+}
+
+void RunThreads(THistConcurrentFill &fill, const std::vector<Double_t> &entries, Int_t nval,
+                Int_t nthreads, std::vector<THistConcurrentFiller*> *fillers = 0)
+{
+   //Fill the entries with nthreads threads, each filling a part of them
+   //with its own filler or with the filler given in fillers
+
+   Int_t n = entries.size() / nval;
+   std::vector<TFillTask> tasks(nthreads);
+   std::vector<TThread*> threads(nthreads);
+   for (Int_t t=0; t<nthreads; t++){
+      Int_t first = n * t / nthreads;
+      Int_t last  = n * (t+1) / nthreads;
+      tasks[t].fFill    = &fill;
+      tasks[t].fFiller  = fillers ? (*fillers)[t] : 0;
+      tasks[t].fEntries = &entries[0] + first*nval;
+      tasks[t].fN       = last - first;
+      tasks[t].fNval    = nval;
+      threads[t] = new TThread(TString::Format("stressHistFill%d", t), FillThread, &tasks[t]);
+      threads[t]->Run();
+   }
+   for (Int_t t=0; t<nthreads; t++){
+      threads[t]->Join();
+      delete threads[t];
+   }
+}
+
+void FillReference(TH1 *h, const std::vector<Double_t> &entries, Int_t nval)
+{
+   //Fill h entry by entry, as Fill of the histogram does
+
+   Int_t n = entries.size() / nval;
+   for (Int_t i=0; i<n; i++){
+      const Double_t *e = &entries[i*nval];
+      switch (nval) {
+         case 2: h->Fill(e[0], e[1]); break;
+         case 3:
+            if (h->InheritsFrom(TProfile::Class())) ((TProfile*)h)->Fill(e[0], e[1], e[2]);
+            else ((TH2*)h)->Fill(e[0], e[1], e[2]);
+            break;
+         case 4:
+            if (h->InheritsFrom(TProfile2D::Class())) ((TProfile2D*)h)->Fill(e[0], e[1], e[2], e[3]);
+            else ((TH3*)h)->Fill(e[0], e[1], e[2], e[3]);
+            break;
+         default: break;
+      }
+   }
+}
+
+std::vector<Double_t> MakeEntries(Int_t n, Int_t nval)
+{
+   //Generate n entries of nval-1 gaussian values followed by a weight
+
+   std::vector<Double_t> entries(n*nval);
+   for (Int_t i=0; i<n; i++){
+      for (Int_t j=0; j<nval-1; j++) entries[i*nval+j] = gRandom->Gaus(0, 2);
+      entries[i*nval+nval-1] = gRandom->Uniform(0.5, 2);
+   }
+   return entries;
+}
+
+Int_t CompareHists(TH1 *h, TH1 *ref)
+{
+   //Compare the contents, errors, number of entries and statistics of h
+   //with the ones of ref. The sums are done in another order, so they
+   //only agree up to the rounding. Returns the number of differences
+
+   h->BufferEmpty();
+   ref->BufferEmpty();
+   if (h->GetNcells() != ref->GetNcells()) return 1;
+   Int_t wrongvalues = 0;
+   for (Int_t bin=0; bin<ref->GetNcells(); bin++){
+      Double_t c = ref->GetBinContent(bin);
+      Double_t e = ref->GetBinError(bin);
+      if (TMath::Abs(h->GetBinContent(bin) - c) > 1e-9 * TMath::Max(1., TMath::Abs(c))) wrongvalues++;
+      if (TMath::Abs(h->GetBinError(bin) - e) > 1e-9 * TMath::Max(1., e)) wrongvalues++;
+   }
+   if (h->GetEntries() != ref->GetEntries()) wrongvalues++;
+   Double_t stats[TH1::kNstat], refstats[TH1::kNstat];
+   for (Int_t i=0; i<TH1::kNstat; i++) stats[i] = refstats[i] = 0;
+   h->GetStats(stats);
+   ref->GetStats(refstats);
+   for (Int_t i=0; i<TH1::kNstat; i++){
+      if (TMath::Abs(stats[i] - refstats[i]) > 1e-9 * TMath::Max(1., TMath::Abs(refstats[i]))) wrongvalues++;
+   }
+   return wrongvalues;
+}
+
+Bool_t Test1(Int_t nentries, Int_t nthreads)
+{
+   //Fill a TH1D, a TH2D and a TProfile with weighted entries by nthreads
+   //threads, each with its own filler, and compare them with the
+   //histograms filled by the main thread. The lock of the first
+   //THistConcurrentFill is created before TThread::Initialize is called
+
+   gRandom->SetSeed(11);
+   TH1D h1("h1", "h1", 100, -5, 5);
+   TH1D r1("r1", "r1", 100, -5, 5);
+   THistConcurrentFill fill1(&h1, 100);
+   if (!fill1.GetMutex()) return kFALSE;
+   TH2D h2("h2", "h2", 40, -5, 5, 40, -5, 5);
+   TH2D r2("r2", "r2", 40, -5, 5, 40, -5, 5);
+   THistConcurrentFill fill2(&h2, 100);
+   TProfile p1("p1", "p1", 50, -5, 5);
+   TProfile q1("q1", "q1", 50, -5, 5);
+   THistConcurrentFill fillp(&p1, 100);
+   h1.Sumw2(); r1.Sumw2(); h2.Sumw2(); r2.Sumw2();
+
+   std::vector<Double_t> e1 = MakeEntries(nentries, 2);
+   std::vector<Double_t> e2 = MakeEntries(nentries, 3);
+   RunThreads(fill1, e1, 2, nthreads);
+   RunThreads(fill2, e2, 3, nthreads);
+   RunThreads(fillp, e2, 3, nthreads);
+   FillReference(&r1, e1, 2);
+   FillReference(&r2, e2, 3);
+   FillReference(&q1, e2, 3);
+
+   Int_t wrongvalues = CompareHists(&h1, &r1) + CompareHists(&h2, &r2) + CompareHists(&p1, &q1);
+   if (fill1.GetNFillers() != 0 || fill2.GetNFillers() != 0 || fillp.GetNFillers() != 0) wrongvalues++;
+
+   if (wrongvalues>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+Bool_t Test2(Int_t nentries, Int_t nthreads)
+{
+   //Fill a TH1D by nthreads threads with fillers created and kept by the
+   //main thread, whose buffers are larger than the entries of a thread:
+   //the histogram must be complete after FlushAll only, and must not
+   //change when the fillers are deleted
+
+   gRandom->SetSeed(22);
+   TH1D h1("h1", "h1", 100, -5, 5);
+   TH1D r1("r1", "r1", 100, -5, 5);
+   h1.Sumw2(); r1.Sumw2();
+   Int_t bufsize = nentries / nthreads + 10;
+   THistConcurrentFill fill(&h1, bufsize);
+   std::vector<THistConcurrentFiller*> fillers(nthreads);
+   for (Int_t t=0; t<nthreads; t++) fillers[t] = new THistConcurrentFiller(fill);
+   Int_t wrongvalues = 0;
+   if (fill.GetNFillers() != nthreads) wrongvalues++;
+
+   std::vector<Double_t> e1 = MakeEntries(nentries, 2);
+   RunThreads(fill, e1, 2, nthreads, &fillers);
+   FillReference(&r1, e1, 2);
+   //nothing was flushed yet
+   if (h1.GetEntries() != 0) wrongvalues++;
+   fill.FlushAll();
+   for (Int_t t=0; t<nthreads; t++) if (fillers[t]->GetN() != 0) wrongvalues++;
+   wrongvalues += CompareHists(&h1, &r1);
+   for (Int_t t=0; t<nthreads; t++) delete fillers[t];
+   if (fill.GetNFillers() != 0) wrongvalues++;
+   wrongvalues += CompareHists(&h1, &r1);
+
+   if (wrongvalues>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+Bool_t Test3(Int_t nentries, Int_t nthreads)
+{
+   //Fill a TH1D having its own buffer (filled entry by entry instead of
+   //with FillN), a TH3D and a TProfile2D by nthreads threads and compare
+   //them with the histograms filled by the main thread
+
+   gRandom->SetSeed(33);
+   TH1D h1("h1", "h1", 100, -5, 5);
+   TH1D r1("r1", "r1", 100, -5, 5);
+   h1.Sumw2(); r1.Sumw2();
+   h1.SetBuffer(500);
+   r1.SetBuffer(500);
+   THistConcurrentFill fill1(&h1, 100);
+   TH3D h3("h3", "h3", 20, -5, 5, 20, -5, 5, 20, -5, 5);
+   TH3D r3("r3", "r3", 20, -5, 5, 20, -5, 5, 20, -5, 5);
+   h3.Sumw2(); r3.Sumw2();
+   THistConcurrentFill fill3(&h3, 100);
+   TProfile2D p2("p2", "p2", 20, -5, 5, 20, -5, 5);
+   TProfile2D q2("q2", "q2", 20, -5, 5, 20, -5, 5);
+   THistConcurrentFill fillp(&p2, 100);
+
+   std::vector<Double_t> e1 = MakeEntries(nentries, 2);
+   std::vector<Double_t> e3 = MakeEntries(nentries, 4);
+   RunThreads(fill1, e1, 2, nthreads);
+   RunThreads(fill3, e3, 4, nthreads);
+   RunThreads(fillp, e3, 4, nthreads);
+   FillReference(&r1, e1, 2);
+   FillReference(&r3, e3, 4);
+   FillReference(&q2, e3, 4);
+
+   Int_t wrongvalues = CompareHists(&h1, &r1) + CompareHists(&h3, &r3) + CompareHists(&p2, &q2);
+
+   if (wrongvalues>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+Int_t CompareFindFixBins(const TAxis *axis, const std::vector<Double_t> &x)
+{
+   //Compare the bins found by TAxis::FindFixBins with the ones found by
+   //TAxis::FindFixBin, with a stride of 1 and of 2
+
+   Int_t n = x.size();
+   std::vector<Int_t> bins(n);
+   Int_t wrongvalues = 0;
+   axis->FindFixBins(n, &x[0], &bins[0]);
+   for (Int_t i=0; i<n; i++) if (bins[i] != axis->FindFixBin(x[i])) wrongvalues++;
+   axis->FindFixBins(n/2, &x[0], &bins[0], 2);
+   for (Int_t i=0; i<n/2; i++) if (bins[i] != axis->FindFixBin(x[2*i])) wrongvalues++;
+   return wrongvalues;
+}
+
+Int_t CompareFillN1(TH1 *h, TH1 *ref, const std::vector<Double_t> &entries, Bool_t weights)
+{
+   //Fill h with TH1::FillN, from entries made of a value and a weight, and
+   //ref with TH1::Fill, then compare them, including their axis
+
+   Int_t n = entries.size() / 2;
+   h->FillN(n, &entries[0], weights ? &entries[1] : 0, 2);
+   for (Int_t i=0; i<n; i++){
+      if (weights) ref->Fill(entries[2*i], entries[2*i+1]);
+      else ref->Fill(entries[2*i]);
+   }
+   Int_t wrongvalues = CompareHists(h, ref);
+   if (h->GetSumw2N() != ref->GetSumw2N()) wrongvalues++;
+   if (h->GetXaxis()->GetXmin() != ref->GetXaxis()->GetXmin() ||
+       h->GetXaxis()->GetXmax() != ref->GetXaxis()->GetXmax()) wrongvalues++;
+   return wrongvalues;
+}
+
+Int_t CompareFillN2(TH2 *h, TH2 *ref, const std::vector<Double_t> &entries, Bool_t weights)
+{
+   //Fill h with TH2::FillN, from entries made of two values and a weight,
+   //and ref with TH2::Fill, then compare them, including their axes
+
+   Int_t n = entries.size() / 3;
+   h->FillN(n, &entries[0], &entries[1], weights ? &entries[2] : 0, 3);
+   for (Int_t i=0; i<n; i++){
+      if (weights) ref->Fill(entries[3*i], entries[3*i+1], entries[3*i+2]);
+      else ref->Fill(entries[3*i], entries[3*i+1]);
+   }
+   Int_t wrongvalues = CompareHists(h, ref);
+   if (h->GetSumw2N() != ref->GetSumw2N()) wrongvalues++;
+   if (h->GetXaxis()->GetXmax() != ref->GetXaxis()->GetXmax() ||
+       h->GetYaxis()->GetXmax() != ref->GetYaxis()->GetXmax()) wrongvalues++;
+   return wrongvalues;
+}
+
+Bool_t Test4(Int_t nentries)
+{
+   //Compare TH1::FillN and TH2::FillN with TH1::Fill and TH2::Fill called
+   //for each entry. The entries are spread beyond the axes, fall on bin
+   //edges, and are filled in several calls, with and without weights, with
+   //weights all equal to 1 (no Sumw2), with fix and variable bins, with the
+   //under and overflows in the statistics, and with axes that can be
+   //extended, where FillN fills the entries one at a time
+
+   gRandom->SetSeed(44);
+   Int_t wrongvalues = 0;
+   Double_t edges[11] = {-5, -3, -2, -1.5, -1, 0, 0.5, 1, 2, 3.5, 5};
+
+   //the bins of FindFixBins, edges and NaN included
+   std::vector<Double_t> x(nentries);
+   for (Int_t i=0; i<nentries; i++) x[i] = gRandom->Uniform(-7, 7);
+   for (Int_t i=0; i<11 && i<nentries; i++) x[i] = edges[i];
+   if (nentries > 12) x[11] = TMath::QuietNaN();
+   TAxis fixaxis(100, -5, 5);
+   TAxis varaxis(10, edges);
+   wrongvalues += CompareFindFixBins(&fixaxis, x);
+   wrongvalues += CompareFindFixBins(&varaxis, x);
+
+   std::vector<Double_t> e1 = MakeEntries(nentries, 2);
+   std::vector<Double_t> e2 = MakeEntries(nentries, 3);
+   for (Int_t i=0; i<nentries; i++){
+      e1[2*i] *= 2;
+      e2[3*i] *= 2;
+      e2[3*i+1] *= 2;
+   }
+   for (Int_t i=0; i<11 && i<nentries; i++){
+      e1[2*i] = edges[i];
+      e2[3*i] = edges[i];
+      e2[3*i+1] = edges[10-i];
+   }
+   //entries of weight 1
+   std::vector<Double_t> u1(e1), u2(e2);
+   for (Int_t i=0; i<nentries; i++){
+      u1[2*i+1] = 1;
+      u2[3*i+2] = 1;
+   }
+
+   for (Int_t stat=0; stat<2; stat++){
+      TH1::StatOverflows(stat == 1);
+
+      TH1D h1("h1", "h1", 100, -5, 5), r1("r1", "r1", 100, -5, 5);
+      wrongvalues += CompareFillN1(&h1, &r1, e1, kTRUE);
+      //a second call adds to the statistics of the first one
+      wrongvalues += CompareFillN1(&h1, &r1, u1, kFALSE);
+
+      TH1D g1("g1", "g1", 10, edges), s1("s1", "s1", 10, edges);
+      wrongvalues += CompareFillN1(&g1, &s1, u1, kTRUE);
+      wrongvalues += CompareFillN1(&g1, &s1, e1, kTRUE);
+
+      TH1D x1("x1", "x1", 20, -1, 1), t1("t1", "t1", 20, -1, 1);
+      x1.SetCanExtend(TH1::kAllAxes);
+      t1.SetCanExtend(TH1::kAllAxes);
+      wrongvalues += CompareFillN1(&x1, &t1, e1, kTRUE);
+
+      TH2D h2("h2", "h2", 40, -5, 5, 40, -5, 5), r2("r2", "r2", 40, -5, 5, 40, -5, 5);
+      wrongvalues += CompareFillN2(&h2, &r2, u2, kFALSE);
+      wrongvalues += CompareFillN2(&h2, &r2, e2, kTRUE);
+
+      TH2D g2("g2", "g2", 10, edges, 10, edges), s2("s2", "s2", 10, edges, 10, edges);
+      wrongvalues += CompareFillN2(&g2, &s2, e2, kTRUE);
+
+      TH2D x2("x2", "x2", 10, -1, 1, 10, -1, 1), t2("t2", "t2", 10, -1, 1, 10, -1, 1);
+      x2.SetCanExtend(TH1::kAllAxes);
+      t2.SetCanExtend(TH1::kAllAxes);
+      wrongvalues += CompareFillN2(&x2, &t2, e2, kTRUE);
+   }
+   TH1::StatOverflows(kFALSE);
+
+   if (wrongvalues>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+Bool_t Equal(Double_t a, Double_t b)
+{
+   //Compare two sums done in a different order
+
+   return TMath::Abs(a - b) <= 1e-9 * TMath::Max(1., TMath::Abs(b));
+}
+
+Int_t CompareSparse(THnSparse *h, THnSparse *ref)
+{
+   //Compare the filled bins, their contents and errors, the number of
+   //entries and the statistics of h with the ones of ref. The bins of ref
+   //are looked up by the coordinates of the bins of h
+
+   Int_t ndim = h->GetNdimensions();
+   if (ndim != ref->GetNdimensions()) return 1;
+   Int_t wrongvalues = 0;
+   if (h->GetNbins() != ref->GetNbins()) wrongvalues++;
+   if (h->GetEntries() != ref->GetEntries()) wrongvalues++;
+   if (!Equal(h->GetSumw(), ref->GetSumw())) wrongvalues++;
+   if (!Equal(h->GetSumw2(), ref->GetSumw2())) wrongvalues++;
+   for (Int_t d=0; d<ndim; d++){
+      if (!Equal(h->GetSumwx(d), ref->GetSumwx(d))) wrongvalues++;
+      if (!Equal(h->GetSumwx2(d), ref->GetSumwx2(d))) wrongvalues++;
+   }
+   std::vector<Int_t> coord(ndim);
+   for (Long64_t i=0; i<h->GetNbins(); i++){
+      Double_t v = h->GetBinContent(i, &coord[0]);
+      Long64_t j = ref->GetBin(&coord[0], kFALSE);
+      if (j < 0) {
+         wrongvalues++;
+         continue;
+      }
+      if (!Equal(v, ref->GetBinContent(j))) wrongvalues++;
+      if (!Equal(h->GetBinError2(i), ref->GetBinError2(j))) wrongvalues++;
+   }
+   return wrongvalues;
+}
+
+Int_t CompareSparseFillN(THnSparse *h, THnSparse *ref, const std::vector<Double_t> &x,
+                         const std::vector<Double_t> &w, Bool_t weights)
+{
+   //Fill h with THnSparse::FillN, in two calls, and ref with THnSparse::Fill
+   //called for each entry, then compare them. Also check that coordinates
+   //not filled are not found in h
+
+   Int_t ndim = h->GetNdimensions();
+   Int_t n = w.size();
+   Int_t n1 = n / 3;
+   h->FillN(n1, &x[0], weights ? &w[0] : 0);
+   h->FillN(n - n1, &x[n1*ndim], weights ? &w[n1] : 0);
+   for (Int_t i=0; i<n; i++) ref->Fill(&x[i*ndim], weights ? w[i] : 1.);
+   Int_t wrongvalues = CompareSparse(h, ref);
+
+   std::vector<Int_t> coord(ndim);
+   for (Int_t i=0; i<1000; i++){
+      for (Int_t d=0; d<ndim; d++) coord[d] = gRandom->Integer(h->GetAxis(d)->GetNbins() + 2);
+      if ((h->GetBin(&coord[0], kFALSE) < 0) != (ref->GetBin(&coord[0], kFALSE) < 0)) wrongvalues++;
+   }
+   return wrongvalues;
+}
+
+Bool_t Test5(Int_t nentries)
+{
+   //Compare THnSparse::FillN with THnSparse::Fill called for each entry:
+   //with 3 axes, whose compact coordinates fit into 8 bytes and are their
+   //own hash, with 9 axes, whose compact coordinates take 9 bytes and whose
+   //hashes can collide, with a variable bin axis, entries beyond the axes,
+   //with and without weights and errors, and with an axis that can be
+   //extended, where FillN fills the entries one at a time
+
+   gRandom->SetSeed(55);
+   Int_t wrongvalues = 0;
+   Double_t edges[11] = {-5, -3, -2, -1.5, -1, 0, 0.5, 1, 2, 3.5, 5};
+
+   for (Int_t large=0; large<2; large++){
+      const Int_t ndim = large ? 9 : 3;
+      Int_t nbins[9];
+      Double_t xmin[9], xmax[9];
+      for (Int_t d=0; d<ndim; d++){
+         nbins[d] = large ? 200 : 50;
+         xmin[d] = -4;
+         xmax[d] = 4;
+      }
+      //the variable bins of axis 1
+      nbins[1] = 10;
+      std::vector<Double_t> x(nentries*ndim), w(nentries);
+      for (Int_t i=0; i<nentries; i++){
+         for (Int_t d=0; d<ndim; d++) x[i*ndim+d] = gRandom->Gaus(0, 2);
+         w[i] = gRandom->Uniform(0.5, 2);
+      }
+
+      for (Int_t errors=0; errors<2; errors++){
+         THnSparseD h("h", "h", ndim, nbins, xmin, xmax);
+         THnSparseD r("r", "r", ndim, nbins, xmin, xmax);
+         h.SetBinEdges(1, edges);
+         r.SetBinEdges(1, edges);
+         if (errors) {
+            h.Sumw2();
+            r.Sumw2();
+         }
+         wrongvalues += CompareSparseFillN(&h, &r, x, w, errors == 1);
+      }
+
+      THnSparseD h("h", "h", ndim, nbins, xmin, xmax);
+      THnSparseD r("r", "r", ndim, nbins, xmin, xmax);
+      h.Sumw2();
+      r.Sumw2();
+      h.GetAxis(0)->SetCanExtend(kTRUE);
+      r.GetAxis(0)->SetCanExtend(kTRUE);
+      wrongvalues += CompareSparseFillN(&h, &r, x, w, kTRUE);
+   }
+
+   if (wrongvalues>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+Int_t CompareProjections(THnSparse *hs, Int_t nthreads, Option_t *option)
+{
+   //Project hs to a TH1D, a TH2D and a TH3D by the calling thread and by
+   //nthreads threads, and compare the projections. The partial sums of the
+   //threads are added in another order, so the projections only agree up to
+   //the rounding
+
+   Int_t wrongvalues = 0;
+   for (Int_t ndim=1; ndim<=3; ndim++){
+      TH1 *proj[2];
+      for (Int_t i=0; i<2; i++){
+         THnSparse::SetProjectionThreads(i ? nthreads : 1);
+         if (ndim == 1) proj[i] = hs->Projection(3, option);
+         else if (ndim == 2) proj[i] = hs->Projection(4, 3, option);
+         else proj[i] = hs->Projection(0, 1, 2, option);
+      }
+      wrongvalues += CompareHists(proj[1], proj[0]);
+      if (proj[1]->GetSumw2N() != proj[0]->GetSumw2N()) wrongvalues++;
+      delete proj[0];
+      delete proj[1];
+   }
+   THnSparse::SetProjectionThreads(1);
+   return wrongvalues;
+}
+
+Bool_t Test6(Int_t nentries, Int_t nthreads)
+{
+   //Project a THnSparse of 5 axes to a TH1D, a TH2D and a TH3D by the
+   //calling thread and by several threads, and compare the projections:
+   //without and with errors in the THnSparse, with option "E", without and
+   //with a range on a projected and on a summed axis, with option "O".
+   //There are enough filled bins for the projections to be split
+
+   gRandom->SetSeed(66);
+   Int_t wrongvalues = 0;
+   if (nthreads < 2) nthreads = 2;
+   Int_t nbins[5] = {10, 10, 10, 100, 100};
+   Double_t xmin[5] = {-4, -4, -4, -4, -4};
+   Double_t xmax[5] = {4, 4, 4, 4, 4};
+   Int_t n = 5 * nentries;
+   std::vector<Double_t> x(5*n), w(n);
+   for (Int_t i=0; i<n; i++){
+      for (Int_t d=0; d<5; d++) x[i*5+d] = gRandom->Gaus(0, 2);
+      w[i] = gRandom->Uniform(0.5, 2);
+   }
+
+   for (Int_t errors=0; errors<2; errors++){
+      THnSparseD hs("hs", "hs", 5, nbins, xmin, xmax);
+      if (errors) hs.Sumw2();
+      hs.FillN(n, &x[0], errors ? &w[0] : 0);
+      const char *options[4] = {"", "E", "O", "OE"};
+      for (Int_t range=0; range<3; range++){
+         if (range == 1) hs.GetAxis(3)->SetRange(20, 70);
+         if (range == 2) hs.GetAxis(1)->SetRange(3, 8);
+         for (Int_t opt=0; opt<4; opt++)
+            wrongvalues += CompareProjections(&hs, nthreads, options[opt]);
+      }
+   }
+
+   if (wrongvalues>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+void Report(Int_t itest, const char *title, Bool_t ok)
+{
+   //Print the result of a test on a line of 70 characters
+
+   TString line = TString::Format("Test%d: %s", itest, title);
+   while (line.Length() < 67) line += "-";
+   printf("%s %s\n", line.Data(), ok ? "OK" : "FAILED");
+}
+
+Int_t stressHistFill(Int_t nentries, Int_t nthreads)
+{
+   printf("**********************************************************************\n");
+   printf("************Starting concurrent histogram filling stress test*********\n");
+   printf("**********************************************************************\n");
+
+   if (nthreads < 1) nthreads = 1;
+   TH1::AddDirectory(kFALSE);
+   Bool_t ok = kTRUE;
+   Bool_t ok1 = Test1(nentries, nthreads);
+   Report(1, "THistConcurrentFill", ok1);
+   ok &= ok1;
+
+   Bool_t ok2 = Test2(nentries, nthreads);
+   Report(2, "THistConcurrentFill::FlushAll", ok2);
+   ok &= ok2;
+
+   Bool_t ok3 = Test3(nentries, nthreads);
+   Report(3, "Buffered histograms, TH3D and TProfile2D", ok3);
+   ok &= ok3;
+
+   Bool_t ok4 = Test4(nentries);
+   Report(4, "TH1::FillN and TH2::FillN", ok4);
+   ok &= ok4;
+
+   Bool_t ok5 = Test5(nentries);
+   Report(5, "THnSparse::FillN", ok5);
+   ok &= ok5;
+
+   Bool_t ok6 = Test6(nentries, nthreads);
+   Report(6, "THnSparse projections by several threads", ok6);
+   ok &= ok6;
+
+   printf("**********************************************************************\n");
+   return ok ? 0 : 1;
+}
+//_____________________________batch only_____________________
+#ifndef __CINT__
+
+int main(int argc, char *argv[])
+{
+   TApplication theApp("App", &argc, argv);
+   Int_t nentries = 20000;
+   Int_t nthreads = 4;
+   if (argc > 1) nentries = atoi(argv[1]);
+   if (argc > 2) nthreads = atoi(argv[2]);
+   return stressHistFill(nentries, nthreads);
+}
+
+#endif
@@ -0,0 +1,603 @@
+/////////////////////////////////////////////////////////////////
+//
+//___A stress test for the multi-threaded reading and writing of trees___
+//
+//   Each test compares the result of a multi-threaded path with the
+//   result of the corresponding sequential path:
+//   - Test1() - TTree::SetParallelFlush: the trees written with and
+//               without the flush pool hold the same entries and baskets
+//   - Test2() - TTreeCacheUnzip: a chain read with the baskets unzipped
+//               by the shared pool of threads (TTreeUnzipPool) gives the
+//               same entries as the chain read without it
+//   - Test3() - TTree::SetParallelProcess: the histograms filled by a
+//               selector processing the chain with several threads are
+//               the same as with the sequential TTree::Process, and the
+//               processing of a chain with a missing file returns -1
+//   - Test4() - TFilePrefetch (used by the TTreeCache read-ahead): the
+//               baskets read by its thread are the ones read by the file
+//               and it fails at once for an element not requested
+//   - Test5() - TFileMerger::SetParallelMerge and hadd -j: the files merged
+//               with several threads, skipping a corrupt one, give the
+//               same histograms and graph as the sequential merge
+//   - Test6() - TChain::SetOpenAheadDepth: a chain whose next files are
+//               opened by a separate thread gives the same entries as the
+//               chain opening them itself, also when jumping between the
+//               files and when a file is missing
+//
+//   To run in batch mode, do
+//     stressParallelIO
+//     stressParallelIO 100000
+//     stressParallelIO 100000 4
+//   Here the 1st parameter is the number of entries in each TTree,
+//            2nd parameter is the number of threads
+//   Default values are 20000 4
+//
+//   An example of output when all tests pass:
+// **********************************************************************
+// *************Starting parallel I/O stress test************************
+// ***************Generating 3 data files of 20000 entries***************
+// **********************************************************************
+// Test1: TTree::SetParallelFlush------------------------------------- OK
+// Test2: TTreeCacheUnzip and TTreeUnzipPool-------------------------- OK
+// Test3: TTree::SetParallelProcess----------------------------------- OK
+// Test4: TFilePrefetch----------------------------------------------- OK
+// Test5: TFileMerger::SetParallelMerge and hadd -j------------------- OK
+// Test6: TChain::SetOpenAheadDepth----------------------------------- OK
+// **********************************************************************
+// *******************Deleting the data files****************************
+// **********************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "TApplication.h"
+#include "TBranch.h"
+#include "TChain.h"
+#include "TChainOpenAhead.h"
+#include "TError.h"
+#include "TH1D.h"
+#include "TTree.h"
+#include "TTreeCacheUnzip.h"
+#include "TTreeUnzipPool.h"
+#include "TRandom.h"
+#include "TFile.h"
+#include "TFilePrefetch.h"
+#include "TFileMerger.h"
+#include "TGraph.h"
+#include "TString.h"
+#include "TSystem.h"
+#include "stressParallelIO.h"
+
+Int_t stressParallelIO(Int_t nentries = 20000, Int_t nthreads = 4);
+
+const Int_t kNFiles = 3;
+
+const Int_t kMaxN = 20;
+struct TEvent_t {
+   Double_t x;
+   Float_t  y;
+   Int_t    n;
+   Float_t  a[kMaxN];
+};
+
+ClassImp(TStressSelector)
+
+//______________________________________________________________________________
+void TStressSelector::Init(TTree *tree)
+{
+   fChain = tree;
+   fChain->SetBranchAddress("x", &fX);
+   fChain->SetBranchAddress("n", &fN);
+}
+
+//______________________________________________________________________________
+void TStressSelector::SlaveBegin(TTree *)
+{
+   fHx = new TH1D("hx", "x", 100, -50, 50);
+   fHx->SetDirectory(0);
+   fHn = new TH1D("hn", "n", kMaxN, 0, kMaxN);
+   fHn->SetDirectory(0);
+   fOutput->Add(fHx);
+   fOutput->Add(fHn);
+}
+
+//______________________________________________________________________________
+Bool_t TStressSelector::Process(Long64_t entry)
+{
+   fChain->GetTree()->GetEntry(entry);
+   fHx->Fill(fX);
+   fHn->Fill(fN);
+   return kTRUE;
+}
+
+//______________________________________________________________________________
+void MakeTree(const char *filename, Int_t nentries, Int_t nthreads, Int_t seed)
+{
+   //Creates filename holding the tree "T" of nentries, written with
+   //nthreads compression threads (see TTree::SetParallelFlush).
+   //The small baskets make sure there are many of them
+
+   TFile *f = new TFile(filename, "RECREATE");
+   TTree *tree = new TTree("T", "stressParallelIO");
+   TEvent_t ev;
+   tree->Branch("x", &ev.x, "x/D", 2000);
+   tree->Branch("y", &ev.y, "y/F", 2000);
+   tree->Branch("n", &ev.n, "n/I", 2000);
+   tree->Branch("a", ev.a, "a[n]/F", 4000);
+   tree->SetAutoFlush(2000);
+   if (nthreads > 0) tree->SetParallelFlush(nthreads);
+
+   gRandom->SetSeed(seed);
+   for (Int_t i=0; i<nentries; i++){
+      ev.x = gRandom->Gaus(0, 10);
+      ev.y = gRandom->Uniform(-1, 1);
+      ev.n = gRandom->Integer(kMaxN);
+      for (Int_t j=0; j<ev.n; j++) ev.a[j] = ev.x + j;
+      tree->Fill();
+   }
+   f->Write();
+   f->Close();
+   delete f;
+}
+
+Int_t CompareTrees(TTree *t1, TTree *t2)
+{
+   //Returns the number of entries which differ between the trees
+
+   if (t1->GetEntries() != t2->GetEntries()) return 1;
+   TEvent_t ev1, ev2;
+   t1->SetBranchAddress("x", &ev1.x);
+   t1->SetBranchAddress("y", &ev1.y);
+   t1->SetBranchAddress("n", &ev1.n);
+   t1->SetBranchAddress("a", ev1.a);
+   t2->SetBranchAddress("x", &ev2.x);
+   t2->SetBranchAddress("y", &ev2.y);
+   t2->SetBranchAddress("n", &ev2.n);
+   t2->SetBranchAddress("a", ev2.a);
+   Int_t wrongentries = 0;
+   for (Long64_t i=0; i<t1->GetEntries(); i++){
+      t1->GetEntry(i);
+      t2->GetEntry(i);
+      Bool_t same = ev1.x == ev2.x && ev1.y == ev2.y && ev1.n == ev2.n;
+      for (Int_t j=0; same && j<ev1.n; j++) same = ev1.a[j] == ev2.a[j];
+      if (!same) wrongentries++;
+   }
+   t1->ResetBranchAddresses();
+   t2->ResetBranchAddresses();
+   return wrongentries;
+}
+
+Bool_t Test1(Int_t nentries, Int_t nthreads)
+{
+   //Write the same entries with and without TTree::SetParallelFlush and
+   //check that both files hold the same entries, in the same number of
+   //baskets of the same size
+
+   MakeTree("stressParallelIOFlush.root", nentries, nthreads, 1);
+
+   TFile f1("stressParallelIO_0.root");
+   TFile f2("stressParallelIOFlush.root");
+   TTree *t1 = (TTree*)f1.Get("T");
+   TTree *t2 = (TTree*)f2.Get("T");
+   if (!t1 || !t2) return kFALSE;
+
+   Int_t wrongbaskets = 0;
+   TIter next(t1->GetListOfBranches());
+   TBranch *b1;
+   while ((b1 = (TBranch*)next())) {
+      TBranch *b2 = t2->GetBranch(b1->GetName());
+      if (!b2 || b1->GetWriteBasket() != b2->GetWriteBasket() ||
+          b1->GetTotBytes() != b2->GetTotBytes() ||
+          b1->GetZipBytes() != b2->GetZipBytes()) {
+         wrongbaskets++;
+         continue;
+      }
+      for (Int_t i=0; i<b1->GetWriteBasket(); i++){
+         if (b1->GetBasketBytes()[i] != b2->GetBasketBytes()[i] ||
+             b1->GetBasketEntry()[i] != b2->GetBasketEntry()[i])
+            wrongbaskets++;
+      }
+   }
+   if (t1->GetBranch("x")->GetWriteBasket() < 10) wrongbaskets++;
+   Int_t wrongentries = CompareTrees(t1, t2);
+
+   if (wrongbaskets>0 || wrongentries>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+Bool_t Test2(Int_t nthreads)
+{
+   //Read the chain of the data files with and without the parallel
+   //unzipping of the baskets and check that the entries are the same
+
+   TChain serial("T");
+   serial.Add("stressParallelIO_?.root");
+   serial.SetCacheSize(1000000);
+
+   TTreeUnzipPool::SetNThreads(nthreads);
+   TTreeCacheUnzip::EParUnzipMode mode = TTreeCacheUnzip::GetParallelUnzip();
+   TTreeCacheUnzip::SetParallelUnzip(TTreeCacheUnzip::kForce);
+   TChain unzip("T");
+   unzip.Add("stressParallelIO_?.root");
+   unzip.SetCacheSize(1000000);
+   Int_t wrongentries = CompareTrees(&serial, &unzip);
+   TFile *file = unzip.GetCurrentFile();
+   Bool_t used = file && dynamic_cast<TTreeCacheUnzip*>(file->GetCacheRead()) != 0;
+   TTreeCacheUnzip::SetParallelUnzip(mode);
+
+   if (wrongentries>0 || !used)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+Int_t CompareHistograms(TH1 *h1, TH1 *h2)
+{
+   //Returns the number of bins which differ between the histograms
+
+   if (!h1 || !h2 || h1->GetNbinsX() != h2->GetNbinsX()) return 1;
+   Int_t wrongbins = 0;
+   for (Int_t i=0; i<=h1->GetNbinsX()+1; i++){
+      if (h1->GetBinContent(i) != h2->GetBinContent(i)) wrongbins++;
+   }
+   if (h1->GetEntries() != h2->GetEntries()) wrongbins++;
+   return wrongbins;
+}
+
+Int_t CompareHistograms(TList *l1, TList *l2, const char *name)
+{
+   //Returns the number of bins which differ between the histograms name
+   //of the two lists
+
+   TH1 *h1 = l1 ? (TH1*)l1->FindObject(name) : 0;
+   TH1 *h2 = l2 ? (TH1*)l2->FindObject(name) : 0;
+   return CompareHistograms(h1, h2);
+}
+
+Bool_t Test3(Int_t nthreads)
+{
+   //Process the chain of the data files with a selector, sequentially
+   //and with nthreads threads, and compare the histograms filled.
+   //Then check that the processing of a chain with a missing file fails
+
+   TChain chain("T");
+   chain.Add("stressParallelIO_?.root");
+
+   TStressSelector serial;
+   Long64_t status1 = chain.Process(&serial);
+   chain.SetParallelProcess(nthreads);
+   TStressSelector parallel;
+   Long64_t status2 = chain.Process(&parallel);
+
+   Int_t wrongbins = CompareHistograms(serial.GetOutputList(), parallel.GetOutputList(), "hx")
+                   + CompareHistograms(serial.GetOutputList(), parallel.GetOutputList(), "hn");
+   TH1 *hn = (TH1*)parallel.GetOutputList()->FindObject("hn");
+   if (!hn || hn->GetEntries() != chain.GetEntries()) wrongbins++;
+   //with the parallel processing, only the clones of the selector fill histograms
+   Bool_t cloned = serial.fHx && !parallel.fHx;
+
+   //a file of the chain disappears after the chain has been set up
+   gSystem->CopyFile("stressParallelIO_0.root", "stressParallelIOMissing.root", kTRUE);
+   TChain broken("T");
+   broken.Add("stressParallelIO_0.root");
+   broken.Add("stressParallelIOMissing.root");
+   broken.GetEntries();
+   gSystem->Unlink("stressParallelIOMissing.root");
+   broken.SetParallelProcess(nthreads);
+   TStressSelector failed;
+   Int_t level = gErrorIgnoreLevel;
+   gErrorIgnoreLevel = kFatal;
+   Long64_t status3 = broken.Process(&failed);
+   gErrorIgnoreLevel = level;
+
+   if (wrongbins>0 || !cloned || status1 != status2 || status3 != -1)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+Bool_t Test4()
+{
+   //Read the baskets of a branch with a TFilePrefetch, by blocks of 4
+   //baskets, and compare them with the baskets read directly from the
+   //file. The reads wait for the prefetching thread: ReadBuffer must
+   //return as soon as the block has been read, and must fail without
+   //waiting for an element which was not requested
+
+   TFile *file = TFile::Open("stressParallelIO_0.root");
+   TFile *reference = TFile::Open("stressParallelIO_0.root");
+   TTree *tree = file ? (TTree*)file->Get("T") : 0;
+   if (!tree || !reference) return kFALSE;
+   TBranch *branch = tree->GetBranch("a");
+   Int_t nbaskets = branch->GetWriteBasket();
+   std::vector<Long64_t> seeks(nbaskets);
+   std::vector<Int_t> bytes(nbaskets);
+   for (Int_t i=0; i<nbaskets; i++){
+      seeks[i] = branch->GetBasketSeek(i);
+      bytes[i] = branch->GetBasketBytes()[i];
+   }
+
+   TFilePrefetch *prefetch = new TFilePrefetch(file);
+   if (prefetch->ThreadStart()) {
+      delete prefetch;
+      delete reference;
+      delete file;
+      return kFALSE;
+   }
+
+   Int_t wrongbaskets = 0;
+   const Int_t kBlock = 4;
+   for (Int_t first=0; first<nbaskets; first+=kBlock){
+      Int_t n = nbaskets - first < kBlock ? nbaskets - first : kBlock;
+      prefetch->ReadBlock(&seeks[first], &bytes[first], n);
+      for (Int_t i=first; i<first+n; i++){
+         char *buf = new char[bytes[i]];
+         char *ref = new char[bytes[i]];
+         if (prefetch->ReadBuffer(buf, seeks[i], bytes[i]) ||
+             reference->ReadBuffer(ref, seeks[i], bytes[i]) ||
+             memcmp(buf, ref, bytes[i]))
+            wrongbaskets++;
+         delete [] buf;
+         delete [] ref;
+      }
+   }
+   //an element which is neither read nor pending
+   char c;
+   if (!prefetch->ReadBuffer(&c, file->GetEND() + 100, 1)) wrongbaskets++;
+   if (nbaskets < 2*kBlock) wrongbaskets++;
+
+   delete prefetch;
+   delete reference;
+   delete file;
+   if (wrongbaskets>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+Int_t CompareMergedFiles(const char *name1, const char *name2)
+{
+   //Returns the number of differences between the histograms and graphs
+   //of the two merged files
+
+   TFile f1(name1);
+   TFile f2(name2);
+   Int_t wrongobjects = 0;
+   const char *hists[] = { "h", "dir/h" };
+   for (Int_t k=0; k<2; k++){
+      wrongobjects += CompareHistograms((TH1*)f1.Get(hists[k]), (TH1*)f2.Get(hists[k]));
+   }
+   TGraph *g1 = (TGraph*)f1.Get("g");
+   TGraph *g2 = (TGraph*)f2.Get("g");
+   if (!g1 || !g2 || g1->GetN() != g2->GetN()) return wrongobjects + 1;
+   for (Int_t i=0; i<g1->GetN(); i++){
+      if (g1->GetX()[i] != g2->GetX()[i] || g1->GetY()[i] != g2->GetY()[i])
+         wrongobjects++;
+   }
+   return wrongobjects;
+}
+
+Bool_t Test5(Int_t nthreads)
+{
+   //Merge files holding histograms, in the top directory and in a
+   //subdirectory, and a graph, sequentially and with nthreads threads
+   //(TFileMerger::SetParallelMerge and hadd -j), and compare the results.
+   //A corrupt file among the sources is skipped, as with hadd -k
+
+   const Int_t nfiles = 2*nthreads + 1;
+   for (Int_t i=0; i<nfiles; i++){
+      TFile f(TString::Format("stressParallelIOHist_%d.root", i), "RECREATE");
+      TH1D h("h", "h", 100, -5, 5);
+      TGraph g(10);
+      gRandom->SetSeed(i+1);
+      for (Int_t j=0; j<1000; j++) h.Fill(gRandom->Gaus(0, 1));
+      for (Int_t j=0; j<10; j++) g.SetPoint(j, i*10 + j, gRandom->Rndm());
+      g.SetName("g");
+      g.Write();
+      TDirectory *dir = f.mkdir("dir");
+      dir->cd();
+      TH1D hd("h", "h", 50, 0, 100);
+      for (Int_t j=0; j<500; j++) hd.Fill(gRandom->Uniform(0, 100));
+      f.Write();
+   }
+   FILE *fp = fopen("stressParallelIOCorrupt.root", "w");
+   if (!fp) return kFALSE;
+   fprintf(fp, "this is not a ROOT file\n");
+   fclose(fp);
+
+   TFileMerger serial(kFALSE);
+   serial.OutputFile("stressParallelIOMerge1.root", "RECREATE");
+   TFileMerger parallel(kFALSE);
+   parallel.SetParallelMerge(nthreads);
+   parallel.OutputFile("stressParallelIOMerge2.root", "RECREATE");
+   TString sources;
+   Int_t wrongobjects = 0;
+   Int_t level = gErrorIgnoreLevel;
+   gErrorIgnoreLevel = kFatal;
+   for (Int_t i=0; i<nfiles; i++){
+      TString name = TString::Format("stressParallelIOHist_%d.root", i);
+      if (!serial.AddFile(name, kFALSE) || !parallel.AddFile(name, kFALSE)) wrongobjects++;
+      sources += " " + name;
+      if (i == nthreads) {
+         //the corrupt file is refused at once, in parallel mode too
+         if (parallel.AddFile("stressParallelIOCorrupt.root", kFALSE)) wrongobjects++;
+         sources += " stressParallelIOCorrupt.root";
+      }
+   }
+   if (!serial.Merge() || !parallel.Merge()) wrongobjects++;
+   gErrorIgnoreLevel = level;
+   wrongobjects += CompareMergedFiles("stressParallelIOMerge1.root", "stressParallelIOMerge2.root");
+
+   //same with hadd, when it can be found
+   char *hadd = gSystem->Which(gSystem->Getenv("PATH"), "hadd", kExecutePermission);
+   if (hadd) {
+#ifdef WIN32
+      const char *devnull = "NUL";
+#else
+      const char *devnull = "/dev/null";
+#endif
+      TString cmd = TString::Format("hadd -f -k -j %d stressParallelIOMerge3.root%s > %s 2>&1",
+                                    nthreads, sources.Data(), devnull);
+      if (gSystem->Exec(cmd) != 0) wrongobjects++;
+      wrongobjects += CompareMergedFiles("stressParallelIOMerge1.root", "stressParallelIOMerge3.root");
+      delete [] hadd;
+   }
+
+   for (Int_t i=0; i<nfiles; i++){
+      gSystem->Unlink(TString::Format("stressParallelIOHist_%d.root", i));
+   }
+   gSystem->Unlink("stressParallelIOCorrupt.root");
+   gSystem->Unlink("stressParallelIOMerge1.root");
+   gSystem->Unlink("stressParallelIOMerge2.root");
+   gSystem->Unlink("stressParallelIOMerge3.root");
+   if (wrongobjects>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+Bool_t Test6()
+{
+   //Read the chain of the data files with and without opening the next
+   //files in advance, first in order and then at random entries. Then
+   //compare the loading of the trees of a chain with a missing file
+
+   TChain serial("T");
+   serial.Add("stressParallelIO_?.root");
+   TChain ahead("T");
+   ahead.Add("stressParallelIO_?.root");
+   ahead.GetEntries();
+   ahead.SetOpenAheadDepth(2);
+   Int_t wrongentries = CompareTrees(&serial, &ahead);
+   //each file after the first one is taken from the thread, or opened by
+   //the chain if the thread was late
+   TChainOpenAhead *openahead = ahead.GetOpenAhead();
+   if (!openahead || openahead->GetNOpened() + openahead->GetNMissed() != kNFiles-1)
+      wrongentries++;
+
+   Double_t x1, x2;
+   serial.SetBranchAddress("x", &x1);
+   ahead.SetBranchAddress("x", &x2);
+   Long64_t nentries = serial.GetEntries();
+   gRandom->SetSeed(271828);
+   for (Int_t i=0; i<100; i++){
+      Long64_t entry = gRandom->Integer((UInt_t)nentries);
+      if (serial.GetEntry(entry) <= 0 || ahead.GetEntry(entry) <= 0 || x1 != x2)
+         wrongentries++;
+   }
+   serial.ResetBranchAddresses();
+   ahead.ResetBranchAddresses();
+
+   //a file of the chains disappears after the chains have been set up
+   gSystem->CopyFile("stressParallelIO_0.root", "stressParallelIOMissing.root", kTRUE);
+   TChain broken1("T");
+   TChain broken2("T");
+   const char *names[] = { "stressParallelIO_0.root", "stressParallelIOMissing.root",
+                           "stressParallelIO_1.root", "stressParallelIO_2.root" };
+   for (Int_t i=0; i<4; i++){
+      broken1.Add(names[i]);
+      broken2.Add(names[i]);
+   }
+   broken1.GetEntries();
+   broken2.GetEntries();
+   gSystem->Unlink("stressParallelIOMissing.root");
+   broken2.SetOpenAheadDepth(2);
+   Int_t level = gErrorIgnoreLevel;
+   gErrorIgnoreLevel = kFatal;
+   for (Int_t i=0; i<4; i++){
+      Long64_t entry = broken1.GetTreeOffset()[i];
+      Long64_t local1 = broken1.LoadTree(entry);
+      Long64_t local2 = broken2.LoadTree(entry);
+      if (local1 != local2 || (i == 1) != (local2 < 0)) wrongentries++;
+   }
+   gErrorIgnoreLevel = level;
+
+   if (wrongentries>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+void MakeTrees(Int_t nentries)
+{
+   //Creates the kNFiles data files read by the tests
+
+   for (Int_t i=0; i<kNFiles; i++){
+      MakeTree(TString::Format("stressParallelIO_%d.root", i), nentries, 0, i+1);
+   }
+}
+
+void CleanUp()
+{
+   for (Int_t i=0; i<kNFiles; i++){
+      gSystem->Unlink(TString::Format("stressParallelIO_%d.root", i));
+   }
+   gSystem->Unlink("stressParallelIOFlush.root");
+}
+
+void Report(Int_t itest, const char *title, Bool_t ok)
+{
+   //Print the result of a test on a line of 70 characters
+
+   TString line = TString::Format("Test%d: %s", itest, title);
+   while (line.Length() < 67) line += "-";
+   printf("%s %s\n", line.Data(), ok ? "OK" : "FAILED");
+}
+
+Int_t stressParallelIO(Int_t nentries, Int_t nthreads)
+{
+   printf("**********************************************************************\n");
+   printf("*************Starting parallel I/O stress test************************\n");
+   printf("**********************************************************************\n");
+   printf("***************Generating %d data files of %d entries***************\n", kNFiles, nentries);
+   printf("**********************************************************************\n");
+   MakeTrees(nentries);
+
+   Bool_t ok = kTRUE;
+   Bool_t ok1 = Test1(nentries, nthreads);
+   Report(1, "TTree::SetParallelFlush", ok1);
+   ok &= ok1;
+
+   Bool_t ok2 = Test2(nthreads);
+   Report(2, "TTreeCacheUnzip and TTreeUnzipPool", ok2);
+   ok &= ok2;
+
+   Bool_t ok3 = Test3(nthreads);
+   Report(3, "TTree::SetParallelProcess", ok3);
+   ok &= ok3;
+
+   Bool_t ok4 = Test4();
+   Report(4, "TFilePrefetch", ok4);
+   ok &= ok4;
+
+   Bool_t ok5 = Test5(nthreads);
+   Report(5, "TFileMerger::SetParallelMerge and hadd -j", ok5);
+   ok &= ok5;
+
+   Bool_t ok6 = Test6();
+   Report(6, "TChain::SetOpenAheadDepth", ok6);
+   ok &= ok6;
+
+   printf("**********************************************************************\n");
+   printf("*******************Deleting the data files****************************\n");
+   printf("**********************************************************************\n");
+   CleanUp();
+   return ok ? 0 : 1;
+}
+//_____________________________batch only_____________________
+#ifndef __CINT__
+
+int main(int argc, char *argv[])
+{
+   TApplication theApp("App", &argc, argv);
+   Int_t nentries = 20000;
+   Int_t nthreads = 4;
+   if (argc > 1) nentries = atoi(argv[1]);
+   if (argc > 2) nthreads = atoi(argv[2]);
+   return stressParallelIO(nentries, nthreads);
+}
+
+#endif
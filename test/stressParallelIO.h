@@ -0,0 +1,39 @@
+///////////////////////////////////////////////////////////////////
+//  Selector used by stressParallelIO to compare the sequential
+//  TTree::Process with the parallel one (TTree::SetParallelProcess).
+//
+//  The parallel processing clones the selector with its default
+//  constructor, which requires the dictionary of the class: it is
+//  generated from this header (stressParallelIODict).
+///////////////////////////////////////////////////////////////////
+
+#ifndef STRESSPARALLELIO_H
+#define STRESSPARALLELIO_H
+
+#include <TSelector.h>
+
+class TTree;
+class TH1D;
+
+class TStressSelector : public TSelector {
+
+public:
+   TTree   *fChain;   //! Tree or chain being processed
+   Double_t fX;       //! Value of the branch x
+   Int_t    fN;       //! Value of the branch n
+   TH1D    *fHx;      //! Distribution of x, in the output list
+   TH1D    *fHn;      //! Distribution of n, in the output list
+
+   TStressSelector() : fChain(0), fX(0), fN(0), fHx(0), fHn(0) { }
+   virtual ~TStressSelector() { }
+
+   virtual Int_t  Version() const { return 2; }
+   virtual void   Init(TTree *tree);
+   virtual Bool_t Notify() { return kTRUE; }
+   virtual void   SlaveBegin(TTree *tree);
+   virtual Bool_t Process(Long64_t entry);
+
+   ClassDef(TStressSelector,0)  //Selector filling the histograms compared by stressParallelIO
+};
+
+#endif
@@ -0,0 +1,606 @@
+/////////////////////////////////////////////////////////////////
+//
+//___A stress test for the optimized ways of reading trees___
+//
+//   Each test compares the result of an optimized reading path with the
+//   result of the usual TTree::GetEntry / TTree::Draw:
+//   - Test1() - TBranch::GetBulkEntries gives the values of GetEntry for
+//               the branches of every basic type, and refuses the
+//               variable size arrays
+//   - Test2() - TTreeFormula::SetJIT: the formulas compiled by the
+//               interpreter give the values of the interpreted formulas
+//   - Test3() - member-wise vectors: the vectors of objects and of doubles
+//               read member-wise, by runs of members of the same type,
+//               are the ones read object-wise and from a split branch
+//   - Test4() - TTreeCache profile: a tree and a chain reading with the
+//               branches saved by TTree::SaveCacheProfile skip the learning
+//               phase, cache the same branches and read the same entries
+//   - Test5() - TTreeRangeIndex: the indices of a chain built in memory,
+//               with runs spilled to temporary files and by several
+//               threads hold the sorted values with their entry number in
+//               the chain, and select the entries found by a scan
+//
+//   To run in batch mode, do
+//     stressTreeRead
+//     stressTreeRead 100000
+//   Here the parameter is the number of entries in the TTree.
+//   Default value is 20000
+//
+//   An example of output when all tests pass:
+// **********************************************************************
+// **************Starting tree reading stress test***********************
+// **********************************************************************
+// Test1: TBranch::GetBulkEntries------------------------------------- OK
+// Test2: TTreeFormula::SetJIT---------------------------------------- OK
+// Test3: Member-wise reading of vectors------------------------------ OK
+// Test4: TTreeCache profile------------------------------------------ OK
+// Test5: TTreeRangeIndex--------------------------------------------- OK
+// **********************************************************************
+// *******************Deleting the data files****************************
+// **********************************************************************
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "TApplication.h"
+#include "TBranch.h"
+#include "TChain.h"
+#include "TEntryList.h"
+#include "TLeaf.h"
+#include "TMath.h"
+#include "TTree.h"
+#include "TTreeCache.h"
+#include "TTreeFormula.h"
+#include "TTreeRangeIndex.h"
+#include "TRandom.h"
+#include "TFile.h"
+#include "TString.h"
+#include "TSystem.h"
+#include "TVirtualStreamerInfo.h"
+#include "stressTreeRead.h"
+
+Int_t stressTreeRead(Int_t nentries = 20000);
+
+ClassImp(TStressPoint)
+
+const char *gFileName = "stressTreeRead.root";
+const char *gVectorFileName = "stressTreeReadVector.root";
+const char *gProfileName = "stressTreeRead.prof";
+const char *gCopyName = "stressTreeReadCopy.root";
+const Int_t kMaxN = 10;
+
+void MakeTree(Int_t nentries)
+{
+   //Creates the file holding the tree "T" read by the tests, with a
+   //branch of each basic type and small baskets
+
+   Char_t    b;
+   Short_t   s;
+   Int_t     i;
+   Long64_t  l;
+   Float_t   f;
+   Double_t  d;
+   Bool_t    o;
+   Double_t  v[3];
+   Int_t     n;
+   Float_t   a[kMaxN];
+
+   TFile *file = new TFile(gFileName, "RECREATE");
+   TTree *tree = new TTree("T", "stressTreeRead");
+   tree->Branch("b", &b, "b/B", 1000);
+   tree->Branch("s", &s, "s/S", 1000);
+   tree->Branch("i", &i, "i/I", 2000);
+   tree->Branch("l", &l, "l/L", 4000);
+   tree->Branch("f", &f, "f/F", 2000);
+   tree->Branch("d", &d, "d/D", 4000);
+   tree->Branch("o", &o, "o/O", 1000);
+   tree->Branch("v", v, "v[3]/D", 8000);
+   tree->Branch("n", &n, "n/I", 2000);
+   tree->Branch("a", a, "a[n]/F", 4000);
+
+   gRandom->SetSeed(12345);
+   for (Int_t entry=0; entry<nentries; entry++){
+      b = (Char_t)gRandom->Integer(256);
+      s = (Short_t)(gRandom->Integer(65536) - 32768);
+      i = (Int_t)gRandom->Integer(2000000000) - 1000000000;
+      l = (Long64_t)i * 1000003 + entry;
+      f = gRandom->Gaus(0, 10);
+      d = gRandom->Gaus(0, 10);
+      o = gRandom->Rndm() > 0.5;
+      for (Int_t j=0; j<3; j++) v[j] = d + j;
+      n = gRandom->Integer(kMaxN);
+      for (Int_t j=0; j<n; j++) a[j] = f * j;
+      tree->Fill();
+   }
+   file->Write();
+   file->Close();
+   delete file;
+}
+
+Bool_t Test1()
+{
+   //Read every supported branch with GetBulkEntries, from a copy of the
+   //tree, and compare the values with the ones read by GetEntry
+
+   TFile f1(gFileName);
+   TFile f2(gFileName);
+   TTree *t1 = (TTree*)f1.Get("T");
+   TTree *t2 = (TTree*)f2.Get("T");
+   if (!t1 || !t2) return kFALSE;
+
+   const char *names[] = { "b", "s", "i", "l", "f", "d", "o", "v" };
+   const Int_t chunk = 300;
+   char bulk[chunk*3*sizeof(Double_t)];
+   char value[3*sizeof(Double_t)];
+   Int_t wrongentries = 0;
+   for (UInt_t k=0; k<sizeof(names)/sizeof(names[0]); k++){
+      TBranch *bulkbranch = t1->GetBranch(names[k]);
+      TBranch *branch = t2->GetBranch(names[k]);
+      TLeaf *leaf = (TLeaf*)branch->GetListOfLeaves()->At(0);
+      Int_t size = leaf->GetLenStatic() * leaf->GetLenType();
+      branch->SetAddress(value);
+      Long64_t entry = 0;
+      Int_t ncalls = 0;
+      while (entry < t1->GetEntries()) {
+         Int_t n = bulkbranch->GetBulkEntries(entry, bulk, chunk);
+         if (n <= 0) {
+            wrongentries++;
+            break;
+         }
+         ncalls++;
+         for (Int_t j=0; j<n; j++){
+            branch->GetEntry(entry+j);
+            if (memcmp(bulk + j*size, value, size)) wrongentries++;
+         }
+         entry += n;
+      }
+      //the branches are read in several baskets and in several chunks
+      if (ncalls < 3 || bulkbranch->GetWriteBasket() < 2) wrongentries++;
+      branch->ResetAddress();
+   }
+   //the variable size arrays are not supported
+   if (t1->GetBranch("a")->GetBulkEntries(0, bulk, 1) != -1) wrongentries++;
+
+   if (wrongentries>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+Bool_t Test2()
+{
+   //Evaluate formulas over the scalar leaves with the compiled evaluation
+   //(TTreeFormula::SetJIT) and with the interpreted one, and compare the
+   //values for each entry. The formula over arrays must not be compiled
+
+   TFile f(gFileName);
+   TTree *tree = (TTree*)f.Get("T");
+   if (!tree) return kFALSE;
+
+   const char *exprs[] = { "i+f*2-b", "d/f+l", "sqrt(abs(d))+log(abs(f)+1)",
+                           "sin(d)*cos(f)+pow(f,2)", "(i>0)&&(d<5)||o",
+                           "max(s,d)-exp(-abs(f))", "v[1]+a[0]" };
+   const Int_t nexprs = sizeof(exprs)/sizeof(exprs[0]);
+   Bool_t jit = TTreeFormula::IsJIT();
+   TTreeFormula *interpreted[nexprs];
+   TTreeFormula *compiled[nexprs];
+   for (Int_t k=0; k<nexprs; k++){
+      interpreted[k] = new TTreeFormula(TString::Format("i%d", k), exprs[k], tree);
+      compiled[k] = new TTreeFormula(TString::Format("c%d", k), exprs[k], tree);
+   }
+
+   Int_t wrongentries = 0;
+   for (Long64_t entry=0; entry<tree->GetEntries(); entry++){
+      tree->LoadTree(entry);
+      for (Int_t k=0; k<nexprs; k++){
+         if (interpreted[k]->GetNdata() == 0 || compiled[k]->GetNdata() == 0) continue;
+         //the formula is compiled, or not, at its first evaluation
+         TTreeFormula::SetJIT(kFALSE);
+         Double_t v1 = interpreted[k]->EvalInstance();
+         TTreeFormula::SetJIT(kTRUE);
+         Double_t v2 = compiled[k]->EvalInstance();
+         if (TMath::Abs(v1 - v2) > 1e-12 * TMath::Max(1., TMath::Abs(v1)))
+            wrongentries++;
+      }
+   }
+   for (Int_t k=0; k<nexprs; k++){
+      //only the formula over arrays stays interpreted
+      if (compiled[k]->IsJITCompiled() != (k < nexprs-1) || interpreted[k]->IsJITCompiled())
+         wrongentries++;
+      delete interpreted[k];
+      delete compiled[k];
+   }
+   TTreeFormula::SetJIT(jit);
+
+   if (wrongentries>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+void MakeVectorTrees(Int_t nentries)
+{
+   //Creates the file holding the trees of vectors read by Test3. The
+   //same vectors are stored in the tree "memberwise" (unsplit, streamed
+   //member-wise), "objectwise" (unsplit, streamed object-wise) and
+   //"split" (split branch)
+
+   std::vector<TStressPoint> points;
+   std::vector<Double_t> values;
+   std::vector<TStressPoint> *ppoints = &points;
+   std::vector<Double_t> *pvalues = &values;
+
+   TFile *file = new TFile(gVectorFileName, "RECREATE");
+   const char *names[] = { "memberwise", "objectwise", "split" };
+   TTree *trees[3];
+   for (Int_t t=0; t<3; t++){
+      trees[t] = new TTree(names[t], "stressTreeRead vectors");
+      trees[t]->Branch("points", &ppoints, 4000, t == 2 ? 99 : 0);
+      trees[t]->Branch("values", &pvalues, 4000, 0);
+   }
+
+   Bool_t memberwise = TVirtualStreamerInfo::GetStreamMemberWise();
+   gRandom->SetSeed(9876);
+   for (Int_t entry=0; entry<nentries; entry++){
+      Int_t n = gRandom->Integer(20);
+      points.resize(n);
+      values.resize(n);
+      for (Int_t j=0; j<n; j++){
+         TStressPoint &p = points[j];
+         p.fX  = gRandom->Gaus(0, 10);
+         p.fY  = gRandom->Gaus(0, 10);
+         p.fZ  = gRandom->Uniform(-100, 100);
+         p.fId = entry*100 + j;
+         p.fE  = gRandom->Exp(50);
+         p.fQ  = (Short_t)(gRandom->Integer(3) - 1);
+         p.fW  = gRandom->Rndm();
+         values[j] = p.fE * p.fW;
+      }
+      TVirtualStreamerInfo::SetStreamMemberWise(kTRUE);
+      trees[0]->Fill();
+      TVirtualStreamerInfo::SetStreamMemberWise(kFALSE);
+      trees[1]->Fill();
+      TVirtualStreamerInfo::SetStreamMemberWise(memberwise);
+      trees[2]->Fill();
+   }
+   file->Write();
+   file->Close();
+   delete file;
+}
+
+Bool_t Test3()
+{
+   //Read the vectors of TStressPoint and of Double_t streamed member-wise,
+   //whose members are read in bulk, and compare them with the same vectors
+   //streamed object-wise and with the ones of the split branch
+
+   TFile f(gVectorFileName);
+   const char *names[] = { "memberwise", "objectwise", "split" };
+   TTree *trees[3];
+   std::vector<TStressPoint> *points[3];
+   std::vector<Double_t> *values[3];
+   for (Int_t t=0; t<3; t++){
+      trees[t] = (TTree*)f.Get(names[t]);
+      if (!trees[t]) return kFALSE;
+      points[t] = 0;
+      values[t] = 0;
+      trees[t]->SetBranchAddress("points", &points[t]);
+      trees[t]->SetBranchAddress("values", &values[t]);
+   }
+
+   Int_t wrongentries = 0;
+   Long64_t nelements = 0;
+   for (Long64_t entry=0; entry<trees[0]->GetEntries(); entry++){
+      for (Int_t t=0; t<3; t++) trees[t]->GetEntry(entry);
+      for (Int_t t=1; t<3; t++){
+         if (*points[0] != *points[t] || *values[0] != *values[t]) wrongentries++;
+      }
+      nelements += points[0]->size();
+   }
+   if (nelements == 0) wrongentries++;
+   for (Int_t t=0; t<3; t++){
+      trees[t]->ResetBranchAddresses();
+      delete points[t];
+      delete values[t];
+   }
+
+   if (wrongentries>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+Bool_t CompareCachedBranches(TTreeCache *tc, const TObjArray *branches)
+{
+   //Check that tc is not learning and caches the branches of the same
+   //names as branches, in the same order
+
+   if (!tc || tc->IsLearning()) return kFALSE;
+   const TObjArray *cached = tc->GetCachedBranches();
+   if (!cached || cached->GetEntriesFast() != branches->GetEntriesFast()) return kFALSE;
+   for (Int_t k=0; k<branches->GetEntriesFast(); k++){
+      if (strcmp(cached->At(k)->GetName(), branches->At(k)->GetName())) return kFALSE;
+   }
+   return kTRUE;
+}
+
+Bool_t Test4()
+{
+   //Read a few branches of the tree with a TTreeCache until the end of its
+   //learning phase and save its profile. Read the tree again, and a chain
+   //of two copies of it, with this profile: their caches must cache the
+   //same branches from the first entry onwards, and the values must be the
+   //same as the ones read with the learning phase
+
+   const char *names[] = { "d", "i", "f" };
+   const Int_t nbranches = sizeof(names)/sizeof(names[0]);
+   Int_t wrongentries = 0;
+
+   TFile f1(gFileName);
+   TTree *t1 = (TTree*)f1.Get("T");
+   if (!t1) return kFALSE;
+   t1->SetCacheSize(10000000);
+   Double_t d1;
+   Int_t i1;
+   Float_t ff1;
+   TBranch *b1[nbranches];
+   for (Int_t k=0; k<nbranches; k++) b1[k] = t1->GetBranch(names[k]);
+   t1->SetBranchAddress("d", &d1);
+   t1->SetBranchAddress("i", &i1);
+   t1->SetBranchAddress("f", &ff1);
+   std::vector<Double_t> values1;
+   for (Long64_t entry=0; entry<t1->GetEntries(); entry++){
+      t1->LoadTree(entry);
+      for (Int_t k=0; k<nbranches; k++) b1[k]->GetEntry(entry);
+      values1.push_back(d1 + i1 + ff1);
+   }
+   TTreeCache *tc1 = (TTreeCache*)f1.GetCacheRead(t1);
+   if (!tc1 || tc1->IsLearning()) return kFALSE;
+   if (t1->SaveCacheProfile(gProfileName) != nbranches) return kFALSE;
+   const TObjArray *learnt = tc1->GetCachedBranches();
+
+   //the tree: the profile is applied when the cache is created
+   TFile f2(gFileName);
+   TTree *t2 = (TTree*)f2.Get("T");
+   if (!t2) return kFALSE;
+   t2->SetCacheProfile(gProfileName);
+   t2->SetCacheSize(10000000);
+   if (!CompareCachedBranches((TTreeCache*)f2.GetCacheRead(t2), learnt)) wrongentries++;
+   Double_t d2;
+   Int_t i2;
+   Float_t ff2;
+   t2->SetBranchAddress("d", &d2);
+   t2->SetBranchAddress("i", &i2);
+   t2->SetBranchAddress("f", &ff2);
+   TBranch *b2[nbranches];
+   for (Int_t k=0; k<nbranches; k++) b2[k] = t2->GetBranch(names[k]);
+   for (Long64_t entry=0; entry<t2->GetEntries(); entry++){
+      t2->LoadTree(entry);
+      for (Int_t k=0; k<nbranches; k++) b2[k]->GetEntry(entry);
+      if (d2 + i2 + ff2 != values1[entry]) wrongentries++;
+   }
+   t2->ResetBranchAddresses();
+
+   //the chain: the profile is kept for the tree of each file
+   TChain chain("T");
+   chain.Add(gFileName);
+   chain.Add(gFileName);
+   chain.SetCacheSize(10000000);
+   chain.SetCacheProfile(gProfileName);
+   Double_t d3;
+   Int_t i3;
+   Float_t ff3;
+   chain.SetBranchAddress("d", &d3);
+   chain.SetBranchAddress("i", &i3);
+   chain.SetBranchAddress("f", &ff3);
+   Long64_t nentries = t1->GetEntries();
+   Long64_t nread = 0;
+   Int_t treenumber = -1;
+   for (Long64_t entry=0; ; entry++){
+      Long64_t local = chain.LoadTree(entry);
+      if (local < 0) break;
+      TTree *tree = chain.GetTree();
+      if (chain.GetTreeNumber() != treenumber) {
+         treenumber = chain.GetTreeNumber();
+         TFile *file = chain.GetCurrentFile();
+         if (!file || !CompareCachedBranches((TTreeCache*)file->GetCacheRead(tree), learnt))
+            wrongentries++;
+      }
+      for (Int_t k=0; k<nbranches; k++) tree->GetBranch(names[k])->GetEntry(local);
+      if (local != entry % nentries || d3 + i3 + ff3 != values1[local]) wrongentries++;
+      nread++;
+   }
+   if (nread != 2*nentries || treenumber != 1) wrongentries++;
+   chain.ResetBranchAddresses();
+   t1->ResetBranchAddresses();
+
+   if (wrongentries>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+Bool_t CompareRangeIndex(TTreeRangeIndex *index, const std::vector<std::pair<Double_t,Long64_t> > &values)
+{
+   //Compare the index tree of index with the values, sorted by value and
+   //entry number
+
+   if (!index || index->GetN() != (Long64_t)values.size()) return kFALSE;
+   TTree *indextree = index->GetIndexTree();
+   Double_t value;
+   Long64_t entry;
+   indextree->SetBranchAddress("value", &value);
+   indextree->SetBranchAddress("entry", &entry);
+   Int_t wrongvalues = 0;
+   for (Long64_t i=0; i<indextree->GetEntries(); i++){
+      indextree->GetEntry(i);
+      if (value != values[i].first || entry != values[i].second) wrongvalues++;
+   }
+   indextree->ResetBranchAddresses();
+   return wrongvalues == 0;
+}
+
+Bool_t Test5()
+{
+   //Index the values of the array a and of d for a chain of two copies of
+   //the tree, with all the values sorted in memory at once, with runs of
+   //50 values written to temporary files and merged in several passes, and
+   //by two threads. The indices must hold all the values, sorted, with
+   //their entry number in the chain, and must select the entries of the
+   //chain having a value in a range as a scan does
+
+   Int_t wrongentries = 0;
+   gSystem->CopyFile(gFileName, gCopyName, kTRUE);
+   TChain chain("T");
+   chain.Add(gFileName);
+   chain.Add(gCopyName);
+
+   //the values of a and d with their entry number in the chain
+   Int_t n;
+   Float_t a[kMaxN];
+   Double_t d;
+   chain.SetBranchAddress("n", &n);
+   chain.SetBranchAddress("a", a);
+   chain.SetBranchAddress("d", &d);
+   std::vector<std::pair<Double_t,Long64_t> > avalues, dvalues;
+   for (Long64_t entry=0; chain.GetEntry(entry) > 0; entry++){
+      for (Int_t j=0; j<n; j++) avalues.push_back(std::make_pair((Double_t)a[j], entry));
+      dvalues.push_back(std::make_pair(d, entry));
+   }
+   chain.ResetBranchAddresses();
+   Long64_t nentries = chain.GetEntries();
+   if (nentries <= 0 || (Long64_t)dvalues.size() != nentries) return kFALSE;
+   std::vector<std::pair<Double_t,Long64_t> > sorted(dvalues);
+   std::sort(sorted.begin(), sorted.end());
+   std::sort(avalues.begin(), avalues.end());
+
+   TTreeRangeIndex *inmemory = TTreeRangeIndex::Build(&chain, "a", "amemory");
+   TTreeRangeIndex *spilled = TTreeRangeIndex::Build(&chain, "a", "aspilled", 50);
+   TTreeRangeIndex *dindex = TTreeRangeIndex::Build(&chain, "d", "dspilled", 50);
+   chain.SetParallelProcess(2);
+   TTreeRangeIndex *parallel = TTreeRangeIndex::Build(&chain, "a", "aparallel", 50);
+   chain.SetParallelProcess(0);
+   if (!CompareRangeIndex(inmemory, avalues)) wrongentries++;
+   if (!CompareRangeIndex(spilled, avalues)) wrongentries++;
+   if (!CompareRangeIndex(parallel, avalues)) wrongentries++;
+   if (!CompareRangeIndex(dindex, sorted)) wrongentries++;
+
+   //the entries selected in a range are the ones of a scan of the values
+   if (spilled) {
+      TTreeRangeIndex query(spilled->GetIndexTree());
+      const Double_t ranges[][2] = { {-5, 5}, {20, 1e30}, {-1e30, -30}, {1000, 2000} };
+      for (UInt_t r=0; r<sizeof(ranges)/sizeof(ranges[0]); r++){
+         std::vector<Long64_t> expected;
+         for (UInt_t i=0; i<avalues.size(); i++){
+            if (avalues[i].first >= ranges[r][0] && avalues[i].first <= ranges[r][1])
+               expected.push_back(avalues[i].second);
+         }
+         std::sort(expected.begin(), expected.end());
+         expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+         TEntryList *elist = query.GetEntryList(&chain, ranges[r][0], ranges[r][1]);
+         if (!elist) {
+            wrongentries++;
+            continue;
+         }
+         chain.SetEntryList(elist);
+         UInt_t nselected = 0;
+         for (Long64_t i=0; ; i++){
+            Long64_t entry = chain.GetEntryNumber(i);
+            if (entry < 0) break;
+            if (nselected >= expected.size() || entry != expected[nselected]) wrongentries++;
+            nselected++;
+         }
+         if (nselected != expected.size()) wrongentries++;
+         chain.SetEntryList(0);
+         delete elist;
+      }
+   }
+
+   //the equal values of the two copies are found in the first one
+   if (dindex) {
+      TTreeRangeIndex query(dindex->GetIndexTree());
+      for (Long64_t entry=0; entry<nentries/2; entry+=97){
+         if (query.GetEntryNumberWithValue(dvalues[entry].first) != entry) wrongentries++;
+      }
+      if (query.GetEntryNumberWithValue(1e30) != -1) wrongentries++;
+   }
+
+   TTreeRangeIndex *indices[] = { inmemory, spilled, dindex, parallel };
+   for (UInt_t k=0; k<sizeof(indices)/sizeof(indices[0]); k++){
+      if (!indices[k]) continue;
+      delete indices[k]->GetIndexTree();
+      delete indices[k];
+   }
+
+   if (wrongentries>0)
+      return kFALSE;
+   else
+      return kTRUE;
+}
+
+void CleanUp()
+{
+   gSystem->Unlink(gFileName);
+   gSystem->Unlink(gVectorFileName);
+   gSystem->Unlink(gProfileName);
+   gSystem->Unlink(gCopyName);
+}
+
+void Report(Int_t itest, const char *title, Bool_t ok)
+{
+   //Print the result of a test on a line of 70 characters
+
+   TString line = TString::Format("Test%d: %s", itest, title);
+   while (line.Length() < 67) line += "-";
+   printf("%s %s\n", line.Data(), ok ? "OK" : "FAILED");
+}
+
+Int_t stressTreeRead(Int_t nentries)
+{
+   MakeTree(nentries);
+   MakeVectorTrees(nentries/10);
+   printf("**********************************************************************\n");
+   printf("**************Starting tree reading stress test***********************\n");
+   printf("**********************************************************************\n");
+
+   Bool_t ok = kTRUE;
+   Bool_t ok1 = Test1();
+   Report(1, "TBranch::GetBulkEntries", ok1);
+   ok &= ok1;
+
+   Bool_t ok2 = Test2();
+   Report(2, "TTreeFormula::SetJIT", ok2);
+   ok &= ok2;
+
+   Bool_t ok3 = Test3();
+   Report(3, "Member-wise reading of vectors", ok3);
+   ok &= ok3;
+
+   Bool_t ok4 = Test4();
+   Report(4, "TTreeCache profile", ok4);
+   ok &= ok4;
+
+   Bool_t ok5 = Test5();
+   Report(5, "TTreeRangeIndex", ok5);
+   ok &= ok5;
+
+   printf("**********************************************************************\n");
+   printf("*******************Deleting the data files****************************\n");
+   printf("**********************************************************************\n");
+   CleanUp();
+   return ok ? 0 : 1;
+}
+//_____________________________batch only_____________________
+#ifndef __CINT__
+
+int main(int argc, char *argv[])
+{
+   TApplication theApp("App", &argc, argv);
+   Int_t nentries = 20000;
+   if (argc > 1) nentries = atoi(argv[1]);
+   return stressTreeRead(nentries);
+}
+
+#endif
@@ -0,0 +1,37 @@
+///////////////////////////////////////////////////////////////////
+//  Class stored in a vector by stressTreeRead to compare the
+//  member-wise reading of the vectors with the object-wise one.
+//
+//  The consecutive members of the same type are read together
+//  (see TStreamerInfoActions). The dictionary of the class and of
+//  the vector is generated from this header (stressTreeReadDict).
+///////////////////////////////////////////////////////////////////
+
+#ifndef STRESSTREEREAD_H
+#define STRESSTREEREAD_H
+
+#include <Rtypes.h>
+
+class TStressPoint {
+
+public:
+   Float_t  fX;       //Coordinates of the point
+   Float_t  fY;
+   Float_t  fZ;
+   Int_t    fId;      //Identifier of the point
+   Double_t fE;       //Energy
+   Short_t  fQ;       //Charge
+   Float_t  fW;       //Weight
+
+   TStressPoint() : fX(0), fY(0), fZ(0), fId(0), fE(0), fQ(0), fW(0) { }
+   virtual ~TStressPoint() { }
+
+   Bool_t operator==(const TStressPoint &p) const {
+      return fX == p.fX && fY == p.fY && fZ == p.fZ && fId == p.fId &&
+             fE == p.fE && fQ == p.fQ && fW == p.fW;
+   }
+
+   ClassDef(TStressPoint,1)  //Point stored in a vector by stressTreeRead
+};
+
+#endif
@@ -53,6 +53,9 @@
 #pragma link C++ class TTreeCloner+;
 #pragma link C++ class TTreeCache+;
 #pragma link C++ class TTreeCacheUnzip+;
+#pragma link C++ class TTreeFlushPool;
+#pragma link C++ class TChainOpenAhead;
+#pragma link C++ class TTreeUnzipPool;
 #pragma link C++ class TVirtualTreePlayer;
 #pragma link C++ class TVirtualIndex+;
 #pragma link C++ class TTreeResult+;
@@ -42,6 +42,7 @@ private:
    TBasket& operator=(const TBasket&); // TBasket objects are not copiable.
 
    // Internal corner cases for ReadBasketBuffers
+   Int_t ReadBasketBuffersMapped(char*, Int_t, TFile*);
    Int_t ReadBasketBuffersUnzip(char*, Int_t, Bool_t, TFile*);
    Int_t ReadBasketBuffersUncompressedCase();
 
@@ -69,6 +70,7 @@ public:
    virtual ~TBasket();
    
    virtual void    AdjustSize(Int_t newsize);
+           Int_t   CompressBuffer();
    virtual void    DeleteEntryOffset();
    virtual Int_t   DropBuffers();
    TBranch        *GetBranch() const {return fBranch;}
@@ -81,6 +83,7 @@ public:
            Int_t   GetLast() const {return fLast;}
    virtual void    MoveEntries(Int_t dentries);
    virtual void    PrepareBasket(Long64_t /* entry */) {};
+           Int_t   PrepareParallelWrite(Int_t cycle);
            Int_t   ReadBasketBuffers(Long64_t pos, Int_t len, TFile *file);
            Int_t   ReadBasketBytes(Long64_t pos, TFile *file);
    virtual void    Reset();
@@ -95,6 +98,7 @@ public:
    inline  void    Update(Int_t newlast) { Update(newlast,newlast); }; 
    virtual void    Update(Int_t newlast, Int_t skipped);
    virtual Int_t   WriteBuffer();
+           Int_t   WriteCompressedBuffer(Int_t nout);
 
    ClassDef(TBasket,2);  //the TBranch buffers
 };
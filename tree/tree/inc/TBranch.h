@@ -40,6 +40,8 @@
 #include "TDataType.h"
 #endif
 
+#include <vector>
+
 class TTree;
 class TBasket;
 class TLeaf;
@@ -48,6 +50,7 @@ class TDirectory;
 class TFile;
 class TClonesArray;
 class TTreeCloner;
+class TTreeFlushPool;
 
    const Int_t kDoNotProcess = BIT(10); // Active bit for branches
    const Int_t kIsClone      = BIT(11); // to indicate a TBranchClones
@@ -59,6 +62,7 @@ class TBranch : public TNamed , public TAttFill {
 
 protected:
    friend class TTreeCloner;
+   friend class TTreeFlushPool;
    // TBranch status bits
    enum EStatusBits {
       kAutoDelete = BIT(15),
@@ -81,6 +85,7 @@ protected:
    Long64_t    fFirstBasketEntry;//! First entry in the current basket.
    Long64_t    fNextBasketEntry; //! Next entry that will requires us to go to the next basket
    TBasket    *fCurrentBasket;   //! Pointer to the current basket.
+   TBasket    *fExtraBasket;     //! Written basket kept to be reused by Fill (see WriteCompressedBasket)
    Long64_t    fEntries;         //  Number of entries
    Long64_t    fFirstEntry;      //  Number of the first entry in this branch
    Long64_t    fTotBytes;        //  Total number of bytes in all leaves before compression
@@ -91,6 +96,8 @@ protected:
    Int_t      *fBasketBytes;     //[fMaxBaskets] Length of baskets on file
    Long64_t   *fBasketEntry;     //[fMaxBaskets] Table of first entry in each basket
    Long64_t   *fBasketSeek;      //[fMaxBaskets] Addresses of baskets on file
+   Double_t   *fBasketMin;       //[fMaxBaskets] Minimum of the values filled in each basket (0 if not recorded)
+   Double_t   *fBasketMax;       //[fMaxBaskets] Maximum of the values filled in each basket (0 if not recorded)
    TTree      *fTree;            //! Pointer to Tree header
    TBranch    *fMother;          //! Pointer to top-level parent branch in the tree.
    TBranch    *fParent;          //! Pointer to parent branch.
@@ -99,6 +106,12 @@ protected:
    TString     fFileName;        //  Name of file where buffers are stored ("" if in same file as Tree header)
    TBuffer    *fEntryBuffer;     //! Buffer used to directly pass the content without streaming
    TList      *fBrowsables;      //! List of TVirtualBranchBrowsables used for Browse()
+   Int_t       fCompressDictSize;//  Size of the compression dictionary (0 if none)
+   char       *fCompressDict;    //[fCompressDictSize] Compression dictionary trained on the first baskets
+   Int_t       fDictTrainBaskets;//! Number of baskets still to be sampled to train the dictionary
+   Int_t       fDictMaxSize;     //! Maximum size of the dictionary to train
+   std::vector<char>  fDictSamples;     //! Content of the baskets sampled for the dictionary
+   std::vector<Int_t> fDictSampleSizes; //! Size of each sampled basket
 
    Bool_t      fSkipZip;         //! After being read, the buffer will not be unziped.
 
@@ -112,11 +125,15 @@ protected:
    void     ReadLeaves2Impl(TBuffer &b);
    void     FillLeavesImpl(TBuffer &b);
    
+   void     AddClonedBasket(TBasket &b, Bool_t ondisk, Long64_t startEntry, TBranch *from, Int_t index);
    void     SetSkipZip(Bool_t skip = kTRUE) { fSkipZip = skip; }
    void     Init(const char *name, const char *leaflist, Int_t compress);
+   void     UpdateBasketStats(Bool_t first);
 
    TBasket *GetFreshBasket();
+   void     TrainCompressionDictionary();
    Int_t    WriteBasket(TBasket* basket, Int_t where);
+   Int_t    WriteCompressedBasket(TBasket* basket, Int_t where, Int_t nout);
    
    TString  GetRealFileName() const;
 
@@ -147,11 +164,16 @@ public:
            TBasket  *GetBasket(Int_t basket);
            Int_t    *GetBasketBytes() const {return fBasketBytes;}
            Long64_t *GetBasketEntry() const {return fBasketEntry;}
+           Double_t *GetBasketMax() const {return fBasketMax;}
+           Double_t *GetBasketMin() const {return fBasketMin;}
    virtual Long64_t  GetBasketSeek(Int_t basket) const;
    virtual Int_t     GetBasketSize() const {return fBasketSize;}
    virtual TList    *GetBrowsables();
+           Int_t     GetBulkEntries(Long64_t entry, void *buffer, Int_t nentries);
    virtual const char* GetClassName() const;
            Int_t     GetCompressionAlgorithm() const;
+   const char       *GetCompressionDictionary() const {return fCompressDict;}
+           Int_t     GetCompressionDictionarySize() const {return fCompressDictSize;}
            Int_t     GetCompressionLevel() const;
            Int_t     GetCompressionSettings() const;
    TDirectory       *GetDirectory() const {return fDirectory;}
@@ -200,8 +222,10 @@ public:
    virtual void      SetObject(void *objadd);
    virtual void      SetAutoDelete(Bool_t autodel=kTRUE);
    virtual void      SetBasketSize(Int_t buffsize);
+           Bool_t    SetBasketStats(Bool_t stats = kTRUE);
    virtual void      SetBufferAddress(TBuffer *entryBuffer);
    void              SetCompressionAlgorithm(Int_t algorithm=0);
+   void              SetCompressionDictionary(Int_t nbaskets=4, Int_t maxsize=32768);
    void              SetCompressionLevel(Int_t level=1);
    void              SetCompressionSettings(Int_t settings=1);
    virtual void      SetEntries(Long64_t entries);
@@ -219,7 +243,7 @@ public:
 
    static  void      ResetCount();
 
-   ClassDef(TBranch,12);  //Branch descriptor
+   ClassDef(TBranch,14);  //Branch descriptor
 };
 
 //______________________________________________________________________________
@@ -31,6 +31,7 @@ class TCut;
 class TEntryList;
 class TEventList;
 class TCollection;
+class TChainOpenAhead;
 
 class TChain : public TTree {
 
@@ -45,6 +46,8 @@ protected:
    TObjArray   *fFiles;            //-> List of file names containing the trees (TChainElement, owned)
    TList       *fStatus;           //-> List of active/inactive branches (TChainElement, owned)
    TChain      *fProofChain;       //! chain proxy when going to be processed by PROOF
+   Int_t        fOpenAheadDepth;   //! Number of files opened in advance (see SetOpenAheadDepth)
+   TChainOpenAhead *fOpenAhead;    //! Thread opening the next files in advance
 
 private:
    TChain(const TChain&);            // not implemented
@@ -97,6 +100,8 @@ public:
    virtual Long64_t  GetEntryNumber(Long64_t entry) const;
    virtual Int_t     GetEntryWithIndex(Int_t major, Int_t minor=0);
    TFile            *GetFile() const;
+   TChainOpenAhead  *GetOpenAhead() const { return fOpenAhead; }
+           Int_t     GetOpenAheadDepth() const { return fOpenAheadDepth; }
    virtual TLeaf    *GetLeaf(const char* branchname, const char* leafname);
    virtual TLeaf    *GetLeaf(const char* name);
    virtual TObjArray *GetListOfBranches();
@@ -158,12 +163,14 @@ public:
 #endif
 
    virtual void      SetBranchStatus(const char *bname, Bool_t status=1, UInt_t *found=0);
+   virtual Int_t     SetCacheProfile(const char *filename);
    virtual void      SetCacheSize(Long64_t cacheSize = -1);
    virtual void      SetDirectory(TDirectory *dir);
    virtual void      SetEntryList(TEntryList *elist, Option_t *opt="");
    virtual void      SetEntryListFile(const char *filename="", Option_t *opt="");
    virtual void      SetEventList(TEventList *evlist);
    virtual void      SetMakeClass(Int_t make) { TTree::SetMakeClass(make); if (fTree) fTree->SetMakeClass(make);}
+   virtual void      SetOpenAheadDepth(Int_t depth = 1);
    virtual void      SetPacketSize(Int_t size = 100);
    virtual void      SetProof(Bool_t on = kTRUE, Bool_t refresh = kFALSE, Bool_t gettreeheader = kFALSE);
    virtual void      SetWeight(Double_t w=1, Option_t *option="");
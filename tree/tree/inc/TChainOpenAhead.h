@@ -0,0 +1,87 @@
+// @(#)root/tree:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2012, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TChainOpenAhead
+#define ROOT_TChainOpenAhead
+
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TChainOpenAhead                                                      //
+//                                                                      //
+// Thread opening the next files of a TChain while the current file is //
+// being processed (see TChain::SetOpenAheadDepth).                     //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef ROOT_TObject
+#include "TObject.h"
+#endif
+#ifndef ROOT_TString
+#include "TString.h"
+#endif
+
+#include <deque>
+
+class TChain;
+class TFile;
+class TThread;
+class TMutex;
+class TCondition;
+
+class TChainOpenAhead : public TObject {
+
+private:
+   struct TOpenTask {
+      Int_t                fTreeNumber; // Number of the tree in the chain
+      TString              fUrl;        // Name of the file
+      TFile               *fFile;       // Opened file, 0 in case of failure
+      Int_t                fStatus;     // One of EOpenStatus
+      Bool_t               fDiscard;    // True if the file is not needed anymore
+   };
+   enum EOpenStatus { kQueued, kOpening, kOpened };
+
+   TChain                  *fChain;          //! Chain whose files are opened
+   TThread                 *fThread;         //! Thread opening the files
+   Bool_t                   fActive;         //! False once the thread has been asked to stop
+   TMutex                  *fMutex;          //! Protect the queue, used by the condition variables
+   TCondition              *fStartCondition; //! Signaled when a file has been queued
+   TCondition              *fDoneCondition;  //! Signaled when a file has been opened
+   std::deque<TOpenTask*>   fTasks;          //! Files queued or opened, in tree order
+
+   // Statistics
+   Int_t                    fNOpened;        //! Number of files taken already opened
+   Int_t                    fNWaits;         //! Number of files the chain had to wait for
+   Int_t                    fNMissed;        //! Number of files the chain had to open itself
+
+   TChainOpenAhead(const TChainOpenAhead&);            // not implemented
+   TChainOpenAhead& operator=(const TChainOpenAhead&); // not implemented
+
+   void         Discard(TOpenTask *task);
+   void         Open(TOpenTask *task);
+   TOpenTask   *NextTask();
+
+public:
+   TChainOpenAhead(TChain *chain);
+   virtual ~TChainOpenAhead();
+
+   Int_t        GetNMissed() const { return fNMissed; }
+   Int_t        GetNOpened() const { return fNOpened; }
+   Int_t        GetNWaits() const { return fNWaits; }
+   virtual void Print(Option_t *option = "") const;
+   void         Queue(Int_t treenum, Int_t depth);
+   TFile       *Take(Int_t treenum);
+
+   static void *OpenLoop(void *arg);
+
+   ClassDef(TChainOpenAhead,0)  //Thread opening the next files of a TChain in advance
+};
+
+#endif
@@ -87,6 +87,7 @@ class TBranchRef;
 class TBasket;
 class TStreamerInfo;
 class TTreeCloner;
+class TTreeFlushPool;
 class TFileMergeInfo;
 
 class TTree : public TNamed, public TAttLine, public TAttFill, public TAttMarker {
@@ -140,6 +141,9 @@ protected:
    TBranchRef    *fBranchRef;         //  Branch supporting the TRefTable (if any)
    UInt_t         fFriendLockStatus;  //! Record which method is locking the friend recursion
    TBuffer       *fTransientBuffer;   //! Pointer to the current transient buffer.
+   TTreeFlushPool *fFlushPool;        //! Pool of threads compressing the baskets (see SetParallelFlush)
+   Int_t          fNProcessThreads;   //! Number of threads used by Process(TSelector*) (see SetParallelProcess)
+   TString        fCacheProfile;      //! File with the branches to put in the cache (see SetCacheProfile)
 
    static Int_t     fgBranchStyle;      //  Old/New branch style
    static Long64_t  fgMaxTreeSize;      //  Maximum size of a file containg a Tree
@@ -358,6 +362,7 @@ public:
    virtual TBranchRef     *GetBranchRef() const { return fBranchRef; };
    virtual Bool_t          GetBranchStatus(const char* branchname) const;
    static  Int_t           GetBranchStyle();
+   virtual const char     *GetCacheProfile() const { return fCacheProfile.Data(); }
    virtual Long64_t        GetCacheSize() const { return fCacheSize; }
    virtual TClusterIterator GetClusterIterator(Long64_t firstentry);
    virtual Long64_t        GetChainEntryNumber(Long64_t entry) const { return entry; }
@@ -393,6 +398,7 @@ public:
    virtual TObjArray      *GetListOfBranches() { return &fBranches; }
    virtual TObjArray      *GetListOfLeaves() { return &fLeaves; }
    virtual TList          *GetListOfFriends() const { return fFriends; }
+           TTreeFlushPool *GetFlushPool() const { return fFlushPool; }
    virtual TList          *GetListOfAliases() const { return fAliases; }
 
    // GetMakeClass is left non-virtual for efficiency reason.
@@ -408,6 +414,7 @@ public:
    TObject                *GetNotify() const { return fNotify; }
    TVirtualTreePlayer     *GetPlayer();
    virtual Int_t           GetPacketSize() const { return fPacketSize; }
+           Int_t           GetParallelProcess() const { return fNProcessThreads; }
    virtual Long64_t        GetReadEntry()  const { return fReadEntry; }
    virtual Long64_t        GetReadEvent()  const { return fReadEntry; }
    virtual Int_t           GetScanField()  const { return fScanField; }
@@ -481,11 +488,13 @@ public:
    virtual void            ResetAfterMerge(TFileMergeInfo *);
    virtual void            ResetBranchAddress(TBranch *);
    virtual void            ResetBranchAddresses();
+   virtual Int_t           SaveCacheProfile(const char *filename) const;
    virtual Long64_t        Scan(const char* varexp = "", const char* selection = "", Option_t* option = "", Long64_t nentries = 1000000000, Long64_t firstentry = 0); // *MENU*
    virtual Bool_t          SetAlias(const char* aliasName, const char* aliasFormula);
    virtual void            SetAutoSave(Long64_t autos = 300000000);
    virtual void            SetAutoFlush(Long64_t autof = -30000000);
    virtual void            SetBasketSize(const char* bname, Int_t buffsize = 16000);
+   virtual void            SetBasketStats(const char* bname = "*", Bool_t stats = kTRUE);
 #if !defined(__CINT__)
    virtual Int_t           SetBranchAddress(const char *bname,void *add, TBranch **ptr = 0);
 #endif
@@ -512,8 +521,11 @@ public:
    virtual void            SetCacheSize(Long64_t cachesize = -1);
    virtual void            SetCacheEntryRange(Long64_t first, Long64_t last);
    virtual void            SetCacheLearnEntries(Int_t n=10);
+   virtual Int_t           SetCacheProfile(const char *filename);
    virtual void            SetChainOffset(Long64_t offset = 0) { fChainOffset=offset; }
    virtual void            SetCircular(Long64_t maxEntries);
+   virtual void            SetCompressionDictionary(const char* bname, Int_t nbaskets = 4, Int_t maxsize = 32768);
+   virtual void            SetCompressionSettings(const char* bname, Int_t settings = 1);
    virtual void            SetDebug(Int_t level = 1, Long64_t min = 0, Long64_t max = 9999999); // *MENU*
    virtual void            SetDefaultEntryOffsetLen(Int_t newdefault, Bool_t updateExisting = kFALSE);
    virtual void            SetDirectory(TDirectory* dir);
@@ -529,6 +541,8 @@ public:
    virtual void            SetName(const char* name); // *MENU*
    virtual void            SetNotify(TObject* obj) { fNotify = obj; }
    virtual void            SetObject(const char* name, const char* title);
+   virtual void            SetParallelFlush(Int_t nthreads = -1);
+   virtual void            SetParallelProcess(Int_t nthreads = -1);
    virtual void            SetParallelUnzip(Bool_t opt=kTRUE, Float_t RelSize=-1);
    virtual void            SetScanField(Int_t n = 50) { fScanField = n; } // *MENU*
    virtual void            SetTimerInterval(Int_t msec = 333) { fTimerInterval=msec; }
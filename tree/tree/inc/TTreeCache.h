@@ -28,6 +28,9 @@
 #include "TObjArray.h"
 #endif
 
+#include <deque>
+#include <vector>
+
 class TTree;
 class TBranch;
 
@@ -61,6 +64,26 @@ protected:
    EPrefillType    fPrefillType; // Whether a prefilling is enabled (and if applicable which type)
    static  Int_t   fgLearnEntries; // number of entries used for learning mode
 
+   // Members for the read-ahead of the next cache fills
+   struct TReadAheadBlock {
+      Long64_t              fEntryMin;  // First entry of the baskets read in advance
+      Long64_t              fEntryNext; // First entry after the baskets read in advance
+      Long64_t              fNbytes;    // Total size of the baskets read in advance
+      std::vector<Long64_t> fSeek;      // Sorted positions of the baskets
+      std::vector<Int_t>    fSeekLen;   // Lengths of the baskets
+   };
+   TFilePrefetch  *fReadAhead;        //! Thread reading the baskets of the next cache fills
+   Int_t           fReadAheadDepth;   //! Number of cache fills read in advance (0 means no read-ahead)
+   Long64_t        fReadAheadMaxSize; //! Maximum number of bytes read in advance
+   Long64_t        fReadAheadNext;    //! First entry not yet read in advance
+   std::deque<TReadAheadBlock> fReadAheadBlocks; //! Blocks read in advance and not yet used
+   Long64_t        fNReadAheadBytes;  //! Number of bytes used from the blocks read in advance
+   Double_t        fStallTime;        //! Time spent waiting for the baskets of the cache (in seconds)
+
+   void            ReadAhead();
+   void            StopReadAhead();
+   Bool_t          TransferBuffer();
+
 private:
    TTreeCache(const TTreeCache &);            //this class cannot be copied
    TTreeCache& operator=(const TTreeCache &);
@@ -72,6 +95,7 @@ public:
    virtual ~TTreeCache();
    virtual void         AddBranch(TBranch *b, Bool_t subgbranches = kFALSE);
    virtual void         AddBranch(const char *branch, Bool_t subbranches = kFALSE);
+   virtual void         Close(Option_t *option="");
    virtual void         DropBranch(TBranch *b, Bool_t subbranches = kFALSE);
    virtual void         DropBranch(const char *branch, Bool_t subbranches = kFALSE);
    virtual void         Disable() {fEnabled = kFALSE;}
@@ -83,22 +107,30 @@ public:
    virtual Int_t        GetEntryMax() const {return fEntryMax;}
    static Int_t         GetLearnEntries();
    virtual EPrefillType GetLearnPrefill() const {return fPrefillType;}
+   Int_t                GetReadAheadDepth() const {return fReadAheadDepth;}
+   Long64_t             GetReadAheadMaxSize() const {return fReadAheadMaxSize;}
+   Double_t             GetStallTime() const {return fStallTime;}
    TTree               *GetTree() const;
    virtual Bool_t       IsEnabled() const {return fEnabled;}
    virtual Bool_t       IsLearning() const {return fIsLearning;}
+   virtual Int_t        LoadProfile(const char *filename);
 
    virtual Bool_t       FillBuffer();
    virtual void         LearnPrefill();
 
    virtual void         Print(Option_t *option="") const;
    virtual Int_t        ReadBuffer(char *buf, Long64_t pos, Int_t len);
+   virtual Int_t        ReadBufferExtNormal(char *buf, Long64_t pos, Int_t len, Int_t &loc);
    virtual Int_t        ReadBufferNormal(char *buf, Long64_t pos, Int_t len); 
    virtual Int_t        ReadBufferPrefetch(char *buf, Long64_t pos, Int_t len);
    virtual void         ResetCache();
+   virtual Int_t        SaveProfile(const char *filename) const;
    virtual void         SetEntryRange(Long64_t emin,   Long64_t emax);
    virtual void         SetFile(TFile *file);
    virtual void         SetLearnPrefill(EPrefillType type = kNoPrefill);
    static void          SetLearnEntries(Int_t n = 10);
+   virtual void         SetReadAheadDepth(Int_t nfills = 1);
+   virtual void         SetReadAheadMaxSize(Long64_t nbytes = 0);
    void                 StartLearningPhase();
    virtual void         StopLearningPhase();
    virtual void         UpdateBranches(TTree *tree);
@@ -30,10 +30,10 @@
 #endif
 
 #include <queue>
+#include <vector>
 
 class TTree;
 class TBranch;
-class TThread;
 class TCondition;
 class TBasket;
 class TMutex;
@@ -47,9 +47,7 @@ public:
 protected:
 
    // Members for paral. managing
-   TThread    *fUnzipThread[10];
-   Bool_t      fActiveThread;          // Used to terminate gracefully the unzippers
-   TCondition *fUnzipStartCondition;   // Used to signal the threads to start.
+   Bool_t      fActiveThread;          // Used to terminate gracefully the unzipping of the blocks of this cache
    TCondition *fUnzipDoneCondition;    // Used to wait for an unzip tour to finish. Gives the Async feel.
    Bool_t      fParallel;              // Indicate if we want to activate the parallelism (for this instance)
    Bool_t      fAsyncReading;
@@ -57,10 +55,12 @@ protected:
    TMutex     *fIOMutex;
 
    Int_t       fCycle;
+   Int_t       fSubmittedCycle;        // Last cycle whose blocks were submitted to the TTreeUnzipPool
+   Int_t       fNTasks;                // Number of blocks submitted to the TTreeUnzipPool and not yet processed
    static TTreeCacheUnzip::EParUnzipMode fgParallel;  // Indicate if we want to activate the parallelism
 
    Int_t       fLastReadPos;
-   Int_t       fBlocksToGo;
+   Long64_t    fReadEntry;             // Highest first entry of the baskets read in this cycle
 
    // Unzipping related members
    Int_t      *fUnzipLen;         //! [fNseek] Length of the unzipped buffers
@@ -80,6 +80,10 @@ protected:
    Int_t       fNMissed;          //! number of blocks that were not found in the cache and were unzipped
 
    std::queue<Int_t>       fActiveBlks; // The blocks which are active now
+   std::vector<Long64_t>   fBlockEntry;    //! First entry of the basket of each block
+   std::vector<Long64_t>   fBlockEntryEnd; //! First entry after the basket of each block
+   std::vector<TBranch*>   fBlockBranch;   //! Branch of the basket of each block
+   std::vector<Int_t>      fDeferred;      //! Blocks postponed because the unzipped blocks use too much memory
 
 private:
    TTreeCacheUnzip(const TTreeCacheUnzip &);            //this class cannot be copied
@@ -90,8 +94,8 @@ private:
 
    // Private methods
    void  Init();
-   Int_t StartThreadUnzip(Int_t nthreads);
-   Int_t StopThreadUnzip();
+   void  SubmitBlocks();
+   void  SubmitDeferred();
 
 public:
    TTreeCacheUnzip();
@@ -113,17 +117,14 @@ public:
    Bool_t               IsActiveThread();
    Bool_t               IsQueueEmpty();
 
-   void                 WaitUnzipStartSignal();
-   void                 SendUnzipStartSignal(Bool_t broadcast);
-
    // Unzipping related methods
    Int_t          GetRecordHeader(char *buf, Int_t maxbytes, Int_t &nbytes, Int_t &objlen, Int_t &keylen);
    virtual void   ResetCache();
    virtual Int_t  GetUnzipBuffer(char **buf, Long64_t pos, Int_t len, Bool_t *free);
    void           SetUnzipBufferSize(Long64_t bufferSize);
    static void    SetUnzipRelBufferSize(Float_t relbufferSize);
-   Int_t          UnzipBuffer(char **dest, char *src);
-   Int_t          UnzipCache(Int_t &startindex, Int_t &locbuffsz, char *&locbuff);
+   Int_t          UnzipBuffer(char **dest, char *src, TBranch *branch = 0);
+   Int_t          UnzipBlock(Int_t index, Int_t cycle, Int_t &locbuffsz, char *&locbuff);
 
    // Methods to get stats
    Int_t  GetNUnzip() { return fNUnzip; }
@@ -132,8 +133,6 @@ public:
 
    void Print(Option_t* option = "") const;
 
-   // static members
-   static void* UnzipLoop(void *arg);
    ClassDef(TTreeCacheUnzip,0)  //Specialization of TTreeCache for parallel unzipping
 };
 
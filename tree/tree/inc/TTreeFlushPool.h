@@ -0,0 +1,89 @@
+// @(#)root/tree:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2012, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TTreeFlushPool
+#define ROOT_TTreeFlushPool
+
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TTreeFlushPool                                                       //
+//                                                                      //
+// Pool of threads compressing the full baskets of a TTree. The         //
+// baskets are written to the file in the order they were submitted by  //
+// the thread filling the tree (see TTree::SetParallelFlush).           //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef ROOT_TObject
+#include "TObject.h"
+#endif
+
+#include <deque>
+#include <vector>
+
+class TTree;
+class TBasket;
+class TThread;
+class TMutex;
+class TCondition;
+
+class TTreeFlushPool : public TObject {
+
+private:
+   struct TFlushTask {
+      TBasket *fBasket;   // Basket to compress and write
+      Int_t    fWhere;    // Basket number in its branch
+      Int_t    fSize;     // Uncompressed size of the basket
+      Int_t    fNout;     // Size of the compressed object, -1 in case of error
+      Int_t    fStatus;   // One of EFlushStatus
+   };
+   enum EFlushStatus { kQueued, kCompressing, kCompressed };
+
+   TTree                    *fTree;          //! Tree whose baskets are flushed
+   std::vector<TThread*>     fThreads;       //! Compression threads
+   Bool_t                    fActive;        //! False once the threads have been asked to stop
+   TMutex                   *fMutex;         //! Protect the queues, used by the condition variables
+   TCondition               *fStartCondition;//! Signaled when a basket has been queued
+   TCondition               *fDoneCondition; //! Signaled when a basket has been compressed
+   std::deque<TFlushTask*>   fQueue;         //! Baskets waiting for a compression thread
+   std::deque<TFlushTask*>   fTasks;         //! All the baskets not yet written, in submission order
+   Long64_t                  fQueuedBytes;   //! Uncompressed size of the baskets not yet written
+   Long64_t                  fMaxQueuedBytes;//! Above this size, Commit waits for baskets to be written
+
+   // Statistics
+   Int_t                     fNSubmitted;    //! Number of baskets handed over to the pool
+   Int_t                     fNCompressedMain; //! Number of baskets compressed by the filling thread
+   Int_t                     fNWaits;        //! Number of times the filling thread had to wait
+
+   TTreeFlushPool(const TTreeFlushPool&);            // not implemented
+   TTreeFlushPool& operator=(const TTreeFlushPool&); // not implemented
+
+   void         Compress(TFlushTask *task);
+   TFlushTask  *NextTask();
+
+public:
+   TTreeFlushPool(TTree *tree, Int_t nthreads);
+   virtual ~TTreeFlushPool();
+
+   Int_t        Commit(Bool_t wait = kTRUE);
+   Long64_t     GetMaxQueuedBytes() const { return fMaxQueuedBytes; }
+   Int_t        GetNThreads() const { return (Int_t)fThreads.size(); }
+   Bool_t       IsEmpty() const { return fTasks.empty(); }
+   virtual void Print(Option_t *option = "") const;
+   void         SetMaxQueuedBytes(Long64_t maxbytes) { fMaxQueuedBytes = maxbytes; }
+   Int_t        Submit(TBasket *basket, Int_t where);
+
+   static void *FlushLoop(void *arg);
+
+   ClassDef(TTreeFlushPool,0)  //Pool of threads compressing the baskets of a TTree
+};
+
+#endif
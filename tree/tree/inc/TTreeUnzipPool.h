@@ -0,0 +1,91 @@
+// @(#)root/tree:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2012, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TTreeUnzipPool
+#define ROOT_TTreeUnzipPool
+
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TTreeUnzipPool                                                       //
+//                                                                      //
+// Process-wide pool of threads unzipping the baskets prefetched by     //
+// all the TTreeCacheUnzip instances. Each thread has its own queue of  //
+// blocks and steals work from the other threads when it runs out.      //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef ROOT_TObject
+#include "TObject.h"
+#endif
+
+#include <deque>
+#include <vector>
+
+class TTreeCacheUnzip;
+class TThread;
+class TMutex;
+class TCondition;
+
+class TTreeUnzipPool : public TObject {
+
+private:
+   struct TUnzipTask {
+      TTreeCacheUnzip *fCache;  // Cache owning the block
+      Int_t            fIndex;  // Index of the block in the cache
+      Int_t            fCycle;  // Cycle of the cache when the block was submitted
+   };
+   struct TWorker {
+      TTreeUnzipPool          *fPool;       // Pool owning the worker
+      Int_t                    fId;         // Index of the worker in the pool
+      TThread                 *fThread;     // Thread running UnzipLoop
+      TMutex                  *fMutex;      // Protect fTasks
+      std::deque<TUnzipTask>   fTasks;      // Blocks to unzip, most urgent first
+      char                    *fBuffer;     // Buffer holding the compressed block
+      Int_t                    fBufferSize; // Size of fBuffer
+   };
+
+   std::vector<TWorker*>  fWorkers;        //! Unzipping threads and their queues
+   Bool_t                 fActive;         //! False once the threads have been asked to stop
+   TMutex                *fIdleMutex;      //! Protect fNQueued, used by fIdleCondition
+   TCondition            *fIdleCondition;  //! Signaled when blocks have been queued
+   Int_t                  fNQueued;        //! Number of blocks in all the queues
+   UInt_t                 fNext;           //! Worker receiving the next submitted block
+
+   // Statistics
+   Long64_t               fNSubmitted;     //! Number of blocks submitted
+   Long64_t               fNStolen;        //! Number of blocks stolen from another worker
+   Long64_t               fNCancelled;     //! Number of blocks removed before being unzipped
+
+   static TTreeUnzipPool *fgInstance;      // The pool shared by all the caches
+   static Int_t           fgNThreads;      // Number of threads of the pool (0 means number of cores - 1)
+
+   TTreeUnzipPool(const TTreeUnzipPool&);            // not implemented
+   TTreeUnzipPool& operator=(const TTreeUnzipPool&); // not implemented
+
+   Bool_t       NextTask(TWorker *worker, TUnzipTask &task);
+
+public:
+   TTreeUnzipPool(Int_t nthreads);
+   virtual ~TTreeUnzipPool();
+
+   Int_t        Cancel(TTreeCacheUnzip *cache);
+   Int_t        GetNThreads() const { return (Int_t)fWorkers.size(); }
+   virtual void Print(Option_t *option = "") const;
+   void         Submit(TTreeCacheUnzip *cache, Int_t cycle, Int_t n, const Int_t *index);
+
+   static TTreeUnzipPool *Instance();
+   static void            SetNThreads(Int_t nthreads);
+   static void           *UnzipLoop(void *arg);
+
+   ClassDef(TTreeUnzipPool,0)  //Process-wide pool of threads unzipping the baskets of the TTreeCacheUnzip
+};
+
+#endif
@@ -33,7 +33,8 @@
 #endif
 
 extern "C" void R__zipMultipleAlgorithm(int cxlevel, int *srcsize, char *src, int *tgtsize, char *tgt, int *irep, int compressionAlgorithm);
-extern "C" void R__unzip(Int_t *nin, UChar_t *bufin, Int_t *lout, char *bufout, Int_t *nout);
+extern "C" void R__zipDict(int cxlevel, int *srcsize, char *src, int *tgtsize, char *tgt, int *irep, int compressionAlgorithm, const char *dict, int dictsize);
+extern "C" void R__unzipDict(Int_t *nin, UChar_t *bufin, Int_t *lout, char *bufout, Int_t *nout, const char *dict, Int_t dictsize);
 extern "C" int R__unzip_header(Int_t *nin, UChar_t *bufin, Int_t *lout);
 
 const Int_t  kMAXBUF = 0xFFFFFF;
@@ -160,6 +161,87 @@ void TBasket::AdjustSize(Int_t newsize)
    fBufferSize  = newsize;
 }
 
+//_______________________________________________________________________
+Int_t TBasket::CompressBuffer()
+{
+   // Transfer the entry offsets at the end of the basket buffer and compress
+   // the object part in the compressed buffer, leaving fBuffer pointing to the
+   // data to be written (first stage of WriteBuffer).
+   //
+   // The function only touches the basket itself and does not access the
+   // file, so that TTreeFlushPool can call it from a worker thread, provided
+   // the basket was prepared with PrepareParallelWrite.
+   //
+   // The function returns the number of bytes of the (compressed) object
+   // part or -1 in case of error.
+
+   // Transfer fEntryOffset table at the end of fBuffer.
+   fLast = fBufferRef->Length();
+   if (fEntryOffset) {
+      // Note: We might want to investigate the compression gain if we 
+      // transform the Offsets to fBuffer in entry length to optimize 
+      // compression algorithm.  The aggregate gain on a (random) CMS files
+      // is around 5.5%. So the code could something like:
+      //      for(Int_t z = fNevBuf; z > 0; --z) {
+      //         if (fEntryOffset[z]) fEntryOffset[z] = fEntryOffset[z] - fEntryOffset[z-1];
+      //      }
+      fBufferRef->WriteArray(fEntryOffset,fNevBuf+1);
+      if (fDisplacement) {
+         fBufferRef->WriteArray(fDisplacement,fNevBuf+1);
+         delete [] fDisplacement; fDisplacement = 0;
+      }
+   }
+
+   Int_t lbuf, nout, noutot, bufmax, nzip;
+   lbuf       = fBufferRef->Length();
+   fObjlen    = lbuf - fKeylen;
+
+   fHeaderOnly = kTRUE;
+   Int_t cxlevel = fBranch->GetCompressionLevel();
+   Int_t cxAlgorithm = fBranch->GetCompressionAlgorithm();
+   const char *dict = fBranch->GetCompressionDictionary();
+   Int_t dictsize   = fBranch->GetCompressionDictionarySize();
+   if (cxlevel > 0) {
+      Int_t nbuffers = 1 + (fObjlen - 1) / kMAXBUF;
+      Int_t buflen = fKeylen + fObjlen + 9 * nbuffers + 28; //add 28 bytes in case object is placed in a deleted gap
+      InitializeCompressedBuffer(buflen, GetFile());
+      if (!fCompressedBufferRef) {
+         Warning("WriteBuffer", "Unable to allocate the compressed buffer");
+         return -1;
+      }
+      fCompressedBufferRef->SetWriteMode();
+      fBuffer = fCompressedBufferRef->Buffer();
+      char *objbuf = fBufferRef->Buffer() + fKeylen;
+      char *bufcur = &fBuffer[fKeylen];
+      noutot = 0;
+      nzip   = 0;
+      for (Int_t i = 0; i < nbuffers; ++i) {
+         if (i == nbuffers - 1) bufmax = fObjlen - nzip;
+         else bufmax = kMAXBUF;
+         //compress the buffer
+         if (dictsize > 0) R__zipDict(cxlevel, &bufmax, objbuf, &bufmax, bufcur, &nout, cxAlgorithm, dict, dictsize);
+         else R__zipMultipleAlgorithm(cxlevel, &bufmax, objbuf, &bufmax, bufcur, &nout, cxAlgorithm);
+
+         // test if buffer has really been compressed. In case of small buffers 
+         // when the buffer contains random data, it may happen that the compressed
+         // buffer is larger than the input. In this case, we write the original uncompressed buffer
+         if (nout == 0 || nout >= fObjlen) {
+            // We used to delete fBuffer here, we no longer want to since
+            // the buffer (held by fCompressedBufferRef) might be re-used later.
+            fBuffer = fBufferRef->Buffer();
+            return fObjlen;
+         }
+         bufcur += nout;
+         noutot += nout;
+         objbuf += kMAXBUF;
+         nzip   += kMAXBUF;
+      }
+      return noutot;
+   }
+   fBuffer = fBufferRef->Buffer();
+   return fObjlen;
+}
+
 //_______________________________________________________________________
 Long64_t TBasket::CopyTo(TFile *to) 
 {
@@ -326,6 +408,70 @@ void TBasket::MoveEntries(Int_t dentries)
 }
 
 #define OLD_CASE_EXPRESSION fObjlen==fNbytes-fKeylen && GetBranch()->GetCompressionLevel()!=0 && file->GetVersion()<=30401
+//_______________________________________________________________________
+Int_t TBasket::PrepareParallelWrite(Int_t cycle)
+{
+   // Prepare this basket to be compressed outside of the thread filling the
+   // tree (see TTreeFlushPool): resolve the output file, record the cycle
+   // and make sure the basket does not share the transient compressed buffer
+   // of the TTree with the other baskets.
+   //
+   // The function returns 0 on success, 1 if the basket must be written
+   // directly with WriteBuffer and -1 if the file is not writable.
+
+   const Int_t kWrite = 1;
+
+   TFile *file = fBranch->GetFile(kWrite);
+   if (!file || !file->IsWritable()) {
+      return -1;
+   }
+   if (fBufferRef->TestBit(TBufferFile::kNotDecompressed)) {
+      return 1;
+   }
+   fMotherDir = file;
+   fCycle = cycle;
+   if (!fOwnsCompressedBuffer) {
+      // The shared buffer belongs to the tree, get a private one.
+      fCompressedBufferRef = 0;
+   }
+   return 0;
+}
+
+//_______________________________________________________________________
+Int_t TBasket::ReadBasketBuffersMapped(char* buffer, Int_t len, TFile* file)
+{
+   // The file is memory mapped (see TFile::SetMemoryMap) and buffer is the
+   // address of the basket in the mapping: let the TBuffer of the basket
+   // point there instead of copying the data. Nothing is written into the
+   // buffer when reading, the data are byte swapped as they are copied out.
+   // Returns the length of the basket, 0 if the basket is compressed and
+   // must be read the usual way, -1 in case of error.
+
+   if (fBufferRef) {
+      fBufferRef->SetBuffer(buffer, len, kFALSE);
+      fBufferRef->SetReadMode();
+      fBufferRef->Reset();
+   } else {
+      fBufferRef = new TBufferFile(TBuffer::kRead, len, buffer, kFALSE);
+   }
+   fBufferRef->SetParent(file);
+
+   Streamer(*fBufferRef);
+
+   if (IsZombie()) {
+      return -1;
+   }
+   if (fObjlen+fKeylen != fNbytes || fNbytes != len) {
+      // The basket was compressed anyway, go back to a buffer of our own.
+      fBufferRef->SetBuffer(new char[len], len, kTRUE);
+      fBufferRef->Reset();
+      return 0;
+   }
+
+   fBuffer = fBufferRef->Buffer();
+   return len;
+}
+
 //_______________________________________________________________________
 Int_t TBasket::ReadBasketBuffersUncompressedCase()
 {
@@ -384,6 +530,11 @@ static inline TBuffer* R__InitializeReadBasketBuffer(TBuffer* bufferRef, Int_t l
 
    TBuffer* result;
    if (R__likely(bufferRef)) {
+      if (R__unlikely(!bufferRef->TestBit(TBuffer::kIsOwner))) {
+         // The buffer pointed into a memory mapped file or into the cache, it
+         // can not be reused.
+         bufferRef->SetBuffer(new char[len], len, kTRUE);
+      }
       bufferRef->SetReadMode();
       Int_t curBufferSize = bufferRef->BufferSize();
       if (curBufferSize < len) {
@@ -452,6 +603,24 @@ Int_t TBasket::ReadBasketBuffers(Long64_t pos, Int_t len, TFile *file)
       }
    }
 
+   // For a memory mapped file, an uncompressed basket is used in place.
+   if (R__unlikely(fBranch->GetCompressionLevel()==0)) {
+      char *mapped = file->GetMapBuffer(pos, len);
+      if (mapped) {
+         Double_t start = 0;
+         if (R__unlikely(gPerfStats)) start = TTimeStamp();
+         fBranch->GetTree()->IncrementTotalBuffers(-fBufferSize);
+         Int_t res = ReadBasketBuffersMapped(mapped, len, file);
+         if (res < 0) return 1;
+         if (res > 0) {
+            // Counted as a read, as if the basket had been copied.
+            file->CountMapRead(len, start);
+            goto AfterBuffer;
+         }
+         fBranch->GetTree()->IncrementTotalBuffers(fBufferSize);
+      }
+   }
+
    // Determine which buffer to use, so that we can avoid a memcpy in case of 
    // the basket was not compressed.
    TBuffer* readBufferRef;
@@ -564,7 +733,8 @@ Int_t TBasket::ReadBasketBuffers(Long64_t pos, Int_t len, TFile *file)
             goto AfterBuffer;
          }
 
-         R__unzip(&nin, rawCompressedObjectBuffer, &nbuf, rawUncompressedObjectBuffer, &nout);
+         R__unzipDict(&nin, rawCompressedObjectBuffer, &nbuf, rawUncompressedObjectBuffer, &nout,
+                      fBranch->GetCompressionDictionary(), fBranch->GetCompressionDictionarySize());
          if (!nout) break;
          noutot += nout;
          nintot += nin;
@@ -934,92 +1104,35 @@ Int_t TBasket::WriteBuffer()
       return nBytes>0 ? fKeylen+nout : -1;
    }
 
-   // Transfer fEntryOffset table at the end of fBuffer.
-   fLast = fBufferRef->Length();
-   if (fEntryOffset) {
-      // Note: We might want to investigate the compression gain if we 
-      // transform the Offsets to fBuffer in entry length to optimize 
-      // compression algorithm.  The aggregate gain on a (random) CMS files
-      // is around 5.5%. So the code could something like:
-      //      for(Int_t z = fNevBuf; z > 0; --z) {
-      //         if (fEntryOffset[z]) fEntryOffset[z] = fEntryOffset[z] - fEntryOffset[z-1];
-      //      }
-      fBufferRef->WriteArray(fEntryOffset,fNevBuf+1);
-      if (fDisplacement) {
-         fBufferRef->WriteArray(fDisplacement,fNevBuf+1);
-         delete [] fDisplacement; fDisplacement = 0;
-      }
+   fCycle = fBranch->GetWriteBasket();
+   Int_t nout = CompressBuffer();
+   if (nout < 0) {
+      return -1;
    }
+   return WriteCompressedBuffer(nout);
+}
 
-   Int_t lbuf, nout, noutot, bufmax, nzip;
-   lbuf       = fBufferRef->Length();
-   fObjlen    = lbuf - fKeylen;
-
-   fHeaderOnly = kTRUE;
-   fCycle = fBranch->GetWriteBasket();
-   Int_t cxlevel = fBranch->GetCompressionLevel();
-   Int_t cxAlgorithm = fBranch->GetCompressionAlgorithm();
-   if (cxlevel > 0) {
-      Int_t nbuffers = 1 + (fObjlen - 1) / kMAXBUF;
-      Int_t buflen = fKeylen + fObjlen + 9 * nbuffers + 28; //add 28 bytes in case object is placed in a deleted gap
-      InitializeCompressedBuffer(buflen, file);
-      if (!fCompressedBufferRef) {
-         Warning("WriteBuffer", "Unable to allocate the compressed buffer");
-         return -1;
-      }
-      fCompressedBufferRef->SetWriteMode();
-      fBuffer = fCompressedBufferRef->Buffer();
-      char *objbuf = fBufferRef->Buffer() + fKeylen;
-      char *bufcur = &fBuffer[fKeylen];
-      noutot = 0;
-      nzip   = 0;
-      for (Int_t i = 0; i < nbuffers; ++i) {
-         if (i == nbuffers - 1) bufmax = fObjlen - nzip;
-         else bufmax = kMAXBUF;
-         //compress the buffer
-         R__zipMultipleAlgorithm(cxlevel, &bufmax, objbuf, &bufmax, bufcur, &nout, cxAlgorithm);
+//_______________________________________________________________________
+Int_t TBasket::WriteCompressedBuffer(Int_t nout)
+{
+   // Reserve nout bytes (plus the key) in the file and write the data
+   // prepared by CompressBuffer (second stage of WriteBuffer).
+   //
+   // The function returns the number of bytes committed to the file or -1
+   // in case of write error.
 
-         // test if buffer has really been compressed. In case of small buffers 
-         // when the buffer contains random data, it may happen that the compressed
-         // buffer is larger than the input. In this case, we write the original uncompressed buffer
-         if (nout == 0 || nout >= fObjlen) {
-            nout = fObjlen;
-            // We used to delete fBuffer here, we no longer want to since
-            // the buffer (held by fCompressedBufferRef) might be re-used later.
-            fBuffer = fBufferRef->Buffer();
-            Create(fObjlen,file);
-            fBufferRef->SetBufferOffset(0);
+   TFile *file = GetFile();
+   if (!file) return -1;
 
-            Streamer(*fBufferRef);         //write key itself again
-            if ((nout+fKeylen)>buflen) {
-               Warning("WriteBuffer","Possible memory corruption due to compression algorithm, wrote %d bytes past the end of a block of %d bytes. fNbytes=%d, fObjLen=%d, fKeylen=%d",
-                  (nout+fKeylen-buflen),buflen,fNbytes,fObjlen,fKeylen);
-            }
-            goto WriteFile;
-         }
-         bufcur += nout;
-         noutot += nout;
-         objbuf += kMAXBUF;
-         nzip   += kMAXBUF;
-      }
-      nout = noutot;
-      Create(noutot,file);
-      fBufferRef->SetBufferOffset(0);
+   Create(nout,file);
+   fBufferRef->SetBufferOffset(0);
 
-      Streamer(*fBufferRef);         //write key itself again
+   Streamer(*fBufferRef);         //write key itself again
+   if (fBuffer != fBufferRef->Buffer()) {
       memcpy(fBuffer,fBufferRef->Buffer(),fKeylen);
-   } else {
-      fBuffer = fBufferRef->Buffer();
-      Create(fObjlen,file);
-      fBufferRef->SetBufferOffset(0);
-
-      Streamer(*fBufferRef);         //write key itself again
-      nout = fObjlen;
    }
 
-WriteFile:
    Int_t nBytes = WriteFileKeepBuffer();
    fHeaderOnly = kFALSE;
    return nBytes>0 ? fKeylen+nout : -1;
 }
-
@@ -11,6 +11,7 @@
 
 #include "TBranch.h"
 
+#include "Bytes.h"
 #include "Compression.h"
 #include "TBasket.h"
 #include "TBranchBrowsable.h"
@@ -36,11 +37,15 @@
 #include "TTree.h"
 #include "TTreeCache.h"
 #include "TTreeCacheUnzip.h"
+#include "TTreeFlushPool.h"
 #include "TVirtualPad.h"
 
 #include <cstddef>
 #include <string.h>
 #include <stdio.h>
+#include <float.h>
+
+extern "C" int R__zip_traindict(int algorithm, int nsamples, const int *sizes, const char *samples, int capacity, char *dict);
 
 R__EXTERN TTree* gTree;
 
@@ -95,6 +100,7 @@ TBranch::TBranch()
 , fFirstBasketEntry(-1)
 , fNextBasketEntry(-1)
 , fCurrentBasket(0)
+, fExtraBasket(0)
 , fEntries(0)
 , fFirstEntry(0)
 , fTotBytes(0)
@@ -105,6 +111,8 @@ TBranch::TBranch()
 , fBasketBytes(0)
 , fBasketEntry(0)
 , fBasketSeek(0)
+, fBasketMin(0)
+, fBasketMax(0)
 , fTree(0)
 , fMother(0)
 , fParent(0)
@@ -113,6 +121,10 @@ TBranch::TBranch()
 , fFileName("")
 , fEntryBuffer(0)
 , fBrowsables(0)
+, fCompressDictSize(0)
+, fCompressDict(0)
+, fDictTrainBaskets(0)
+, fDictMaxSize(0)
 , fSkipZip(kFALSE)
 , fReadLeaves(&TBranch::ReadLeavesImpl)
 , fFillLeaves(&TBranch::FillLeavesImpl)
@@ -141,6 +153,7 @@ TBranch::TBranch(TTree *tree, const char* name, void* address, const char* leafl
 , fFirstBasketEntry(-1)
 , fNextBasketEntry(-1)
 , fCurrentBasket(0)
+, fExtraBasket(0)
 , fEntries(0)
 , fFirstEntry(0)
 , fTotBytes(0)
@@ -151,6 +164,8 @@ TBranch::TBranch(TTree *tree, const char* name, void* address, const char* leafl
 , fBasketBytes(0)
 , fBasketEntry(0)
 , fBasketSeek(0)
+, fBasketMin(0)
+, fBasketMax(0)
 , fTree(tree)
 , fMother(0)
 , fParent(0)
@@ -159,6 +174,10 @@ TBranch::TBranch(TTree *tree, const char* name, void* address, const char* leafl
 , fFileName("")
 , fEntryBuffer(0)
 , fBrowsables(0)
+, fCompressDictSize(0)
+, fCompressDict(0)
+, fDictTrainBaskets(0)
+, fDictMaxSize(0)
 , fSkipZip(kFALSE)
 , fReadLeaves(&TBranch::ReadLeavesImpl)
 , fFillLeaves(&TBranch::FillLeavesImpl)
@@ -243,6 +262,7 @@ TBranch::TBranch(TBranch *parent, const char* name, void* address, const char* l
 , fFirstBasketEntry(-1)
 , fNextBasketEntry(-1)
 , fCurrentBasket(0)
+, fExtraBasket(0)
 , fEntries(0)
 , fFirstEntry(0)
 , fTotBytes(0)
@@ -253,6 +273,8 @@ TBranch::TBranch(TBranch *parent, const char* name, void* address, const char* l
 , fBasketBytes(0)
 , fBasketEntry(0)
 , fBasketSeek(0)
+, fBasketMin(0)
+, fBasketMax(0)
 , fTree(parent ? parent->GetTree() : 0)
 , fMother(parent ? parent->GetMother() : 0)
 , fParent(parent)
@@ -261,6 +283,10 @@ TBranch::TBranch(TBranch *parent, const char* name, void* address, const char* l
 , fFileName("")
 , fEntryBuffer(0)
 , fBrowsables(0)
+, fCompressDictSize(0)
+, fCompressDict(0)
+, fDictTrainBaskets(0)
+, fDictMaxSize(0)
 , fSkipZip(kFALSE)
 , fReadLeaves(&TBranch::ReadLeavesImpl)
 , fFillLeaves(&TBranch::FillLeavesImpl)
@@ -420,15 +446,26 @@ TBranch::~TBranch()
    delete [] fBasketSeek;
    fBasketSeek  = 0;
 
+   delete [] fBasketMin;
+   fBasketMin   = 0;
+
+   delete [] fBasketMax;
+   fBasketMax   = 0;
+
    delete [] fBasketEntry;
    fBasketEntry = 0;
 
    delete [] fBasketBytes;
    fBasketBytes = 0;
 
+   delete [] fCompressDict;
+   fCompressDict = 0;
+
    fBaskets.Delete();
    fNBaskets = 0;
    fCurrentBasket = 0;
+   delete fExtraBasket;
+   fExtraBasket = 0;
    fFirstBasketEntry = -1;
    fNextBasketEntry = -1;
 
@@ -474,7 +511,17 @@ TBranch::~TBranch()
 //______________________________________________________________________________
 void TBranch::AddBasket(TBasket& b, Bool_t ondisk, Long64_t startEntry)
 {
-   // Add the basket to this branch.
+   // Add the basket to this branch. The range of its values is not known.
+
+   AddClonedBasket(b, ondisk, startEntry, 0, 0);
+}
+
+//______________________________________________________________________________
+void TBranch::AddClonedBasket(TBasket& b, Bool_t ondisk, Long64_t startEntry, TBranch *from, Int_t index)
+{
+   // Add the basket to this branch. The basket is a copy of the basket
+   // number index of the branch from (see TTreeCloner), whose range of
+   // values is copied if both branches record them (see SetBasketStats).
 
    // Warning: if the basket are not 'flushed/copied' in the same
    // order as they were created, this will induce a slow down in
@@ -518,10 +565,23 @@ void TBranch::AddBasket(TBasket& b, Bool_t ondisk, Long64_t startEntry)
             fBasketEntry[j] = fBasketEntry[j-1];
             fBasketBytes[j] = fBasketBytes[j-1];
             fBasketSeek[j]  = fBasketSeek[j-1];
+            if (fBasketMin) {
+               fBasketMin[j] = fBasketMin[j-1];
+               fBasketMax[j] = fBasketMax[j-1];
+            }
          }
       }
    }
    fBasketEntry[where] = startEntry;
+   if (fBasketMin) {
+      if (from && from->fBasketMin) {
+         fBasketMin[where] = from->fBasketMin[index];
+         fBasketMax[where] = from->fBasketMax[index];
+      } else {
+         fBasketMin[where] = -DBL_MAX;
+         fBasketMax[where] =  DBL_MAX;
+      }
+   }
 
    if (ondisk) {
       fBasketBytes[where] = basket->GetNbytes();  // not for in mem
@@ -561,6 +621,10 @@ void TBranch::AddLastBasket(Long64_t startEntry)
 
    }
    fBasketEntry[where] = startEntry;
+   if (fBasketMin) {
+      fBasketMin[where] = -DBL_MAX;
+      fBasketMax[where] =  DBL_MAX;
+   }
    fBaskets.AddAtAndExpand(0,fWriteBasket);
 }
 
@@ -636,6 +700,11 @@ void TBranch::DropBaskets(Option_t* options)
    TBasket *basket;
    Int_t nbaskets = fBaskets.GetEntriesFast();
 
+   if (all && fExtraBasket) {
+      delete fExtraBasket;
+      fExtraBasket = 0;
+   }
+
    if ( (fNBaskets>1) || all ) {
       //slow case
       for (Int_t i=0;i<nbaskets;i++) {
@@ -698,6 +767,12 @@ void TBranch::ExpandBasketArrays()
                                                 newsize*sizeof(Long64_t),fMaxBaskets*sizeof(Long64_t));
    fBasketSeek   = (Long64_t*)TStorage::ReAlloc(fBasketSeek,
                                                 newsize*sizeof(Long64_t),fMaxBaskets*sizeof(Long64_t));
+   if (fBasketMin) {
+      fBasketMin = (Double_t*)TStorage::ReAlloc(fBasketMin,
+                                                newsize*sizeof(Double_t),fMaxBaskets*sizeof(Double_t));
+      fBasketMax = (Double_t*)TStorage::ReAlloc(fBasketMax,
+                                                newsize*sizeof(Double_t),fMaxBaskets*sizeof(Double_t));
+   }
 
    fMaxBaskets   = newsize;
 
@@ -707,6 +782,10 @@ void TBranch::ExpandBasketArrays()
       fBasketBytes[i] = 0;
       fBasketEntry[i] = 0;
       fBasketSeek[i]  = 0;
+      if (fBasketMin) {
+         fBasketMin[i] = -DBL_MAX;
+         fBasketMax[i] =  DBL_MAX;
+      }
    }
 }
 
@@ -727,7 +806,13 @@ Int_t TBranch::Fill()
 
    TBasket* basket = GetBasket(fWriteBasket);
    if (!basket) {
-      basket = fTree->CreateBasket(this); //  create a new basket
+      if (fExtraBasket) {
+         // Reuse the basket last written by the flush pool.
+         basket = fExtraBasket;
+         fExtraBasket = 0;
+      } else {
+         basket = fTree->CreateBasket(this); //  create a new basket
+      }
       if (!basket) return 0;
       ++fNBaskets;
       fBaskets.AddAtAndExpand(basket,fWriteBasket);
@@ -749,12 +834,19 @@ Int_t TBranch::Fill()
 
    if (fEntryBuffer) {
       nbytes = FillEntryBuffer(basket,buf,lnew);
+      if (fBasketMin) {
+         // The values are not seen when copying the buffers.
+         fBasketMin[fWriteBasket] = -DBL_MAX;
+         fBasketMax[fWriteBasket] =  DBL_MAX;
+      }
    } else {
       Int_t lold = buf->Length();
+      Bool_t first = basket->GetNevBuf() == 0;
       basket->Update(lold);
       ++fEntries;
       ++fEntryNumber;
       (this->*fFillLeaves)(*buf);
+      if (fBasketMin) UpdateBasketStats(first);
       if (buf->GetMapCount()) {
          // The map is used.
          ResetBit(TBranch::kDoNotUseBufferMap);
@@ -1088,6 +1180,11 @@ TBasket* TBranch::GetBasket(Int_t basketnumber)
    if (basket) return basket;
    if (basketnumber == fWriteBasket) return 0;
 
+   if (R__unlikely(fBasketSeek[basketnumber] == 0) && fTree->GetFlushPool()) {
+      // The basket might still be in the flush pool, get it written first.
+      fTree->GetFlushPool()->Commit(kTRUE);
+   }
+
    // create/decode basket parameters from buffer
    TFile *file = GetFile(0);
    if (file == 0) {
@@ -1152,6 +1249,112 @@ TList* TBranch::GetBrowsables() {
    return fBrowsables;
 }
 
+//______________________________________________________________________________
+Int_t TBranch::GetBulkEntries(Long64_t entry, void *buffer, Int_t nentries)
+{
+   // Read in one go up to nentries entries, starting at entry, and store
+   // their values contiguously in buffer, converted to the memory
+   // representation of the leaf type (e.g. an array of Float_t for a
+   // branch "x/F", of 3*nentries Double_t for a branch "v[3]/D").
+   //
+   // The entries are read from the basket containing entry: the number of
+   // entries read is limited by the end of this basket. Call the function
+   // again, starting at the next entry, to read the following basket.
+   // The baskets are read through the TTreeCache, if any, as with GetEntry.
+   // The byte swapping of the whole range is done at once, which is much
+   // faster than reading the entries one by one with GetEntry.
+   // Note that the leaf itself (and the address set with SetAddress) is not
+   // updated.
+   //
+   // This is only supported for a branch of class TBranch with a single
+   // leaf of basic numeric type (TLeafB, TLeafS, TLeafI, TLeafL, TLeafF,
+   // TLeafD, TLeafO) and of fixed size (no leaf counter).
+   //
+   // The function returns the number of entries read, 0 if entry does not
+   // exist and -1 in case of I/O error or if the branch is not supported, in
+   // which case the entries must be read with GetEntry.
+
+   if (fNleaves != 1 || IsA() != TBranch::Class()) {
+      return -1;
+   }
+   TLeaf *leaf = (TLeaf*)fLeaves.UncheckedAt(0);
+   if (leaf->GetLeafCount()) {
+      return -1;
+   }
+   TClass *cl = leaf->IsA();
+   Int_t lentype = 0;
+   if (cl == TLeafB::Class() || cl == TLeafO::Class()) {
+      lentype = 1;
+   } else if (cl == TLeafS::Class()) {
+      lentype = 2;
+   } else if (cl == TLeafI::Class() || cl == TLeafF::Class()) {
+      lentype = 4;
+   } else if (cl == TLeafL::Class() || cl == TLeafD::Class()) {
+      lentype = 8;
+   } else {
+      return -1;
+   }
+   if (nentries <= 0 || (entry < fFirstEntry) || (entry >= fEntryNumber)) {
+      return 0;
+   }
+
+   // Find the basket containing this entry (see GetEntry).
+   if ((entry < fFirstBasketEntry) || (entry >= fNextBasketEntry)) {
+      fReadBasket = TMath::BinarySearch(fWriteBasket + 1, fBasketEntry, entry);
+      if (fReadBasket < 0) {
+         fNextBasketEntry = -1;
+         Error("GetBulkEntries", "In the branch %s, no basket contains the entry %lld", GetName(), entry);
+         return -1;
+      }
+      if (fReadBasket == fWriteBasket) {
+         fNextBasketEntry = fEntryNumber;
+      } else {
+         fNextBasketEntry = fBasketEntry[fReadBasket+1];
+      }
+      fFirstBasketEntry = fBasketEntry[fReadBasket];
+   }
+   TBasket *basket = (TBasket*) fBaskets.UncheckedAt(fReadBasket);
+   if (!basket) {
+      basket = GetBasket(fReadBasket);
+      if (!basket) {
+         fCurrentBasket = 0;
+         fFirstBasketEntry = -1;
+         fNextBasketEntry = -1;
+         return -1;
+      }
+   }
+   fCurrentBasket = basket;
+   basket->PrepareBasket(entry);
+   TBuffer* buf = basket->GetBufferRef();
+   Int_t nevbufsize = leaf->GetLenStatic() * lentype;
+   if (!buf || basket->GetEntryOffset() || basket->GetNevBufSize() != nevbufsize) {
+      // Not a fixed size layout, fall back to GetEntry.
+      return -1;
+   }
+   if (!buf->IsReading()) {
+      basket->SetReadMode();
+   }
+
+   Long64_t n = fNextBasketEntry - entry;
+   if (n > nentries) n = nentries;
+   Int_t nvalues = Int_t(n) * leaf->GetLenStatic();
+   Int_t bufbegin = basket->GetKeylen() + Int_t(entry - fFirstBasketEntry) * nevbufsize;
+   if (bufbegin + nvalues * lentype > buf->BufferSize()) {
+      Error("GetBulkEntries", "In the branch %s, the basket %d is too short for the entries %lld to %lld",
+            GetName(), fReadBasket, entry, entry + n - 1);
+      return -1;
+   }
+   char *src = buf->Buffer() + bufbegin;
+   switch (lentype) {
+      case 1: memcpy(buffer, src, nvalues); break;
+      case 2: frombuf(src, (UShort_t*)buffer, nvalues); break;
+      case 4: frombuf(src, (UInt_t*)buffer, nvalues); break;
+      case 8: frombuf(src, (ULong64_t*)buffer, nvalues); break;
+   }
+   buf->SetBufferOffset(bufbegin + nvalues * lentype);
+   return Int_t(n);
+}
+
 //______________________________________________________________________________
 const char * TBranch::GetClassName() const 
 {
@@ -1885,6 +2088,23 @@ void TBranch::Refresh(TBranch* b)
       fBasketEntry[i] = b->fBasketEntry[i];
       fBasketSeek[i]  = b->fBasketSeek[i];
    }
+   delete [] fBasketMin;
+   delete [] fBasketMax;
+   fBasketMin = 0;
+   fBasketMax = 0;
+   if (b->fBasketMin) {
+      fBasketMin = new Double_t[fMaxBaskets];
+      fBasketMax = new Double_t[fMaxBaskets];
+      memcpy(fBasketMin, b->fBasketMin, fMaxBaskets*sizeof(Double_t));
+      memcpy(fBasketMax, b->fBasketMax, fMaxBaskets*sizeof(Double_t));
+   }
+   delete [] fCompressDict;
+   fCompressDict     = 0;
+   fCompressDictSize = b->fCompressDictSize;
+   if (fCompressDictSize > 0) {
+      fCompressDict = new char[fCompressDictSize];
+      memcpy(fCompressDict, b->fCompressDict, fCompressDictSize);
+   }
    fBaskets.Delete();
    Int_t nbaskets = b->fBaskets.GetSize();
    fBaskets.Expand(nbaskets);
@@ -1909,6 +2129,11 @@ void TBranch::Reset(Option_t*)
    // Entries, max and min are reset.
    //
 
+   if (fTree && fTree->GetFlushPool()) {
+      // Make sure that none of our baskets is still in the flush pool.
+      fTree->GetFlushPool()->Commit(kTRUE);
+   }
+
    fReadBasket = 0;
    fReadEntry = -1;
    fFirstBasketEntry = -1;
@@ -1938,6 +2163,13 @@ void TBranch::Reset(Option_t*)
       }
    }
 
+   if (fBasketMin) {
+      for (Int_t i = 0; i < fMaxBaskets; ++i) {
+         fBasketMin[i] = -DBL_MAX;
+         fBasketMax[i] =  DBL_MAX;
+      }
+   }
+
    fBaskets.Delete();
    fNBaskets = 0;
 }
@@ -1981,6 +2213,13 @@ void TBranch::ResetAfterMerge(TFileMergeInfo *)
       }
    }
 
+   if (fBasketMin) {
+      for (Int_t i = 0; i < fMaxBaskets; ++i) {
+         fBasketMin[i] = -DBL_MAX;
+         fBasketMax[i] =  DBL_MAX;
+      }
+   }
+
    TBasket *reusebasket = (TBasket*)fBaskets[fWriteBasket];
    if (reusebasket) {
       fBaskets[fWriteBasket] = 0;
@@ -2092,6 +2331,43 @@ void TBranch::SetBasketSize(Int_t buffsize)
    }
 }
 
+//______________________________________________________________________________
+Bool_t TBranch::SetBasketStats(Bool_t stats)
+{
+   // Record (stats=kTRUE) or not the minimum and the maximum of the values
+   // filled in each basket of this branch.
+   //
+   // These ranges are written with the branch and let TTree::Draw and
+   // TTree::CopyTree skip, without reading them, the baskets holding no
+   // entry able to pass a simple cut on this branch, like "pt>100".
+   // The ranges are only recorded for a branch with a single numerical
+   // leaf (possibly an array, the range then covers all its elements).
+   // The baskets filled before this call have an unknown range and are
+   // never skipped.
+   //
+   // Returns kTRUE if the ranges are recorded.
+
+   if (!stats) {
+      delete [] fBasketMin;
+      delete [] fBasketMax;
+      fBasketMin = 0;
+      fBasketMax = 0;
+      return kFALSE;
+   }
+   if (fBasketMin) return kTRUE;
+   if (IsA() != TBranch::Class() || fNleaves != 1) return kFALSE;
+   TLeaf *leaf = (TLeaf*)fLeaves.UncheckedAt(0);
+   if (!leaf || leaf->IsA() == TLeafC::Class()) return kFALSE;
+
+   fBasketMin = new Double_t[fMaxBaskets];
+   fBasketMax = new Double_t[fMaxBaskets];
+   for (Int_t i = 0; i < fMaxBaskets; ++i) {
+      fBasketMin[i] = -DBL_MAX;
+      fBasketMax[i] =  DBL_MAX;
+   }
+   return kTRUE;
+}
+
 //______________________________________________________________________________
 void TBranch::SetBufferAddress(TBuffer* buf)
 {
@@ -2131,6 +2407,46 @@ void TBranch::SetCompressionAlgorithm(Int_t algorithm)
    }
 }
 
+//______________________________________________________________________________
+void TBranch::SetCompressionDictionary(Int_t nbaskets, Int_t maxsize)
+{
+   // Compress the baskets of this branch and of its sub-branches with a
+   // dictionary of at most maxsize bytes trained on the first nbaskets
+   // baskets written.
+   //
+   // Branches with small baskets (few entries per basket, or small entries)
+   // compress poorly because each basket is compressed independently and
+   // too short for the algorithm to learn the patterns repeated from one
+   // basket to the next. The dictionary provides these patterns from the
+   // start of each basket. It is stored with the branch in the tree header
+   // and is used again when reading the baskets back.
+   //
+   // Only the zlib (which uses at most 32KB of dictionary) and Zstandard
+   // algorithms support dictionaries; the other algorithms ignore it.
+   // With Zstandard, the dictionary is trained with ZDICT_trainFromBuffer
+   // when enough samples are available; otherwise (and for zlib) the end
+   // of the sampled baskets is used as the dictionary.
+   //
+   // Once trained the dictionary cannot be changed, since the baskets
+   // already written depend on it. Calling this function with nbaskets <= 0
+   // stops a training which has not completed yet.
+
+   if (!fCompressDict) {
+      fDictTrainBaskets = nbaskets > 0 ? nbaskets : 0;
+      fDictMaxSize      = maxsize > 0 ? maxsize : 32768;
+      if (!fDictTrainBaskets) {
+         fDictSamples.clear();
+         fDictSampleSizes.clear();
+      }
+   }
+
+   Int_t nb = fBranches.GetEntriesFast();
+   for (Int_t i=0;i<nb;i++) {
+      TBranch *branch = (TBranch*)fBranches.UncheckedAt(i);
+      branch->SetCompressionDictionary(nbaskets, maxsize);
+   }
+}
+
 //______________________________________________________________________________
 void TBranch::SetCompressionLevel(Int_t level)
 {
@@ -2154,6 +2470,10 @@ void TBranch::SetCompressionLevel(Int_t level)
 //______________________________________________________________________________
 void TBranch::SetCompressionSettings(Int_t settings)
 {
+   // Set the compression algorithm and level of this branch and of its
+   // sub-branches: settings = 100 * algorithm + level, see
+   // TFile::SetCompressionSettings and TTree::SetCompressionSettings.
+
    fCompress = settings;
 
    Int_t nb = fBranches.GetEntriesFast();
@@ -2539,6 +2859,11 @@ Int_t TBranch::WriteBasket(TBasket* basket, Int_t where)
 {
    // Write the current basket to disk and return the number of bytes
    // written to the file.
+   //
+   // If the tree has a flush pool (see TTree::SetParallelFlush), the basket
+   // is instead handed over to the pool, which compresses it in a separate
+   // thread and writes it later on (see WriteCompressedBasket). In this case
+   // the function returns 0 and a fresh basket will be used for the next entries.
 
    Int_t nevbuf = basket->GetNevBuf();
    if (fEntryOffsetLen > 10 &&  (4*nevbuf) < fEntryOffsetLen ) {
@@ -2549,6 +2874,37 @@ Int_t TBranch::WriteBasket(TBasket* basket, Int_t where)
       fEntryOffsetLen = 2*nevbuf; // assume some fluctuations.
    }
 
+   if (fDictTrainBaskets > 0 && !fCompressDict && fCompress % 100 > 0) {
+      // Keep the content of the first baskets to train the compression dictionary.
+      Int_t keylen = basket->GetKeylen();
+      Int_t len    = basket->GetBufferRef()->Length() - keylen;
+      if (len > 0) {
+         const char *data = basket->GetBufferRef()->Buffer() + keylen;
+         fDictSamples.insert(fDictSamples.end(), data, data + len);
+         fDictSampleSizes.push_back(len);
+         if (--fDictTrainBaskets == 0) TrainCompressionDictionary();
+      }
+   }
+
+   TTreeFlushPool *pool = fTree->GetFlushPool();
+   if (pool && where == fWriteBasket && pool->Submit(basket, where) == 0) {
+      // The pool now owns the basket.
+      fBaskets[where] = 0;
+      --fNBaskets;
+      if (basket == fCurrentBasket) {
+         fCurrentBasket    = 0;
+         fFirstBasketEntry = -1;
+         fNextBasketEntry  = -1;
+      }
+      ++fWriteBasket;
+      if (fWriteBasket >= fMaxBaskets) {
+         ExpandBasketArrays();
+      }
+      fBaskets.AddAtAndExpand(0,fWriteBasket);
+      fBasketEntry[fWriteBasket] = fEntryNumber;
+      return 0;
+   }
+
    Int_t nout  = basket->WriteBuffer();    //  Write buffer
    fBasketBytes[where]  = basket->GetNbytes();
    fBasketSeek[where]   = basket->GetSeekKey();
@@ -2588,6 +2944,42 @@ Int_t TBranch::WriteBasket(TBasket* basket, Int_t where)
    return nout;
 }
 
+//______________________________________________________________________________
+Int_t TBranch::WriteCompressedBasket(TBasket* basket, Int_t where, Int_t nout)
+{
+   // Write the basket number 'where', compressed by a thread of the tree's
+   // flush pool (nout is the value returned by TBasket::CompressBuffer),
+   // and update the list of baskets on file.
+   //
+   // Called by TTreeFlushPool::Commit in the thread filling the tree.
+   // Returns the number of bytes written or -1 in case of write error.
+   //
+   // Like the baskets written by WriteBasket, the basket is then reused
+   // (by Fill) for the next entries, unless a basket is already waiting to
+   // be reused, in which case it is deleted.
+
+   if (nout >= 0) {
+      nout = basket->WriteCompressedBuffer(nout);
+   }
+   fBasketBytes[where]  = basket->GetNbytes();
+   fBasketSeek[where]   = basket->GetSeekKey();
+   Int_t addbytes = basket->GetObjlen() + basket->GetKeylen();
+   fZipBytes += nout;
+   fTotBytes += addbytes;
+   fTree->AddTotBytes(addbytes);
+   fTree->AddZipBytes(nout);
+
+   if (nout > 0 && !fExtraBasket) {
+      basket->Reset();
+      fExtraBasket = basket;
+   } else {
+      basket->DropBuffers();
+      delete basket;
+   }
+
+   return nout;
+}
+
 //------------------------------------------------------------------------------
 void TBranch::SetFirstEntry(Long64_t entry)
 {
@@ -2610,6 +3002,65 @@ void TBranch::SetupAddresses()
    // Nothing to do for regular branch, the TLeaf already did it.
 }
 
+//______________________________________________________________________________
+void TBranch::TrainCompressionDictionary()
+{
+   // Build the compression dictionary from the baskets sampled by WriteBasket
+   // (see SetCompressionDictionary) and release the samples.
+
+   Int_t algorithm = fCompress / 100;
+   if (algorithm >= ROOT::kUndefinedCompressionAlgorithm) algorithm = 0;
+
+   Int_t nsamples = (Int_t)fDictSampleSizes.size();
+   char *dict = new char[fDictMaxSize];
+   Int_t dictsize = 0;
+   if (nsamples > 0) {
+      dictsize = R__zip_traindict(algorithm, nsamples, &fDictSampleSizes[0], &fDictSamples[0],
+                                  fDictMaxSize, dict);
+   }
+   std::vector<char>().swap(fDictSamples);
+   std::vector<Int_t>().swap(fDictSampleSizes);
+   fDictTrainBaskets = 0;
+
+   if (dictsize <= 0) {
+      if (gDebug > 0) Info("TrainCompressionDictionary", "No dictionary for branch %s (algorithm %d)", GetName(), algorithm);
+      delete [] dict;
+      return;
+   }
+
+   // The baskets handed over to the flush pool must be compressed without
+   // the dictionary: wait for them before making it visible.
+   TTreeFlushPool *pool = fTree ? fTree->GetFlushPool() : 0;
+   if (pool) pool->Commit(kTRUE);
+
+   fCompressDictSize = dictsize;
+   fCompressDict     = dict;
+   if (gDebug > 0) Info("TrainCompressionDictionary", "Dictionary of %d bytes for branch %s trained on %d baskets", dictsize, GetName(), nsamples);
+}
+
+//______________________________________________________________________________
+void TBranch::UpdateBasketStats(Bool_t first)
+{
+   // Include the values just filled in the range of the write basket,
+   // which is restarted if they are the first ones of the basket.
+
+   if (first) {
+      fBasketMin[fWriteBasket] =  DBL_MAX;
+      fBasketMax[fWriteBasket] = -DBL_MAX;
+   }
+   TLeaf *leaf = (TLeaf*)fLeaves.UncheckedAt(0);
+   Double_t vmin = fBasketMin[fWriteBasket];
+   Double_t vmax = fBasketMax[fWriteBasket];
+   Int_t len = leaf->GetLen();
+   for (Int_t i = 0; i < len; ++i) {
+      Double_t v = leaf->GetValue(i);
+      if (v < vmin) vmin = v;
+      if (v > vmax) vmax = v;
+   }
+   fBasketMin[fWriteBasket] = vmin;
+   fBasketMax[fWriteBasket] = vmax;
+}
+
 //______________________________________________________________________________
 void TBranch::UpdateFile()
 {
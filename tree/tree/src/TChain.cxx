@@ -31,8 +31,10 @@
 #include "TBranch.h"
 #include "TBrowser.h"
 #include "TChainElement.h"
+#include "TChainOpenAhead.h"
 #include "TClass.h"
 #include "TCut.h"
+#include "TEnv.h"
 #include "TError.h"
 #include "TMath.h"
 #include "TFile.h"
@@ -73,6 +75,8 @@ TChain::TChain()
 , fFiles(0)
 , fStatus(0)
 , fProofChain(0)
+, fOpenAheadDepth(gEnv->GetValue("TChain.OpenAheadDepth", 0))
+, fOpenAhead(0)
 {
    // -- Default constructor.
 
@@ -109,6 +113,8 @@ TChain::TChain(const char* name, const char* title)
 , fFiles(0)
 , fStatus(0)
 , fProofChain(0)
+, fOpenAheadDepth(gEnv->GetValue("TChain.OpenAheadDepth", 0))
+, fOpenAhead(0)
 {
    // -- Create a chain.
    //
@@ -173,6 +179,7 @@ TChain::~TChain()
    // -- Destructor.
    gROOT->GetListOfCleanups()->Remove(this);
    
+   SafeDelete(fOpenAhead);
    SafeDelete(fProofChain);
    fStatus->Delete();
    delete fStatus;
@@ -1471,7 +1478,9 @@ Long64_t TChain::LoadTree(Long64_t entry)
    //        if we did not delete it above.
    {
       TDirectory::TContext ctxt(0);
-      fFile = TFile::Open(element->GetTitle());
+      // Take the file if it has been opened in advance (see SetOpenAheadDepth).
+      fFile = fOpenAhead ? fOpenAhead->Take(treenum) : 0;
+      if (!fFile) fFile = TFile::Open(element->GetTitle());
       if (fFile) fFile->SetBit(kMustCleanup);
    }
 
@@ -1519,9 +1528,16 @@ Long64_t TChain::LoadTree(Long64_t entry)
          tpf = 0;
       }
    } else {
+      if (fTree && !fCacheProfile.IsNull()) fTree->SetCacheProfile(fCacheProfile);
       this->SetCacheSize(fCacheSize);
    }
 
+   // Queue the next files to be opened while this one is processed.
+   if (fOpenAheadDepth > 0) {
+      if (!fOpenAhead) fOpenAhead = new TChainOpenAhead(this);
+      fOpenAhead->Queue(treenum, fOpenAheadDepth);
+   }
+
    // Check if fTreeOffset has really been set.
    Long64_t nentries = 0;
    if (fTree) {
@@ -2133,6 +2149,7 @@ void TChain::Reset(Option_t*)
 {
    // Resets the state of this chain.
 
+   SafeDelete(fOpenAhead);
    delete fFile;
    fFile = 0;
    fNtrees         = 0;
@@ -2155,6 +2172,7 @@ void TChain::ResetAfterMerge(TFileMergeInfo *info)
    // Resets the state of this chain after a merge (keep the customization but
    // forget the data).
    
+   SafeDelete(fOpenAhead);
    fNtrees         = 0;
    fTreeNumber     = -1;
    fTree           = 0;
@@ -2196,6 +2214,19 @@ void TChain::SetAutoDelete(Bool_t autodelete)
    }
 }
 
+//______________________________________________________________________________
+Int_t TChain::SetCacheProfile(const char *filename)
+{
+   // Set the cache profile of the underlying TTree. It is kept for the
+   // trees of the next files (see TTree::SetCacheProfile).
+
+   fCacheProfile = filename ? filename : "";
+   if (fTree) {
+      return fTree->SetCacheProfile(filename);
+   }
+   return 0;
+}
+
 void TChain::SetCacheSize(Long64_t cacheSize)
 {
    // Set the cache size of the underlying TTree,
@@ -2608,6 +2639,28 @@ void TChain::SetEventList(TEventList *evlist)
    SetEntryList(enlist);
 }
 
+//______________________________________________________________________________
+void TChain::SetOpenAheadDepth(Int_t depth)
+{
+   // Set the number of files opened in advance.
+   //
+   // When a file of the chain is loaded, the depth following files are
+   // opened by a separate thread while the current one is processed: the
+   // connection and the reading of the file header, keys and streamer
+   // infos do not stall the processing anymore (see TChainOpenAhead).
+   // The tree itself is still read by LoadTree. This mostly helps with
+   // chains of many small remote files.
+   //
+   // With depth <= 0 (the default) the files are opened one at a time.
+   // The default can be changed with the rootrc resource
+   //    TChain.OpenAheadDepth:  0
+
+   fOpenAheadDepth = depth > 0 ? depth : 0;
+   if (!fOpenAheadDepth) {
+      SafeDelete(fOpenAhead);
+   }
+}
+
 //_______________________________________________________________________
 void TChain::SetPacketSize(Int_t size)
 {
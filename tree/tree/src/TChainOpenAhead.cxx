@@ -0,0 +1,275 @@
+// @(#)root/tree:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2012, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TChainOpenAhead                                                      //
+//                                                                      //
+// Thread opening the next files of a TChain in advance.                //
+//                                                                      //
+// Without it, TChain::LoadTree opens a file only when the entries of   //
+// the previous one are exhausted: the connection, the reading of the   //
+// header, of the keys and of the streamer infos are paid one file      //
+// after the other. With chains of many small remote files these        //
+// latencies dominate the processing time.                              //
+//                                                                      //
+// When the chain has an open-ahead depth n (see                        //
+// TChain::SetOpenAheadDepth), each time it loads a file it queues the  //
+// n following files to this thread, which opens them. When the chain   //
+// gets to one of these files, LoadTree takes it (Take) instead of      //
+// opening it, waiting if it is still being opened. The files not       //
+// needed anymore (after a jump in the entries) are closed.             //
+//                                                                      //
+// The thread only opens the files (TFile::Open reads the keys and the  //
+// streamer infos): the trees and their baskets are streamed through    //
+// globals (gTree, gROOT->SetReadingObject) shared with the main        //
+// thread, hence they are read by TChain::LoadTree as usual.            //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#include "TChainOpenAhead.h"
+#include "TChain.h"
+#include "TChainElement.h"
+#include "TFile.h"
+#include "TObjArray.h"
+#include "TVirtualMutex.h"
+#include "TThread.h"
+#include "TCondition.h"
+#include "TMutex.h"
+
+ClassImp(TChainOpenAhead)
+
+//______________________________________________________________________________
+TChainOpenAhead::TChainOpenAhead(TChain *chain) :
+   fChain(chain),
+   fThread(0),
+   fActive(kTRUE),
+   fMutex(0),
+   fStartCondition(0),
+   fDoneCondition(0),
+   fNOpened(0),
+   fNWaits(0),
+   fNMissed(0)
+{
+   // Create the thread opening the files of chain in advance.
+
+   fMutex          = new TMutex(kTRUE);
+   fStartCondition = new TCondition(fMutex);
+   fDoneCondition  = new TCondition(fMutex);
+
+   fThread = new TThread("ChainOpenAhead", OpenLoop, (void*)this);
+   if (fThread->Run()) {
+      Error("TChainOpenAhead", "Unable to start the thread, the files will not be opened in advance");
+      delete fThread;
+      fThread = 0;
+   }
+}
+
+//______________________________________________________________________________
+TChainOpenAhead::~TChainOpenAhead()
+{
+   // Destructor. Stop the thread and close the files opened in advance
+   // which were not taken by the chain.
+
+   {
+      R__LOCKGUARD(fMutex);
+      fActive = kFALSE;
+      fStartCondition->Broadcast();
+   }
+   if (fThread) {
+      if (fThread->Exists()) {
+         fThread->Join();
+      }
+      delete fThread;
+      fThread = 0;
+   }
+
+   while (!fTasks.empty()) {
+      TOpenTask *task = fTasks.front();
+      fTasks.pop_front();
+      delete task->fFile;
+      delete task;
+   }
+
+   delete fStartCondition;
+   delete fDoneCondition;
+   delete fMutex;
+}
+
+//______________________________________________________________________________
+void TChainOpenAhead::Discard(TOpenTask *task)
+{
+   // Forget about the file of task, which must have been removed from the
+   // queue. If the file is being opened, the thread closes it once open.
+   // Must be called with fMutex locked.
+
+   if (task->fStatus == kOpening) {
+      task->fDiscard = kTRUE;
+      return;
+   }
+   delete task->fFile;
+   delete task;
+}
+
+//______________________________________________________________________________
+TChainOpenAhead::TOpenTask *TChainOpenAhead::NextTask()
+{
+   // Wait for a file to open. Returns 0 when the thread must stop.
+
+   R__LOCKGUARD(fMutex);
+   while (fActive) {
+      for (UInt_t i = 0; i < fTasks.size(); ++i) {
+         if (fTasks[i]->fStatus == kQueued) {
+            fTasks[i]->fStatus = kOpening;
+            return fTasks[i];
+         }
+      }
+      fStartCondition->Wait();
+   }
+   return 0;
+}
+
+//______________________________________________________________________________
+void TChainOpenAhead::Open(TOpenTask *task)
+{
+   // Open the file of task. Nothing is read from the file but its header,
+   // keys and streamer infos: the tree is read by the chain.
+
+   TFile *file = 0;
+   {
+      TDirectory::TContext ctxt(0);
+      file = TFile::Open(task->fUrl);
+   }
+   if (file && file->IsZombie()) {
+      delete file;
+      file = 0;
+   }
+   if (file) {
+      file->SetBit(kMustCleanup);
+   }
+
+   Bool_t discard;
+   {
+      R__LOCKGUARD(fMutex);
+      discard = task->fDiscard;
+      if (!discard) {
+         task->fFile   = file;
+         task->fStatus = kOpened;
+         fDoneCondition->Broadcast();
+      }
+   }
+   if (discard) {
+      delete file;
+      delete task;
+   }
+}
+
+//______________________________________________________________________________
+void *TChainOpenAhead::OpenLoop(void *arg)
+{
+   // This is a static function.
+   // Main loop of the thread: open the queued files until the object is
+   // deleted.
+
+   TChainOpenAhead *openahead = (TChainOpenAhead*)arg;
+
+   TThread::SetCancelOn();
+   TThread::SetCancelDeferred();
+
+   TOpenTask *task;
+   while ((task = openahead->NextTask())) {
+      openahead->Open(task);
+   }
+   return (void *)0;
+}
+
+//______________________________________________________________________________
+void TChainOpenAhead::Print(Option_t *) const
+{
+   // Print the statistics of the files opened in advance.
+
+   printf("******TChainOpenAhead statistics for chain: %s ******\n", fChain ? fChain->GetName() : "");
+   printf("Number of files opened in advance: %d\n", fNOpened);
+   printf("Number of waits for a file being opened: %d\n", fNWaits);
+   printf("Number of files opened by the chain: %d\n", fNMissed);
+   printf("Number of files queued: %d\n", (Int_t)fTasks.size());
+}
+
+//______________________________________________________________________________
+void TChainOpenAhead::Queue(Int_t treenum, Int_t depth)
+{
+   // Queue the depth files following the tree number treenum of the chain,
+   // and close the other files opened in advance.
+
+   if (!fThread) return;
+
+   TObjArray *files = fChain->GetListOfFiles();
+   Int_t last = treenum + depth;
+   if (last >= fChain->GetNtrees()) last = fChain->GetNtrees() - 1;
+
+   R__LOCKGUARD(fMutex);
+   // Forget the files out of the new window.
+   for (std::deque<TOpenTask*>::iterator it = fTasks.begin(); it != fTasks.end(); ) {
+      TOpenTask *task = *it;
+      if (task->fTreeNumber <= treenum || task->fTreeNumber > last) {
+         it = fTasks.erase(it);
+         Discard(task);
+      } else {
+         ++it;
+      }
+   }
+   Int_t next = fTasks.empty() ? treenum + 1 : fTasks.back()->fTreeNumber + 1;
+   for (Int_t t = next; t <= last; ++t) {
+      TChainElement *element = (TChainElement*) files->At(t);
+      if (!element) break;
+      TOpenTask *task = new TOpenTask;
+      task->fTreeNumber = t;
+      task->fUrl        = element->GetTitle();
+      task->fFile       = 0;
+      task->fStatus     = kQueued;
+      task->fDiscard    = kFALSE;
+      fTasks.push_back(task);
+   }
+   fStartCondition->Signal();
+}
+
+//______________________________________________________________________________
+TFile *TChainOpenAhead::Take(Int_t treenum)
+{
+   // Return the file of the tree number treenum of the chain if it has
+   // been opened in advance, waiting for it if it is being opened. The
+   // caller owns the file. Returns 0 if the file was not queued, was not
+   // opened yet or could not be opened: the caller must then open it.
+
+   R__LOCKGUARD(fMutex);
+   for (std::deque<TOpenTask*>::iterator it = fTasks.begin(); it != fTasks.end(); ++it) {
+      TOpenTask *task = *it;
+      if (task->fTreeNumber != treenum) continue;
+      if (task->fStatus == kOpening) {
+         ++fNWaits;
+         while (task->fStatus == kOpening) {
+            fDoneCondition->Wait();
+         }
+      }
+      // The queue may have been modified while waiting.
+      for (it = fTasks.begin(); *it != task; ++it) { }
+      fTasks.erase(it);
+      TFile *file = task->fFile;
+      delete task;
+      if (file) {
+         ++fNOpened;
+      } else {
+         ++fNMissed;
+      }
+      return file;
+   }
+   ++fNMissed;
+   return 0;
+}
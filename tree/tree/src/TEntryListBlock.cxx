@@ -49,8 +49,21 @@ End_Html */
 #include "TEntryListBlock.h"
 #include "TString.h"
 
+#include <string.h>
+
 ClassImp(TEntryListBlock)
 
+//______________________________________________________________________________
+static inline Int_t R__CountBits(UInt_t w)
+{
+   // Return the number of bits set in the 16 bits word w.
+
+   w = w - ((w >> 1) & 0x5555);
+   w = (w & 0x3333) + ((w >> 2) & 0x3333);
+   w = (w + (w >> 4)) & 0x0F0F;
+   return (w + (w >> 8)) & 0x1F;
+}
+
 //______________________________________________________________________________
 TEntryListBlock::TEntryListBlock()
 {
@@ -243,11 +256,15 @@ Int_t TEntryListBlock::Merge(TEntryListBlock *block)
 {
    //Merge with the other block
    //Returns the resulting number of entries in the block
+   //Two lists of passing entries are merged as sorted lists, otherwise the
+   //blocks are merged 16 entries at a time as bits.
 
-   Int_t i, j;
+   Int_t i;
    if (block->GetNPassed() == 0) return GetNPassed();
    if (GetNPassed() == 0){
       //this block is empty
+      if (fIndices)
+         delete [] fIndices;
       fN = block->fN;
       fIndices = new UShort_t[fN];
       for (i=0; i<fN; i++)
@@ -255,116 +272,139 @@ Int_t TEntryListBlock::Merge(TEntryListBlock *block)
       fNPassed = block->fNPassed;
       fType = block->fType;
       fPassing = block->fPassing;
-      fCurrent = block->fCurrent;
+      fCurrent = 0;
       fLastIndexReturned = -1;
       fLastIndexQueried = -1;
       return fNPassed;
    }
-   if (fType==0){
-      //stored as bits
-      if (block->fType == 0){
-         for (i=0; i<kBlockSize*16; i++){
-            if (block->Contains(i))
-               Enter(i);
-         }
-      } else {
-         if (block->fPassing){
-            //the other block stores entries that pass
-            for (i=0; i<block->fNPassed; i++){
-               Enter(block->fIndices[i]);
-            }
-         } else {
-            //the other block stores entries that don't pass
-            if (block->fNPassed==0){
-               for (i=0; i<kBlockSize*16; i++){
-                  Enter(i);
-               }
-            }
-            for (j=0; j<block->fIndices[0]; j++)
-               Enter(j);
-            for (i=0; i<block->fNPassed-1; i++){
-               for (j=block->fIndices[i]+1; j<block->fIndices[i+1]; j++){
-                  Enter(j);
-               }
-            }
-            for (j=block->fIndices[block->fNPassed-1]+1; j<kBlockSize*16; j++)
-               Enter(j);
+   if (fType==1 && fPassing && block->fType==1 && block->fPassing &&
+       fNPassed + block->fNPassed <= kBlockSize){
+      //both blocks are stored as lists of passing entries
+      //make a bigger list
+      Int_t en = block->fNPassed;
+      Int_t newsize = fNPassed + en;
+      UShort_t *newlist = new UShort_t[newsize];
+      UShort_t *elst = block->fIndices;
+      Int_t newpos, elpos;
+      newpos = elpos = 0;
+      for (i=0; i<fNPassed; i++) {
+         while (elpos < en && fIndices[i] > elst[elpos]) {
+            newlist[newpos] = elst[elpos];
+            newpos++;
+            elpos++;
          }
+         if (elpos < en && fIndices[i] == elst[elpos]) elpos++;
+         newlist[newpos] = fIndices[i];
+         newpos++;
+      }
+      while (elpos < en) {
+         newlist[newpos] = elst[elpos];
+         newpos++;
+         elpos++;
       }
+      delete [] fIndices;
+      fIndices = newlist;
+      fNPassed = newpos;
+      fN = fNPassed;
    } else {
-      //stored as a list
-      if (GetNPassed() + block->GetNPassed() > kBlockSize){
-         //change to bits
+      //change to bits and merge the words
+      if (fType!=0){
          UShort_t *bits = new UShort_t[kBlockSize];
          Transform(1, bits);
-         Merge(block);
-      } else {
-         //this is only possible if fPassing=1 in both blocks
-         if (block->fType==1){
-            //second block stored as a list
-            //make a bigger list
-            Int_t en = block->fNPassed;
-            Int_t newsize = fNPassed + en;
-            UShort_t *newlist = new UShort_t[newsize];
-            UShort_t *elst = block->fIndices;
-            Int_t newpos, elpos;
-            newpos = elpos = 0;
-            for (i=0; i<fNPassed; i++) {
-               while (elpos < en && fIndices[i] > elst[elpos]) {
-                  newlist[newpos] = elst[elpos];
-                  newpos++;
-                  elpos++;
-               }
-               if (fIndices[i] == elst[elpos]) elpos++;
-               newlist[newpos] = fIndices[i];
-               newpos++;
-            }
-            while (elpos < en) {
-               newlist[newpos] = elst[elpos];
-               newpos++;
-               elpos++;
-            }
-            delete [] fIndices;
-            fIndices = newlist;
-            fNPassed = newpos;
-            fN = fNPassed;
-         } else {
-            //second block is stored as bits
-
-            Int_t en = block->fNPassed;
-            Int_t newsize = fNPassed + en;
-            UShort_t *newlist = new UShort_t[newsize];
-            Int_t newpos, current;
-            newpos = current = 0;
-            for (i=0; i<kBlockSize*16; i++){
-               if (!block->Contains(i)) continue;
-               while(current < fNPassed && fIndices[current]<i){
-                  newlist[newpos] = fIndices[current];
-                  current++;
-                  newpos++;
-               }
-               if (fIndices[current]==i) current++;
-               newlist[newpos] = i;
-               newpos++;
-            }
-            while(current<fNPassed){
-               newlist[newpos] = fIndices[current];
-               newpos++;
-               current++;
-            }
-            delete [] fIndices;
-            fIndices = newlist;
-            fNPassed = newpos;
-            fN = fNPassed;
+      }
+      UShort_t other[kBlockSize];
+      const UShort_t *obits = other;
+      if (block->fType==0)
+         obits = block->fIndices;
+      else
+         block->GetBits(other);
+      Int_t npassed = 0;
+      for (i=0; i<kBlockSize; i++){
+         fIndices[i] |= obits[i];
+         npassed += R__CountBits(fIndices[i]);
+      }
+      fNPassed = npassed;
+   }
+   fCurrent = 0;
+   fLastIndexQueried = -1;
+   fLastIndexReturned = -1;
+   OptimizeStorage();
+   return GetNPassed();
+}
+
+//______________________________________________________________________________
+Int_t TEntryListBlock::Subtract(TEntryListBlock *block)
+{
+   //Remove from this block the entries contained in the other block
+   //Returns the resulting number of entries in the block
+
+   Int_t i;
+   if (GetNPassed() == 0 || block->GetNPassed() == 0) return GetNPassed();
+   UShort_t other[kBlockSize];
+   const UShort_t *obits = other;
+   if (block->fType==0)
+      obits = block->fIndices;
+   else
+      block->GetBits(other);
+   if (fType==1 && fPassing){
+      //stored as a list of passing entries, keep those not in the other block
+      Int_t npassed = 0;
+      for (i=0; i<fNPassed; i++){
+         UShort_t entry = fIndices[i];
+         if ((obits[entry>>4] & (1<<(entry & 15)))==0){
+            fIndices[npassed] = entry;
+            npassed++;
          }
       }
+      fNPassed = npassed;
+      fN = fNPassed;
+   } else {
+      //change to bits and subtract the words
+      if (fType!=0){
+         UShort_t *bits = new UShort_t[kBlockSize];
+         Transform(1, bits);
+      }
+      Int_t npassed = 0;
+      for (i=0; i<kBlockSize; i++){
+         fIndices[i] &= (UShort_t)~obits[i];
+         npassed += R__CountBits(fIndices[i]);
+      }
+      fNPassed = npassed;
    }
+   fCurrent = 0;
    fLastIndexQueried = -1;
    fLastIndexReturned = -1;
    OptimizeStorage();
    return GetNPassed();
 }
 
+//______________________________________________________________________________
+void TEntryListBlock::GetBits(UShort_t *bits) const
+{
+   //Fill bits (kBlockSize words) with the bits representation of the block,
+   //whatever the representation actually used
+
+   Int_t i;
+   if (fType==0 && fIndices){
+      memcpy(bits, fIndices, kBlockSize*sizeof(UShort_t));
+      return;
+   }
+   if (fType!=1){
+      //empty block
+      memset(bits, 0, kBlockSize*sizeof(UShort_t));
+      return;
+   }
+   if (fPassing){
+      memset(bits, 0, kBlockSize*sizeof(UShort_t));
+      for (i=0; i<fNPassed; i++)
+         bits[fIndices[i]>>4] |= 1<<(fIndices[i] & 15);
+   } else {
+      memset(bits, 0xFF, kBlockSize*sizeof(UShort_t));
+      for (i=0; i<fNPassed; i++)
+         bits[fIndices[i]>>4] &= (0xFFFF^(1<<(fIndices[i] & 15)));
+   }
+}
+
 //______________________________________________________________________________
 Int_t TEntryListBlock::GetNPassed()
 {
@@ -384,18 +424,21 @@ Int_t TEntryListBlock::GetEntry(Int_t entry)
 //See also Next()
 
    if (entry > kBlockSize*16) return -1;
-   if (entry > GetNPassed()) return -1;
+   if (entry >= GetNPassed()) return -1;
    if (entry == fLastIndexQueried+1) return Next();
    else {
       Int_t i=0; Int_t j=0; Int_t entries_found=0;
       if (fType==0){
-         if ((fIndices[i] & (1<<j))!=0)
+         //skip the words before the one holding the entry
+         Int_t nbits;
+         while (entries_found + (nbits = R__CountBits(fIndices[i])) <= entry){
+            entries_found += nbits;
+            i++;
+         }
+         for (j=0; j<16; j++){
+            if ((fIndices[i] & (1<<j))==0) continue;
+            if (entries_found==entry) break;
             entries_found++;
-         while (entries_found<entry+1){
-            if (j==15){i++; j=0;}
-            else j++;
-            if ((fIndices[i] & (1<<j))!=0)
-               entries_found++;
          }
          fLastIndexQueried = entry;
          fLastIndexReturned = i*16+j;
@@ -455,19 +498,20 @@ Int_t TEntryListBlock::Next()
    }
 
    if (fType==0) {
-      //bits
-      Int_t i=0;
-      Int_t j=0;
-      fLastIndexReturned++;
-      i = fLastIndexReturned>>4;
-      j = fLastIndexReturned & 15;
-      Bool_t result=(fIndices[i] & (1<<j))!=0;
-      while (result==0){
-         if (j==15) {j=0; i++;}
-         else j++;
-         result = (fIndices[i] & (1<<j))!=0;
+      //bits, skip the empty words
+      Int_t pos = fLastIndexReturned+1;
+      Int_t i = pos>>4;
+      UInt_t word = fIndices[i] >> (pos & 15);
+      if (!word){
+         do { i++; } while (fIndices[i]==0);
+         word = fIndices[i];
+         pos = i*16;
+      }
+      while ((word & 1)==0){
+         word >>= 1;
+         pos++;
       }
-      fLastIndexReturned = i*16+j;
+      fLastIndexReturned = pos;
       fLastIndexQueried++;
       return fLastIndexReturned;
 
@@ -570,19 +614,16 @@ void TEntryListBlock::Transform(Bool_t dir, UShort_t *indexnew)
    Int_t ilist = 0;
    Int_t ibite, ibit;
    if (!dir) {
-         for (i=0; i<kBlockSize*16; i++){
-            ibite = i >> 4;
-            ibit = i & 15;
-            Bool_t result = (fIndices[ibite] & (1<<ibit))!=0;
-            if (result && fPassing){
-               //fill with the entries that pass
-               indexnew[ilist] = i;
-               ilist++;
-            }
-            else if (!result && !fPassing){
-               //fill with the entries that don't pass
-               indexnew[ilist] = i;
-               ilist++;
+         //fill with the entries that pass (or that don't pass if !fPassing),
+         //skipping the words without such entries
+         for (ibite=0; ibite<kBlockSize; ibite++){
+            UInt_t word = fPassing ? fIndices[ibite] : (~fIndices[ibite] & 0xFFFF);
+            if (!word) continue;
+            for (ibit=0; ibit<16; ibit++){
+               if (word & (1<<ibit)){
+                  indexnew[ilist] = (ibite<<4) + ibit;
+                  ilist++;
+               }
             }
          }
       if (fIndices)
@@ -357,6 +357,7 @@
 #include "TTreeCloner.h"
 #include "TTreeCache.h"
 #include "TTreeCacheUnzip.h"
+#include "TTreeFlushPool.h"
 #include "TVirtualCollectionProxy.h"
 #include "TEmulatedCollectionProxy.h"
 #include "TVirtualFitter.h"
@@ -655,6 +656,8 @@ TTree::TTree()
 , fBranchRef(0)
 , fFriendLockStatus(0)
 , fTransientBuffer(0)
+, fFlushPool(0)
+, fNProcessThreads(0)
 {
    // Default constructor and I/O constructor.
    //
@@ -724,6 +727,8 @@ TTree::TTree(const char* name, const char* title, Int_t splitlevel /* = 99 */)
 , fBranchRef(0)
 , fFriendLockStatus(0)
 , fTransientBuffer(0)
+, fFlushPool(0)
+, fNProcessThreads(0)
 {
    // Normal tree constructor.
    //
@@ -781,6 +786,12 @@ TTree::~TTree()
 {
    // Destructor.
 
+   if (fFlushPool) {
+      // Write the baskets still being compressed before the branches go away.
+      fFlushPool->Commit(kTRUE);
+      delete fFlushPool;
+      fFlushPool = 0;
+   }
    if (fDirectory) {
       // We are in a directory, which may possibly be a file.
       if (fDirectory->GetList()) {
@@ -4148,6 +4159,11 @@ Int_t TTree::Fill()
    if (fBranchRef) {
       fBranchRef->Fill();
    }
+   if (fFlushPool && fFlushPool->Commit(kFALSE) < 0) {
+      // Write the baskets already compressed by the flush pool.
+      Error("Fill", "Failed writing the baskets compressed in parallel, entry=%lld", fEntries+1);
+      ++nerror;
+   }
    ++fEntries;
    if (fEntries > fMaxEntries) {
       KeepCircular();
@@ -4546,6 +4562,16 @@ Int_t TTree::FlushBaskets() const
          }
       }
    }
+   if (fFlushPool) {
+      // The baskets might have been handed over to the flush pool,
+      // wait for all of them to be written.
+      Int_t nwrite = fFlushPool->Commit(kTRUE);
+      if (nwrite<0) {
+         ++nerror;
+      } else {
+         nbytes += nwrite;
+      }
+   }
    if (nerror) {
       return -1;
    } else {
@@ -6337,6 +6363,8 @@ Long64_t TTree::Process(TSelector* selector, Option_t* option, Long64_t nentries
    //  If the Tree (Chain) has an associated EventList, the loop is on the nentries
    //  of the EventList, starting at firstentry, otherwise the loop is on the
    //  specified Tree entries.
+   //
+   //  See SetParallelProcess to process the entries with several threads.
 
    GetPlayer();
    if (fPlayer) {
@@ -6810,6 +6838,10 @@ void TTree::Reset(Option_t* option)
 {
    // Reset baskets, buffers and entries count in all branches and leaves.
 
+   if (fFlushPool) {
+      fFlushPool->Commit(kTRUE);
+   }
+
    fNotify        = 0;
    fEntries       = 0;
    fNClusterRange = 0;
@@ -6840,6 +6872,10 @@ void TTree::ResetAfterMerge(TFileMergeInfo *info)
    // Resets the state of this TTree after a merge (keep the customization but
    // forget the data).
 
+   if (fFlushPool) {
+      fFlushPool->Commit(kTRUE);
+   }
+
    fEntries       = 0;
    fNClusterRange = 0;
    fTotBytes      = 0;
@@ -6889,6 +6925,24 @@ void TTree::ResetBranchAddresses()
    }
 }
 
+//______________________________________________________________________________
+Int_t TTree::SaveCacheProfile(const char *filename) const
+{
+   // Save in filename the list of branches in the TreeCache of this tree,
+   // in the order in which they were first used. The file can be given to
+   // SetCacheProfile by the next jobs to skip the learning phase of the cache.
+   // Returns the number of branches saved, or -1 in case of error.
+   // See TTreeCache::SaveProfile.
+
+   TFile *f = GetCurrentFile();
+   TTreeCache *tc = f ? (TTreeCache*)f->GetCacheRead(const_cast<TTree*>(this)) : 0;
+   if (!tc) {
+      Error("SaveCacheProfile","The tree %s has no cache",GetName());
+      return -1;
+   }
+   return tc->SaveProfile(filename);
+}
+
 //______________________________________________________________________________
 Long64_t TTree::Scan(const char* varexp, const char* selection, Option_t* option, Long64_t nentries, Long64_t firstentry)
 {
@@ -7110,6 +7164,45 @@ void TTree::SetBasketSize(const char* bname, Int_t buffsize)
    }
 }
 
+//______________________________________________________________________________
+void TTree::SetBasketStats(const char* bname, Bool_t stats)
+{
+   // Record (stats=kTRUE) or not the minimum and the maximum of the values
+   // filled in each basket of the branches matching bname.
+   //
+   // bname is the name of a branch.
+   // if bname="*", apply to all branches.
+   // if bname="xxx*", apply to all branches with name starting with xxx
+   // see TRegexp for wildcarding options
+   //
+   // The ranges are only recorded for the branches with a single numerical
+   // leaf (see TBranch::SetBasketStats). They let TTree::Draw and
+   // TTree::CopyTree skip the baskets unable to pass the simple cuts of
+   // the selection on these branches. For example:
+   //    T.SetBasketStats("pt");
+   //    ... fill and write the tree ...
+   //    T.Draw("eta","pt>100 && abs(eta)<2.5");
+   // does not read the baskets of eta and pt for the entries in the baskets
+   // of pt whose maximum is below 100.
+
+   Int_t nleaves = fLeaves.GetEntriesFast();
+   TRegexp re(bname, kTRUE);
+   Int_t nb = 0;
+   for (Int_t i = 0; i < nleaves; i++)  {
+      TLeaf* leaf = (TLeaf*) fLeaves.UncheckedAt(i);
+      TBranch* branch = (TBranch*) leaf->GetBranch();
+      TString s = branch->GetName();
+      if (strcmp(bname, branch->GetName()) && (s.Index(re) == kNPOS)) {
+         continue;
+      }
+      nb++;
+      branch->SetBasketStats(stats);
+   }
+   if (!nb) {
+      Error("SetBasketStats", "unknown branch -> '%s'", bname);
+   }
+}
+
 //_______________________________________________________________________
 Int_t TTree::SetBranchAddress(const char* bname, void* addr, TBranch** ptr)
 {
@@ -7417,9 +7510,12 @@ void TTree::SetCacheSize(Long64_t cacheSize)
    }
 
    if(TTreeCacheUnzip::IsParallelUnzip() && file->GetCompressionLevel() > 0)
-      new TTreeCacheUnzip(this, cacheSize);
+      pf = new TTreeCacheUnzip(this, cacheSize);
    else
-      new TTreeCache(this, cacheSize);
+      pf = new TTreeCache(this, cacheSize);
+
+   // Skip the learning phase if the branches are known (see SetCacheProfile).
+   if (!fCacheProfile.IsNull()) pf->LoadProfile(fCacheProfile);
 }
 
 //______________________________________________________________________________
@@ -7433,6 +7529,28 @@ void TTree::SetCacheEntryRange(Long64_t first, Long64_t last)
    if (tc) tc->SetEntryRange(first,last);
 }
 
+//______________________________________________________________________________
+Int_t TTree::SetCacheProfile(const char *filename)
+{
+   // Use the list of branches saved in filename by SaveCacheProfile instead
+   // of learning them during the first entries: the cache reads the baskets
+   // of these branches from the first entry onwards.
+   // If the cache does not exist yet, the profile is applied when it is
+   // created (see SetCacheSize); it is also applied again when the cache is
+   // recreated. Use an empty filename to go back to the learning phase for
+   // the next caches.
+   // Returns the number of branches put in the cache (0 if the profile is
+   // applied later), or -1 in case of error.
+
+   fCacheProfile = filename ? filename : "";
+   if (fCacheProfile.IsNull()) return 0;
+
+   TFile *f = GetCurrentFile();
+   TTreeCache *tc = f ? (TTreeCache*)f->GetCacheRead(this) : 0;
+   if (!tc) return 0;
+   return tc->LoadProfile(fCacheProfile);
+}
+
 //______________________________________________________________________________
 void TTree::SetCacheLearnEntries(Int_t n)
 {
@@ -7492,6 +7610,75 @@ void TTree::SetCircular(Long64_t maxEntries)
    }
 }
 
+//______________________________________________________________________________
+void TTree::SetCompressionDictionary(const char* bname, Int_t nbaskets, Int_t maxsize)
+{
+   // Compress the baskets of a set of branches with a dictionary of at most
+   // maxsize bytes trained on their first nbaskets baskets
+   // (see TBranch::SetCompressionDictionary).
+   //
+   // bname is the name of a branch.
+   // if bname="*", apply to all branches.
+   // if bname="xxx*", apply to all branches with name starting with xxx
+   // see TRegexp for wildcarding options
+   //
+   // This is useful for the branches with small baskets, for example when
+   // the tree is flushed often (see SetAutoFlush):
+   //    tree->SetCompressionDictionary("*");
+
+   Int_t nleaves = fLeaves.GetEntriesFast();
+   TRegexp re(bname, kTRUE);
+   Int_t nb = 0;
+   for (Int_t i = 0; i < nleaves; i++)  {
+      TLeaf* leaf = (TLeaf*) fLeaves.UncheckedAt(i);
+      TBranch* branch = (TBranch*) leaf->GetBranch();
+      TString s = branch->GetName();
+      if (strcmp(bname, branch->GetName()) && (s.Index(re) == kNPOS)) {
+         continue;
+      }
+      nb++;
+      branch->SetCompressionDictionary(nbaskets, maxsize);
+   }
+   if (!nb) {
+      Error("SetCompressionDictionary", "unknown branch -> '%s'", bname);
+   }
+}
+
+//______________________________________________________________________________
+void TTree::SetCompressionSettings(const char* bname, Int_t settings)
+{
+   // Set the compression algorithm and level of a set of branches.
+   //
+   // bname is the name of a branch.
+   // if bname="*", apply to all branches.
+   // if bname="xxx*", apply to all branches with name starting with xxx
+   // see TRegexp for wildcarding options
+   // settings = 100 * algorithm + level (see TBranch::SetCompressionSettings)
+   //
+   // For example, to keep the LZMA compression of the file for most of the
+   // branches but use the faster to decompress LZ4 for the branches read
+   // in every analysis:
+   //    tree->SetCompressionSettings("jet*", ROOT::CompressionSettings(ROOT::kLZ4, 4));
+   // The new settings only apply to the baskets written after the call.
+
+   Int_t nleaves = fLeaves.GetEntriesFast();
+   TRegexp re(bname, kTRUE);
+   Int_t nb = 0;
+   for (Int_t i = 0; i < nleaves; i++)  {
+      TLeaf* leaf = (TLeaf*) fLeaves.UncheckedAt(i);
+      TBranch* branch = (TBranch*) leaf->GetBranch();
+      TString s = branch->GetName();
+      if (strcmp(bname, branch->GetName()) && (s.Index(re) == kNPOS)) {
+         continue;
+      }
+      nb++;
+      branch->SetCompressionSettings(settings);
+   }
+   if (!nb) {
+      Error("SetCompressionSettings", "unknown branch -> '%s'", bname);
+   }
+}
+
 //______________________________________________________________________________
 void TTree::SetDebug(Int_t level, Long64_t min, Long64_t max)
 {
@@ -7793,6 +7980,80 @@ void TTree::SetObject(const char* name, const char* title)
    }
 }
 
+//______________________________________________________________________________
+void TTree::SetParallelFlush(Int_t nthreads)
+{
+   // Enable or disable the compression of the baskets in parallel.
+   //
+   // With nthreads > 0, the full baskets are no longer compressed by the
+   // thread calling TTree::Fill: they are handed over to a pool of nthreads
+   // threads (see TTreeFlushPool) and the baskets compressed by the pool are
+   // written by TTree::Fill and TTree::FlushBaskets in the order they were
+   // filled. The format of the file is unchanged.
+   // With nthreads < 0, one thread per core (minus one) is used.
+   // With nthreads == 0, the pool is deleted (after writing all its baskets).
+   //
+   // This is most effective for trees with many branches, as all the
+   // baskets flushed at the same time (see SetAutoFlush) are compressed
+   // concurrently. The memory used by the baskets waiting to be written is
+   // bounded, see TTreeFlushPool::SetMaxQueuedBytes.
+   // Baskets using the old compression algorithm, which is not reentrant,
+   // are still compressed by the thread filling the tree.
+
+   if (fFlushPool) {
+      fFlushPool->Commit(kTRUE);
+      delete fFlushPool;
+      fFlushPool = 0;
+   }
+   if (nthreads < 0) {
+      SysInfo_t info;
+      gSystem->GetSysInfo(&info);
+      nthreads = info.fCpus > 1 ? info.fCpus - 1 : 1;
+   }
+   if (nthreads > 0) {
+      fFlushPool = new TTreeFlushPool(this, nthreads);
+   }
+}
+
+//______________________________________________________________________________
+void TTree::SetParallelProcess(Int_t nthreads)
+{
+   // Process the entries of this tree with nthreads threads in
+   // TTree::Process(TSelector*).
+   // If nthreads < 0, the number of threads is the number of cores.
+   // If nthreads <= 1, the entries are processed sequentially (default).
+   //
+   // The entry range is split into clusters (see GetClusterIterator) which
+   // are distributed dynamically among the threads. Each thread processes
+   // its clusters with its own clone of the selector, created with the
+   // default constructor of the selector class, reading its own copy of the
+   // tree (the file is opened once per thread) with its own TTreeCache.
+   // The calls to the selector are those of a PROOF session: Begin and
+   // Terminate are called for the original selector, SlaveBegin, Init,
+   // Notify, Process and SlaveTerminate for the clones. The objects in the
+   // output lists of the clones are then merged into the output list of the
+   // original selector with their Merge(TCollection*) function; objects
+   // without Merge function are all added to the output list.
+   //
+   // The entries are processed sequentially if the selector is interpreted,
+   // if the tree is not read from a file opened in read mode, if it has
+   // friends or if an entry list or event list is set. For a TChain, the
+   // files are processed one after the other, the clusters of each file
+   // being processed in parallel.
+   //
+   // The code of the selector called during the processing (Process,
+   // ProcessCut, ProcessFill and the functions they call) must be thread
+   // safe apart from the accesses to the selector data members and to the
+   // objects it creates.
+
+   if (nthreads < 0) {
+      SysInfo_t info;
+      gSystem->GetSysInfo(&info);
+      nthreads = info.fCpus > 1 ? info.fCpus : 1;
+   }
+   fNProcessThreads = nthreads > 1 ? nthreads : 0;
+}
+
 //______________________________________________________________________________
 void TTree::SetParallelUnzip(Bool_t opt, Float_t RelSize)
 {
@@ -8037,6 +8298,10 @@ void TTree::Streamer(TBuffer& b)
       if (fBranchRef) {
          fBranchRef->Clear();
       }
+      if (fFlushPool) {
+         // The header must describe all the baskets handed over so far.
+         fFlushPool->Commit(kTRUE);
+      }
       b.WriteClassBuffer(TTree::Class(), this);
    }
 }
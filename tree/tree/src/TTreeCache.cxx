@@ -210,6 +210,41 @@
 //--
 //
 //
+//     READING THE NEXT CLUSTERS IN ADVANCE
+//     ====================================
+//
+//  When the cache is exhausted, it is filled with the baskets of the next
+//  clusters and the event loop waits for the transfer. With a high latency
+//  file (TNetFile, TWebFile, xrootd) this costs a full round trip at each
+//  fill. With
+//     TTreeCache *tc = (TTreeCache*)f->GetCacheRead(T);
+//     tc->SetReadAheadDepth(2);           //<<< read 2 fills in advance
+//     tc->SetReadAheadMaxSize(50000000);  //<<< using at most 50 MBytes
+//  (or the rootrc variables TTreeCache.ReadAheadDepth and
+//  TTreeCache.ReadAheadSize) the baskets of the next fills are read by a
+//  separate thread while the current one is processed. The time spent
+//  waiting for the baskets of the cache is given by GetStallTime and
+//  reported by TTreePerfStats. As the thread reads the file while the
+//  event loop reads it too, this is only done for the files read with
+//  xrootd (TXNetFile), whose client supports concurrent reads.
+//
+//
+//     REUSING THE BRANCHES LEARNT BY A PREVIOUS JOB
+//     =============================================
+//
+//  During the learning phase the cache reads the baskets one by one and
+//  misses the branches used only after the first entries. When the same
+//  analysis is run many times (for example short skims over many files),
+//  the branches learnt by one job can be saved with
+//     T->SaveCacheProfile("myanalysis.cacheprofile");  //<<< at the end of the job
+//  and given to the next jobs with
+//     T->SetCacheProfile("myanalysis.cacheprofile");   //<<< before the loop
+//  The cache then starts without learning phase: the baskets of the
+//  branches of the profile are read from the first entry onwards. The
+//  profile is a text file with one branch name per line, in the order in
+//  which the branches were first used; it can be edited by hand.
+//
+//
 //     SPECIAL CASES WHERE TreeCache should not be activated
 //     =====================================================
 //
@@ -238,7 +273,14 @@
 #include "TLeaf.h"
 #include "TFriendElement.h"
 #include "TFile.h"
+#include "TFilePrefetch.h"
+#include "TEnv.h"
+#include "TMath.h"
+#include "TTimeStamp.h"
+#include "TUrl.h"
+#include "TSystem.h"
 #include <limits.h>
+#include <fstream>
 
 Int_t TTreeCache::fgLearnEntries = 100;
 
@@ -267,7 +309,13 @@ TTreeCache::TTreeCache() : TFileCacheRead(),
    fFirstEntry(-1),
    fReadDirectionSet(kFALSE),
    fEnabled(kTRUE),
-   fPrefillType(TTreeCache::kNoPrefill)
+   fPrefillType(TTreeCache::kNoPrefill),
+   fReadAhead(0),
+   fReadAheadDepth(0),
+   fReadAheadMaxSize(0),
+   fReadAheadNext(0),
+   fNReadAheadBytes(0),
+   fStallTime(0)
 {
    // Default Constructor.
 }
@@ -295,9 +343,19 @@ TTreeCache::TTreeCache(TTree *tree, Int_t buffersize) : TFileCacheRead(tree->Get
    fFirstEntry(-1),
    fReadDirectionSet(kFALSE),
    fEnabled(kTRUE),
-   fPrefillType(TTreeCache::kNoPrefill)
+   fPrefillType(TTreeCache::kNoPrefill),
+   fReadAhead(0),
+   fReadAheadDepth(gEnv->GetValue("TTreeCache.ReadAheadDepth", 0)),
+   fReadAheadMaxSize(gEnv->GetValue("TTreeCache.ReadAheadSize", 0)),
+   fReadAheadNext(0),
+   fNReadAheadBytes(0),
+   fStallTime(0)
 {
    // Constructor.
+   // The number of cache fills read in advance and the maximum memory
+   // they can use are taken from the rootrc variables
+   // TTreeCache.ReadAheadDepth and TTreeCache.ReadAheadSize (see
+   // SetReadAheadDepth and SetReadAheadMaxSize).
 
    fEntryNext = fEntryMin + fgLearnEntries;
    Int_t nleaves = tree->GetListOfLeaves()->GetEntries();
@@ -309,6 +367,9 @@ TTreeCache::~TTreeCache()
 {
    // destructor. (in general called by the TFile destructor)
 
+   // Stop reading in advance before releasing the file.
+   StopReadAhead();
+
    // Informe the TFile that we have been deleted (in case
    // we are deleted explicitly by legacy user code).
    if (fFile) fFile->SetCacheRead(0, fTree);   
@@ -446,6 +507,16 @@ void TTreeCache::AddBranch(const char *bname, Bool_t subbranches /*= kFALSE*/)
    }
 }
 
+//_____________________________________________________________________________
+void TTreeCache::Close(Option_t *option)
+{
+   // Stop the read-ahead thread and close out the asynchronous fetches
+   // of TFileCacheRead, before the file is closed.
+
+   StopReadAhead();
+   TFileCacheRead::Close(option);
+}
+
 //_____________________________________________________________________________
 void TTreeCache::DropBranch(TBranch *b, Bool_t subbranches /*= kFALSE*/)
 {
@@ -901,6 +972,43 @@ TTree *TTreeCache::GetTree() const
    return ((TBranch*)(fBranches->UncheckedAt(0)))->GetTree();
 }
 
+//_____________________________________________________________________________
+Int_t TTreeCache::LoadProfile(const char *filename)
+{
+   // Put in the cache the branches listed in filename (see SaveProfile)
+   // and stop the learning phase: the baskets of these branches are read
+   // from the first entry onwards. The branches of the profile which are
+   // not in the tree are ignored. Lines starting with '#' are comments.
+   // Returns the number of branches put in the cache, or -1 if the file
+   // cannot be read.
+
+   TString fname(filename);
+   gSystem->ExpandPathName(fname);
+   std::ifstream in(fname.Data());
+   if (!in.good()) {
+      Error("LoadProfile","Cannot open the profile file %s",filename);
+      return -1;
+   }
+
+   StartLearningPhase();
+   Int_t nadded = 0;
+   TString line;
+   while (line.ReadLine(in)) {
+      line = line.Strip(TString::kBoth);
+      if (line.IsNull() || line[0] == '#') continue;
+      TBranch *b = fTree->GetBranch(line.Data());
+      if (!b) {
+         if (gDebug > 0) Info("LoadProfile","Branch %s is not in the tree %s",line.Data(),fTree->GetName());
+         continue;
+      }
+      Int_t nbranches = fNbranches;
+      AddBranch(b, kFALSE);
+      if (fNbranches > nbranches) nadded++;
+   }
+   StopLearningPhase();
+   return nadded;
+}
+
 //_____________________________________________________________________________
 void TTreeCache::Print(Option_t *option) const
 {
@@ -928,6 +1036,10 @@ void TTreeCache::Print(Option_t *option) const
    printf("Cache Efficiency ..................: %f\n",GetEfficiency());
    printf("Cache Efficiency Rel...............: %f\n",GetEfficiencyRel());
    printf("Learn entries......................: %d\n",TTreeCache::GetLearnEntries());
+   if (fReadAheadDepth > 0) {
+      printf("Read-ahead.........................: %d cache fills, %lld bytes used\n",fReadAheadDepth,fNReadAheadBytes);
+   }
+   printf("Stall time.........................: %f seconds\n",fStallTime);
    if ( opt.Contains("cachedbranches") ) {
       opt.ReplaceAll("cachedbranches","");
       printf("Cached branches....................:\n");
@@ -942,6 +1054,186 @@ void TTreeCache::Print(Option_t *option) const
 }
 
 
+//_____________________________________________________________________________
+void TTreeCache::ReadAhead()
+{
+   // Queue to the read-ahead thread the baskets of the cache fills
+   // following the current one, until fReadAheadDepth fills are queued
+   // or fReadAheadMaxSize bytes are used.
+   // A fill is made of the consecutive clusters following the current
+   // fill, up to the size of the cache; only the baskets starting in
+   // these clusters are read.
+   // This is called each time the cache has been filled.
+
+   if (fReadAheadDepth <= 0 || fIsLearning || fReverseRead) return;
+   if (fEnablePrefetching || fAsyncReading) return;
+   if (fNbranches <= 0 || !fFile || fEntryNext < 0) return;
+
+   // After a jump in the entries, the blocks are not those of the
+   // next fills anymore.
+   if (!fReadAheadBlocks.empty() && fReadAheadBlocks.front().fEntryMin > fEntryNext) {
+      fReadAheadBlocks.clear();
+   }
+   if ((Int_t)fReadAheadBlocks.size() >= fReadAheadDepth) return;
+
+   // As for TFile.AsyncPrefetching, local files are not read in advance.
+   if (!strcmp(fFile->GetEndpointUrl()->GetProtocol(), "file")) return;
+   // The other files are read by the event loop at the same time as by
+   // the read-ahead thread: only the xrootd client supports it.
+   if (!fFile->InheritsFrom("TXNetFile")) {
+      Warning("ReadAhead", "%s does not support concurrent reads (%s), disabling the read-ahead",
+              fFile->GetName(), fFile->ClassName());
+      fReadAheadDepth = 0;
+      return;
+   }
+
+   if (!fReadAhead) {
+      fReadAhead = new TFilePrefetch(fFile);
+      // Keep the blocks not yet used plus the one being used.
+      fReadAhead->SetMaxReadBlocks(fReadAheadDepth+1);
+      if (fReadAhead->ThreadStart()) {
+         Error("ReadAhead", "Unable to start the read-ahead thread, disabling the read-ahead");
+         SafeDelete(fReadAhead);
+         fReadAheadDepth = 0;
+         return;
+      }
+   }
+
+   TTree *tree = ((TBranch*)fBranches->UncheckedAt(0))->GetTree();
+   Long64_t entryMax = fEntryMax > 0 ? fEntryMax : tree->GetEntries();
+   Long64_t maxSize = fReadAheadMaxSize > 0 ? fReadAheadMaxSize : (Long64_t)fReadAheadDepth * fBufferSizeMin;
+
+   if (fReadAheadBlocks.empty() || fReadAheadNext < fEntryNext) fReadAheadNext = fEntryNext;
+   Long64_t nbytes = 0;
+   for (UInt_t k = 0; k < fReadAheadBlocks.size(); ++k) nbytes += fReadAheadBlocks[k].fNbytes;
+
+   TEventList *elist = fTree->GetEventList();
+   Long64_t chainOffset = 0;
+   if (elist) {
+      if (fTree->IsA() ==TChain::Class()) {
+         TChain *chain = (TChain*)fTree;
+         Int_t t = chain->GetTreeNumber();
+         chainOffset = chain->GetTreeOffset()[t];
+      }
+   }
+
+   std::vector<Long64_t> seek;
+   std::vector<Int_t>    seekLen;
+   std::vector<Int_t>    index;
+   std::vector<Long64_t> pos;
+   std::vector<Int_t>    len;
+   while ((Int_t)fReadAheadBlocks.size() < fReadAheadDepth && fReadAheadNext < entryMax) {
+      TTree::TClusterIterator clusterIter = tree->GetClusterIterator(fReadAheadNext);
+      clusterIter();
+      Long64_t entryMin  = fReadAheadNext;
+      Long64_t entryNext = fReadAheadNext;
+      Long64_t ntot = 0;
+      seek.clear();
+      seekLen.clear();
+      // Add clusters until the size of the cache is reached.
+      do {
+         Long64_t first = entryNext;
+         entryNext = clusterIter.GetNextEntry();
+         if (entryNext > entryMax) entryNext = entryMax;
+         for (Int_t i=0;i<fNbranches;i++) {
+            TBranch *b = (TBranch*)fBranches->UncheckedAt(i);
+            if (b->GetDirectory()==0) continue;
+            if (b->GetDirectory()->GetFile() != fFile) continue;
+            Int_t nb = b->GetMaxBaskets();
+            Int_t *lbaskets   = b->GetBasketBytes();
+            Long64_t *entries = b->GetBasketEntry();
+            if (!lbaskets || !entries) continue;
+            Int_t blistsize = b->GetListOfBaskets()->GetSize();
+            Int_t j = TMath::BinarySearch(nb, entries, first);
+            if (j < 0) j = 0;
+            for (;j<nb;j++) {
+               if (entries[j] >= entryNext) break;
+               if (entries[j] < first) continue;
+               // This basket has already been read, skip it
+               if (j<blistsize && b->GetListOfBaskets()->UncheckedAt(j)) continue;
+               Long64_t bpos = b->GetBasketSeek(j);
+               Int_t blen = lbaskets[j];
+               if (bpos <= 0 || blen <= 0) continue;
+               if (blen > fBufferSizeMin) continue;
+               if (elist) {
+                  Long64_t emax = fEntryMax;
+                  if (j<nb-1) emax = entries[j+1]-1;
+                  if (!elist->ContainsRange(entries[j]+chainOffset,emax+chainOffset)) continue;
+               }
+               seek.push_back(bpos);
+               seekLen.push_back(blen);
+               ntot += blen;
+            }
+         }
+      } while (ntot < fBufferSizeMin && entryNext < entryMax && clusterIter() < entryMax);
+
+      if (seek.empty()) {
+         fReadAheadNext = entryNext;
+         continue;
+      }
+      // Do not go over the memory budget, unless nothing is read in advance.
+      if (nbytes + ntot > maxSize && !fReadAheadBlocks.empty()) break;
+
+      // Sort the baskets and merge the consecutive ones, as done by
+      // TFileCacheRead::Sort for the cache itself.
+      Int_t n = (Int_t)seek.size();
+      index.resize(n);
+      TMath::Sort(n, &seek[0], &index[0], kFALSE);
+      fReadAheadBlocks.push_back(TReadAheadBlock());
+      TReadAheadBlock &block = fReadAheadBlocks.back();
+      block.fEntryMin  = entryMin;
+      block.fEntryNext = entryNext;
+      block.fNbytes    = ntot;
+      block.fSeek.reserve(n);
+      block.fSeekLen.reserve(n);
+      pos.clear();
+      len.clear();
+      for (Int_t i = 0; i < n; ++i) {
+         Long64_t bpos = seek[index[i]];
+         Int_t    blen = seekLen[index[i]];
+         if (!block.fSeek.empty() && block.fSeek.back() == bpos) continue;
+         block.fSeek.push_back(bpos);
+         block.fSeekLen.push_back(blen);
+         if (!pos.empty() && pos.back() + len.back() == bpos && len.back() <= 16000000) {
+            len.back() += blen;
+         } else {
+            pos.push_back(bpos);
+            len.push_back(blen);
+         }
+      }
+      fReadAhead->ReadBlock(&pos[0], &len[0], (Int_t)pos.size());
+      nbytes += ntot;
+      fReadAheadNext = entryNext;
+      if (gDebug > 0)
+         Info("ReadAhead", "Reading in advance %d baskets (%lld bytes) for the entries %lld to %lld",
+              n, ntot, entryMin, entryNext);
+   }
+}
+
+//_____________________________________________________________________________
+Int_t TTreeCache::ReadBufferExtNormal(char *buf, Long64_t pos, Int_t len, Int_t &loc)
+{
+   // Overload of TFileCacheRead::ReadBufferExtNormal.
+   // The first time the cache is accessed after having been filled, read
+   // its baskets, using the blocks read in advance when possible (see
+   // SetReadAheadDepth), measure the time spent waiting for them and
+   // queue the next fills to the read-ahead thread.
+
+   if (fNseek > 0 && !fIsSorted && !fAsyncReading) {
+      Sort();
+      loc = -1;
+
+      Double_t start = TTimeStamp();
+      Bool_t failed = TransferBuffer();
+      fStallTime += Double_t(TTimeStamp()) - start;
+      if (failed) return -1;
+      fIsTransferred = kTRUE;
+
+      ReadAhead();
+   }
+   return TFileCacheRead::ReadBufferExtNormal(buf, pos, len, loc);
+}
+
 //_____________________________________________________________________________
 Int_t TTreeCache::ReadBufferNormal(char *buf, Long64_t pos, Int_t len){
 
@@ -1032,6 +1324,7 @@ void TTreeCache::ResetCache()
 {
    // This will simply clear the cache
    TFileCacheRead::Prefetch(0,0);
+   fReadAheadBlocks.clear();
 
    if (fEnablePrefetching) {
       fFirstTime = kTRUE;
@@ -1039,6 +1332,36 @@ void TTreeCache::ResetCache()
    }
 }
 
+//_____________________________________________________________________________
+Int_t TTreeCache::SaveProfile(const char *filename) const
+{
+   // Save in filename the names of the branches in the cache, in the order
+   // in which they were first used. A later job can give this file to
+   // LoadProfile (or TTree::SetCacheProfile) to skip the learning phase.
+   // Returns the number of branches saved, or -1 if the file cannot be written.
+
+   TString fname(filename);
+   gSystem->ExpandPathName(fname);
+   std::ofstream out(fname.Data());
+   if (!out.good()) {
+      Error("SaveProfile","Cannot create the profile file %s",filename);
+      return -1;
+   }
+   if (fIsLearning) {
+      Warning("SaveProfile","The cache is still learning, the profile %s may be incomplete",filename);
+   }
+
+   out << "# TTreeCache profile of the tree " << (fTree ? fTree->GetName() : "") << std::endl;
+   Int_t nsaved = 0;
+   TIter next(fBrNames);
+   TObjString *os;
+   while ((os = (TObjString*)next())) {
+      out << os->GetName() << std::endl;
+      nsaved++;
+   }
+   return nsaved;
+}
+
 //_____________________________________________________________________________
 void TTreeCache::SetEntryRange(Long64_t emin, Long64_t emax)
 {
@@ -1076,6 +1399,8 @@ void TTreeCache::SetFile(TFile *file)
       fFile = 0;
       prevFile->SetCacheRead(0, fTree);
    }
+   // The blocks read in advance belong to the previous file.
+   StopReadAhead();
    TFileCacheRead::SetFile(file);
 }
 
@@ -1101,6 +1426,52 @@ void TTreeCache::SetLearnPrefill(TTreeCache::EPrefillType type /* = kNoPrefill *
    fPrefillType = type;
 }
 
+//_____________________________________________________________________________
+void TTreeCache::SetReadAheadDepth(Int_t nfills)
+{
+   // Set the number of cache fills read in advance.
+   //
+   // With a remote file, the event loop waits for a full round trip
+   // each time the cache has to be filled with the next clusters. When
+   // nfills is greater than 0, the baskets of the nfills fills following
+   // the current one are read by a separate thread (see TFilePrefetch)
+   // while the current one is processed. When the next fill is needed
+   // its baskets are taken from the blocks already read, waiting for
+   // them only if the transfer is not finished yet; the baskets which
+   // were not read in advance are read as usual.
+   // The time spent waiting for the baskets of the cache is returned by
+   // GetStallTime and reported by TTreePerfStats.
+   //
+   // The read-ahead thread reads the file at the same time as the event
+   // loop, which only the xrootd client (TXNetFile) supports: TFile has
+   // a single seek pointer, TNetFile and TWebFile a single connection.
+   // The read-ahead is hence refused with a warning for the other remote
+   // files, and is not used for local files, in reverse reading and
+   // when TFile.AsyncPrefetching or TFile.AsyncReading is used.
+   // The default value is given by the rootrc variable
+   // TTreeCache.ReadAheadDepth (0 by default, i.e. no read-ahead).
+   // The memory used by the blocks read in advance can be limited with
+   // SetReadAheadMaxSize.
+
+   if (nfills < 0) nfills = 0;
+   if (nfills == fReadAheadDepth) return;
+   StopReadAhead();
+   fReadAheadDepth = nfills;
+}
+
+//_____________________________________________________________________________
+void TTreeCache::SetReadAheadMaxSize(Long64_t nbytes)
+{
+   // Set the maximum number of bytes of the baskets read in advance
+   // and not yet used (see SetReadAheadDepth).
+   // If nbytes <= 0, the limit is the number of fills read in advance
+   // times the size of the cache.
+   // The default value is given by the rootrc variable
+   // TTreeCache.ReadAheadSize.
+
+   fReadAheadMaxSize = nbytes;
+}
+
 //_____________________________________________________________________________
 void TTreeCache::StartLearningPhase()
 {
@@ -1114,6 +1485,7 @@ void TTreeCache::StartLearningPhase()
    if (fBrNames) fBrNames->Delete();
    fIsTransferred = kFALSE;
    fEntryCurrent = -1;
+   fReadAheadBlocks.clear();
 }
 
 //_____________________________________________________________________________
@@ -1140,6 +1512,78 @@ void TTreeCache::StopLearningPhase()
    }
 }
 
+//_____________________________________________________________________________
+void TTreeCache::StopReadAhead()
+{
+   // Stop the read-ahead thread and forget the blocks read in advance.
+   // The thread is restarted by the next fill of the cache.
+
+   fReadAheadBlocks.clear();
+   SafeDelete(fReadAhead);
+}
+
+//_____________________________________________________________________________
+Bool_t TTreeCache::TransferBuffer()
+{
+   // Read the sorted baskets of the cache into fBuffer.
+   // The baskets read in advance for the current fill are copied from
+   // the read-ahead thread (waiting for them if needed), the others are
+   // read with a single vector read.
+   // Returns kTRUE in case of failure.
+
+   // Forget the blocks of the fills before the current one.
+   while (!fReadAheadBlocks.empty() && fReadAheadBlocks.front().fEntryNext <= fEntryCurrent) {
+      fReadAheadBlocks.pop_front();
+   }
+   if (!fReadAhead || fReadAheadBlocks.empty() || fReadAheadBlocks.front().fEntryMin >= fEntryNext) {
+      return fFile->ReadBuffers(fBuffer,fPos,fLen,fNb);
+   }
+
+   std::vector<Int_t>    missing;
+   std::vector<Long64_t> mpos;
+   std::vector<Int_t>    mlen;
+   Int_t mtot = 0;
+   for (Int_t i = 0; i < fNseek; ++i) {
+      Bool_t found = kFALSE;
+      for (UInt_t k = 0; !found && k < fReadAheadBlocks.size(); ++k) {
+         const TReadAheadBlock &block = fReadAheadBlocks[k];
+         if (block.fEntryMin >= fEntryNext) break;
+         Int_t n = (Int_t)block.fSeek.size();
+         Int_t m = (Int_t)TMath::BinarySearch(n, &block.fSeek[0], fSeekSort[i]);
+         if (m >= 0 && block.fSeek[m] == fSeekSort[i] && block.fSeekLen[m] >= fSeekSortLen[i]) {
+            found = !fReadAhead->ReadBuffer(&fBuffer[fSeekPos[i]], fSeekSort[i], fSeekSortLen[i]);
+         }
+      }
+      if (found) {
+         fNReadAheadBytes += fSeekSortLen[i];
+      } else {
+         missing.push_back(i);
+         mpos.push_back(fSeekSort[i]);
+         mlen.push_back(fSeekSortLen[i]);
+         mtot += fSeekSortLen[i];
+      }
+   }
+
+   // Forget the blocks used by the current fill. A block going past the
+   // end of the fill is kept, it contains baskets of the next one.
+   while (!fReadAheadBlocks.empty() && fReadAheadBlocks.front().fEntryNext <= fEntryNext) {
+      fReadAheadBlocks.pop_front();
+   }
+
+   if (missing.empty()) return kFALSE;
+   char *buffer = new char[mtot];
+   Bool_t failed = fFile->ReadBuffers(buffer, &mpos[0], &mlen[0], (Int_t)missing.size());
+   if (!failed) {
+      Int_t offset = 0;
+      for (UInt_t k = 0; k < missing.size(); ++k) {
+         memcpy(&fBuffer[fSeekPos[missing[k]]], &buffer[offset], mlen[k]);
+         offset += mlen[k];
+      }
+   }
+   delete [] buffer;
+   return failed;
+}
+
 //_____________________________________________________________________________
 void TTreeCache::UpdateBranches(TTree *tree)
 {
@@ -1152,6 +1596,7 @@ void TTreeCache::UpdateBranches(TTree *tree)
    fEntryMax  = fTree->GetEntries();
 
    fEntryCurrent = -1;
+   fReadAheadBlocks.clear();
 
    if (fBrNames->GetEntries() == 0 && fIsLearning) {
       // We still need to learn.
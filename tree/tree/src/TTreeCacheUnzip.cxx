@@ -24,9 +24,13 @@
 // Parallel Unzipping                                                   //
 //                                                                      //
 // TTreeCache has been specialised in order to let additional threads   //
-//  free to unzip in advance its content. In this implementation we     //
-//  support up to 10 threads, but right now it makes more sense to      //
-//  limit their number to 1-2                                           //
+//  free to unzip in advance its content. The threads belong to a       //
+//  process-wide pool (see TTreeUnzipPool) shared by all the caches.    //
+//  Once a cluster has been read, its blocks are submitted to the pool  //
+//  sorted by the first entry of their basket, so that the blocks       //
+//  needed first are unzipped first. Blocks whose baskets end before    //
+//  the entries being read are not unzipped anymore.                    //
+// The number of threads is set with TTreeUnzipPool::SetNThreads.       //
 //                                                                      //
 // The application reading data is carefully synchronized, in order to: //
 //  - if the block it wants is not unzipped, it self-unzips it without  //
@@ -46,6 +50,7 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include "TTreeCacheUnzip.h"
+#include "TTreeUnzipPool.h"
 #include "TChain.h"
 #include "TBranch.h"
 #include "TFile.h"
@@ -58,8 +63,8 @@
 
 #include "TEnv.h"
 
-#define THREADCNT 2
-extern "C" void R__unzip(Int_t *nin, UChar_t *bufin, Int_t *lout, char *bufout, Int_t *nout);
+extern "C" void R__unzipDict(Int_t *nin, UChar_t *bufin, Int_t *lout, char *bufout, Int_t *nout, const char *dict, Int_t dictsize);
+extern "C" int R__unzip_needdict(UChar_t *bufin);
 extern "C" int R__unzip_header(Int_t *nin, UChar_t *bufin, Int_t *lout);
 
 TTreeCacheUnzip::EParUnzipMode TTreeCacheUnzip::fgParallel = TTreeCacheUnzip::kDisable;
@@ -77,8 +82,10 @@ TTreeCacheUnzip::TTreeCacheUnzip() : TTreeCache(),
    fActiveThread(kFALSE),
    fAsyncReading(kFALSE),
    fCycle(0),
+   fSubmittedCycle(-1),
+   fNTasks(0),
    fLastReadPos(0),
-   fBlocksToGo(0),
+   fReadEntry(-1),
    fUnzipLen(0),
    fUnzipChunks(0),
    fUnzipStatus(0),
@@ -101,8 +108,10 @@ TTreeCacheUnzip::TTreeCacheUnzip(TTree *tree, Int_t buffersize) : TTreeCache(tre
    fActiveThread(kFALSE),
    fAsyncReading(kFALSE),
    fCycle(0),
+   fSubmittedCycle(-1),
+   fNTasks(0),
    fLastReadPos(0),
-   fBlocksToGo(0),
+   fReadEntry(-1),
    fUnzipLen(0),
    fUnzipChunks(0),
    fUnzipStatus(0),
@@ -127,7 +136,6 @@ void TTreeCacheUnzip::Init()
    fMutexList        = new TMutex(kTRUE);
    fIOMutex          = new TMutex(kTRUE);
 
-   fUnzipStartCondition   = new TCondition(fMutexList);
    fUnzipDoneCondition   = new TCondition(fMutexList);
 
    fTotalUnzipBytes = 0;
@@ -149,10 +157,9 @@ void TTreeCacheUnzip::Init()
 
       fParallel = kTRUE;
 
-      for (Int_t i = 0; i < 10; i++) fUnzipThread[i] = 0;
-
-      StartThreadUnzip(THREADCNT);
-
+      // The blocks are unzipped by the threads of the TTreeUnzipPool,
+      // they are submitted once they have been read (see SubmitBlocks).
+      fActiveThread = kTRUE;
    }
    else {
       Warning("TTreeCacheUnzip", "Parallel Option unknown");
@@ -174,13 +181,18 @@ TTreeCacheUnzip::~TTreeCacheUnzip()
 
    ResetCache();
 
-   if (IsActiveThread())
-      StopThreadUnzip();
-
+   {
+      // Wait for the blocks being unzipped by the pool, the other ones
+      // were removed from the pool by ResetCache.
+      R__LOCKGUARD(fMutexList);
+      fActiveThread = kFALSE;
+      while (fNTasks > 0) {
+         fUnzipDoneCondition->TimedWaitRelative(200);
+      }
+   }
 
    delete [] fUnzipLen;
 
-   delete fUnzipStartCondition;
    delete fUnzipDoneCondition;
 
 
@@ -256,6 +268,9 @@ Bool_t TTreeCacheUnzip::FillBuffer()
 
       //clear cache buffer
       TFileCacheRead::Prefetch(0,0);
+      fBlockEntry.clear();
+      fBlockEntryEnd.clear();
+      fBlockBranch.clear();
 
       //store baskets
       for (Int_t i=0;i<fNbranches;i++) {
@@ -287,6 +302,10 @@ Bool_t TTreeCacheUnzip::FillBuffer()
             fNReadPref++;
 
             TFileCacheRead::Prefetch(pos,len);
+            // Remember the entries of the basket to prioritize its unzipping
+            fBlockEntry.push_back(entries[j]);
+            fBlockEntryEnd.push_back(j<nb-1 ? entries[j+1] : b->GetEntries());
+            fBlockBranch.push_back(b);
          }
          if (gDebug > 0) printf("Entry: %lld, registering baskets branch %s, fEntryNext=%lld, fNseek=%d, fNtot=%d\n",entry,((TBranch*)fBranches->UncheckedAt(i))->GetName(),fEntryNext,fNseek,fNtot);
       }
@@ -385,27 +404,6 @@ Bool_t TTreeCacheUnzip::IsQueueEmpty()
    return kFALSE;
 }
 
-void TTreeCacheUnzip::WaitUnzipStartSignal()
-{
-   // Here the threads sleep waiting for some blocks to unzip
-
-   fUnzipStartCondition->TimedWaitRelative(2000);
-
-}
-//_____________________________________________________________________________
-void TTreeCacheUnzip::SendUnzipStartSignal(Bool_t broadcast)
-{
-   // This will send the signal corresponfing to the queue... normally used
-   // when we want to start processing the list of buffers.
-
-   if (gDebug > 0) Info("SendSignal", " fUnzipCondition->Signal()");
-
-   if (broadcast)
-      fUnzipStartCondition->Broadcast();
-   else 
-      fUnzipStartCondition->Signal();
-}
-
 //_____________________________________________________________________________
 Int_t TTreeCacheUnzip::SetParallelUnzip(TTreeCacheUnzip::EParUnzipMode option)
 {
@@ -426,133 +424,52 @@ Int_t TTreeCacheUnzip::SetParallelUnzip(TTreeCacheUnzip::EParUnzipMode option)
 }
 
 
-class TTreeCacheUnzipData {
-public:
-   TTreeCacheUnzip *fInstance;
-   Int_t            fCount;
-};
-
 //_____________________________________________________________________________
-Int_t TTreeCacheUnzip::StartThreadUnzip(Int_t nthreads)
+void TTreeCacheUnzip::SubmitBlocks()
 {
-   // The Thread is only a part of the TTreeCache but it is the part that
-   // waits for info in the queue and process it... unfortunatly, a Thread is
-   // not an object an we have to deal with it in the old C-Style way
-   // Returns 0 if the thread was initialized or 1 if it was already running
-   Int_t nt = nthreads;
-   if (nt > 10) nt = 10;
-
-   if (gDebug > 0)
-      Info("StartThreadUnzip", "Going to start %d threads.", nt);
-
-   for (Int_t i = 0; i < nt; i++) {
-      if (!fUnzipThread[i]) {
-         TString nm("UnzipLoop");
-         nm += i;
-
-         if (gDebug > 0)
-            Info("StartThreadUnzip", "Going to start thread '%s'", nm.Data());
-
-         TTreeCacheUnzipData *d = new TTreeCacheUnzipData;
-         d->fInstance = this;
-         d->fCount = i;
-
-         fUnzipThread[i] = new TThread(nm.Data(), UnzipLoop, (void*)d);
-         if (!fUnzipThread[i])
-            Error("TTreeCacheUnzip::StartThreadUnzip", " Unable to create new thread.");
-
-         fUnzipThread[i]->Run();
-
-         // There is at least one active thread
-         fActiveThread=kTRUE;
-
-      }
+   // Submit to the TTreeUnzipPool the blocks of the current cycle, once they
+   // have been read. The blocks are sorted by the first entry of their basket
+   // so that the ones needed first are unzipped first.
+   // Must be called with fMutexList locked.
+
+   if (!fActiveThread || fIsLearning || !fIsTransferred) return;
+   if (fSubmittedCycle == fCycle) return;
+   fSubmittedCycle = fCycle;
+
+   Int_t n = (Int_t)fBlockEntry.size();
+   if (n > fNseekMax) n = fNseekMax;
+   if (n <= 0) return;
+
+   Int_t *index  = new Int_t[n];
+   Int_t *blocks = new Int_t[n];
+   TMath::Sort(n, &fBlockEntry[0], index, kFALSE);
+   Int_t nblocks = 0;
+   for (Int_t i = 0; i < n; i++) {
+      Int_t idx = index[i];
+      // The small blocks are not worth the overhead, they are unzipped by the main thread
+      if (!fUnzipStatus[idx] && (fSeekLen[idx] > 256)) blocks[nblocks++] = idx;
    }
-
-   return (fActiveThread == kTRUE);
-}
-
-//_____________________________________________________________________________
-Int_t TTreeCacheUnzip::StopThreadUnzip()
-{
-   // To stop the thread we only need to change the value of the variable
-   // fActiveThread to false and the loop will stop (of course, we will have)
-   // to do the cleaning after that.
-   // Note: The syncronization part is important here or we will try to delete
-   //       teh object while it's still processing the queue
-   fActiveThread = kFALSE;
-
-   for (Int_t i = 0; i < 1; i++) {
-      if(fUnzipThread[i]){
-
-         SendUnzipStartSignal(kTRUE);
-
-         if (fUnzipThread[i]->Exists()) {
-            fUnzipThread[i]->Join();
-            delete fUnzipThread[i];
-         }
-      }
-
+   if (nblocks) {
+      TTreeUnzipPool::Instance()->Submit(this, fCycle, nblocks, blocks);
+      fNTasks += nblocks;
    }
-
-   return 1;
+   delete [] index;
+   delete [] blocks;
 }
 
-
-
 //_____________________________________________________________________________
-void* TTreeCacheUnzip::UnzipLoop(void *arg)
+void TTreeCacheUnzip::SubmitDeferred()
 {
-   // This is a static function.
-   // This is the call that will be executed in the Thread generated by
-   // StartThreadTreeCacheUnzip... what we want to do is to inflate the next
-   // series of buffers leaving them in the second cache.
-   // Returns 0 when it finishes
-   TTreeCacheUnzipData *d = (TTreeCacheUnzipData *)arg;
-   TTreeCacheUnzip *unzipMng = d->fInstance;
-
-   TThread::SetCancelOn();
-   TThread::SetCancelDeferred();
-
-   Int_t thrnum = d->fCount;
-   Int_t startindex = thrnum;
-   Int_t locbuffsz = 16384;
-   char *locbuff = new char[16384];
-   Int_t res = 0;
-   Int_t myCycle = 0;
-
-   while( unzipMng->IsActiveThread() ) {
-      res = 1;
-
-      {
-         R__LOCKGUARD(unzipMng->fMutexList);
-         if (myCycle != unzipMng->fCycle) startindex = thrnum;
-         myCycle = unzipMng->fCycle;
-         if (unzipMng->fNseek) startindex = startindex % unzipMng->fNseek;
-         else startindex = -1;
-      }
-
-
-      if (startindex >= 0)
-         res = unzipMng->UnzipCache(startindex, locbuffsz, locbuff);
-
-      {
-         R__LOCKGUARD(unzipMng->fMutexList);
-
-         if(!unzipMng->IsActiveThread()) break;
-
-         if ((res == 1) || (!unzipMng->fIsTransferred)) {
-            unzipMng->WaitUnzipStartSignal();
-            startindex = unzipMng->fLastReadPos+3+thrnum;
-         }
-      }
+   // Submit again to the TTreeUnzipPool the blocks which were postponed
+   // because the unzipped blocks were using too much memory.
+   // Must be called with fMutexList locked.
 
+   if (fDeferred.empty() || !fActiveThread) return;
+   if (fTotalUnzipBytes >= fUnzipBufferSize) return;
 
-   }
-
-   delete d;
-   delete [] locbuff;
-   return (void *)0;
+   TTreeUnzipPool::Instance()->Submit(this, fCycle, (Int_t)fDeferred.size(), &fDeferred[0]);
+   fNTasks += (Int_t)fDeferred.size();
+   fDeferred.clear();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -618,6 +535,11 @@ void TTreeCacheUnzip::ResetCache()
 
    // Reset all the lists and wipe all the chunks
    fCycle++;
+   if (fNTasks > 0) {
+      // Forget the blocks of the previous cycle which are still queued
+      fNTasks -= TTreeUnzipPool::Instance()->Cancel(this);
+   }
+   fDeferred.clear();
    for (Int_t i = 0; i < fNseekMax; i++) {
       if (fUnzipLen) fUnzipLen[i] = 0;
       if (fUnzipChunks) {
@@ -657,14 +579,11 @@ void TTreeCacheUnzip::ResetCache()
 
 
    fLastReadPos = 0;
+   fReadEntry = -1;
    fTotalUnzipBytes = 0;
-   fBlocksToGo = fNseek;
    }
 
 
-   SendUnzipStartSignal(kTRUE);
-
-
 }
 
 //_____________________________________________________________________________
@@ -680,6 +599,7 @@ Int_t TTreeCacheUnzip::GetUnzipBuffer(char **buf, Long64_t pos, Int_t len, Bool_
    // to pass it to the creator of TBuffer
    Int_t res = 0;
    Int_t loc = -1;
+   TBranch *branch = 0;
 
    {
       R__LOCKGUARD(fMutexList);
@@ -745,6 +665,10 @@ Int_t TTreeCacheUnzip::GetUnzipBuffer(char **buf, Long64_t pos, Int_t len, Bool_
             Int_t seekidx = fSeekIndex[loc];
 
             fLastReadPos = seekidx;
+            if (seekidx < (Int_t)fBlockBranch.size()) branch = fBlockBranch[seekidx];
+            // The baskets ending before this one starts will not be needed anymore
+            if (seekidx < (Int_t)fBlockEntry.size() && fBlockEntry[seekidx] > fReadEntry)
+               fReadEntry = fBlockEntry[seekidx];
 
             do {
 
@@ -763,15 +687,15 @@ Int_t TTreeCacheUnzip::GetUnzipBuffer(char **buf, Long64_t pos, Int_t len, Bool_
                      *buf = fUnzipChunks[seekidx];
                      fUnzipChunks[seekidx] = 0;
                      fTotalUnzipBytes -= fUnzipLen[seekidx];
-                     SendUnzipStartSignal(kFALSE);
+                     SubmitDeferred();
                      *free = kTRUE;
                   }
                   else {
                      memcpy(*buf, fUnzipChunks[seekidx], fUnzipLen[seekidx]);
-	             delete fUnzipChunks[seekidx];
+                     delete [] fUnzipChunks[seekidx];
                      fTotalUnzipBytes -= fUnzipLen[seekidx];
                      fUnzipChunks[seekidx] = 0;
-                     SendUnzipStartSignal(kFALSE);
+                     SubmitDeferred();
                      *free = kFALSE;
                   }
 
@@ -815,15 +739,15 @@ Int_t TTreeCacheUnzip::GetUnzipBuffer(char **buf, Long64_t pos, Int_t len, Bool_
                   *buf = fUnzipChunks[seekidx];
                   fUnzipChunks[seekidx] = 0;
                   fTotalUnzipBytes -= fUnzipLen[seekidx];
-                  SendUnzipStartSignal(kFALSE);
+                  SubmitDeferred();
                   *free = kTRUE;
                }
                else {
                   memcpy(*buf, fUnzipChunks[seekidx], fUnzipLen[seekidx]);
-                  delete fUnzipChunks[seekidx];
+                  delete [] fUnzipChunks[seekidx];
                   fTotalUnzipBytes -= fUnzipLen[seekidx];
                   fUnzipChunks[seekidx] = 0;
-                  SendUnzipStartSignal(kFALSE);
+                  SubmitDeferred();
                   *free = kFALSE;
                }
 
@@ -832,14 +756,13 @@ Int_t TTreeCacheUnzip::GetUnzipBuffer(char **buf, Long64_t pos, Int_t len, Bool_
 
                return fUnzipLen[seekidx];
             }
-            else {
+            else if (seekidx >= 0) {
                // This is a complete miss. We want to avoid the threads
                // to try unzipping this block in the future.
                fUnzipStatus[seekidx] = 2;
                fUnzipChunks[seekidx] = 0;
 
-               if ((fTotalUnzipBytes < fUnzipBufferSize) && fBlocksToGo)
-                  SendUnzipStartSignal(kFALSE);
+               SubmitDeferred();
 
                //if (gDebug > 0)
                //   Info("GetUnzipBuffer", "++++++++++++++++++++ CacheMISS Block wanted: %d  len:%d fNseek:%d", seekidx, len, fNseek);
@@ -892,7 +815,7 @@ Int_t TTreeCacheUnzip::GetUnzipBuffer(char **buf, Long64_t pos, Int_t len, Bool_
    } // scope of the lock!
 
    if (!res) {
-      res = UnzipBuffer(buf, fCompBuffer);
+      res = UnzipBuffer(buf, fCompBuffer, branch);
       *free = kTRUE;
    }
 
@@ -927,10 +850,13 @@ void TTreeCacheUnzip::SetUnzipBufferSize(Long64_t bufferSize)
 }
 
 //_____________________________________________________________________________
-Int_t TTreeCacheUnzip::UnzipBuffer(char **dest, char *src)
+Int_t TTreeCacheUnzip::UnzipBuffer(char **dest, char *src, TBranch *branch)
 {
    // UNzips a ROOT specific buffer... by reading the header at the beginning.
    // returns the size of the inflated buffer or -1 if error
+   // branch is the branch of the basket, needed for the buffers compressed
+   // with a dictionary (see TBranch::SetCompressionDictionary). If it is not
+   // known, these buffers are left to TBasket::ReadBasketBuffers (returns -1).
    // Note!! : If *dest == 0 we will allocate the buffer and it will be the
    // responsability of the caller to free it... it is useful for example
    // to pass it to the creator of TBuffer
@@ -995,7 +921,16 @@ Int_t TTreeCacheUnzip::UnzipBuffer(char **dest, char *src)
             return uzlen;
          }
 
-         R__unzip(&nin, bufcur, &nbuf, objbuf, &nout);
+         if (R__unzip_needdict(bufcur) && !branch) {
+            if (alloc) {
+               delete [] *dest;
+               *dest = 0;
+            }
+            return -1;
+         }
+         R__unzipDict(&nin, bufcur, &nbuf, objbuf, &nout,
+                      branch ? branch->GetCompressionDictionary() : 0,
+                      branch ? branch->GetCompressionDictionarySize() : 0);
 
 
 
@@ -1029,97 +964,68 @@ Int_t TTreeCacheUnzip::UnzipBuffer(char **dest, char *src)
 }
 
 //_____________________________________________________________________________
-Int_t TTreeCacheUnzip::UnzipCache(Int_t &startindex, Int_t &locbuffsz, char *&locbuff)
+Int_t TTreeCacheUnzip::UnzipBlock(Int_t index, Int_t cycle, Int_t &locbuffsz, char *&locbuff)
 {
-   // This inflates all the buffers in the cache.. passing the data to a new
-   // buffer that will only wait there to be read...
+   // This inflates the block number index of the cache, passing the data to
+   // a new buffer that will only wait there to be read...
+   // This is called by the threads of the TTreeUnzipPool for the blocks
+   // submitted by SubmitBlocks; cycle is the value of fCycle at that time.
    // We can not inflate all the buffers in the cache so we will try to do
    // it until the cache gets full... there is a member called fUnzipBufferSize which will
-   // tell us the max size we can allocate for this cache.
+   // tell us the max size we can allocate for this cache. Beyond it, the
+   // block is postponed until some of the unzipped blocks have been read.
    //
-   // note that we will  unzip in the order they were put into the cache not
-   // the order of the transference so it has to be read in that order or the
-   // pre-unzipping will be useless.
+   // locbuff is a buffer of size locbuffsz owned by the calling thread,
+   // it is resized as needed.
    //
-   // startindex is used as start index to check for blks to be unzipped
+   // returns 0 in normal conditions or -1 if error, 1 if the block was not unzipped
    //
-   // returns 0 in normal conditions or -1 if error, 1 if it would like to sleep
-   //
-   // This func is supposed to compete among an indefinite number of threads to get a chunk to inflate
-   // in order to accommodate multiple unzippers
    // Since everything is so async, we cannot use a fixed buffer, we are forced to keep
    // the individual chunks as separate blocks, whose summed size does not exceed the maximum
    // allowed. The pointers are kept globally in the array fUnzipChunks
-   Int_t myCycle;
    const Int_t hlen=128;
    Int_t objlen=0, keylen=0;
    Int_t nbytes=0;
    Int_t readbuf = 0;
 
-   Int_t idxtounzip = -1;
    Long64_t rdoffs = 0;
    Int_t rdlen = 0;
+   TBranch *branch = 0;
    {
       R__LOCKGUARD(fMutexList);
 
-      if (!IsActiveThread() || !fNseek || fIsLearning || !fIsTransferred) {
-         if (gDebug > 0)
-            Info("UnzipCache", "Sudden Break!!! IsActiveThread(): %d, fNseek: %d, fIsLearning:%d",
-                 IsActiveThread(), fNseek, fIsLearning);
+      if (!fActiveThread || (cycle != fCycle) || fIsLearning || !fIsTransferred ||
+          index >= fNseekMax || fUnzipStatus[index]) {
+         // The cache has been reset or the main thread has already taken care
+         // of this block.
+         --fNTasks;
+         fUnzipDoneCondition->Broadcast();
          return 1;
       }
 
-      // To synchronize with the 'paging'
-      myCycle = fCycle;
-
-      // Try to look for a blk to unzip
-      idxtounzip = -1;
-      rdoffs = 0;
-      rdlen = 0;
-      if (fTotalUnzipBytes < fUnzipBufferSize) {
-
-
-         if (fBlocksToGo > 0) {
-            for (Int_t ii=0; ii < fNseek; ii++) {
-               Int_t reqi = (startindex+ii) % fNseek;
-               if (!fUnzipStatus[reqi] && (fSeekLen[reqi] > 256)   ) {
-                  // We found a chunk which is not unzipped nor pending
-                  fUnzipStatus[reqi] = 1; // Set it as pending
-                  idxtounzip = reqi;
-
-                  rdoffs = fSeek[idxtounzip];
-                  rdlen = fSeekLen[idxtounzip];
-                  break;
-               }
-            }
-	    if (idxtounzip < 0) fBlocksToGo = 0;
-         }
-
-
+      if (index < (Int_t)fBlockEntryEnd.size() && fBlockEntryEnd[index] <= fReadEntry) {
+         // The entries of this basket have already been read, do not waste time on it.
+         // If it is asked for anyway, the main thread will unzip it itself.
+         --fNTasks;
+         fUnzipDoneCondition->Broadcast();
+         return 1;
       }
 
-   } // lock scope
-
-
-
-   if (idxtounzip < 0) {
-      if (gDebug > 0)
-         Info("UnzipCache", "Nothing to do... startindex:%d fTotalUnzipBytes:%lld fUnzipBufferSize:%lld fNseek:%d",
-              startindex, fTotalUnzipBytes, fUnzipBufferSize, fNseek );
-      return 1;
-   }
-
-
-   // And here we have a new blk to unzip
-   startindex = idxtounzip+THREADCNT;
+      if (fTotalUnzipBytes >= fUnzipBufferSize) {
+         // Too much memory is used by the unzipped blocks, the block will be
+         // submitted again when some of them have been read (see SubmitDeferred).
+         fDeferred.push_back(index);
+         --fNTasks;
+         fUnzipDoneCondition->Broadcast();
+         return 1;
+      }
 
+      fUnzipStatus[index] = 1; // Set it as pending
+      rdoffs = fSeek[index];
+      rdlen = fSeekLen[index];
+      if (index < (Int_t)fBlockBranch.size()) branch = fBlockBranch[index];
 
-   if (!IsActiveThread() || !fNseek || fIsLearning ) {
-      if (gDebug > 0)
-         Info("UnzipCache", "Sudden Break!!! IsActiveThread(): %d, fNseek: %d, fIsLearning:%d",
-              IsActiveThread(), fNseek, fIsLearning);
-      return 1;
-   }
+   } // lock scope
 
    Int_t loc = -1;
 
@@ -1138,35 +1044,38 @@ Int_t TTreeCacheUnzip::UnzipCache(Int_t &startindex, Int_t &locbuffsz, char *&lo
       }
 
 
-      if (gDebug > 0) 
-      Info("UnzipCache", "Going to unzip block %d", idxtounzip);
+   if (gDebug > 0)
+      Info("UnzipBlock", "Going to unzip block %d", index);
 
-      readbuf = ReadBufferExt(locbuff, rdoffs, rdlen, loc);
+   readbuf = ReadBufferExt(locbuff, rdoffs, rdlen, loc);
 
    {
       R__LOCKGUARD(fMutexList);
 
-      if ( (myCycle != fCycle) || !fIsTransferred )  {
+      if ( (cycle != fCycle) || !fIsTransferred )  {
          if (gDebug > 0)
-            Info("UnzipCache", "Sudden paging Break!!! IsActiveThread(): %d, fNseek: %d, fIsLearning:%d",
-                 IsActiveThread(), fNseek, fIsLearning);
-
-         fUnzipStatus[idxtounzip] = 2; // Set it as not done
-         fUnzipChunks[idxtounzip] = 0;
-         fUnzipLen[idxtounzip] = 0;
-         fUnzipDoneCondition->Signal();
-         
-         startindex = 0;
+            Info("UnzipBlock", "Sudden paging Break!!! IsActiveThread(): %d, fNseek: %d, fIsLearning:%d",
+                 fActiveThread, fNseek, fIsLearning);
+
+         if (cycle == fCycle) {
+            fUnzipStatus[index] = 2; // Set it as not done
+            fUnzipChunks[index] = 0;
+            fUnzipLen[index] = 0;
+         }
+         --fNTasks;
+         fUnzipDoneCondition->Broadcast();
          return 1;
       }
 
 
       if (readbuf <= 0) {
-         fUnzipStatus[idxtounzip] = 2; // Set it as not done
-         fUnzipChunks[idxtounzip] = 0;
-         fUnzipLen[idxtounzip] = 0;
+         fUnzipStatus[index] = 2; // Set it as not done
+         fUnzipChunks[index] = 0;
+         fUnzipLen[index] = 0;
          if (gDebug > 0)
-            Info("UnzipCache", "Block %d not done. rdoffs=%lld rdlen=%d readbuf=%d", idxtounzip, rdoffs, rdlen, readbuf);
+            Info("UnzipBlock", "Block %d not done. rdoffs=%lld rdlen=%d readbuf=%d", index, rdoffs, rdlen, readbuf);
+         --fNTasks;
+         fUnzipDoneCondition->Broadcast();
          return -1;
       }
 
@@ -1180,14 +1089,15 @@ Int_t TTreeCacheUnzip::UnzipCache(Int_t &startindex, Int_t &locbuffsz, char *&lo
       // This block will be unzipped synchronously in the main thread
       if (len > 4*fUnzipBufferSize) {
 
-         //if (gDebug > 0)
-            Info("UnzipCache", "Block %d is too big, skipping.", idxtounzip);
+         if (gDebug > 0)
+            Info("UnzipBlock", "Block %d is too big, skipping.", index);
 
-         fUnzipStatus[idxtounzip] = 2; // Set it as done
-         fUnzipChunks[idxtounzip] = 0;
-         fUnzipLen[idxtounzip] = 0;
+         fUnzipStatus[index] = 2; // Set it as done
+         fUnzipChunks[index] = 0;
+         fUnzipLen[index] = 0;
 
-         fUnzipDoneCondition->Signal();
+         --fNTasks;
+         fUnzipDoneCondition->Broadcast();
          return 0;
       }
 
@@ -1197,51 +1107,55 @@ Int_t TTreeCacheUnzip::UnzipCache(Int_t &startindex, Int_t &locbuffsz, char *&lo
    char *ptr = 0;
    Int_t loclen = 0;
 
-   loclen = UnzipBuffer(&ptr, locbuff);
+   loclen = UnzipBuffer(&ptr, locbuff, branch);
+
+   R__LOCKGUARD(fMutexList);
 
    if ((loclen > 0) && (loclen == objlen+keylen)) {
-      R__LOCKGUARD(fMutexList);
 
-      if ( (myCycle != fCycle)  || !fIsTransferred) {
+      if ( (cycle != fCycle)  || !fIsTransferred) {
          if (gDebug > 0)
-            Info("UnzipCache", "Sudden paging Break!!! IsActiveThread(): %d, fNseek: %d, fIsLearning:%d",
-                 IsActiveThread(), fNseek, fIsLearning);
+            Info("UnzipBlock", "Sudden paging Break!!! IsActiveThread(): %d, fNseek: %d, fIsLearning:%d",
+                 fActiveThread, fNseek, fIsLearning);
          delete [] ptr;
 
-         fUnzipStatus[idxtounzip] = 2; // Set it as not done
-         fUnzipChunks[idxtounzip] = 0;
-         fUnzipLen[idxtounzip] = 0;
+         if (cycle == fCycle) {
+            fUnzipStatus[index] = 2; // Set it as not done
+            fUnzipChunks[index] = 0;
+            fUnzipLen[index] = 0;
+         }
 
-         startindex = 0;
-         fUnzipDoneCondition->Signal();
+         --fNTasks;
+         fUnzipDoneCondition->Broadcast();
          return 1;
       }
 
-      fUnzipStatus[idxtounzip] = 2; // Set it as done
-      fUnzipChunks[idxtounzip] = ptr;
-      fUnzipLen[idxtounzip] = loclen;
+      fUnzipStatus[index] = 2; // Set it as done
+      fUnzipChunks[index] = ptr; // The chunk now belongs to the cache
+      fUnzipLen[index] = loclen;
       fTotalUnzipBytes += loclen;
 
-      fActiveBlks.push(idxtounzip);
+      fActiveBlks.push(index);
 
       if (gDebug > 0)
-         Info("UnzipCache", "reqi:%d, rdoffs:%lld, rdlen: %d, loclen:%d",
-              idxtounzip, rdoffs, rdlen, loclen);
+         Info("UnzipBlock", "reqi:%d, rdoffs:%lld, rdlen: %d, loclen:%d",
+              index, rdoffs, rdlen, loclen);
 
       fNUnzip++;
    }
    else {
-      R__LOCKGUARD(fMutexList);
-      Info("argh", "loclen:%d objlen:%d loc:%d readbuf:%d", loclen, objlen, loc, readbuf);
-      fUnzipStatus[idxtounzip] = 2; // Set it as done
-      fUnzipChunks[idxtounzip] = 0;
-      fUnzipLen[idxtounzip] = 0;
+      if (gDebug > 0)
+         Info("UnzipBlock", "loclen:%d objlen:%d loc:%d readbuf:%d", loclen, objlen, loc, readbuf);
+      delete [] ptr;
+      if (cycle == fCycle) {
+         fUnzipStatus[index] = 2; // Set it as done
+         fUnzipChunks[index] = 0;
+         fUnzipLen[index] = 0;
+      }
    }
 
-
-   fUnzipDoneCondition->Signal();
-
-   delete [] ptr;
+   --fNTasks;
+   fUnzipDoneCondition->Broadcast();
    return 0;
 }
 
@@ -1261,7 +1175,16 @@ void  TTreeCacheUnzip::Print(Option_t* option) const {
 //_____________________________________________________________________________
 Int_t TTreeCacheUnzip::ReadBufferExt(char *buf, Long64_t pos, Int_t len, Int_t &loc) {
 
-   R__LOCKGUARD(fIOMutex);
-   return TTreeCache::ReadBufferExt(buf, pos, len, loc);
+   Int_t res;
+   {
+      R__LOCKGUARD(fIOMutex);
+      res = TTreeCache::ReadBufferExt(buf, pos, len, loc);
+   }
 
+   // Once the blocks of a new cycle have been read, hand them over to the unzipping threads
+   if (fParallel && fIsTransferred && fSubmittedCycle != fCycle) {
+      R__LOCKGUARD(fMutexList);
+      SubmitBlocks();
+   }
+   return res;
 }
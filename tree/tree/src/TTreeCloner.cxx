@@ -28,6 +28,7 @@
 #include "TMath.h"
 #include "TTree.h"
 #include "TTreeCloner.h"
+#include "TTreeFlushPool.h"
 #include "TFile.h"
 #include "TLeafB.h"
 #include "TLeafI.h"
@@ -37,6 +38,7 @@
 #include "TLeafC.h"
 
 #include <algorithm>
+#include <string.h>
 
 //______________________________________________________________________________
 Bool_t TTreeCloner::CompareSeek::operator()(UInt_t i1, UInt_t i2)
@@ -211,6 +213,10 @@ void TTreeCloner::CloseOutWriteBaskets()
       TBranch *to = (TBranch*)fToBranches.UncheckedAt(i);
       to->FlushOneBasket(to->GetWriteBasket());
    }
+   if (fToTree->GetFlushPool()) {
+      // The baskets must be on file before we add the new ones.
+      fToTree->GetFlushPool()->Commit(kTRUE);
+   }
 }
 
 //______________________________________________________________________________
@@ -223,6 +229,18 @@ UInt_t TTreeCloner::CollectBranches(TBranch *from, TBranch *to) {
    // Since this is called from the constructor, this can not be a virtual function
 
    UInt_t numBaskets = 0;
+   if (from->GetCompressionDictionarySize() != to->GetCompressionDictionarySize()
+       || (from->GetCompressionDictionarySize() > 0
+           && memcmp(from->GetCompressionDictionary(), to->GetCompressionDictionary(), from->GetCompressionDictionarySize()) != 0)) {
+      // The baskets can only be decompressed with the dictionary they were compressed with.
+      fWarningMsg.Form("The export branch and the import branch do not have the same compression dictionary. (The branch name is %s.)",
+                       from->GetName());
+      if (!(fOptions & kNoWarnings)) {
+         Warning("TTreeCloner::CollectBranches", "%s", fWarningMsg.Data());
+      }
+      fIsValid = kFALSE;
+      return 0;
+   }
    if (from->InheritsFrom(TBranchClones::Class())) {
       TBranchClones *fromclones = (TBranchClones*) from;
       TBranchClones *toclones = (TBranchClones*) to;
@@ -509,7 +527,7 @@ void TTreeCloner::CopyMemoryBaskets()
       if (basket) {
          basket = (TBasket*)basket->Clone();
          basket->SetBranch(to);
-         to->AddBasket(*basket, kFALSE, fToStartEntries+from->GetBasketEntry()[from->GetWriteBasket()]);
+         to->AddClonedBasket(*basket, kFALSE, fToStartEntries+from->GetBasketEntry()[from->GetWriteBasket()], from, from->GetWriteBasket());
       } else {
          to->AddLastBasket(  fToStartEntries+from->GetBasketEntry()[from->GetWriteBasket()] );
       }
@@ -641,13 +659,13 @@ void TTreeCloner::WriteBaskets()
          basket->LoadBasketBuffers(pos,len,fromfile,fFromTree);
          basket->IncrementPidOffset(fPidOffset);
          basket->CopyTo(tofile);
-         to->AddBasket(*basket,kTRUE,fToStartEntries + from->GetBasketEntry()[index]);
+         to->AddClonedBasket(*basket,kTRUE,fToStartEntries + from->GetBasketEntry()[index], from, index);
       } else {
          TBasket *frombasket = from->GetBasket( index );
          if (frombasket && frombasket->GetNevBuf()>0) {
             TBasket *tobasket = (TBasket*)frombasket->Clone();
             tobasket->SetBranch(to);
-            to->AddBasket(*tobasket, kFALSE, fToStartEntries+from->GetBasketEntry()[index]);
+            to->AddClonedBasket(*tobasket, kFALSE, fToStartEntries+from->GetBasketEntry()[index], from, index);
             to->FlushOneBasket(to->GetWriteBasket());
          }
       }
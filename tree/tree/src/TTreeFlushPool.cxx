@@ -0,0 +1,278 @@
+// @(#)root/tree:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2012, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TTreeFlushPool                                                       //
+//                                                                      //
+// Pool of threads compressing the full baskets of a TTree.             //
+//                                                                      //
+// When a TTree has a flush pool (see TTree::SetParallelFlush), the     //
+// baskets filled by TBranch::Fill and TBranch::FlushBaskets are not    //
+// compressed and written by the thread filling the tree. They are      //
+// handed over to the pool instead (Submit) and compressed by one of    //
+// its threads, while the filling thread moves on to a fresh basket.    //
+//                                                                      //
+// The compressed baskets are written to the file (Commit) by the       //
+// thread filling the tree, in the order they were submitted, so that   //
+// the layout of the file does not depend on the scheduling of the      //
+// threads. The on-disk format is unchanged.                            //
+// TTree::Fill writes the baskets which are ready, TTree::FlushBaskets  //
+// (and hence AutoSave and Write) waits for all of them. While waiting, //
+// the filling thread compresses queued baskets itself.                 //
+//                                                                      //
+// The memory used by the baskets waiting to be written is bounded by   //
+// SetMaxQueuedBytes (default 100 MBytes); above this limit TTree::Fill //
+// waits for the oldest baskets to be written.                          //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#include "TTreeFlushPool.h"
+#include "TTree.h"
+#include "TBranch.h"
+#include "TBasket.h"
+#include "TBufferFile.h"
+#include "TVirtualMutex.h"
+#include "TThread.h"
+#include "TCondition.h"
+#include "TMutex.h"
+#include "TString.h"
+
+extern "C" int R__ZipMode;
+
+ClassImp(TTreeFlushPool)
+
+//______________________________________________________________________________
+TTreeFlushPool::TTreeFlushPool(TTree *tree, Int_t nthreads) :
+   fTree(tree),
+   fActive(kTRUE),
+   fMutex(0),
+   fStartCondition(0),
+   fDoneCondition(0),
+   fQueuedBytes(0),
+   fMaxQueuedBytes(100000000),
+   fNSubmitted(0),
+   fNCompressedMain(0),
+   fNWaits(0)
+{
+   // Create a pool of nthreads compression threads for the baskets of tree.
+
+   fMutex          = new TMutex(kTRUE);
+   fStartCondition = new TCondition(fMutex);
+   fDoneCondition  = new TCondition(fMutex);
+
+   if (nthreads < 1) nthreads = 1;
+   for (Int_t i = 0; i < nthreads; ++i) {
+      TString nm("FlushLoop");
+      nm += i;
+      TThread *th = new TThread(nm.Data(), FlushLoop, (void*)this);
+      if (th->Run()) {
+         Error("TTreeFlushPool", "Unable to start thread '%s'", nm.Data());
+         delete th;
+         break;
+      }
+      fThreads.push_back(th);
+   }
+}
+
+//______________________________________________________________________________
+TTreeFlushPool::~TTreeFlushPool()
+{
+   // Destructor. Stop the threads. The baskets which were not committed
+   // are lost; TTree calls Commit before deleting its flush pool.
+
+   {
+      R__LOCKGUARD(fMutex);
+      fActive = kFALSE;
+      fStartCondition->Broadcast();
+   }
+   for (UInt_t i = 0; i < fThreads.size(); ++i) {
+      if (fThreads[i]->Exists()) {
+         fThreads[i]->Join();
+      }
+      delete fThreads[i];
+   }
+   fThreads.clear();
+
+   while (!fTasks.empty()) {
+      TFlushTask *task = fTasks.front();
+      fTasks.pop_front();
+      delete task->fBasket;
+      delete task;
+   }
+   fQueue.clear();
+
+   delete fStartCondition;
+   delete fDoneCondition;
+   delete fMutex;
+}
+
+//______________________________________________________________________________
+Int_t TTreeFlushPool::Commit(Bool_t wait)
+{
+   // Write to the file, in submission order, the baskets whose compression
+   // is finished.
+   // If wait is true, wait for all the baskets submitted so far to be
+   // compressed and written. Otherwise only wait if the size of the baskets
+   // waiting to be written exceeds the limit set by SetMaxQueuedBytes.
+   // In both cases, rather than waiting idle, the calling thread compresses
+   // the baskets which were not yet picked up by a compression thread.
+   //
+   // Must be called by the thread filling the tree.
+   // Returns the number of bytes written or -1 in case of write error.
+
+   Int_t nbytes = 0;
+   Int_t nerror = 0;
+   while (1) {
+      TFlushTask *task = 0;
+      TFlushTask *help = 0;
+      {
+         R__LOCKGUARD(fMutex);
+         if (fTasks.empty()) break;
+         if (fTasks.front()->fStatus == kCompressed) {
+            task = fTasks.front();
+            fTasks.pop_front();
+            fQueuedBytes -= task->fSize;
+         } else if (!wait && fQueuedBytes <= fMaxQueuedBytes) {
+            break;
+         } else if (!fQueue.empty()) {
+            help = fQueue.front();
+            fQueue.pop_front();
+            help->fStatus = kCompressing;
+            ++fNCompressedMain;
+         } else {
+            ++fNWaits;
+            fDoneCondition->Wait();
+            continue;
+         }
+      }
+      if (help) {
+         Compress(help);
+         continue;
+      }
+      TBranch *branch = task->fBasket->GetBranch();
+      Int_t nwrite = branch->WriteCompressedBasket(task->fBasket, task->fWhere, task->fNout);
+      if (nwrite < 0) {
+         ++nerror;
+      } else {
+         nbytes += nwrite;
+      }
+      delete task;
+   }
+   if (nerror) {
+      return -1;
+   }
+   return nbytes;
+}
+
+//______________________________________________________________________________
+void TTreeFlushPool::Compress(TFlushTask *task)
+{
+   // Compress the basket of task and mark it as ready to be written.
+
+   Int_t nout = task->fBasket->CompressBuffer();
+
+   R__LOCKGUARD(fMutex);
+   task->fNout   = nout;
+   task->fStatus = kCompressed;
+   fDoneCondition->Broadcast();
+}
+
+//______________________________________________________________________________
+void *TTreeFlushPool::FlushLoop(void *arg)
+{
+   // This is a static function.
+   // Main loop of the compression threads: compress the queued baskets
+   // until the pool is deleted.
+
+   TTreeFlushPool *pool = (TTreeFlushPool*)arg;
+
+   TThread::SetCancelOn();
+   TThread::SetCancelDeferred();
+
+   TFlushTask *task;
+   while ((task = pool->NextTask())) {
+      pool->Compress(task);
+   }
+   return (void *)0;
+}
+
+//______________________________________________________________________________
+TTreeFlushPool::TFlushTask *TTreeFlushPool::NextTask()
+{
+   // Wait for a basket to compress. Returns 0 when the pool is being deleted.
+
+   R__LOCKGUARD(fMutex);
+   while (fActive && fQueue.empty()) {
+      fStartCondition->Wait();
+   }
+   if (!fActive || fQueue.empty()) {
+      return 0;
+   }
+   TFlushTask *task = fQueue.front();
+   fQueue.pop_front();
+   task->fStatus = kCompressing;
+   return task;
+}
+
+//______________________________________________________________________________
+void TTreeFlushPool::Print(Option_t *) const
+{
+   // Print the statistics of the pool.
+
+   printf("******TreeFlushPool statistics for tree: %s ******\n",fTree ? fTree->GetName() : "");
+   printf("Number of compression threads: %d\n", (Int_t)fThreads.size());
+   printf("Max allowed mem for pending baskets: %lld\n", fMaxQueuedBytes);
+   printf("Number of baskets submitted: %d\n", fNSubmitted);
+   printf("Number of baskets compressed by the filling thread: %d\n", fNCompressedMain);
+   printf("Number of waits for a basket to be compressed: %d\n", fNWaits);
+   printf("Number of baskets waiting to be written: %d\n", (Int_t)fTasks.size());
+}
+
+//______________________________________________________________________________
+Int_t TTreeFlushPool::Submit(TBasket *basket, Int_t where)
+{
+   // Hand the full basket number 'where' of its branch over to the pool.
+   //
+   // Returns 0 if the pool took ownership of the basket. Otherwise the basket
+   // must be written directly with TBasket::WriteBuffer: the function returns
+   // 1 when there is nothing to gain from the pool (no compression, basket
+   // transfered without decompression or use of the old compression algorithm,
+   // which is not reentrant) and -1 in case of error.
+
+   TBranch *branch = basket->GetBranch();
+   if (branch->GetCompressionLevel() <= 0) {
+      return 1;
+   }
+   Int_t algorithm = branch->GetCompressionAlgorithm();
+   if (algorithm == 0) algorithm = R__ZipMode;
+   if (algorithm == 0 || algorithm == 3) {
+      return 1;
+   }
+   Int_t status = basket->PrepareParallelWrite(where);
+   if (status) {
+      return status;
+   }
+
+   TFlushTask *task = new TFlushTask;
+   task->fBasket = basket;
+   task->fWhere  = where;
+   task->fSize   = basket->GetBufferRef()->Length();
+   task->fNout   = -1;
+   task->fStatus = kQueued;
+
+   R__LOCKGUARD(fMutex);
+   fQueue.push_back(task);
+   fTasks.push_back(task);
+   fQueuedBytes += task->fSize;
+   ++fNSubmitted;
+   fStartCondition->Signal();
+   return 0;
+}
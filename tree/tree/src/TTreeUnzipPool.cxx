@@ -0,0 +1,302 @@
+// @(#)root/tree:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2012, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TTreeUnzipPool                                                       //
+//                                                                      //
+// Process-wide pool of threads unzipping the baskets prefetched by     //
+// the TTreeCacheUnzip instances.                                       //
+//                                                                      //
+// A single pool is shared by all the caches of the process (for        //
+// example one per file of a TChain), so that the number of unzipping  //
+// threads does not grow with the number of open trees. The pool is     //
+// created the first time a TTreeCacheUnzip needs it; its size can be   //
+// changed beforehand with TTreeUnzipPool::SetNThreads (by default the  //
+// number of cores minus one).                                          //
+//                                                                      //
+// Each thread has its own queue of blocks. When a cache has read a     //
+// cluster, it submits its blocks sorted by the first entry of their    //
+// basket, spreading them over the queues. A thread unzips the blocks   //
+// of its own queue starting from the most urgent one, and when its     //
+// queue is empty it steals the least urgent block of another queue.    //
+// The queues are protected by one mutex each, so that the threads of   //
+// the pool and the caches do not compete for a single lock.            //
+//                                                                      //
+// The unzipping itself, as well as the bookkeeping of the blocks, is   //
+// done by TTreeCacheUnzip::UnzipBlock.                                 //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#include "TTreeUnzipPool.h"
+#include "TTreeCacheUnzip.h"
+#include "TVirtualMutex.h"
+#include "TThread.h"
+#include "TCondition.h"
+#include "TMutex.h"
+#include "TSystem.h"
+#include "TString.h"
+
+TTreeUnzipPool *TTreeUnzipPool::fgInstance = 0;
+Int_t TTreeUnzipPool::fgNThreads = 0;
+
+static TVirtualMutex *gUnzipPoolMutex = 0;
+
+ClassImp(TTreeUnzipPool)
+
+//______________________________________________________________________________
+TTreeUnzipPool::TTreeUnzipPool(Int_t nthreads) :
+   fActive(kTRUE),
+   fIdleMutex(0),
+   fIdleCondition(0),
+   fNQueued(0),
+   fNext(0),
+   fNSubmitted(0),
+   fNStolen(0),
+   fNCancelled(0)
+{
+   // Create a pool of nthreads unzipping threads.
+   // Use TTreeUnzipPool::Instance to get the pool shared by all the caches.
+
+   fIdleMutex     = new TMutex(kTRUE);
+   fIdleCondition = new TCondition(fIdleMutex);
+
+   if (nthreads < 1) nthreads = 1;
+
+   // Create all the queues before starting the first thread, since
+   // the threads look into the queues of the others.
+   for (Int_t i = 0; i < nthreads; ++i) {
+      TWorker *worker     = new TWorker;
+      worker->fPool       = this;
+      worker->fId         = i;
+      worker->fThread     = 0;
+      worker->fMutex      = new TMutex(kTRUE);
+      worker->fBuffer     = new char[16384];
+      worker->fBufferSize = 16384;
+      fWorkers.push_back(worker);
+   }
+
+   if (gDebug > 0)
+      Info("TTreeUnzipPool", "Going to start %d threads.", nthreads);
+
+   for (Int_t i = 0; i < nthreads; ++i) {
+      TString nm("UnzipLoop");
+      nm += i;
+      TThread *th = new TThread(nm.Data(), UnzipLoop, (void*)fWorkers[i]);
+      if (th->Run()) {
+         Error("TTreeUnzipPool", "Unable to start thread '%s'", nm.Data());
+         delete th;
+         continue;
+      }
+      fWorkers[i]->fThread = th;
+   }
+}
+
+//______________________________________________________________________________
+TTreeUnzipPool::~TTreeUnzipPool()
+{
+   // Destructor. Stop the threads. The caches must have cancelled
+   // their blocks before (see TTreeCacheUnzip::~TTreeCacheUnzip).
+
+   {
+      R__LOCKGUARD(fIdleMutex);
+      fActive = kFALSE;
+      fIdleCondition->Broadcast();
+   }
+   for (UInt_t i = 0; i < fWorkers.size(); ++i) {
+      TWorker *worker = fWorkers[i];
+      if (worker->fThread) {
+         if (worker->fThread->Exists()) {
+            worker->fThread->Join();
+         }
+         delete worker->fThread;
+      }
+      delete worker->fMutex;
+      delete [] worker->fBuffer;
+      delete worker;
+   }
+   fWorkers.clear();
+
+   delete fIdleCondition;
+   delete fIdleMutex;
+   if (fgInstance == this) fgInstance = 0;
+}
+
+//______________________________________________________________________________
+Int_t TTreeUnzipPool::Cancel(TTreeCacheUnzip *cache)
+{
+   // Remove from the queues all the blocks of cache which were not yet
+   // picked up by a thread. The blocks being unzipped are not affected.
+   // Returns the number of blocks removed.
+
+   Int_t ncancel = 0;
+   for (UInt_t i = 0; i < fWorkers.size(); ++i) {
+      TWorker *worker = fWorkers[i];
+      R__LOCKGUARD(worker->fMutex);
+      std::deque<TUnzipTask>::iterator it = worker->fTasks.begin();
+      while (it != worker->fTasks.end()) {
+         if (it->fCache == cache) {
+            it = worker->fTasks.erase(it);
+            ++ncancel;
+         } else {
+            ++it;
+         }
+      }
+   }
+   if (ncancel) {
+      R__LOCKGUARD(fIdleMutex);
+      fNQueued    -= ncancel;
+      fNCancelled += ncancel;
+   }
+   return ncancel;
+}
+
+//______________________________________________________________________________
+TTreeUnzipPool *TTreeUnzipPool::Instance()
+{
+   // Static function returning the pool shared by all the caches,
+   // creating it if needed.
+
+   R__LOCKGUARD2(gUnzipPoolMutex);
+
+   if (!fgInstance) {
+      Int_t nthreads = fgNThreads;
+      if (nthreads <= 0) {
+         SysInfo_t info;
+         gSystem->GetSysInfo(&info);
+         nthreads = info.fCpus > 1 ? info.fCpus - 1 : 1;
+      }
+      fgInstance = new TTreeUnzipPool(nthreads);
+   }
+   return fgInstance;
+}
+
+//______________________________________________________________________________
+Bool_t TTreeUnzipPool::NextTask(TWorker *worker, TUnzipTask &task)
+{
+   // Get the next block to unzip for worker: the first block of its own
+   // queue or, if it is empty, the last block of the queue of another
+   // worker. Wait if all the queues are empty.
+   // Returns kFALSE when the pool is being deleted.
+
+   Int_t nworkers = (Int_t)fWorkers.size();
+   while (1) {
+      Bool_t found  = kFALSE;
+      Bool_t stolen = kFALSE;
+      {
+         R__LOCKGUARD(worker->fMutex);
+         if (!worker->fTasks.empty()) {
+            task = worker->fTasks.front();
+            worker->fTasks.pop_front();
+            found = kTRUE;
+         }
+      }
+      for (Int_t i = 1; !found && i < nworkers; ++i) {
+         TWorker *victim = fWorkers[(worker->fId + i) % nworkers];
+         R__LOCKGUARD(victim->fMutex);
+         if (!victim->fTasks.empty()) {
+            task = victim->fTasks.back();
+            victim->fTasks.pop_back();
+            found  = kTRUE;
+            stolen = kTRUE;
+         }
+      }
+
+      R__LOCKGUARD(fIdleMutex);
+      if (found) {
+         --fNQueued;
+         if (stolen) ++fNStolen;
+         return kTRUE;
+      }
+      while (fActive && fNQueued <= 0) {
+         fIdleCondition->Wait();
+      }
+      if (!fActive) return kFALSE;
+   }
+   return kFALSE;
+}
+
+//______________________________________________________________________________
+void TTreeUnzipPool::Print(Option_t *) const
+{
+   // Print the statistics of the pool.
+
+   printf("******TreeUnzipPool statistics ******\n");
+   printf("Number of unzipping threads: %d\n", (Int_t)fWorkers.size());
+   printf("Number of blocks submitted: %lld\n", fNSubmitted);
+   printf("Number of blocks stolen: %lld\n", fNStolen);
+   printf("Number of blocks cancelled: %lld\n", fNCancelled);
+   printf("Number of blocks waiting: %d\n", fNQueued);
+}
+
+//______________________________________________________________________________
+void TTreeUnzipPool::SetNThreads(Int_t nthreads)
+{
+   // Static function setting the number of threads of the pool.
+   // If nthreads <= 0 the number of cores minus one is used.
+   // This must be called before the first TTreeCacheUnzip starts
+   // unzipping, the size of an existing pool is not changed.
+
+   fgNThreads = nthreads;
+}
+
+//______________________________________________________________________________
+void TTreeUnzipPool::Submit(TTreeCacheUnzip *cache, Int_t cycle, Int_t n, const Int_t *index)
+{
+   // Queue the n blocks index[0..n-1] of cache. The blocks must be sorted
+   // by decreasing urgency; consecutive blocks go to different threads so
+   // that the most urgent ones are unzipped first.
+
+   if (n <= 0 || fWorkers.empty()) return;
+
+   Int_t nworkers = (Int_t)fWorkers.size();
+   UInt_t first;
+   {
+      R__LOCKGUARD(fIdleMutex);
+      first = fNext;
+      fNext = (fNext + n) % nworkers;
+   }
+   for (Int_t w = 0; w < nworkers && w < n; ++w) {
+      TWorker *worker = fWorkers[(first + w) % nworkers];
+      R__LOCKGUARD(worker->fMutex);
+      for (Int_t i = w; i < n; i += nworkers) {
+         TUnzipTask task;
+         task.fCache = cache;
+         task.fIndex = index[i];
+         task.fCycle = cycle;
+         worker->fTasks.push_back(task);
+      }
+   }
+
+   R__LOCKGUARD(fIdleMutex);
+   fNQueued    += n;
+   fNSubmitted += n;
+   fIdleCondition->Broadcast();
+}
+
+//______________________________________________________________________________
+void *TTreeUnzipPool::UnzipLoop(void *arg)
+{
+   // This is a static function.
+   // Main loop of the unzipping threads: unzip the queued blocks until the
+   // pool is deleted.
+
+   TWorker *worker = (TWorker*)arg;
+   TTreeUnzipPool *pool = worker->fPool;
+
+   TThread::SetCancelOn();
+   TThread::SetCancelDeferred();
+
+   TUnzipTask task;
+   while (pool->NextTask(worker, task)) {
+      task.fCache->UnzipBlock(task.fIndex, task.fCycle, worker->fBufferSize, worker->fBuffer);
+   }
+   return (void *)0;
+}
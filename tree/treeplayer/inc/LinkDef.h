@@ -25,6 +25,10 @@
 #pragma link C++ class TTreeDrawArgsParser+;
 #pragma link C++ class TTreePerfStats+;
 #pragma link C++ class TTreeTableInterface;
+#pragma link C++ class TBasketStatsFilter;
+#pragma link C++ class TRangeIndexRun;
+#pragma link C++ class TSelectorRangeIndex;
+#pragma link C++ class TTreeRangeIndex;
 
 #pragma link C++ namespace ROOT;
 
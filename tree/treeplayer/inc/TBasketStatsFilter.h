@@ -0,0 +1,75 @@
+// @(#)root/treeplayer:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2012, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TBasketStatsFilter
+#define ROOT_TBasketStatsFilter
+
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TBasketStatsFilter                                                   //
+//                                                                      //
+// Use the range of the values of the baskets (see                      //
+// TBranch::SetBasketStats) to find the entries unable to pass the      //
+// simple cuts of a selection without reading them.                     //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef ROOT_TObject
+#include "TObject.h"
+#endif
+#ifndef ROOT_TString
+#include "TString.h"
+#endif
+
+#include <vector>
+
+class TTree;
+class TBranch;
+
+class TBasketStatsFilter : public TObject {
+
+private:
+   enum ECutOp { kLess, kLessEqual, kGreater, kGreaterEqual, kEqual };
+   struct TStatsCut {
+      TString   fName;     // Name of the leaf or branch
+      Int_t     fOp;       // One of ECutOp
+      Double_t  fValue;    // Value the leaf is compared to
+      TBranch  *fBranch;   // Branch holding the ranges in the current tree, 0 if none
+   };
+
+   TTree                  *fTree;      //! Tree or chain whose entries are filtered
+   TTree                  *fCurrent;   //! Tree whose branches are used
+   std::vector<TStatsCut>  fCuts;      //! Simple cuts found in the selection
+   Bool_t                  fActive;    //! True if at least one cut has ranges in the current tree
+   Long64_t                fFirst;     //! First entry of the range whose result is known
+   Long64_t                fLast;      //! Last entry + 1 of the range whose result is known
+   Bool_t                  fPass;      //! Result for the entries of this range
+   Long64_t                fNSkipped;  //! Number of entries skipped
+
+   TBasketStatsFilter(const TBasketStatsFilter&);            // not implemented
+   TBasketStatsFilter& operator=(const TBasketStatsFilter&); // not implemented
+
+   Bool_t       AddCut(const TString &term);
+   Bool_t       AddSelection(const TString &selection);
+
+public:
+   TBasketStatsFilter(TTree *tree, const char *selection);
+   virtual ~TBasketStatsFilter() {}
+
+   Int_t        GetNcuts() const { return (Int_t)fCuts.size(); }
+   Long64_t     GetNSkipped() const { return fNSkipped; }
+   Bool_t       MayPass(Long64_t entry);
+   void         Update();
+
+   ClassDef(TBasketStatsFilter,0)  //Skip the baskets unable to pass the simple cuts of a selection
+};
+
+#endif
@@ -29,6 +29,7 @@ class TTreeFormula;
 class TTreeFormulaManager;
 class TH1;
 class TEntryListArray;
+class TBasketStatsFilter;
 
 class TSelectorDraw : public TSelector {
 
@@ -39,6 +40,7 @@ protected:
    TTreeFormula **fVar;            //![fDimension] Array of pointers to variables formula
    TTreeFormula  *fSelect;         //  Pointer to selection formula
    TTreeFormulaManager *fManager;  //  Pointer to the formula manager
+   TBasketStatsFilter *fBasketFilter; //! Skip the baskets unable to pass the selection
    TObject       *fTreeElist;      //  pointer to Tree Event list
    TEntryListArray *fTreeElistArray;   //!  pointer to Tree Event list array
    TH1           *fOldHistogram;   //! Pointer to previously used histogram
@@ -109,6 +111,7 @@ public:
    virtual Double_t *GetW() const    {return fW;}
    virtual Bool_t    Notify();
    virtual Bool_t    Process(Long64_t /*entry*/) { return kFALSE; }
+   virtual Bool_t    ProcessCut(Long64_t entry);
    virtual void      ProcessFill(Long64_t entry);
    virtual void      ProcessFillMultiple(Long64_t entry);
    virtual void      ProcessFillObject(Long64_t entry);
@@ -0,0 +1,92 @@
+// @(#)root/treeplayer:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2012, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TSelectorRangeIndex
+#define ROOT_TSelectorRangeIndex
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TSelectorRangeIndex                                                  //
+//                                                                      //
+// A specialized TSelector for TTreeRangeIndex::Build.                  //
+// It evaluates an expression for all the entries of a tree and stores  //
+// the values, with their entry number, in sorted runs (TRangeIndexRun) //
+// added to the output list. The full runs are spilled to temporary     //
+// files, so that only one run per thread is kept in memory.            //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef ROOT_TSelector
+#include "TSelector.h"
+#endif
+#ifndef ROOT_TNamed
+#include "TNamed.h"
+#endif
+
+#include <stdio.h>
+#include <vector>
+
+class TTree;
+class TTreeFormula;
+
+class TRangeIndexRun : public TNamed {
+private:
+   TRangeIndexRun(const TRangeIndexRun&);            // Not implemented.
+   TRangeIndexRun &operator=(const TRangeIndexRun&); // Not implemented.
+
+public:
+   std::vector<Double_t>  fValues;   // Values in increasing order (current chunk once spilled)
+   std::vector<Long64_t>  fEntries;  // Entry number of each value
+   TString                fFileName; // Temporary file of the spilled values, empty if none
+   FILE                  *fFile;     //! Temporary file opened by Rewind
+   Long64_t               fN;        // Number of values written to the temporary file
+   size_t                 fPos;      //! Position of the next value returned by Next
+
+   enum { kChunkSize = 8192 };       // Number of values read or written at once
+
+   TRangeIndexRun(const char *name = "");
+   virtual ~TRangeIndexRun();
+   Long64_t GetN() const;
+   Bool_t   IsSpilled() const { return fFileName.Length() > 0; }
+   Bool_t   Next(Double_t &value, Long64_t &entry);
+   Bool_t   Rewind();
+   Bool_t   Spill();
+
+   ClassDef(TRangeIndexRun,0)  //Sorted run of the values of a TTreeRangeIndex
+};
+
+class TSelectorRangeIndex : public TSelector {
+public :
+   TTree                 *fChain;       //! Pointer to the analyzed TTree or TChain
+   TTreeFormula          *fFormula;     //! Expression to index
+   Long64_t               fRunSize;     //  Number of values sorted at once
+   Long64_t               fOffset;      //  Entry number of the first entry of the current tree
+   Long64_t               fTreeEntries; //  Number of entries of the current tree
+   Bool_t                 fCountTrees;  //  True if each tree of a chain is seen separately
+   Int_t                  fNRuns;       //  Number of runs produced
+   std::vector<Double_t>  fValues;      //! Values of the current run
+   std::vector<Long64_t>  fEntries;     //! Entry numbers of the current run
+
+   TSelectorRangeIndex();
+   virtual ~TSelectorRangeIndex();
+   virtual Int_t    Version() const { return 2; }
+   virtual void     Begin(TTree *tree);
+   virtual void     SlaveBegin(TTree *tree);
+   virtual void     Init(TTree *tree);
+   virtual Bool_t   Notify();
+   virtual Bool_t   Process(Long64_t entry);
+   virtual void     FlushRun(Bool_t spill = kFALSE);
+   virtual void     SlaveTerminate();
+   virtual void     Terminate() {}
+
+   ClassDef(TSelectorRangeIndex,0); //A specialized TSelector for TTreeRangeIndex::Build
+};
+
+#endif
@@ -120,6 +120,12 @@ protected:
    Bool_t                    fDidBooleanOptimization;  //! True if we executed one boolean optimization since the last time instance number 0 was evaluated
    TTreeFormulaManager      *fManager;        //! The dimension coordinator.
 
+   // Members used by the compiled evaluation (see CompileJIT)
+   typedef Double_t (*JITFunc_t)(void **values);
+   JITFunc_t                 fJITFunc;        //! Compiled evaluation function, 0 if not available
+   Int_t                     fJITStatus;      //! 0: not compiled yet, 1: compiled, -1: cannot be compiled
+   static Int_t              fgJIT;           //  1: compile the formulas, 0: do not, -1: use TTreeFormula.JIT from gEnv
+
    // Helper members and function used during the construction and parsing
    TList                    *fDimensionSetup; //! list of dimension setups, for delayed creation of the dimension information.
    std::vector<std::string>  fAliasesUsed;    //! List of aliases used during the parsing of the expression.
@@ -127,6 +133,7 @@ protected:
    TTreeFormula(const char *name, const char *formula, TTree *tree, const std::vector<std::string>& aliases);
    void Init(const char *name, const char *formula);
    Bool_t      BranchHasMethod(TLeaf* leaf, TBranch* branch, const char* method,const char* params, Long64_t readentry) const;
+   Bool_t      CompileJIT();
    Int_t       DefineAlternate(const char* expression);
    void        DefineDimensions(Int_t code, Int_t size, TFormLeafInfoMultiVarDim * info, Int_t& virt_dim);
    Int_t       FindLeafForExpression(const char* expression, TLeaf *&leaf, TString &leftover, Bool_t &final, UInt_t &paran_level, TObjArray &castqueue, std::vector<std::string>& aliasUsed, Bool_t &useLeafCollectionObject, const char *fullExpression);
@@ -185,11 +192,14 @@ public:
    //NOTE: Also modify the code in PrintValue which current goes around this limitation :(
    virtual Bool_t      IsInteger(Bool_t fast=kTRUE) const;
            Bool_t      IsQuickLoad() const { return fQuickLoad; }
+   static  Bool_t      IsJIT();
+           Bool_t      IsJITCompiled() const { return fJITStatus > 0; }
    virtual Bool_t      IsString() const;
    virtual Bool_t      Notify() { UpdateFormulaLeaves(); return kTRUE; }
    virtual char       *PrintValue(Int_t mode=0) const;
    virtual char       *PrintValue(Int_t mode, Int_t instance, const char *decform = "9.9") const;
    virtual void        SetAxis(TAxis *axis=0);
+   static  void        SetJIT(Bool_t jit=kTRUE);
            void        SetQuickLoad(Bool_t quick) { fQuickLoad = quick; }
    virtual void        SetTree(TTree *tree) {fTree = tree;}
    virtual void        ResetLoading();
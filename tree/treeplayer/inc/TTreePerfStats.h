@@ -51,6 +51,7 @@ protected:
    Double_t      fCpuTime;       //Cpu time
    Double_t      fDiskTime;      //Time spent in pure raw disk IO
    Double_t      fUnzipTime;     //Time spent uncompressing the data.
+   Double_t      fStallTime;     //Time spent waiting for the baskets of the TTreeCache
    Double_t      fCompress;      //Tree compression factor      
    TString       fName;          //name of this TTreePerfStats
    TString       fHostInfo;      //name of the host system, ROOT version and date
@@ -86,6 +87,7 @@ public:
    virtual Int_t    GetReadaheadSize() const {return fReadaheadSize;}
    virtual Int_t    GetReadCalls() const {return fReadCalls;}
    virtual Double_t GetRealTime()  const {return fRealTime;}
+   virtual Double_t GetStallTime() const {return fStallTime;}
    TStopwatch      *GetStopwatch() const {return fWatch;}
    virtual Int_t    GetTreeCacheSize() const {return fTreeCacheSize;}
    virtual Double_t GetUnzipTime() const {return fUnzipTime; }
@@ -118,10 +120,11 @@ public:
    virtual void     SetReadCalls(Int_t ncalls) {fReadCalls = ncalls;}
    virtual void     SetRealNorm(Double_t rnorm) {fRealNorm = rnorm;}
    virtual void     SetRealTime(Double_t rtime) {fRealTime = rtime;}
+   virtual void     SetStallTime(Double_t t) {fStallTime = t;}
    virtual void     SetTreeCacheSize(Int_t nbytes) {fTreeCacheSize = nbytes;}
    virtual void     SetUnzipTime(Double_t uztime) {fUnzipTime = uztime;}
 
-   ClassDef(TTreePerfStats,1)  // TTree I/O performance measurement
+   ClassDef(TTreePerfStats,2)  // TTree I/O performance measurement
 };
 
 #endif
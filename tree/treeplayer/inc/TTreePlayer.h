@@ -61,6 +61,7 @@ protected:
    TSelector     *fSelectorUpdate;  //! Set to the selector address when it's entry list needs to be updated by the UpdateFormulaLeaves function
 
 protected:
+   Bool_t         CanProcessParallel(TSelector *selector) const;
    const   char  *GetNameByIndex(TString &varexp, Int_t *index,Int_t colindex);
    void           TakeAction(Int_t nfill, Int_t &npoints, Int_t &action, TObject *obj, Option_t *option);
    void           TakeEstimate(Int_t nfill, Int_t &npoints, Int_t action, TObject *obj, Option_t *option);
@@ -119,6 +120,7 @@ public:
                                ,Long64_t nentries, Long64_t firstentry);
    virtual Long64_t  Process(const char *filename,Option_t *option, Long64_t nentries, Long64_t firstentry);
    virtual Long64_t  Process(TSelector *selector,Option_t *option,  Long64_t nentries, Long64_t firstentry);
+   virtual Long64_t  ProcessParallel(TSelector *selector,Option_t *option,  Long64_t nentries, Long64_t firstentry);
    virtual void      RecursiveRemove(TObject *obj);
    virtual Long64_t  Scan(const char *varexp, const char *selection, Option_t *option
                           ,Long64_t nentries, Long64_t firstentry);
@@ -0,0 +1,63 @@
+// @(#)root/treeplayer:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2012, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TTreeRangeIndex
+#define ROOT_TTreeRangeIndex
+
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TTreeRangeIndex                                                      //
+//                                                                      //
+// A sorted index of the values of an expression of a tree, stored in a //
+// TTree, answering range queries with a TEntryList.                    //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef ROOT_TNamed
+#include "TNamed.h"
+#endif
+
+class TTree;
+class TBranch;
+class TEntryList;
+
+class TTreeRangeIndex : public TNamed {
+
+protected:
+   TTree      *fIndexTree;    //! Values in increasing order, with their entry number
+   TBranch    *fValueBranch;  //! Branch of the values in fIndexTree
+   TBranch    *fEntryBranch;  //! Branch of the entry numbers in fIndexTree
+   Double_t    fValue;        //! Value of the current entry of fIndexTree
+   Long64_t    fEntry;        //! Entry number of the current entry of fIndexTree
+
+private:
+   TTreeRangeIndex(const TTreeRangeIndex&);            // Not implemented.
+   TTreeRangeIndex &operator=(const TTreeRangeIndex&); // Not implemented.
+
+public:
+   TTreeRangeIndex();
+   TTreeRangeIndex(TTree *indextree);
+   virtual              ~TTreeRangeIndex() {}
+
+   static TTreeRangeIndex *Build(TTree *tree, const char *expression, const char *name = 0, Long64_t runsize = 0);
+
+   Long64_t              FindFirst(Double_t value);
+   TEntryList           *GetEntryList(TTree *tree, Double_t min, Double_t max);
+   Long64_t              GetEntryNumberWithValue(Double_t value);
+   const char           *GetExpression() const { return GetTitle(); }
+   TTree                *GetIndexTree() const { return fIndexTree; }
+   Long64_t              GetN() const;
+   virtual void          Print(Option_t *option = "") const;
+
+   ClassDef(TTreeRangeIndex,0);  //A sorted index of the values of an expression of a tree
+};
+
+#endif
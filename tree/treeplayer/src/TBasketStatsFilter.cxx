@@ -0,0 +1,292 @@
+// @(#)root/treeplayer:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2012, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TBasketStatsFilter                                                   //
+//                                                                      //
+// Skip the entries of a tree unable to pass a selection, using only    //
+// the range of the values of the baskets recorded at fill time for     //
+// the branches with TBranch::SetBasketStats (or TTree::SetBasketStats).//
+//                                                                      //
+// The selection is split in its terms joined by "&&" at the top level. //
+// The terms comparing a leaf to a number, like "pt>100", "n<=3",       //
+// "100<pt" or "id==11" (with <, <=, >, >= or ==), are used as cuts.    //
+// The other terms are ignored, and the filter is not used at all if    //
+// the selection has a "||" at the top level. An entry MayPass unless   //
+// one of the cuts is impossible for the range of the basket of its     //
+// leaf holding the entry: the entries for which MayPass returns kFALSE //
+// would be rejected by the selection, the other ones must still be     //
+// tested with the full selection.                                      //
+//                                                                      //
+// The result is kept for the range of entries sharing the same         //
+// baskets, so that MayPass is cheap enough to be called for each       //
+// entry. TSelectorDraw (for TTree::Draw) and TTreePlayer::CopyTree     //
+// call it before evaluating the selection: the baskets of the skipped  //
+// entries are then never read.                                         //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#include "TBasketStatsFilter.h"
+#include "TTree.h"
+#include "TBranch.h"
+#include "TLeaf.h"
+#include "TMath.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+
+ClassImp(TBasketStatsFilter)
+
+//______________________________________________________________________________
+static TString R__StripParentheses(const TString &expr)
+{
+   // Return expr without its surrounding blanks and parentheses.
+
+   TString s = expr.Strip(TString::kBoth);
+   while (s.Length() > 1 && s[0] == '(' && s[s.Length()-1] == ')') {
+      // Check that the first parenthesis is closed by the last one.
+      Int_t depth = 0;
+      Int_t i;
+      for (i = 0; i < s.Length(); ++i) {
+         if (s[i] == '(') ++depth;
+         else if (s[i] == ')' && --depth == 0) break;
+      }
+      if (i != s.Length()-1) break;
+      s = s(1, s.Length()-2);
+      s = s.Strip(TString::kBoth);
+   }
+   return s;
+}
+
+//______________________________________________________________________________
+static Bool_t R__IsLeafName(const TString &s)
+{
+   // Return true if s can only be the name of a leaf or of a branch.
+
+   if (s.Length() == 0) return kFALSE;
+   if (!isalpha(s[0]) && s[0] != '_') return kFALSE;
+   for (Int_t i = 1; i < s.Length(); ++i) {
+      if (!isalnum(s[i]) && s[i] != '_' && s[i] != '.') return kFALSE;
+   }
+   return kTRUE;
+}
+
+//______________________________________________________________________________
+static Bool_t R__IsNumber(const TString &s, Double_t &value)
+{
+   // Return true if s is a number, whose value is then returned in value.
+
+   if (s.Length() == 0) return kFALSE;
+   char *end = 0;
+   value = strtod(s.Data(), &end);
+   return end == s.Data() + s.Length();
+}
+
+//______________________________________________________________________________
+TBasketStatsFilter::TBasketStatsFilter(TTree *tree, const char *selection) :
+   fTree(tree),
+   fCurrent(0),
+   fActive(kFALSE),
+   fFirst(0),
+   fLast(0),
+   fPass(kTRUE),
+   fNSkipped(0)
+{
+   // Create the filter of the entries of tree (a TTree or a TChain) for
+   // selection. The filter has no cut (GetNcuts()==0) if the selection
+   // has no simple term usable with the ranges of the baskets.
+
+   if (selection && selection[0]) {
+      if (!AddSelection(selection)) fCuts.clear();
+   }
+}
+
+//______________________________________________________________________________
+Bool_t TBasketStatsFilter::AddCut(const TString &term)
+{
+   // Add the cut of term if it compares a leaf to a number.
+   // Returns kFALSE if term is not such a comparison.
+
+   TString s = R__StripParentheses(term);
+   Int_t depth = 0;
+   Int_t oppos = -1;
+   Int_t oplen = 0;
+   for (Int_t i = 0; i < s.Length(); ++i) {
+      char c = s[i];
+      if (c == '(' || c == '[') {
+         ++depth;
+      } else if (c == ')' || c == ']') {
+         --depth;
+      } else if (depth == 0 && (c == '<' || c == '>' || c == '=' || c == '!')) {
+         if (oppos >= 0) return kFALSE;   // more than one comparison
+         oppos = i;
+         oplen = (i+1 < s.Length() && s[i+1] == '=') ? 2 : 1;
+         if (c == '!' || (c == '=' && oplen == 1)) return kFALSE;
+         i += oplen - 1;
+      }
+   }
+   if (oppos < 0) return kFALSE;
+
+   TString op    = s(oppos, oplen);
+   TString left  = TString(s(0, oppos)).Strip(TString::kBoth);
+   TString right = TString(s(oppos+oplen, s.Length()-oppos-oplen)).Strip(TString::kBoth);
+   if (right.Length() && (right[0] == '<' || right[0] == '>')) return kFALSE;   // << or >>
+
+   TStatsCut cut;
+   Bool_t mirror;
+   if (R__IsLeafName(left) && R__IsNumber(right, cut.fValue)) {
+      cut.fName = left;
+      mirror = kFALSE;
+   } else if (R__IsNumber(left, cut.fValue) && R__IsLeafName(right)) {
+      cut.fName = right;
+      mirror = kTRUE;
+   } else {
+      return kFALSE;
+   }
+   if (op == "==")      cut.fOp = kEqual;
+   else if (op == "<")  cut.fOp = mirror ? kGreater : kLess;
+   else if (op == "<=") cut.fOp = mirror ? kGreaterEqual : kLessEqual;
+   else if (op == ">")  cut.fOp = mirror ? kLess : kGreater;
+   else                 cut.fOp = mirror ? kLessEqual : kGreaterEqual;
+   cut.fBranch = 0;
+   fCuts.push_back(cut);
+   return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t TBasketStatsFilter::AddSelection(const TString &selection)
+{
+   // Add the cuts of the terms of selection joined by "&&".
+   // Returns kFALSE if the selection cannot be split in such terms: since
+   // ignoring one of the terms of a "&&" is harmless, the caller may go on
+   // with the other terms, unless this is the full selection.
+
+   TString s = R__StripParentheses(selection);
+   std::vector<TString> terms;
+   Int_t depth = 0;
+   Int_t start = 0;
+   for (Int_t i = 0; i < s.Length(); ++i) {
+      char c = s[i];
+      if (c == '(' || c == '[') {
+         ++depth;
+      } else if (c == ')' || c == ']') {
+         --depth;
+      } else if (depth == 0) {
+         if (c == '|' || c == '?' || c == ',') return kFALSE;
+         if (c == '&') {
+            if (i+1 >= s.Length() || s[i+1] != '&') return kFALSE;   // bitwise and
+            terms.push_back(s(start, i-start));
+            start = i+2;
+            ++i;
+         }
+      }
+   }
+   if (terms.empty()) {
+      return AddCut(s);
+   }
+   terms.push_back(s(start, s.Length()-start));
+   for (UInt_t t = 0; t < terms.size(); ++t) {
+      AddSelection(terms[t]);
+   }
+   return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t TBasketStatsFilter::MayPass(Long64_t entry)
+{
+   // Return kFALSE if the entry (number in the current tree) cannot pass
+   // the selection, according to the range of the values of the baskets
+   // holding it. Return kTRUE if it may pass, the selection must then be
+   // evaluated.
+
+   if (fCuts.empty()) return kTRUE;
+   if (fCurrent != fTree->GetTree()) Update();
+   if (!fActive) return kTRUE;
+   if (entry >= fFirst && entry < fLast) {
+      if (!fPass) ++fNSkipped;
+      return fPass;
+   }
+
+   Bool_t   pass  = kTRUE;
+   Long64_t first = 0;
+   Long64_t last  = TMath::Limits<Long64_t>::Max();
+   Long64_t skip  = entry;
+   for (UInt_t c = 0; c < fCuts.size(); ++c) {
+      const TStatsCut &cut = fCuts[c];
+      TBranch *branch = cut.fBranch;
+      if (!branch) continue;
+      if (entry >= branch->GetEntries()) {
+         if (branch->GetEntries() > first) first = branch->GetEntries();
+         continue;
+      }
+      Long64_t *entries = branch->GetBasketEntry();
+      Int_t nbaskets = branch->GetWriteBasket();
+      Int_t i = TMath::BinarySearch(nbaskets + 1, entries, entry);
+      if (i < 0) {
+         if (entries[0] < last) last = entries[0];
+         continue;
+      }
+      // Skip the empty baskets.
+      while (i < nbaskets && entries[i+1] <= entry) ++i;
+      Long64_t bfirst = entries[i];
+      Long64_t blast  = i < nbaskets ? entries[i+1] : branch->GetEntries();
+      Double_t vmin = branch->GetBasketMin()[i];
+      Double_t vmax = branch->GetBasketMax()[i];
+      Bool_t impossible;
+      switch (cut.fOp) {
+         case kLess:         impossible = vmin >= cut.fValue; break;
+         case kLessEqual:    impossible = vmin >  cut.fValue; break;
+         case kGreater:      impossible = vmax <= cut.fValue; break;
+         case kGreaterEqual: impossible = vmax <  cut.fValue; break;
+         default:            impossible = cut.fValue < vmin || cut.fValue > vmax; break;
+      }
+      if (impossible) {
+         pass = kFALSE;
+         if (blast > skip) skip = blast;
+      } else {
+         if (bfirst > first) first = bfirst;
+         if (blast < last) last = blast;
+      }
+   }
+   fPass = pass;
+   if (pass) {
+      fFirst = first;
+      fLast  = last;
+   } else {
+      fFirst = entry;
+      fLast  = skip;
+      ++fNSkipped;
+   }
+   return pass;
+}
+
+//______________________________________________________________________________
+void TBasketStatsFilter::Update()
+{
+   // Find the branches of the cuts in the current tree of the chain.
+   // Must be called when the chain loads a new tree.
+
+   fCurrent = fTree->GetTree();
+   fActive  = kFALSE;
+   fFirst   = 0;
+   fLast    = 0;
+   for (UInt_t c = 0; c < fCuts.size(); ++c) {
+      TStatsCut &cut = fCuts[c];
+      cut.fBranch = 0;
+      if (!fCurrent || fTree->GetAlias(cut.fName)) continue;
+      TLeaf *leaf = fCurrent->GetLeaf(cut.fName);
+      TBranch *branch = leaf ? leaf->GetBranch() : fCurrent->GetBranch(cut.fName);
+      // The entries of a friend tree may not match the ones of this tree.
+      if (!branch || branch->GetTree() != fCurrent || !branch->GetBasketMin()) continue;
+      cut.fBranch = branch;
+      fActive = kTRUE;
+   }
+}
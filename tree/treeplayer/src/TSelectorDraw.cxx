@@ -39,6 +39,7 @@
 #include "TStyle.h"
 #include "TClass.h"
 #include "TColor.h"
+#include "TBasketStatsFilter.h"
 
 ClassImp(TSelectorDraw)
 
@@ -65,6 +66,7 @@ TSelectorDraw::TSelectorDraw()
    fManager        = 0;
    fMultiplicity   = 0;
    fSelect         = 0;
+   fBasketFilter   = 0;
    fSelectedRows   = 0;
    fDraw           = 0;
    fObject         = 0;
@@ -921,6 +923,7 @@ void TSelectorDraw::ClearFormula()
       fVar[i] = 0;
    }
    delete fSelect; fSelect = 0;
+   delete fBasketFilter; fBasketFilter = 0;
    fManager = 0;
    fMultiplicity = 0;
 }
@@ -961,6 +964,13 @@ Bool_t TSelectorDraw::CompileVariables(const char *varexp, const char *selection
          fSelect = 0;
          return kFALSE;
       }
+      // Use the ranges of the baskets to skip the entries unable to pass
+      // the simple cuts of the selection (see TTree::SetBasketStats).
+      fBasketFilter = new TBasketStatsFilter(fTree, selection);
+      if (!fBasketFilter->GetNcuts()) {
+         delete fBasketFilter;
+         fBasketFilter = 0;
+      }
    }
 
    // if varexp is empty, take first column by default
@@ -1121,6 +1131,18 @@ Bool_t TSelectorDraw::Notify()
       }
    }
    if (fSelect) fSelect->UpdateFormulaLeaves();
+   if (fBasketFilter) fBasketFilter->Update();
+   return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t TSelectorDraw::ProcessCut(Long64_t entry)
+{
+   // Called in the entry loop before ProcessFill.
+   // Reject, without reading it, the entry if the ranges of the values of
+   // the baskets holding it show that it cannot pass the selection.
+
+   if (fBasketFilter) return fBasketFilter->MayPass(entry);
    return kTRUE;
 }
 
@@ -0,0 +1,328 @@
+// @(#)root/treeplayer:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2012, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TSelectorRangeIndex                                                  //
+//                                                                      //
+// A specialized TSelector for TTreeRangeIndex::Build.                  //
+//                                                                      //
+// The input list holds the expression to index (TNamed "expression")   //
+// and the number of values sorted at once (TParameter<Long64_t>        //
+// "runsize"). For each entry, the values of all the instances of the   //
+// expression are collected with the entry number in the tree or chain. //
+// Every runsize values, they are sorted into a TRangeIndexRun added    //
+// to the output list. The full runs are spilled to temporary files     //
+// (see TRangeIndexRun::Spill), so that a selector keeps at most        //
+// runsize values in memory whatever the size of the tree; only the     //
+// last, partial, run stays in memory.                                  //
+//                                                                      //
+// The selector can be processed by several threads (see                //
+// TTree::SetParallelProcess): each clone then sees the trees of a      //
+// chain one after the other, as independent trees, and numbers their   //
+// entries by counting the entries of the previous ones. The runs of    //
+// the clones are sorted in parallel and are all moved to the output    //
+// list of the selector.                                                //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#include "TSelectorRangeIndex.h"
+#include "TTree.h"
+#include "TChain.h"
+#include "TTreeFormula.h"
+#include "TParameter.h"
+#include "TSystem.h"
+#include "TMath.h"
+
+#include <algorithm>
+
+ClassImp(TRangeIndexRun)
+ClassImp(TSelectorRangeIndex)
+
+namespace {
+   // Order of the values of a run: by value, then by entry number, so that
+   // the index does not depend on the run size or on the number of threads.
+   class TRangeIndexLess {
+   private:
+      const std::vector<Double_t> &fValues;
+      const std::vector<Long64_t> &fEntries;
+   public:
+      TRangeIndexLess(const std::vector<Double_t> &values, const std::vector<Long64_t> &entries) :
+         fValues(values), fEntries(entries) {}
+      bool operator()(size_t a, size_t b) const {
+         if (fValues[a] != fValues[b]) return fValues[a] < fValues[b];
+         return fEntries[a] < fEntries[b];
+      }
+   };
+}
+
+//______________________________________________________________________________
+TRangeIndexRun::TRangeIndexRun(const char *name) :
+   TNamed(name, ""), fFile(0), fN(0), fPos(0)
+{
+   // Create an empty run, kept in memory until Spill is called.
+}
+
+//______________________________________________________________________________
+TRangeIndexRun::~TRangeIndexRun()
+{
+   // Destructor: close and remove the temporary file of the run.
+
+   if (fFile) fclose(fFile);
+   if (IsSpilled()) gSystem->Unlink(fFileName);
+}
+
+//______________________________________________________________________________
+Long64_t TRangeIndexRun::GetN() const
+{
+   // Return the number of values of the run.
+
+   return IsSpilled() ? fN : (Long64_t)fValues.size();
+}
+
+//______________________________________________________________________________
+Bool_t TRangeIndexRun::Next(Double_t &value, Long64_t &entry)
+{
+   // Return in value and entry the next value of the run and its entry
+   // number, starting from the first one after Rewind. A spilled run is
+   // read back by chunks of at most kChunkSize values. Returns kFALSE
+   // after the last value, whose memory and file are then released.
+
+   if (fPos >= fValues.size()) {
+      std::vector<Double_t>().swap(fValues);
+      std::vector<Long64_t>().swap(fEntries);
+      fPos = 0;
+      if (!fFile) return kFALSE;
+      Int_t len = 0;
+      if (fread(&len, sizeof(Int_t), 1, fFile) != 1 || len <= 0) {
+         fclose(fFile);
+         fFile = 0;
+         return kFALSE;
+      }
+      fValues.resize(len);
+      fEntries.resize(len);
+      if (fread(&fValues[0], sizeof(Double_t), len, fFile) != (size_t)len ||
+          fread(&fEntries[0], sizeof(Long64_t), len, fFile) != (size_t)len) {
+         Error("Next", "cannot read the temporary file %s", fFileName.Data());
+         fValues.clear();
+         fEntries.clear();
+         fclose(fFile);
+         fFile = 0;
+         return kFALSE;
+      }
+   }
+   value = fValues[fPos];
+   entry = fEntries[fPos];
+   ++fPos;
+   return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t TRangeIndexRun::Rewind()
+{
+   // Prepare the reading of the run from its first value with Next.
+   // Returns kFALSE if the temporary file of a spilled run cannot be opened.
+
+   fPos = 0;
+   if (!IsSpilled()) return kTRUE;
+   if (fFile) fclose(fFile);
+   fValues.clear();
+   fEntries.clear();
+   fFile = fopen(fFileName, "rb");
+   if (!fFile) {
+      SysError("Rewind", "cannot open the temporary file %s", fFileName.Data());
+      return kFALSE;
+   }
+   return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t TRangeIndexRun::Spill()
+{
+   // Append the values in memory to the temporary file of the run, created
+   // in the temporary directory of the system at the first call, and
+   // release their memory. The values are written by chunks of at most
+   // kChunkSize values, each followed by the entry numbers, and the file
+   // is closed between two calls: many runs can be spilled at once, and
+   // only the ones being merged are opened. Returns kFALSE in case of error.
+
+   FILE *fp = 0;
+   if (!IsSpilled()) {
+      TString base = "RangeIndexRun";
+      fp = gSystem->TempFileName(base);
+      if (!fp) return kFALSE;
+      fFileName = base;
+   } else {
+      fp = fopen(fFileName, "ab");
+      if (!fp) {
+         SysError("Spill", "cannot open the temporary file %s", fFileName.Data());
+         return kFALSE;
+      }
+   }
+   size_t n = fValues.size();
+   Bool_t ok = kTRUE;
+   for (size_t first = 0; ok && first < n; first += kChunkSize) {
+      Int_t len = (Int_t)std::min(n - first, (size_t)kChunkSize);
+      ok = fwrite(&len, sizeof(Int_t), 1, fp) == 1 &&
+           fwrite(&fValues[first], sizeof(Double_t), len, fp) == (size_t)len &&
+           fwrite(&fEntries[first], sizeof(Long64_t), len, fp) == (size_t)len;
+   }
+   if (fclose(fp) != 0) ok = kFALSE;
+   if (!ok) {
+      SysError("Spill", "cannot write the temporary file %s", fFileName.Data());
+      return kFALSE;
+   }
+   fN += n;
+   std::vector<Double_t>().swap(fValues);
+   std::vector<Long64_t>().swap(fEntries);
+   fPos = 0;
+   return kTRUE;
+}
+
+//______________________________________________________________________________
+TSelectorRangeIndex::TSelectorRangeIndex() :
+   fChain(0), fFormula(0), fRunSize(1000000), fOffset(0), fTreeEntries(0),
+   fCountTrees(kFALSE), fNRuns(0)
+{
+   // Default constructor.
+}
+
+//______________________________________________________________________________
+TSelectorRangeIndex::~TSelectorRangeIndex()
+{
+   // Destructor.
+
+   delete fFormula; fFormula = 0;
+}
+
+//______________________________________________________________________________
+void TSelectorRangeIndex::Begin(TTree *tree)
+{
+   // Called at the start of the query, before the selector is cloned when
+   // processed by several threads: flag the chains for the clones.
+
+   fChain = tree;
+   if (fInput && tree && tree->InheritsFrom(TChain::Class()) && !fInput->FindObject("chain")) {
+      fInput->Add(new TNamed("chain", tree->GetName()));
+   }
+}
+
+//______________________________________________________________________________
+void TSelectorRangeIndex::SlaveBegin(TTree *tree)
+{
+   // Called after Begin(), for each clone when processed by several
+   // threads.
+
+   fChain = tree;
+   SetStatus(0);
+   fOffset      = 0;
+   fTreeEntries = 0;
+   fNRuns       = 0;
+
+   TParameter<Long64_t> *runsize = (TParameter<Long64_t>*)fInput->FindObject("runsize");
+   if (runsize && runsize->GetVal() > 0) fRunSize = runsize->GetVal();
+   // A clone reads the trees of the chain as independent trees.
+   fCountTrees = fInput->FindObject("chain") && tree && !tree->InheritsFrom(TChain::Class());
+}
+
+//______________________________________________________________________________
+void TSelectorRangeIndex::Init(TTree *tree)
+{
+   // Called for each new tree (each file of a chain for a clone): compile
+   // the expression for it.
+
+   fChain = tree;
+   delete fFormula;
+   fFormula = 0;
+   if (!tree) return;
+   TObject *expressionObj = fInput->FindObject("expression");
+   const char *expression = expressionObj ? expressionObj->GetTitle() : "";
+   if (strlen(expression)) {
+      fFormula = new TTreeFormula("Expression", expression, tree);
+      fFormula->SetQuickLoad(kTRUE);
+      if (!fFormula->GetNdim()) {
+         delete fFormula;
+         fFormula = 0;
+         Abort("cannot compile the expression");
+      }
+   }
+}
+
+//______________________________________________________________________________
+Bool_t TSelectorRangeIndex::Notify()
+{
+   // This function is called at the first entry of a new tree in a chain.
+
+   if (fFormula) fFormula->UpdateFormulaLeaves();
+   if (fCountTrees) {
+      fOffset     += fTreeEntries;
+      fTreeEntries = fChain->GetEntries();
+   } else if (fChain) {
+      fOffset = fChain->GetChainOffset();
+   }
+   return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t TSelectorRangeIndex::Process(Long64_t entry)
+{
+   // Collect the values of the expression for entry (number in the current
+   // tree). The NaN values are not indexed.
+
+   if (!fFormula) return kFALSE;
+
+   Int_t ndata = fFormula->GetNdata();
+   for (Int_t i = 0; i < ndata; ++i) {
+      Double_t value = fFormula->EvalInstance(i);
+      if (TMath::IsNaN(value)) continue;
+      fValues.push_back(value);
+      fEntries.push_back(fOffset + entry);
+   }
+   if ((Long64_t)fValues.size() >= fRunSize) FlushRun(kTRUE);
+   return kTRUE;
+}
+
+//______________________________________________________________________________
+void TSelectorRangeIndex::FlushRun(Bool_t spill)
+{
+   // Sort the values collected so far into a new run of the output list.
+   // If spill is true, the run is written to a temporary file instead of
+   // being kept in memory.
+
+   size_t n = fValues.size();
+   if (!n) return;
+
+   std::vector<size_t> index(n);
+   for (size_t i = 0; i < n; ++i) index[i] = i;
+   std::sort(index.begin(), index.end(), TRangeIndexLess(fValues, fEntries));
+   TRangeIndexRun *run = new TRangeIndexRun(TString::Format("RangeIndexRun_%lx_%d", (ULong_t)this, fNRuns++));
+   run->fValues.resize(n);
+   run->fEntries.resize(n);
+   for (size_t i = 0; i < n; ++i) {
+      run->fValues[i]  = fValues[index[i]];
+      run->fEntries[i] = fEntries[index[i]];
+   }
+   fValues.clear();
+   fEntries.clear();
+   if (spill && !run->Spill()) {
+      delete run;
+      Abort("cannot write a run to a temporary file");
+      return;
+   }
+   fOutput->Add(run);
+}
+
+//______________________________________________________________________________
+void TSelectorRangeIndex::SlaveTerminate()
+{
+   // Called after all entries have been processed: sort the last run.
+
+   FlushRun();
+}
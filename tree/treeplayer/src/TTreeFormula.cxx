@@ -18,6 +18,12 @@
 #include "TClonesArray.h"
 #include "TLeafB.h"
 #include "TLeafC.h"
+#include "TLeafD.h"
+#include "TLeafF.h"
+#include "TLeafI.h"
+#include "TLeafL.h"
+#include "TLeafO.h"
+#include "TLeafS.h"
 #include "TLeafObject.h"
 #include "TDataMember.h"
 #include "TMethodCall.h"
@@ -36,6 +42,8 @@
 #include "TString.h"
 #include "TTimeStamp.h"
 #include "TMath.h"
+#include "TEnv.h"
+#include "TVirtualMutex.h"
 
 #include "TVirtualRefProxy.h"
 #include "TTreeFormulaManager.h"
@@ -52,10 +60,37 @@
 #include <stdlib.h>
 #include <typeinfo>
 #include <algorithm>
+#include <map>
 
 const Int_t kMaxLen     = 1024;
 R__EXTERN TTree *gTree;
 
+Int_t TTreeFormula::fgJIT = -1;
+
+static TVirtualMutex *gTreeFormulaJITMutex = 0;
+
+// Helper functions declared to the interpreter before compiling the first
+// formula. They reproduce the handling of the indeterminations done by
+// TTreeFormula::EvalInstance.
+static const char *gTreeFormulaJITHelpers =
+   "namespace R__TTreeFormulaJIT {"
+   " inline Double_t Div(Double_t a, Double_t b) { return b == 0 ? 0 : a/b; }"
+   " inline Double_t Mod(Double_t a, Double_t b) { return Double_t(Long64_t(a) % Long64_t(b)); }"
+   " inline Double_t Tan(Double_t x) { return TMath::Cos(x) == 0 ? 0 : TMath::Tan(x); }"
+   " inline Double_t ACos(Double_t x) { return TMath::Abs(x) > 1 ? 0 : TMath::ACos(x); }"
+   " inline Double_t ASin(Double_t x) { return TMath::Abs(x) > 1 ? 0 : TMath::ASin(x); }"
+   " inline Double_t TanH(Double_t x) { return TMath::CosH(x) == 0 ? 0 : TMath::TanH(x); }"
+   " inline Double_t ACosH(Double_t x) { return x < 1 ? 0 : TMath::ACosH(x); }"
+   " inline Double_t ATanH(Double_t x) { return TMath::Abs(x) > 1 ? 0 : TMath::ATanH(x); }"
+   " inline Double_t Fmod(Double_t a, Double_t b) { return fmod(a, b); }"
+   " inline Double_t Sq(Double_t x) { return x*x; }"
+   " inline Double_t Sqrt(Double_t x) { return TMath::Sqrt(TMath::Abs(x)); }"
+   " inline Double_t Log(Double_t x) { return x > 0 ? TMath::Log(x) : 0; }"
+   " inline Double_t Log10(Double_t x) { return x > 0 ? TMath::Log10(x) : 0; }"
+   " inline Double_t Exp(Double_t x) { return x < -700 ? 0 : TMath::Exp(x > 700 ? 700 : x); }"
+   " inline Double_t Sign(Double_t x) { return x < 0 ? -1 : 1; }"
+   "}";
+
 
 
 ClassImp(TTreeFormula)
@@ -141,6 +176,8 @@ TTreeFormula::TTreeFormula(): TFormula(), fQuickLoad(kFALSE), fNeedLoading(kTRUE
    fHasCast      = 0;
    fManager      = 0;
    fMultiplicity = 0;
+   fJITFunc      = 0;
+   fJITStatus    = 0;
 
    Int_t j,k;
    for (j=0; j<kMAXCODES; j++) {
@@ -189,6 +226,8 @@ void TTreeFormula::Init(const char*name, const char* expression)
    fMultiplicity = 0;
    fAxis         = 0;
    fHasCast      = 0;
+   fJITFunc      = 0;
+   fJITStatus    = 0;
    Int_t i,j,k;
    fManager      = new TTreeFormulaManager;
    fManager->Add(this);
@@ -3307,6 +3346,175 @@ Bool_t TTreeFormula::BranchHasMethod(TLeaf* leafcur, TBranch* branch, const char
    return kFALSE;
 }
 
+//______________________________________________________________________________
+Bool_t TTreeFormula::CompileJIT()
+{
+   // Generate a C++ function evaluating this formula for the types of its
+   // leaves and compile it with the interpreter. EvalInstance then calls
+   // this function instead of interpreting the operations of the formula.
+   //
+   // Only the formulas made of numerical operations on simple leaves
+   // (one value of a basic type per entry, without counter nor data member
+   // lookup) are compiled; for all the others, and if the compilation is
+   // disabled (see SetJIT), kFALSE is returned and the formula is
+   // evaluated as before. The functions are shared by all the formulas
+   // with the same expression and leaf types.
+
+   fJITFunc   = 0;
+   fJITStatus = -1;
+   if (!IsJIT() || !gInterpreter) return kFALSE;
+   if (fMultiplicity != 0 || fHasCast || fNcodes <= 0 || fNcodes > kMAXCODES) return kFALSE;
+
+   // Check the leaves and prepare the expression reading each of them.
+   TString value[kMAXCODES];
+   for (Int_t code = 0; code < fNcodes; ++code) {
+      TLeaf *leaf = (TLeaf*)fLeaves.UncheckedAt(code);
+      if (!leaf || fLookupType[code] != kDirect || fNdimensions[code] != 0) return kFALSE;
+      if (leaf->GetLeafCount() || leaf->GetLenStatic() != 1) return kFALSE;
+      TClass *cl = leaf->IsA();
+      if (cl != TLeafB::Class() && cl != TLeafS::Class() && cl != TLeafI::Class() &&
+          cl != TLeafL::Class() && cl != TLeafF::Class() && cl != TLeafD::Class() &&
+          cl != TLeafO::Class()) return kFALSE;
+      value[code].Form("Double_t(*(const %s*)values[%d])", leaf->GetTypeName(), code);
+   }
+
+   // Translate the operations into an expression, replacing the values
+   // of the evaluation stack by their C++ expression.
+   const char *jit = "R__TTreeFormulaJIT::";
+   std::vector<TString> stack;
+   stack.reserve(fNoper);
+   for (Int_t i = 0; i < fNoper; ++i) {
+      const Int_t oper   = GetOper()[i];
+      const Int_t action = oper >> kTFOperShift;
+      const Int_t param  = oper & kTFOperMask;
+      Int_t nargs = 0;
+      switch (action) {
+         case kEnd: i = fNoper; continue;
+         case kBoolOptimize: continue; // && and || of the generated code already skip the right side.
+         case kConstant: {
+            Double_t c = fConst[param];
+            if (!TMath::Finite(c)) return kFALSE;
+            TString lit = TString::Format("%.17g", c);
+            if (!lit.Contains(".") && !lit.Contains("e")) lit += ".";
+            if (c < 0) lit = "(" + lit + ")";
+            stack.push_back(lit);
+            continue;
+         }
+         case kDefinedVariable:
+            if (param >= fNcodes) return kFALSE;
+            stack.push_back(value[param]);
+            continue;
+         case kpi:
+            stack.push_back("TMath::ACos(-1.)");
+            continue;
+         case kAdd: case kSubstract: case kMultiply: case kDivide: case kModulo:
+         case katan2: case kfmod: case kpow: case kmin: case kmax:
+         case kAnd: case kOr: case kEqual: case kNotEqual:
+         case kLess: case kGreater: case kLessThan: case kGreaterThan:
+         case kBitAnd: case kBitOr: case kLeftShift: case kRightShift:
+            nargs = 2;
+            break;
+         case kcos: case ksin: case ktan: case kacos: case kasin: case katan:
+         case kcosh: case ksinh: case ktanh: case kacosh: case kasinh: case katanh:
+         case ksq: case ksqrt: case klog: case kexp: case klog10:
+         case kabs: case ksign: case kint: case kSignInv: case kNot:
+            nargs = 1;
+            break;
+         default:
+            // Strings, jumps, function calls, aliases, ...
+            return kFALSE;
+      }
+      if ((Int_t)stack.size() < nargs) return kFALSE;
+      TString b = stack.back();
+      TString a = nargs == 2 ? stack[stack.size()-2] : TString();
+      stack.resize(stack.size()-nargs);
+      TString res;
+      switch (action) {
+         case kAdd:         res.Form("(%s+%s)", a.Data(), b.Data()); break;
+         case kSubstract:   res.Form("(%s-%s)", a.Data(), b.Data()); break;
+         case kMultiply:    res.Form("(%s*%s)", a.Data(), b.Data()); break;
+         case kDivide:      res.Form("%sDiv(%s,%s)", jit, a.Data(), b.Data()); break;
+         case kModulo:      res.Form("%sMod(%s,%s)", jit, a.Data(), b.Data()); break;
+         case katan2:       res.Form("TMath::ATan2(%s,%s)", a.Data(), b.Data()); break;
+         case kfmod:        res.Form("%sFmod(%s,%s)", jit, a.Data(), b.Data()); break;
+         case kpow:         res.Form("TMath::Power(%s,%s)", a.Data(), b.Data()); break;
+         case kmin:         res.Form("TMath::Min(%s,%s)", a.Data(), b.Data()); break;
+         case kmax:         res.Form("TMath::Max(%s,%s)", a.Data(), b.Data()); break;
+         case kAnd:         res.Form("Double_t(%s!=0&&%s!=0)", a.Data(), b.Data()); break;
+         case kOr:          res.Form("Double_t(%s!=0||%s!=0)", a.Data(), b.Data()); break;
+         case kEqual:       res.Form("Double_t(%s==%s)", a.Data(), b.Data()); break;
+         case kNotEqual:    res.Form("Double_t(%s!=%s)", a.Data(), b.Data()); break;
+         case kLess:        res.Form("Double_t(%s<%s)", a.Data(), b.Data()); break;
+         case kGreater:     res.Form("Double_t(%s>%s)", a.Data(), b.Data()); break;
+         case kLessThan:    res.Form("Double_t(%s<=%s)", a.Data(), b.Data()); break;
+         case kGreaterThan: res.Form("Double_t(%s>=%s)", a.Data(), b.Data()); break;
+         case kBitAnd:      res.Form("Double_t(Long64_t(%s)&Long64_t(%s))", a.Data(), b.Data()); break;
+         case kBitOr:       res.Form("Double_t(Long64_t(%s)|Long64_t(%s))", a.Data(), b.Data()); break;
+         case kLeftShift:   res.Form("Double_t(Long64_t(%s)<<Long64_t(%s))", a.Data(), b.Data()); break;
+         case kRightShift:  res.Form("Double_t(Long64_t(%s)>>Long64_t(%s))", a.Data(), b.Data()); break;
+         case kcos:         res.Form("TMath::Cos(%s)", b.Data()); break;
+         case ksin:         res.Form("TMath::Sin(%s)", b.Data()); break;
+         case ktan:         res.Form("%sTan(%s)", jit, b.Data()); break;
+         case kacos:        res.Form("%sACos(%s)", jit, b.Data()); break;
+         case kasin:        res.Form("%sASin(%s)", jit, b.Data()); break;
+         case katan:        res.Form("TMath::ATan(%s)", b.Data()); break;
+         case kcosh:        res.Form("TMath::CosH(%s)", b.Data()); break;
+         case ksinh:        res.Form("TMath::SinH(%s)", b.Data()); break;
+         case ktanh:        res.Form("%sTanH(%s)", jit, b.Data()); break;
+         case kacosh:       res.Form("%sACosH(%s)", jit, b.Data()); break;
+         case kasinh:       res.Form("TMath::ASinH(%s)", b.Data()); break;
+         case katanh:       res.Form("%sATanH(%s)", jit, b.Data()); break;
+         case ksq:          res.Form("%sSq(%s)", jit, b.Data()); break;
+         case ksqrt:        res.Form("%sSqrt(%s)", jit, b.Data()); break;
+         case klog:         res.Form("%sLog(%s)", jit, b.Data()); break;
+         case kexp:         res.Form("%sExp(%s)", jit, b.Data()); break;
+         case klog10:       res.Form("%sLog10(%s)", jit, b.Data()); break;
+         case kabs:         res.Form("TMath::Abs(%s)", b.Data()); break;
+         case ksign:        res.Form("%sSign(%s)", jit, b.Data()); break;
+         case kint:         res.Form("Double_t(Int_t(%s))", b.Data()); break;
+         case kSignInv:     res.Form("(-%s)", b.Data()); break;
+         case kNot:         res.Form("Double_t(%s==0)", b.Data()); break;
+      }
+      stack.push_back(res);
+   }
+   if (stack.size() != 1) return kFALSE;
+
+   // Compile the function, unless a formula with the same expression and
+   // leaf types already did it.
+   R__LOCKGUARD2(gTreeFormulaJITMutex);
+   static std::map<std::string, JITFunc_t> functions;
+   static Bool_t helpers = kFALSE;
+   const std::string key = stack[0].Data();
+   std::map<std::string, JITFunc_t>::iterator it = functions.find(key);
+   if (it != functions.end()) {
+      fJITFunc = it->second;
+   } else {
+      TInterpreter::EErrorCode err = TInterpreter::kNoError;
+      if (!helpers) {
+         gInterpreter->ProcessLine("#include \"TMath.h\"", &err);
+         if (err == TInterpreter::kNoError) gInterpreter->ProcessLine(gTreeFormulaJITHelpers, &err);
+         helpers = (err == TInterpreter::kNoError);
+      }
+      Long_t addr = 0;
+      if (helpers) {
+         Int_t id = (Int_t)functions.size();
+         gInterpreter->ProcessLine(TString::Format("namespace R__TTreeFormulaJIT { Double_t Eval%d(void **values) { return %s; } }",
+                                                   id, key.c_str()), &err);
+         if (err == TInterpreter::kNoError) {
+            addr = gInterpreter->Calc(TString::Format("(long)&R__TTreeFormulaJIT::Eval%d", id), &err);
+            if (err != TInterpreter::kNoError) addr = 0;
+         }
+      }
+      if (!addr && gDebug > 0) {
+         Warning("CompileJIT", "Could not compile %s, it will be interpreted.", GetTitle());
+      }
+      fJITFunc = (JITFunc_t)addr;
+      functions[key] = fJITFunc;
+   }
+   fJITStatus = fJITFunc ? 1 : -1;
+   return fJITFunc != 0;
+}
+
 //______________________________________________________________________________
 Int_t TTreeFormula::GetRealInstance(Int_t instance, Int_t codeindex) {
       // Now let calculate what physical instance we really need.
@@ -3872,6 +4080,29 @@ Double_t TTreeFormula::EvalInstance(Int_t instance, const char *stringStackArg[]
 // efficiencies.
 
    if (TestBit(kMissingLeaf)) return 0;
+   if (instance == 0 && fJITStatus >= 0 && fNoper > 1 && !fAxis) {
+      // Use the compiled version of the formula when it only reads
+      // simple leaves (see CompileJIT).
+      if (fJITStatus == 0) CompileJIT();
+      if (fJITFunc) {
+         void *values[kMAXCODES];
+         for (Int_t code = 0; code < fNcodes; ++code) {
+            TLeaf *leaf = (TLeaf*)fLeaves.UncheckedAt(code);
+            TBranch *branch = (TBranch*)fBranches.UncheckedAt(code);
+            if (branch) {
+               R__LoadBranch(branch,branch->GetTree()->GetReadEntry(),fQuickLoad);
+            } else {
+               branch = leaf->GetBranch();
+               Long64_t treeEntry = branch->GetTree()->GetReadEntry();
+               if (branch->GetReadEntry() != treeEntry) branch->GetEntry( treeEntry );
+            }
+            values[code] = leaf->GetValuePointer();
+         }
+         fNeedLoading = kFALSE;
+         fDidBooleanOptimization = kFALSE;
+         return (*fJITFunc)(values);
+      }
+   }
    if (fNoper == 1 && fNcodes > 0) {
 
       switch (fLookupType[0]) {
@@ -4539,6 +4770,17 @@ Bool_t TTreeFormula::IsInteger(Bool_t fast) const
    return kFALSE;
 }
 
+//______________________________________________________________________________
+Bool_t TTreeFormula::IsJIT()
+{
+   // Static function returning kTRUE if the formulas are compiled with the
+   // interpreter (see CompileJIT). By default this is set by the resource
+   // TTreeFormula.JIT.
+
+   if (fgJIT < 0) fgJIT = gEnv->GetValue("TTreeFormula.JIT", 0) ? 1 : 0;
+   return fgJIT > 0;
+}
+
 //______________________________________________________________________________
 Bool_t TTreeFormula::IsLeafInteger(Int_t code) const
 {
@@ -4895,6 +5137,17 @@ void TTreeFormula::SetAxis(TAxis *axis)
    }
 }
 
+//______________________________________________________________________________
+void TTreeFormula::SetJIT(Bool_t jit)
+{
+   // Static function enabling or disabling the compilation of the formulas
+   // with the interpreter (see CompileJIT). This applies to the formulas
+   // which are evaluated for the first time (or for a new tree of a TChain)
+   // afterwards.
+
+   fgJIT = jit ? 1 : 0;
+}
+
 //______________________________________________________________________________
 void TTreeFormula::Streamer(TBuffer &R__b)
 {
@@ -4965,6 +5218,10 @@ void TTreeFormula::UpdateFormulaLeaves()
 
    Int_t nleaves = fLeafNames.GetEntriesFast();
    ResetBit( kMissingLeaf );
+
+   // The type of the leaves may differ in the new tree.
+   fJITFunc   = 0;
+   fJITStatus = 0;
    for (Int_t i=0;i<nleaves;i++) {
       if (!fTree) break;
       if (!fLeafNames[i]) continue;
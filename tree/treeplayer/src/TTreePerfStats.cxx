@@ -61,6 +61,9 @@
 //   Real Time = Real Time in seconds
 //   CPU  Time = CPU Time in seconds
 //   Disk Time = Real Time spent in pure raw disk IO
+//   StallTime = Real Time spent waiting for the baskets of the TTreeCache,
+//               i.e. not overlapped by the TTreeCache read-ahead
+//               (see TTreeCache::SetReadAheadDepth)
 //   Disk IO   = Raw disk IO speed in MBytes/second
 //   ReadUZRT  = Unzipped MBytes per RT second
 //   ReadUZCP  = Unipped MBytes per CP second
@@ -85,6 +88,7 @@
 #include "Riostream.h"
 #include "TFile.h"
 #include "TTree.h"
+#include "TTreeCache.h"
 #include "TAxis.h"
 #include "TBrowser.h"
 #include "TVirtualPad.h"
@@ -122,6 +126,7 @@ TTreePerfStats::TTreePerfStats() : TVirtualPerfStats()
    fCpuTime       = 0;
    fDiskTime      = 0;
    fUnzipTime     = 0;
+   fStallTime     = 0;
    fCompress      = 0;
    fRealTimeAxis  = 0;
    fHostInfoText  = 0;
@@ -157,6 +162,7 @@ TTreePerfStats::TTreePerfStats(const char *name, TTree *T) : TVirtualPerfStats()
    fCpuTime       = 0;
    fDiskTime      = 0;
    fUnzipTime     = 0;
+   fStallTime     = 0;
    fRealTimeAxis  = 0;
    fCompress      = (T->GetTotBytes()+0.00001)/T->GetZipBytes();
    
@@ -319,6 +325,8 @@ void TTreePerfStats::Finish()
    fReadaheadSize = TFile::GetReadaheadSize();
    fBytesRead     = fFile->GetBytesRead();
    fBytesReadExtra= fFile->GetBytesReadExtra();
+   TTreeCache *cache = dynamic_cast<TTreeCache*>(fFile->GetCacheRead(fTree));
+   if (cache) fStallTime = cache->GetStallTime();
    fRealTime      = fWatch->RealTime();
    fCpuTime       = fWatch->CpuTime();
    Int_t npoints  = fGraphIO->GetN();
@@ -397,6 +405,7 @@ void TTreePerfStats::Paint(Option_t *option)
       fPave->AddText(Form("Real Time = %7.3f s",fRealTime));
       fPave->AddText(Form("CPU  Time = %7.3f s",fCpuTime));
       fPave->AddText(Form("Disk Time = %7.3f s",fDiskTime));
+      fPave->AddText(Form("StallTime = %7.3f s",fStallTime));
       if (unzip) { 
          fPave->AddText(Form("UnzipTime = %7.3f s",fUnzipTime));
       }
@@ -439,6 +448,7 @@ void TTreePerfStats::Print(Option_t * option) const
    printf("Real Time = %7.3f seconds\n",fRealTime);
    printf("CPU  Time = %7.3f seconds\n",fCpuTime);
    printf("Disk Time = %7.3f seconds\n",fDiskTime);
+   printf("StallTime = %7.3f seconds\n",fStallTime);
    if (unzip) {
       printf("Strm Time = %7.3f seconds\n",fCpuTime-fUnzipTime);
       printf("UnzipTime = %7.3f seconds\n",fUnzipTime);
@@ -490,6 +500,7 @@ void TTreePerfStats::SavePrimitive(std::ostream &out, Option_t *option /*= ""*/)
    out<<"   ps->SetCpuTime("<<fCpuTime<<");"<<std::endl;
    out<<"   ps->SetDiskTime("<<fDiskTime<<");"<<std::endl;
    out<<"   ps->SetUnzipTime("<<fUnzipTime<<");"<<std::endl;
+   out<<"   ps->SetStallTime("<<fStallTime<<");"<<std::endl;
    out<<"   ps->SetCompress("<<fCompress<<");"<<std::endl;
 
    Int_t i, npoints = fGraphIO->GetN();
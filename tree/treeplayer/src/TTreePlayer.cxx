@@ -20,6 +20,7 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <vector>
 
 #include "Riostream.h"
 #include "TTreePlayer.h"
@@ -66,6 +67,7 @@
 #include "TEnv.h"
 #include "THLimitsFinder.h"
 #include "TSelectorDraw.h"
+#include "TBasketStatsFilter.h"
 #include "TSelectorEntries.h"
 #include "TPluginManager.h"
 #include "TObjString.h"
@@ -77,6 +79,11 @@
 #include "TVirtualMonitoring.h"
 #include "TTreeCache.h"
 #include "TStyle.h"
+#include "TSelectorCint.h"
+#include "TMethodCall.h"
+#include "TThread.h"
+#include "TMutex.h"
+#include "TVirtualMutex.h"
 
 #include "HFitInterface.h"
 #include "Foption.h"
@@ -152,6 +159,33 @@ TVirtualIndex *TTreePlayer::BuildIndex(const TTree *T, const char *majorname, co
    return new TTreeIndex(T,majorname,minorname);
 }
 
+//______________________________________________________________________________
+Bool_t TTreePlayer::CanProcessParallel(TSelector *selector) const
+{
+   // Return kTRUE if the entries of the tree can be processed with
+   // selector by several threads (see ProcessParallel).
+   // This requires a compiled selector, which can be cloned with its default
+   // constructor, and a tree read from files without entry list, event list
+   // nor friends.
+
+   if (!selector) return kFALSE;
+   TClass *cl = selector->IsA();
+   if (!cl || !cl->IsLoaded() || !cl->GetNew()) return kFALSE;
+   if (cl->InheritsFrom(TSelectorCint::Class()) ||
+       cl->InheritsFrom(TSelectorDraw::Class()) ||
+       cl->InheritsFrom(TSelectorEntries::Class())) {
+      return kFALSE;
+   }
+   if (fTree->GetEntryList() || fTree->GetEventList()) return kFALSE;
+   if (fTree->GetListOfFriends() && fTree->GetListOfFriends()->GetSize()) return kFALSE;
+   if (fTree->InheritsFrom(TChain::Class())) {
+      return ((TChain*)fTree)->GetListOfFiles()->GetEntries() > 0;
+   }
+   TFile *file = fTree->GetCurrentFile();
+   if (!file || file->IsWritable()) return kFALSE;
+   return kTRUE;
+}
+
 //______________________________________________________________________________
 TTree *TTreePlayer::CopyTree(const char *selection, Option_t *, Long64_t nentries,
                              Long64_t firstentry)
@@ -165,6 +199,10 @@ TTree *TTreePlayer::CopyTree(const char *selection, Option_t *, Long64_t nentrie
    // nentries is the number of entries to process (default is all)
    // first is the first entry to process (default is 0)
    //
+   // The entries in baskets whose range of values (see TTree::SetBasketStats)
+   // cannot pass the simple cuts of the selection are skipped without
+   // being read.
+   //
    // IMPORTANT: The copied tree stays connected with this tree until this tree
    //            is deleted.  In particular, any changes in branch addresses
    //            in this tree are forwarded to the clone trees.  Any changes
@@ -216,6 +254,9 @@ TTree *TTreePlayer::CopyTree(const char *selection, Option_t *, Long64_t nentrie
       }
       fFormulaList->Add(select);
    }
+   // Skip the entries whose baskets cannot pass the selection
+   // (see TTree::SetBasketStats).
+   TBasketStatsFilter filter(fTree, selection);
 
    //loop on the specified entries
    Int_t tnumber = -1;
@@ -227,7 +268,9 @@ TTree *TTreePlayer::CopyTree(const char *selection, Option_t *, Long64_t nentrie
       if (tnumber != fTree->GetTreeNumber()) {
          tnumber = fTree->GetTreeNumber();
          if (select) select->UpdateFormulaLeaves();
+         filter.Update();
       }
+      if (!filter.MayPass(localEntry)) continue;
       if (select) {
          Int_t ndata = select->GetNdata();
          Bool_t keep = kFALSE;
@@ -2124,6 +2167,13 @@ Long64_t TTreePlayer::Process(TSelector *selector,Option_t *option, Long64_t nen
    //  If the Tree (Chain) has an associated EventList, the loop is on the nentries
    //  of the EventList, starting at firstentry, otherwise the loop is on the
    //  specified Tree entries.
+   //
+   //  If TTree::SetParallelProcess was called, the entries are processed by
+   //  several threads, see ProcessParallel.
+
+   if (fTree->GetParallelProcess() > 1 && CanProcessParallel(selector)) {
+      return ProcessParallel(selector, option, nentries, firstentry);
+   }
 
    nentries = GetEntriesToProcess(firstentry, nentries);
 
@@ -2229,6 +2279,322 @@ Long64_t TTreePlayer::Process(TSelector *selector,Option_t *option, Long64_t nen
    return selector->GetStatus();
 }
 
+//______________________________________________________________________________
+//
+// Helper classes for TTreePlayer::ProcessParallel.
+//
+class TProcessParallelRanges {
+public:
+   TMutex                *fMutex;         // Protect the members below
+   std::vector<Long64_t>  fFirst;         // First entry of each cluster of the current tree
+   std::vector<Long64_t>  fLast;          // Last entry + 1 of each cluster of the current tree
+   UInt_t                 fNext;          // Next cluster to process
+   Bool_t                 fUseCutFill;    // Call ProcessCut and ProcessFill instead of Process
+   Bool_t                 fAbortProcess;  // A selector asked to abort the processing
+   Bool_t                 fAbortFile;     // A selector asked to skip the rest of the current tree
+};
+
+class TProcessParallelWorker {
+public:
+   TProcessParallelRanges *fRanges;       // Clusters shared by all the workers
+   TSelector              *fSelector;     // Clone of the user selector
+   TFile                  *fFile;         // File opened by this worker
+   TTree                  *fTree;         // Copy of the tree read by this worker
+   Bool_t                  fStarted;      // True once SlaveBegin has been called
+};
+
+//______________________________________________________________________________
+static void *ProcessParallelLoop(void *arg)
+{
+   // Main loop of the threads of TTreePlayer::ProcessParallel: process the
+   // clusters of the current tree until there are none left.
+
+   TProcessParallelWorker *worker = (TProcessParallelWorker *)arg;
+   TProcessParallelRanges *ranges = worker->fRanges;
+   TSelector *selector = worker->fSelector;
+
+   while (1) {
+      Long64_t first, last;
+      {
+         R__LOCKGUARD(ranges->fMutex);
+         if (ranges->fAbortProcess || ranges->fAbortFile) break;
+         if (ranges->fNext >= ranges->fFirst.size()) break;
+         first = ranges->fFirst[ranges->fNext];
+         last  = ranges->fLast[ranges->fNext];
+         ++ranges->fNext;
+      }
+      for (Long64_t entry = first; entry < last; ++entry) {
+         if (gROOT->IsInterrupted()) {
+            R__LOCKGUARD(ranges->fMutex);
+            ranges->fAbortProcess = kTRUE;
+            break;
+         }
+         if (worker->fTree->LoadTree(entry) < 0) break;
+         if (ranges->fUseCutFill) {
+            if (selector->ProcessCut(entry))
+               selector->ProcessFill(entry); //<==call user analysis function
+         } else {
+            selector->Process(entry);        //<==call user analysis function
+         }
+         if (selector->GetAbort() == TSelector::kAbortProcess) {
+            R__LOCKGUARD(ranges->fMutex);
+            ranges->fAbortProcess = kTRUE;
+            break;
+         }
+         if (selector->GetAbort() == TSelector::kAbortFile) {
+            selector->ResetAbort();
+            R__LOCKGUARD(ranges->fMutex);
+            ranges->fAbortFile = kTRUE;
+            break;
+         }
+      }
+   }
+   return (void *)0;
+}
+
+//______________________________________________________________________________
+Long64_t TTreePlayer::ProcessParallel(TSelector *selector,Option_t *option, Long64_t nentries, Long64_t firstentry)
+{
+   // Process this tree executing the code in the specified selector, with
+   // the number of threads set by TTree::SetParallelProcess.
+   // The return value is -1 in case of error and TSelector::GetStatus() in
+   // in case of success.
+   //
+   // This follows the model of a PROOF-Lite session, but in-process:
+   //  - Begin() is called for selector, which is then cloned once per thread
+   //    (with the default constructor of its class). The clones share the
+   //    input list of selector.
+   //  - Each thread opens its own copy of the file and of the tree, with its
+   //    own TTreeCache. SlaveBegin(), Init() and Notify() are called for the
+   //    clones by the calling thread.
+   //  - The clusters of the entry range (see TTree::GetClusterIterator) are
+   //    distributed dynamically among the threads, which call Process() (or
+   //    ProcessCut() and ProcessFill()) of their clone.
+   //  - SlaveTerminate() is called for the clones, their output lists are
+   //    merged into the output list of selector with the Merge(TCollection*)
+   //    function of the objects (objects without Merge function are all
+   //    added) and Terminate() is called for selector.
+   // For a TChain, the files are processed one after the other.
+   //
+   // See TTreePlayer::CanProcessParallel for the conditions to use this
+   // function.
+
+   nentries = GetEntriesToProcess(firstentry, nentries);
+   Long64_t lastentry = firstentry + nentries;
+
+   // List the trees to process: their files, names and first entries.
+   std::vector<TString>  filenames;
+   std::vector<TString>  treenames;
+   std::vector<Long64_t> offsets;
+   if (fTree->InheritsFrom(TChain::Class())) {
+      TChain *chain = (TChain*)fTree;
+      chain->GetEntries(); // Make sure the offsets of the trees are known
+      TIter next(chain->GetListOfFiles());
+      TChainElement *element;
+      Int_t i = 0;
+      while ((element = (TChainElement*)next()) && i < chain->GetNtrees()) {
+         filenames.push_back(element->GetTitle());
+         treenames.push_back(element->GetName());
+         offsets.push_back(chain->GetTreeOffset()[i]);
+         ++i;
+      }
+      offsets.push_back(chain->GetTreeOffset()[i]);
+   } else {
+      TString treename = fTree->GetName();
+      TDirectory *dir = fTree->GetDirectory();
+      if (dir && dir != fTree->GetCurrentFile()) {
+         TString path = dir->GetPath();
+         Ssiz_t idx = path.Index(":/");
+         if (idx != kNPOS) {
+            path.Remove(0, idx+2);
+            treename = path + "/" + treename;
+         }
+      }
+      filenames.push_back(fTree->GetCurrentFile()->GetName());
+      treenames.push_back(treename);
+      offsets.push_back(0);
+      offsets.push_back(fTree->GetEntries());
+   }
+
+   TDirectory::TContext ctxt(0);
+
+   selector->SetOption(option);
+
+   selector->Begin(fTree);       //<===call user initialization function
+
+   if (gMonitoringWriter)
+      gMonitoringWriter->SendProcessingStatus("STARTED",kTRUE);
+
+   // Make sure the global mutexes protecting ROOT are created.
+   TThread::Initialize();
+
+   TProcessParallelRanges ranges;
+   ranges.fMutex        = new TMutex(kTRUE);
+   ranges.fNext         = 0;
+   ranges.fUseCutFill   = selector->Version() == 0;
+   ranges.fAbortProcess = kFALSE;
+   ranges.fAbortFile    = kFALSE;
+
+   Bool_t error = kFALSE;
+   Int_t nworkers = fTree->GetParallelProcess();
+   std::vector<TProcessParallelWorker*> workers;
+   for (Int_t i = 0; i < nworkers; ++i) {
+      TProcessParallelWorker *worker = new TProcessParallelWorker;
+      worker->fRanges   = &ranges;
+      worker->fSelector = (TSelector*)selector->IsA()->New();
+      worker->fFile     = 0;
+      worker->fTree     = 0;
+      worker->fStarted  = kFALSE;
+      workers.push_back(worker);
+      if (!worker->fSelector) {
+         Error("ProcessParallel", "cannot create a copy of the selector %s", selector->IsA()->GetName());
+         selector->Abort("cannot clone the selector");
+         error = kTRUE;
+         break;
+      }
+      worker->fSelector->SetOption(option);
+      worker->fSelector->SetInputList(selector->GetInputList());
+   }
+
+   if (selector->GetAbort() != TSelector::kAbortProcess
+       && (selector->Version() != 0 || selector->GetStatus() != -1)) {
+
+      for (UInt_t t = 0; t < filenames.size() && !ranges.fAbortProcess; ++t) {
+         // Entry range to process in this tree
+         Long64_t first = firstentry - offsets[t];
+         Long64_t last  = lastentry - offsets[t];
+         if (first < 0) first = 0;
+         if (last > offsets[t+1] - offsets[t]) last = offsets[t+1] - offsets[t];
+         if (first >= last) continue;
+
+         // Open the copies of the tree and prepare the selectors
+         for (Int_t i = 0; i < nworkers; ++i) {
+            TProcessParallelWorker *worker = workers[i];
+            delete worker->fFile;
+            worker->fTree = 0;
+            {
+               TDirectory::TContext ctxtopen(0);
+               worker->fFile = TFile::Open(filenames[t], "READ");
+            }
+            if (worker->fFile) worker->fTree = (TTree*)worker->fFile->Get(treenames[t]);
+            if (!worker->fTree) {
+               Error("ProcessParallel", "cannot read the tree %s from the file %s",
+                     treenames[t].Data(), filenames[t].Data());
+               selector->Abort("cannot read the tree");
+               ranges.fAbortProcess = kTRUE;
+               error = kTRUE;
+               break;
+            }
+            if (fTree->GetCacheSize() > 0) {
+               worker->fTree->SetCacheSize(fTree->GetCacheSize());
+               TTreeCache *tpf = (TTreeCache*)worker->fFile->GetCacheRead(worker->fTree);
+               if (tpf) tpf->SetEntryRange(first,last);
+            }
+            if (!worker->fStarted) {
+               worker->fSelector->SlaveBegin(worker->fTree);  //<===call user initialization function
+               worker->fStarted = kTRUE;
+            }
+            if (worker->fSelector->Version() >= 2)
+               worker->fSelector->Init(worker->fTree);
+            worker->fSelector->Notify();
+            if (worker->fSelector->GetAbort() == TSelector::kAbortProcess) {
+               ranges.fAbortProcess = kTRUE;
+            }
+         }
+         if (ranges.fAbortProcess) break;
+
+         // Split the entry range into clusters
+         ranges.fFirst.clear();
+         ranges.fLast.clear();
+         TTree::TClusterIterator clusterIter = workers[0]->fTree->GetClusterIterator(first);
+         Long64_t start;
+         while ((start = clusterIter()) < last) {
+            Long64_t end = clusterIter.GetNextEntry();
+            ranges.fFirst.push_back(start < first ? first : start);
+            ranges.fLast.push_back(end > last ? last : end);
+         }
+         ranges.fNext = 0;
+         ranges.fAbortFile = kFALSE;
+
+         // And process them
+         std::vector<TThread*> threads;
+         for (Int_t i = 0; i < nworkers && i < (Int_t)ranges.fFirst.size(); ++i) {
+            TString nm("ProcessParallelLoop");
+            nm += i;
+            TThread *th = new TThread(nm.Data(), ProcessParallelLoop, (void*)workers[i]);
+            if (th->Run()) {
+               Error("ProcessParallel", "unable to start thread '%s'", nm.Data());
+               delete th;
+               continue;
+            }
+            threads.push_back(th);
+         }
+         if (threads.empty()) {
+            // Do the job in this thread
+            ProcessParallelLoop(workers[0]);
+         }
+         for (UInt_t i = 0; i < threads.size(); ++i) {
+            threads[i]->Join();
+            delete threads[i];
+         }
+
+         if (gMonitoringWriter)
+            gMonitoringWriter->SendProcessingProgress(last-first,TFile::GetFileBytesRead(),kTRUE);
+      }
+   }
+
+   // Terminate the clones and merge their output lists
+   TList *output = selector->GetOutputList();
+   for (Int_t i = 0; i < (Int_t)workers.size(); ++i) {
+      TSelector *clone = workers[i]->fSelector;
+      if (!clone) continue;
+      if (workers[i]->fStarted && (clone->Version() != 0 || clone->GetStatus() != -1)) {
+         clone->SlaveTerminate();   //<==call user termination function
+      }
+      if (!clone->GetOutputList() || !output) continue;
+      TList tomove;
+      TIter nxo(clone->GetOutputList());
+      TObject *obj;
+      while ((obj = nxo())) {
+         TObject *dest = output->FindObject(obj->GetName());
+         if (dest) {
+            TMethodCall callEnv;
+            if (dest->IsA())
+               callEnv.InitWithPrototype(dest->IsA(), "Merge", "TCollection*");
+            if (callEnv.IsValid()) {
+               TList list;
+               list.Add(obj);
+               callEnv.SetParam((Long_t) &list);
+               callEnv.Execute(dest);
+               continue;
+            }
+         }
+         // Not yet in the output list or no Merge interface: move it there
+         tomove.Add(obj);
+      }
+      TIter nxm(&tomove);
+      while ((obj = nxm())) {
+         clone->GetOutputList()->Remove(obj);
+         output->Add(obj);
+      }
+   }
+   for (Int_t i = 0; i < (Int_t)workers.size(); ++i) {
+      delete workers[i]->fSelector;
+      delete workers[i]->fFile;
+      delete workers[i];
+   }
+   delete ranges.fMutex;
+
+   if (selector->Version() != 0 || selector->GetStatus() != -1) {
+      selector->Terminate();        //<==call user termination function
+   }
+   if (gMonitoringWriter)
+      gMonitoringWriter->SendProcessingStatus("DONE");
+
+   if (error) return -1;
+   return selector->GetStatus();
+}
+
 //______________________________________________________________________________
 void TTreePlayer::RecursiveRemove(TObject *obj)
 {
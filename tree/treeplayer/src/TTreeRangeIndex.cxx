@@ -0,0 +1,342 @@
+// @(#)root/treeplayer:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2012, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TTreeRangeIndex                                                      //
+//                                                                      //
+// A sorted index of the values of any numerical expression of a tree   //
+// or chain, answering range queries.                                   //
+//                                                                      //
+// Unlike TTreeIndex (a major and a minor integer value, kept in memory //
+// and looked up by exact value) the index is itself a TTree, named as  //
+// the index and titled with the expression, with two branches:         //
+//    value/D  the values of the expression in increasing order         //
+//    entry/L  the entry number (in the tree or chain) of each value    //
+// It is created in the current directory, and is written and read      //
+// back as any other tree: a query reads only the baskets holding the   //
+// values in the requested range, plus a few ones for the binary        //
+// search, whatever the size of the indexed tree.                       //
+//                                                                      //
+// Building the index:                                                  //
+//    TFile f("index.root","recreate");                                 //
+//    TTreeRangeIndex *index =                                          //
+//       TTreeRangeIndex::Build(T,"sqrt(px*px+py*py)","ptindex");       //
+//    index->GetIndexTree()->Write();                                   //
+// The values are computed by processing the tree with a                //
+// TSelectorRangeIndex, by several threads if TTree::SetParallelProcess //
+// was called. Every runsize values (by default 1000000) are sorted     //
+// into a run, in the thread which computed them, and written to a      //
+// temporary file in TSystem::TempDirectory(). The runs are then        //
+// merged into the index tree, by groups of at most 100 runs, so that   //
+// the memory used does not depend on the number of entries. For an     //
+// expression with several instances per entry (e.g. an array), every   //
+// instance is indexed. Equal values are ordered by entry number.       //
+//                                                                      //
+// Using the index:                                                     //
+//    TFile f("index.root");                                            //
+//    TTreeRangeIndex index((TTree*)f.Get("ptindex"));                  //
+//    T->SetEntryList(index.GetEntryList(T, 100, 1e30));                //
+//    T->Draw("px","sqrt(px*px+py*py)>=100");                           //
+// TTree::Draw and TTree::CopyTree then read only the listed entries.   //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#include "TTreeRangeIndex.h"
+#include "TSelectorRangeIndex.h"
+#include "TTree.h"
+#include "TChain.h"
+#include "TChainElement.h"
+#include "TBranch.h"
+#include "TEntryList.h"
+#include "TTreeFormula.h"
+#include "TParameter.h"
+#include "TList.h"
+#include "TMath.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <vector>
+
+ClassImp(TTreeRangeIndex)
+
+namespace {
+   // Next value of a run being merged.
+   struct RangeIndexHead_t {
+      Double_t fValue;
+      Long64_t fEntry;
+      UInt_t   fRun;
+      bool operator>(const RangeIndexHead_t &other) const {
+         if (fValue != other.fValue) return fValue > other.fValue;
+         if (fEntry != other.fEntry) return fEntry > other.fEntry;
+         return fRun > other.fRun;
+      }
+   };
+
+   // Maximum number of runs merged at once.
+   const UInt_t kMaxMergedRuns = 100;
+}
+
+//______________________________________________________________________________
+static Bool_t R__MergeRuns(TRangeIndexRun **runs, UInt_t nruns, TRangeIndexRun *out,
+                           TTree *indextree, Double_t &value, Long64_t &entry)
+{
+   // Merge the sorted runs into out, spilled by chunks, or if out is 0 into
+   // indextree whose branches read value and entry. Returns kFALSE if a run
+   // cannot be read back entirely.
+
+   Long64_t nvalues = 0;
+   std::priority_queue<RangeIndexHead_t, std::vector<RangeIndexHead_t>, std::greater<RangeIndexHead_t> > heads;
+   for (UInt_t r = 0; r < nruns; ++r) {
+      nvalues += runs[r]->GetN();
+      if (!runs[r]->Rewind()) return kFALSE;
+      RangeIndexHead_t head;
+      head.fRun = r;
+      if (runs[r]->Next(head.fValue, head.fEntry)) heads.push(head);
+   }
+   Long64_t nmerged = 0;
+   while (!heads.empty()) {
+      RangeIndexHead_t head = heads.top();
+      heads.pop();
+      if (out) {
+         out->fValues.push_back(head.fValue);
+         out->fEntries.push_back(head.fEntry);
+         if (out->fValues.size() >= (size_t)TRangeIndexRun::kChunkSize && !out->Spill()) return kFALSE;
+      } else {
+         value = head.fValue;
+         entry = head.fEntry;
+         indextree->Fill();
+      }
+      ++nmerged;
+      if (runs[head.fRun]->Next(head.fValue, head.fEntry)) heads.push(head);
+   }
+   if (out && !out->Spill()) return kFALSE;
+   return nmerged == nvalues;
+}
+
+//______________________________________________________________________________
+TTreeRangeIndex::TTreeRangeIndex() :
+   fIndexTree(0), fValueBranch(0), fEntryBranch(0), fValue(0), fEntry(-1)
+{
+   // Default constructor.
+}
+
+//______________________________________________________________________________
+TTreeRangeIndex::TTreeRangeIndex(TTree *indextree) :
+   fIndexTree(indextree), fValueBranch(0), fEntryBranch(0), fValue(0), fEntry(-1)
+{
+   // Use the index stored in indextree (created by Build). The index tree
+   // is not owned by this object.
+
+   if (!indextree) return;
+   SetName(indextree->GetName());
+   SetTitle(indextree->GetTitle());
+   fValueBranch = indextree->GetBranch("value");
+   fEntryBranch = indextree->GetBranch("entry");
+   if (!fValueBranch || !fEntryBranch) {
+      Error("TTreeRangeIndex", "the tree %s is not a range index", indextree->GetName());
+      fIndexTree   = 0;
+      fValueBranch = 0;
+      fEntryBranch = 0;
+      return;
+   }
+   fValueBranch->SetAddress(&fValue);
+   fEntryBranch->SetAddress(&fEntry);
+}
+
+//______________________________________________________________________________
+TTreeRangeIndex *TTreeRangeIndex::Build(TTree *tree, const char *expression, const char *name, Long64_t runsize)
+{
+   // Static function building the index of the values of expression for
+   // all the entries of tree (a TTree or a TChain).
+   //
+   // The index tree is created in the current directory with the given
+   // name (by default the name of tree followed by "_index"). runsize is
+   // the number of values sorted at once (0 means 1000000): it bounds the
+   // memory used by each thread computing the values, the full runs being
+   // written to temporary files. Returns 0 in case of error.
+
+   if (!tree || !expression || !expression[0]) return 0;
+   {
+      TTreeFormula check("Expression", expression, tree);
+      if (!check.GetNdim()) {
+         ::Error("TTreeRangeIndex::Build", "cannot compile the expression %s", expression);
+         return 0;
+      }
+   }
+   TDirectory *dir = gDirectory;
+
+   TList input;
+   input.SetOwner();
+   input.Add(new TNamed("expression", expression));
+   input.Add(new TParameter<Long64_t>("runsize", runsize > 0 ? runsize : 1000000));
+   TSelectorRangeIndex selector;
+   selector.SetInputList(&input);
+   tree->Process(&selector);
+   if (selector.GetAbort() == TSelector::kAbortProcess) {
+      ::Error("TTreeRangeIndex::Build", "the values of %s could not be computed", expression);
+      return 0;
+   }
+
+   std::vector<TRangeIndexRun*> runs;
+   TList *output = selector.GetOutputList();
+   TIter next(output);
+   TObject *obj;
+   while ((obj = next())) {
+      if (obj->InheritsFrom(TRangeIndexRun::Class())) runs.push_back((TRangeIndexRun*)obj);
+   }
+
+   // Merge the runs by groups, into new spilled runs, until they are few
+   // enough to be read all at once.
+   Double_t value;
+   Long64_t entry;
+   Int_t npass = 0;
+   while (runs.size() > kMaxMergedRuns) {
+      std::vector<TRangeIndexRun*> merged;
+      for (size_t first = 0; first < runs.size(); first += kMaxMergedRuns) {
+         UInt_t nruns = (UInt_t)std::min(runs.size() - first, (size_t)kMaxMergedRuns);
+         if (nruns == 1) {
+            merged.push_back(runs[first]);
+            continue;
+         }
+         TRangeIndexRun *out = new TRangeIndexRun(TString::Format("RangeIndexRun_merged_%d_%d", npass, (Int_t)merged.size()));
+         output->Add(out);
+         merged.push_back(out);
+         if (!R__MergeRuns(&runs[first], nruns, out, 0, value, entry)) {
+            ::Error("TTreeRangeIndex::Build", "the sorted values of %s could not be merged", expression);
+            return 0;
+         }
+         for (UInt_t r = 0; r < nruns; ++r) {
+            output->Remove(runs[first + r]);
+            delete runs[first + r];
+         }
+      }
+      runs.swap(merged);
+      ++npass;
+   }
+
+   // Merge the last runs into the index tree.
+   TDirectory::TContext ctxt(dir);
+   TString indexname = (name && name[0]) ? TString(name) : TString::Format("%s_index", tree->GetName());
+   TTree *indextree = new TTree(indexname, expression);
+   indextree->Branch("value", &value, "value/D");
+   indextree->Branch("entry", &entry, "entry/L");
+   if (!R__MergeRuns(runs.empty() ? 0 : &runs[0], (UInt_t)runs.size(), 0, indextree, value, entry)) {
+      ::Error("TTreeRangeIndex::Build", "the sorted values of %s could not be merged", expression);
+      delete indextree;
+      return 0;
+   }
+   indextree->ResetBranchAddresses();
+
+   return new TTreeRangeIndex(indextree);
+}
+
+//______________________________________________________________________________
+Long64_t TTreeRangeIndex::FindFirst(Double_t value)
+{
+   // Return the position in the index of the first value greater or equal
+   // to value (GetN() if there is none).
+
+   if (!fIndexTree) return 0;
+   Long64_t lo = 0;
+   Long64_t hi = fIndexTree->GetEntries();
+   while (lo < hi) {
+      Long64_t mid = lo + (hi - lo) / 2;
+      fValueBranch->GetEntry(mid);
+      if (fValue < value) lo = mid + 1;
+      else                hi = mid;
+   }
+   return lo;
+}
+
+//______________________________________________________________________________
+TEntryList *TTreeRangeIndex::GetEntryList(TTree *tree, Double_t min, Double_t max)
+{
+   // Return a new TEntryList of the entries of tree (the indexed TTree or
+   // TChain) having at least one value of the expression in [min,max].
+   // The caller owns the list, which is typically given to
+   // TTree::SetEntryList before TTree::Draw or TTree::CopyTree.
+
+   if (!fIndexTree || !tree) return 0;
+
+   std::vector<Long64_t> entries;
+   Long64_t n = fIndexTree->GetEntries();
+   for (Long64_t i = FindFirst(min); i < n; ++i) {
+      fValueBranch->GetEntry(i);
+      if (fValue > max) break;
+      fEntryBranch->GetEntry(i);
+      entries.push_back(fEntry);
+   }
+   std::sort(entries.begin(), entries.end());
+   entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+
+   TEntryList *elist = new TEntryList(GetName(), TString::Format("%g<=%s<=%g", min, GetTitle(), max));
+   if (tree->InheritsFrom(TChain::Class())) {
+      // Fill the sub-list of each tree of the chain.
+      TChain *chain = (TChain*)tree;
+      chain->GetEntries(); // Make sure the offsets of the trees are known
+      Long64_t *offsets = chain->GetTreeOffset();
+      Int_t ntrees = chain->GetNtrees();
+      Int_t t = -1;
+      for (UInt_t i = 0; i < entries.size(); ++i) {
+         if (t < 0 || entries[i] >= offsets[t+1]) {
+            t = TMath::BinarySearch(ntrees + 1, offsets, entries[i]);
+            if (t < 0 || t >= ntrees) break;
+            // Skip the empty trees.
+            while (t+1 < ntrees && offsets[t+1] <= entries[i]) ++t;
+            TChainElement *element = (TChainElement*)chain->GetListOfFiles()->At(t);
+            elist->SetTree(element->GetName(), element->GetTitle());
+         }
+         elist->Enter(entries[i] - offsets[t]);
+      }
+   } else {
+      elist->SetTree(tree);
+      for (UInt_t i = 0; i < entries.size(); ++i) {
+         elist->Enter(entries[i]);
+      }
+   }
+   return elist;
+}
+
+//______________________________________________________________________________
+Long64_t TTreeRangeIndex::GetEntryNumberWithValue(Double_t value)
+{
+   // Return the entry number of the first value of the index equal to
+   // value, -1 if there is none.
+
+   if (!fIndexTree) return -1;
+   Long64_t i = FindFirst(value);
+   if (i >= fIndexTree->GetEntries()) return -1;
+   fValueBranch->GetEntry(i);
+   if (fValue != value) return -1;
+   fEntryBranch->GetEntry(i);
+   return fEntry;
+}
+
+//______________________________________________________________________________
+Long64_t TTreeRangeIndex::GetN() const
+{
+   // Return the number of values in the index.
+
+   return fIndexTree ? fIndexTree->GetEntries() : 0;
+}
+
+//______________________________________________________________________________
+void TTreeRangeIndex::Print(Option_t *) const
+{
+   // Print the name, the expression and the size of the index.
+
+   printf("**********************************************\n");
+   printf("* Range index : %s\n", GetName());
+   printf("* Expression  : %s\n", GetTitle());
+   printf("* Values      : %lld\n", GetN());
+   printf("**********************************************\n");
+}